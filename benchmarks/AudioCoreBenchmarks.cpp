@@ -0,0 +1,220 @@
+// Throughput of the per-block DSP stages at typical device block sizes. Inputs are recorded
+// once from SyntheticHeartSource (or the calibration generator) and replayed block by block,
+// so every run processes the same samples.
+//
+//   cmake -S . -B build && cmake --build build --target knot_audio_benchmarks
+//   ./build/benchmarks/knot_audio_benchmarks
+
+#include "AudioRouter.h"
+#include "BeatTimeline.h"
+#include "BiquadFilter.h"
+#include "Calibration.h"
+#include "SimpleLimiter.h"
+#include "SyntheticHeartSource.h"
+#include "SceneController.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr double kSampleRate = 48000.0;
+constexpr double kRecordingSec = 10.0;
+
+/// Ten seconds of synthetic stereo heart sounds, deinterleaved.
+const std::array<std::vector<float>, 2>& heartRecording() {
+    static const std::array<std::vector<float>, 2> recording = [] {
+        SyntheticHeartSource source;
+        SyntheticHeartParams second;
+        second.bpm = 74.0f;
+        source.setup(kSampleRate, {SyntheticHeartParams{}, second}, 1);
+        const auto frames = static_cast<std::size_t>(kSampleRate * kRecordingSec);
+        std::vector<float> interleaved(frames * 2);
+        source.read(interleaved.data(), frames);
+        std::array<std::vector<float>, 2> channels;
+        for (std::size_t ch = 0; ch < 2; ++ch) {
+            channels[ch].resize(frames);
+            for (std::size_t i = 0; i < frames; ++i) {
+                // Roughly the level after the default input gain.
+                channels[ch][i] = interleaved[i * 2 + ch] * 16.0f;
+            }
+        }
+        return channels;
+    }();
+    return recording;
+}
+
+/// Start of the next block of blockFrames in a recording of totalFrames, wrapping around.
+std::size_t nextBlock(std::size_t& cursor, std::size_t blockFrames, std::size_t totalFrames) {
+    if (cursor + blockFrames > totalFrames) {
+        cursor = 0;
+    }
+    const std::size_t start = cursor;
+    cursor += blockFrames;
+    return start;
+}
+
+void setSampleCounters(benchmark::State& state) {
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_BeatTimelineProcessBuffer(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const auto& input = heartRecording()[0];
+    BeatTimeline timeline;
+    timeline.setup(kSampleRate, ParticipantId::Participant1);
+    timeline.setBaselineTracking(true);
+    std::size_t cursor = 0;
+    double sampleIndex = 0.0;
+    for (auto _ : state) {
+        const std::size_t start = nextBlock(cursor, blockFrames, input.size());
+        timeline.processBuffer(input.data() + start, blockFrames, sampleIndex);
+        sampleIndex += static_cast<double>(blockFrames);
+        benchmark::DoNotOptimize(timeline.currentEnvelope());
+    }
+    setSampleCounters(state);
+}
+
+AudioRouter& mixedSceneRouter(AudioRouter& router) {
+    router.setup(static_cast<float>(kSampleRate));
+    const auto rules = AudioRouter::builtInScenePreset(SceneState::Mixed);
+    for (std::size_t ch = 0; ch < rules.size(); ++ch) {
+        router.setRoutingRule(static_cast<OutputChannel>(ch), rules[ch]);
+    }
+    return router;
+}
+
+/// The per-sample entry point: one prepareBlock() per frame.
+void BM_AudioRouterRoute(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const auto& input = heartRecording();
+    AudioRouter router;
+    mixedSceneRouter(router);
+    std::array<float, 4> out{};
+    std::size_t cursor = 0;
+    for (auto _ : state) {
+        const std::size_t start = nextBlock(cursor, blockFrames, input[0].size());
+        for (std::size_t i = start; i < start + blockFrames; ++i) {
+            const std::array<float, 2> frame{input[0][i], input[1][i]};
+            router.route(frame, {0.2f, 0.2f}, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    setSampleCounters(state);
+}
+
+/// The path AudioPipeline uses: prepareBlock() once, routeFrame() per frame.
+void BM_AudioRouterRouteBlock(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const auto& input = heartRecording();
+    AudioRouter router;
+    mixedSceneRouter(router);
+    const float envelopes[2] = {0.2f, 0.2f};
+    std::vector<float> out(blockFrames * AudioRouter::kOutputChannels);
+    std::size_t cursor = 0;
+    std::uint64_t sampleClock = 0;
+    for (auto _ : state) {
+        const std::size_t start = nextBlock(cursor, blockFrames, input[0].size());
+        router.prepareBlock(sampleClock, blockFrames);
+        for (std::size_t i = 0; i < blockFrames; ++i) {
+            const float frame[2] = {input[0][start + i], input[1][start + i]};
+            router.routeFrame(frame, envelopes, 1.0f, nullptr, out.data() + i * AudioRouter::kOutputChannels,
+                              AudioRouter::kOutputChannels);
+        }
+        sampleClock += blockFrames;
+        benchmark::DoNotOptimize(out.data());
+    }
+    setSampleCounters(state);
+}
+
+void BM_SimpleLimiter(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const auto& input = heartRecording()[0];
+    SimpleLimiter limiter;
+    limiter.setup(kSampleRate, -12.0f, 50.0f);
+    std::vector<float> out(blockFrames);
+    std::size_t cursor = 0;
+    for (auto _ : state) {
+        const std::size_t start = nextBlock(cursor, blockFrames, input.size());
+        for (std::size_t i = 0; i < blockFrames; ++i) {
+            out[i] = limiter.process(input[start + i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    setSampleCounters(state);
+}
+
+void BM_BiquadFilter(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const auto& input = heartRecording()[0];
+    BiquadFilter filter;
+    filter.setup(BiquadFilter::Type::BandPass, kSampleRate, 60.0, 0.7);
+    std::vector<float> out(blockFrames);
+    std::size_t cursor = 0;
+    for (auto _ : state) {
+        const std::size_t start = nextBlock(cursor, blockFrames, input.size());
+        for (std::size_t i = 0; i < blockFrames; ++i) {
+            out[i] = filter.process(input[start + i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    setSampleCounters(state);
+}
+
+/// Calibration plan as CalibrationSession::setup(kSampleRate, 512, 8) lays it out.
+CalibrationPlan calibrationPlan() {
+    CalibrationPlan plan;
+    plan.sampleRate = kSampleRate;
+    plan.toneSamples = static_cast<std::uint64_t>(kSampleRate * CalibrationSession::kToneSec);
+    plan.toneSwapInterval = 512;
+    plan.pulseLengthSamples = 256;
+    plan.pulseSpacingSamples = static_cast<std::uint64_t>(kSampleRate * 0.25);
+    plan.pulseStartSample = plan.toneSamples + static_cast<std::uint64_t>(kSampleRate * 0.5);
+    for (std::uint64_t i = 0; i < 8; ++i) {
+        plan.pulseOffsets[0].push_back(i * plan.pulseSpacingSamples);
+        plan.pulseOffsets[1].push_back(i * plan.pulseSpacingSamples + plan.pulseSpacingSamples / 2);
+    }
+    plan.totalSamples = plan.pulseStartSample + plan.pulseOffsets[1].back() + plan.pulseLengthSamples +
+                        static_cast<std::uint64_t>(kSampleRate * 0.25);
+    return plan;
+}
+
+/// The whole calibration signal looped straight back, tone and pulses; the analyzer restarts
+/// when it reaches the end of the plan.
+void BM_CalibrationAnalyzerIngest(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const CalibrationPlan plan = calibrationPlan();
+    CalibrationSignalGenerator generator;
+    generator.setup(plan);
+    const auto totalFrames = static_cast<std::size_t>(plan.totalSamples);
+    std::vector<float> loopback(totalFrames * 2);
+    generator.generate(loopback.data(), totalFrames);
+
+    CalibrationAnalyzer analyzer;
+    analyzer.setup(plan);
+    std::size_t cursor = 0;
+    for (auto _ : state) {
+        if (cursor + blockFrames > totalFrames) {
+            cursor = 0;
+            analyzer.reset();
+        }
+        analyzer.ingest(loopback.data() + cursor * 2, blockFrames);
+        cursor += blockFrames;
+    }
+    benchmark::DoNotOptimize(analyzer.measuredGainDbDelta());
+    setSampleCounters(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_BeatTimelineProcessBuffer)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_AudioRouterRoute)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_AudioRouterRouteBlock)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_SimpleLimiter)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_BiquadFilter)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_CalibrationAnalyzerIngest)->RangeMultiplier(4)->Range(64, 4096);
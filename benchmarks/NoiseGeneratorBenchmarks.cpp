@@ -0,0 +1,52 @@
+// NoiseGenerator against the per-sample std::mt19937 + std::normal_distribution path it
+// replaced in AudioPipeline, filling one monitor block of unit-variance noise.
+
+#include "NoiseGenerator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+void BM_NormalDistributionMt19937(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    std::mt19937 rng(1);
+    std::normal_distribution<float> dist{0.0f, 1.0f};
+    std::vector<float> out(blockFrames);
+    for (auto _ : state) {
+        for (auto& sample : out) {
+            sample = dist(rng);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_NoiseGeneratorFill(benchmark::State& state) {
+    const auto blockFrames = static_cast<std::size_t>(state.range(0));
+    const auto color = static_cast<NoiseColor>(state.range(1));
+    NoiseGenerator generator;
+    generator.setup(48000.0);
+    generator.seed(1);
+    generator.setColor(color);
+    state.SetLabel(noiseColorToString(color));
+    std::vector<float> out(blockFrames);
+    for (auto _ : state) {
+        generator.fill(out.data(), blockFrames);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_NormalDistributionMt19937)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_NoiseGeneratorFill)
+    ->ArgsProduct({benchmark::CreateRange(64, 4096, 4),
+                   {static_cast<int>(NoiseColor::White), static_cast<int>(NoiseColor::Pink),
+                    static_cast<int>(NoiseColor::Brown)}});
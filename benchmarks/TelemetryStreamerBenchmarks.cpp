@@ -0,0 +1,40 @@
+// Telemetry streaming against a receiver on 127.0.0.1 with the default streaming config: each
+// iteration is one ~0.3 s loopback run (TelemetryStreamer::measureLoopback()).
+//
+//   ./build/benchmarks/knot_audio_benchmarks --benchmark_filter=BM_TelemetryLoopback
+
+#include "infra/TelemetryStreamer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+
+namespace {
+
+void BM_TelemetryLoopback(benchmark::State& state) {
+    const infra::StreamingConfig config;
+    double bytesPerSecond = 0.0;
+    double latencyMedianUs = 0.0;
+    double latencyMaxUs = 0.0;
+    double lostBeats = 0.0;
+    for (auto _ : state) {
+        const auto report = infra::TelemetryStreamer::measureLoopback(config);
+        if (!report.receiverBound) {
+            state.SkipWithError("cannot bind a receiver on 127.0.0.1");
+            return;
+        }
+        bytesPerSecond += report.bytesPerSecond();
+        latencyMedianUs += report.beatLatencyMedianUs;
+        latencyMaxUs = std::max(latencyMaxUs, report.beatLatencyMaxUs);
+        lostBeats += static_cast<double>(report.lostBeats());
+    }
+    const auto runs = static_cast<double>(state.iterations());
+    state.counters["bytesPerSec"] = bytesPerSecond / runs;
+    state.counters["beatLatencyMedianUs"] = latencyMedianUs / runs;
+    state.counters["beatLatencyMaxUs"] = latencyMaxUs;
+    state.counters["lostBeats"] = lostBeats;
+}
+
+} // namespace
+
+BENCHMARK(BM_TelemetryLoopback)->Iterations(5)->Unit(benchmark::kMillisecond)->UseRealTime();
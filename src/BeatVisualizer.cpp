@@ -2,28 +2,220 @@
 
 #include <algorithm>
 
-BeatEnvelopeHistory::BeatEnvelopeHistory() = default;
+BeatEnvelopeHistory::BeatEnvelopeHistory()
+: BeatEnvelopeHistory(kDefaultCapacity) {}
+
+BeatEnvelopeHistory::BeatEnvelopeHistory(std::size_t capacity)
+: capacity_{std::max<std::size_t>(capacity, 2)} {
+    timestamps_.assign(capacity_, 0.0);
+    envelopes_.assign(capacity_, 0.0f);
+    bpms_.assign(capacity_, 0.0f);
+    envelopeWindow_.reset(capacity_);
+    bpmWindow_.reset(capacity_);
+}
 
 void BeatEnvelopeHistory::setHorizon(double seconds) noexcept {
     horizonSeconds_ = std::max(1.0, seconds);
 }
 
 void BeatEnvelopeHistory::addSample(double timestampSec, float envelopeValue, float bpmValue) {
-    BeatVisualMetrics sample;
-    sample.timestampSec = timestampSec;
-    sample.envelope = envelopeValue;
-    sample.bpm = bpmValue;
-    samples_.push_back(sample);
-    prune(timestampSec);
-}
+    if (size() == capacity_) {
+        evictOldest();
+    }
+    const std::uint64_t sequence = head_;
+    const std::size_t slot = slotOf(sequence);
+    timestamps_[slot] = timestampSec;
+    envelopes_[slot] = envelopeValue;
+    bpms_[slot] = bpmValue;
+    ++head_;
 
-const std::deque<BeatVisualMetrics>& BeatEnvelopeHistory::samples() const noexcept {
-    return samples_;
+    envelopeSum_ += envelopeValue;
+    bpmSum_ += bpmValue;
+    envelopeWindow_.push(sequence, envelopes_, capacity_);
+    bpmWindow_.push(sequence, bpms_, capacity_);
+    prune(timestampSec);
 }
 
 void BeatEnvelopeHistory::prune(double nowSeconds) {
     const double threshold = nowSeconds - horizonSeconds_;
-    while (!samples_.empty() && samples_.front().timestampSec < threshold) {
-        samples_.pop_front();
+    while (!empty() && timestamps_[slotOf(tail_)] < threshold) {
+        evictOldest();
+    }
+}
+
+void BeatEnvelopeHistory::clear() noexcept {
+    head_ = 0;
+    tail_ = 0;
+    envelopeSum_ = 0.0;
+    bpmSum_ = 0.0;
+    envelopeWindow_.clear();
+    bpmWindow_.clear();
+}
+
+std::uint64_t BeatEnvelopeHistory::lowerBound(double timestampSec) const noexcept {
+    std::uint64_t low = tail_;
+    std::uint64_t high = head_;
+    while (low < high) {
+        const std::uint64_t mid = low + (high - low) / 2;
+        if (timestamps_[slotOf(mid)] < timestampSec) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+BeatEnvelopeHistory::WindowStats BeatEnvelopeHistory::envelopeStats() const noexcept {
+    return statsFor(envelopes_, envelopeWindow_, envelopeSum_);
+}
+
+BeatEnvelopeHistory::WindowStats BeatEnvelopeHistory::bpmStats() const noexcept {
+    return statsFor(bpms_, bpmWindow_, bpmSum_);
+}
+
+BeatEnvelopeHistory::WindowStats BeatEnvelopeHistory::statsFor(const std::vector<float>& values,
+                                                               const MonotonicWindow& window,
+                                                               double sum) const noexcept {
+    WindowStats stats;
+    if (empty()) {
+        return stats;
+    }
+    stats.min = values[slotOf(window.minSequence())];
+    stats.max = values[slotOf(window.maxSequence())];
+    stats.mean = static_cast<float>(sum / static_cast<double>(size()));
+    return stats;
+}
+
+void BeatEnvelopeHistory::evictOldest() noexcept {
+    const std::uint64_t sequence = tail_;
+    const std::size_t slot = slotOf(sequence);
+    envelopeSum_ -= envelopes_[slot];
+    bpmSum_ -= bpms_[slot];
+    envelopeWindow_.evict(sequence);
+    bpmWindow_.evict(sequence);
+    ++tail_;
+    if (empty()) {
+        // Drop accumulated rounding error whenever the window drains.
+        envelopeSum_ = 0.0;
+        bpmSum_ = 0.0;
+    }
+}
+
+void BeatEnvelopeHistory::MonotonicWindow::reset(std::size_t capacity) {
+    minRing_.assign(capacity, 0);
+    maxRing_.assign(capacity, 0);
+    clear();
+}
+
+void BeatEnvelopeHistory::MonotonicWindow::clear() noexcept {
+    minFront_ = minBack_ = 0;
+    maxFront_ = maxBack_ = 0;
+}
+
+void BeatEnvelopeHistory::MonotonicWindow::push(std::uint64_t sequence, const std::vector<float>& values,
+                                                std::size_t capacity) {
+    const float value = values[static_cast<std::size_t>(sequence % capacity)];
+    const std::size_t ringSize = minRing_.size();
+    while (minBack_ > minFront_ &&
+           values[static_cast<std::size_t>(minRing_[(minBack_ - 1) % ringSize] % capacity)] >= value) {
+        --minBack_;
+    }
+    minRing_[minBack_++ % ringSize] = sequence;
+    while (maxBack_ > maxFront_ &&
+           values[static_cast<std::size_t>(maxRing_[(maxBack_ - 1) % ringSize] % capacity)] <= value) {
+        --maxBack_;
+    }
+    maxRing_[maxBack_++ % ringSize] = sequence;
+}
+
+void BeatEnvelopeHistory::MonotonicWindow::evict(std::uint64_t sequence) noexcept {
+    const std::size_t ringSize = minRing_.size();
+    if (minBack_ > minFront_ && minRing_[minFront_ % ringSize] == sequence) {
+        ++minFront_;
+    }
+    if (maxBack_ > maxFront_ && maxRing_[maxFront_ % ringSize] == sequence) {
+        ++maxFront_;
+    }
+}
+
+void EnvelopeLineStream::allocate(std::size_t capacity) {
+    capacity_ = capacity;
+    // One extra vertex mirrors slot 0 so the strip crossing the wrap point stays connected.
+    staging_.assign(capacity_ + 1, glm::vec2(0.0f, 0.0f));
+    buffer_.allocate(staging_.size() * sizeof(glm::vec2), GL_STREAM_DRAW);
+    vbo_.setVertexBuffer(buffer_, 2, sizeof(glm::vec2));
+    uploadedEnd_ = 0;
+}
+
+void EnvelopeLineStream::sync(const BeatEnvelopeHistory& history) {
+    if (capacity_ != history.capacity()) {
+        allocate(history.capacity());
+    }
+    if (history.empty()) {
+        uploadedEnd_ = history.endSequence();
+        return;
+    }
+    if (!hasOrigin_) {
+        originSec_ = history.frontTimestamp();
+        hasOrigin_ = true;
+    }
+    // The history was cleared (sequence went backwards) or we fell more than a ring behind.
+    if (uploadedEnd_ > history.endSequence() || uploadedEnd_ < history.firstSequence()) {
+        uploadedEnd_ = history.firstSequence();
+    }
+    if (uploadedEnd_ == history.endSequence()) {
+        return;
+    }
+    uploadRange(history, uploadedEnd_, history.endSequence());
+    uploadedEnd_ = history.endSequence();
+}
+
+void EnvelopeLineStream::uploadRange(const BeatEnvelopeHistory& history, std::uint64_t begin, std::uint64_t end) {
+    std::uint64_t sequence = begin;
+    while (sequence < end) {
+        const std::size_t firstSlot = history.slotOf(sequence);
+        const std::size_t runLength =
+            static_cast<std::size_t>(std::min<std::uint64_t>(end - sequence, capacity_ - firstSlot));
+        for (std::size_t i = 0; i < runLength; ++i) {
+            const std::uint64_t seq = sequence + i;
+            staging_[firstSlot + i] = glm::vec2(static_cast<float>(history.timestampAt(seq) - originSec_),
+                                                history.envelopeAt(seq));
+        }
+        buffer_.updateData(static_cast<std::ptrdiff_t>(firstSlot * sizeof(glm::vec2)),
+                           runLength * sizeof(glm::vec2), staging_.data() + firstSlot);
+        if (firstSlot == 0) {
+            staging_[capacity_] = staging_[0];
+            buffer_.updateData(static_cast<std::ptrdiff_t>(capacity_ * sizeof(glm::vec2)), sizeof(glm::vec2),
+                               staging_.data() + capacity_);
+        }
+        sequence += runLength;
+    }
+}
+
+void EnvelopeLineStream::draw(const BeatEnvelopeHistory& history, const ofRectangle& area, double startSec,
+                              double spanSec) const {
+    if (capacity_ == 0 || !hasOrigin_ || spanSec <= 0.0) {
+        return;
+    }
+    const std::uint64_t first = history.lowerBound(startSec);
+    const std::uint64_t end = std::min(history.endSequence(), uploadedEnd_);
+    if (end <= first || end - first < 2) {
+        return;
+    }
+
+    ofPushMatrix();
+    ofTranslate(static_cast<float>(area.x + (originSec_ - startSec) / spanSec * area.width), area.getBottom());
+    ofScale(static_cast<float>(area.width / spanSec), -area.height);
+
+    const std::size_t count = static_cast<std::size_t>(end - first);
+    const std::size_t firstSlot = history.slotOf(first);
+    if (firstSlot + count <= capacity_ + 1) {
+        vbo_.draw(GL_LINE_STRIP, static_cast<int>(firstSlot), static_cast<int>(count));
+    } else {
+        const std::size_t headCount = capacity_ - firstSlot + 1;
+        vbo_.draw(GL_LINE_STRIP, static_cast<int>(firstSlot), static_cast<int>(headCount));
+        vbo_.draw(GL_LINE_STRIP, 0, static_cast<int>(count - (capacity_ - firstSlot)));
     }
+    ofPopMatrix();
 }
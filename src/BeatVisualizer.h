@@ -1,7 +1,11 @@
 #pragma once
 
-#include <deque>
+#include "ofMain.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 struct BeatVisualMetrics {
     float bpm = 0.0f;
@@ -9,16 +13,104 @@ struct BeatVisualMetrics {
     double timestampSec = 0.0;
 };
 
+/// Fixed-capacity time series of envelope/BPM samples stored as separate arrays (SoA).
+/// Samples are addressed by a monotonically increasing sequence number; the storage slot is
+/// `sequence % capacity()`. Append and prune are O(1) (amortised), and min/max/mean over the
+/// retained window are maintained incrementally with monotonic deques.
 class BeatEnvelopeHistory {
 public:
+    struct WindowStats {
+        float min = 0.0f;
+        float max = 0.0f;
+        float mean = 0.0f;
+    };
+
+    static constexpr std::size_t kDefaultCapacity = 4096;
+
     BeatEnvelopeHistory();
+    explicit BeatEnvelopeHistory(std::size_t capacity);
 
     void setHorizon(double seconds) noexcept;
+    [[nodiscard]] double horizon() const noexcept { return horizonSeconds_; }
     void addSample(double timestampSec, float envelopeValue, float bpmValue);
-    [[nodiscard]] const std::deque<BeatVisualMetrics>& samples() const noexcept;
     void prune(double nowSeconds);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return static_cast<std::size_t>(head_ - tail_); }
+    [[nodiscard]] bool empty() const noexcept { return head_ == tail_; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+    /// Sequence range [firstSequence, endSequence) of the retained samples.
+    [[nodiscard]] std::uint64_t firstSequence() const noexcept { return tail_; }
+    [[nodiscard]] std::uint64_t endSequence() const noexcept { return head_; }
+    /// First retained sequence whose timestamp is >= timestampSec (endSequence() if none).
+    [[nodiscard]] std::uint64_t lowerBound(double timestampSec) const noexcept;
+    [[nodiscard]] std::size_t slotOf(std::uint64_t sequence) const noexcept {
+        return static_cast<std::size_t>(sequence % capacity_);
+    }
+
+    [[nodiscard]] double timestampAt(std::uint64_t sequence) const noexcept { return timestamps_[slotOf(sequence)]; }
+    [[nodiscard]] float envelopeAt(std::uint64_t sequence) const noexcept { return envelopes_[slotOf(sequence)]; }
+    [[nodiscard]] float bpmAt(std::uint64_t sequence) const noexcept { return bpms_[slotOf(sequence)]; }
+    [[nodiscard]] double frontTimestamp() const noexcept { return empty() ? 0.0 : timestampAt(tail_); }
+    [[nodiscard]] double backTimestamp() const noexcept { return empty() ? 0.0 : timestampAt(head_ - 1); }
+
+    [[nodiscard]] WindowStats envelopeStats() const noexcept;
+    [[nodiscard]] WindowStats bpmStats() const noexcept;
 
 private:
+    /// Sliding-window min/max over a series, holding sequence numbers in two fixed rings.
+    class MonotonicWindow {
+    public:
+        void reset(std::size_t capacity);
+        void clear() noexcept;
+        void push(std::uint64_t sequence, const std::vector<float>& values, std::size_t capacity);
+        void evict(std::uint64_t sequence) noexcept;
+        [[nodiscard]] std::uint64_t minSequence() const noexcept { return minRing_[minFront_ % minRing_.size()]; }
+        [[nodiscard]] std::uint64_t maxSequence() const noexcept { return maxRing_[maxFront_ % maxRing_.size()]; }
+
+    private:
+        std::vector<std::uint64_t> minRing_;
+        std::vector<std::uint64_t> maxRing_;
+        std::uint64_t minFront_ = 0;
+        std::uint64_t minBack_ = 0;
+        std::uint64_t maxFront_ = 0;
+        std::uint64_t maxBack_ = 0;
+    };
+
+    void evictOldest() noexcept;
+    WindowStats statsFor(const std::vector<float>& values, const MonotonicWindow& window, double sum) const noexcept;
+
     double horizonSeconds_ = 15.0;
-    std::deque<BeatVisualMetrics> samples_;
+    std::size_t capacity_ = kDefaultCapacity;
+    std::uint64_t head_ = 0;
+    std::uint64_t tail_ = 0;
+    std::vector<double> timestamps_;
+    std::vector<float> envelopes_;
+    std::vector<float> bpms_;
+    MonotonicWindow envelopeWindow_;
+    MonotonicWindow bpmWindow_;
+    double envelopeSum_ = 0.0;
+    double bpmSum_ = 0.0;
+};
+
+/// GPU-side mirror of a BeatEnvelopeHistory envelope series. Vertices live in a persistent
+/// buffer laid out like the history ring (plus one mirrored slot so a wrapped window can be
+/// drawn as two line strips); `sync` uploads only samples appended since the last call.
+class EnvelopeLineStream {
+public:
+    void sync(const BeatEnvelopeHistory& history);
+    void draw(const BeatEnvelopeHistory& history, const ofRectangle& area, double startSec, double spanSec) const;
+
+private:
+    void allocate(std::size_t capacity);
+    void uploadRange(const BeatEnvelopeHistory& history, std::uint64_t begin, std::uint64_t end);
+
+    ofBufferObject buffer_;
+    ofVbo vbo_;
+    std::vector<glm::vec2> staging_;
+    std::size_t capacity_ = 0;
+    std::uint64_t uploadedEnd_ = 0;
+    double originSec_ = 0.0;
+    bool hasOrigin_ = false;
 };
@@ -81,7 +81,9 @@ void SceneController::update(double nowSeconds) {
 		const std::string reason = transitionMeta_.triggerReason;
 
 		currentState_ = transition_.to;
-		stateEnteredAt_ = nowSeconds;
+		// Timeline times are nominal rather than the frame that noticed them, so stage offsets
+		// and audio events scheduled against them do not accumulate frame jitter.
+		stateEnteredAt_ = transition_.startTime + fadeDuration_;
 		transition_.active = false;
 		blend_ = 0.0f;
 
@@ -91,7 +93,7 @@ void SceneController::update(double nowSeconds) {
 		event.manual = manual;
 		event.completed = true;
 		event.triggerReason = reason;
-		event.timestamp = nowSeconds;
+		event.timestamp = stateEnteredAt_;
 		event.timeInState = elapsed;
 		event.blendDuration = fadeDuration_;
 		transitionEvents_.push_back(event);
@@ -142,6 +144,10 @@ double SceneController::timeInState(double nowSeconds) const noexcept {
 	return nowSeconds - stateEnteredAt_;
 }
 
+double SceneController::fadeDuration() const noexcept {
+	return fadeDuration_;
+}
+
 bool SceneController::canTransition(SceneState from, SceneState to, bool manualRequest) const noexcept {
 	if (!manualRequest) {
 		return true;
@@ -222,5 +228,20 @@ void SceneController::pollAutoTransition(double nowSeconds) {
 	if (sceneCfg == nullptr || !sceneCfg->transitionTo.has_value()) {
 		return;
 	}
-	startTransition(*sceneCfg->transitionTo, nowSeconds, false, "timeout");
+	startTransition(*sceneCfg->transitionTo, stateEnteredAt_ + *durationOpt, false, "timeout");
+}
+
+std::optional<SceneController::PlannedTransition> SceneController::plannedAutoTransition() const noexcept {
+	if (!timingConfig_ || transition_.active) {
+		return std::nullopt;
+	}
+	const auto durationOpt = timingConfig_->effectiveDuration(currentState_);
+	const auto* sceneCfg = timingConfig_->find(currentState_);
+	if (!durationOpt.has_value() || sceneCfg == nullptr || !sceneCfg->transitionTo.has_value()) {
+		return std::nullopt;
+	}
+	PlannedTransition planned;
+	planned.to = *sceneCfg->transitionTo;
+	planned.startTime = stateEnteredAt_ + *durationOpt;
+	return planned;
 }
@@ -52,6 +52,15 @@ public:
     bool isTransitioning() const noexcept;
     float transitionBlend() const noexcept;
     double timeInState(double nowSeconds) const noexcept;
+    double fadeDuration() const noexcept;
+
+    /// The timeout transition the timing config will start from the current state, with its
+    /// nominal start time. Lets audio events be queued on the output clock ahead of time.
+    struct PlannedTransition {
+        SceneState to = SceneState::Idle;
+        double startTime = 0.0;
+    };
+    std::optional<PlannedTransition> plannedAutoTransition() const noexcept;
 
 private:
     struct Transition {
@@ -33,20 +33,35 @@ std::optional<SceneState> parseSceneState(const ofJson& jsonValue) {
 }  // namespace
 
 SceneTimingConfig SceneTimingConfig::load(const std::filesystem::path& relativePath) {
+	std::string error;
+	auto config = tryLoad(relativePath, error);
+	if (!config.has_value()) {
+		ofLogWarning("SceneTimingConfig") << error;
+		return SceneTimingConfig{};
+	}
+	return std::move(*config);
+}
+
+std::optional<SceneTimingConfig> SceneTimingConfig::tryLoad(const std::filesystem::path& relativePath,
+															std::string& error) {
 	SceneTimingConfig config;
 	const auto absolutePath = resolveDataPath(relativePath);
 
 	if (!std::filesystem::exists(absolutePath)) {
-		ofLogWarning("SceneTimingConfig") << "Config not found: " << absolutePath;
-		return config;
+		error = "Config not found: " + absolutePath.string();
+		return std::nullopt;
 	}
 
 	ofJson json;
 	try {
 		json = ofLoadJson(absolutePath.string());
 	} catch (const std::exception& ex) {
-		ofLogError("SceneTimingConfig") << "Failed to parse config: " << ex.what();
-		return config;
+		error = std::string("Failed to parse config: ") + ex.what();
+		return std::nullopt;
+	}
+	if (!json.is_object()) {
+		error = "Failed to parse config: " + absolutePath.string();
+		return std::nullopt;
 	}
 
 	const auto scenesIt = json.find("scenes");
@@ -59,8 +74,16 @@ SceneTimingConfig SceneTimingConfig::load(const std::filesystem::path& relativeP
 			}
 
 			SceneConfig scene;
-			if (value.contains("autoDuration") && !value["autoDuration"].is_null()) {
-				scene.autoDuration = value["autoDuration"].get<double>();
+			try {
+				if (value.contains("autoDuration") && !value["autoDuration"].is_null()) {
+					scene.autoDuration = value["autoDuration"].get<double>();
+				}
+				if (value.contains("idleReturnDelay") && !value["idleReturnDelay"].is_null()) {
+					scene.idleReturnDelay = value["idleReturnDelay"].get<double>();
+				}
+			} catch (const std::exception& ex) {
+				error = "Invalid value in scene " + key + ": " + ex.what();
+				return std::nullopt;
 			}
 
 			if (value.contains("stages") && value["stages"].is_array()) {
@@ -73,10 +96,6 @@ SceneTimingConfig SceneTimingConfig::load(const std::filesystem::path& relativeP
 				scene.transitionTo = parseSceneState(value["transitionTo"]);
 			}
 
-			if (value.contains("idleReturnDelay") && !value["idleReturnDelay"].is_null()) {
-				scene.idleReturnDelay = value["idleReturnDelay"].get<double>();
-			}
-
 			config.scenes_.emplace(*stateOpt, std::move(scene));
 		}
 	}
@@ -88,9 +107,37 @@ SceneTimingConfig SceneTimingConfig::load(const std::filesystem::path& relativeP
 		config.testScaleFactor_ = (scale > 0.0) ? scale : 1.0;
 	}
 
+	error = config.validate();
+	if (!error.empty()) {
+		return std::nullopt;
+	}
 	return config;
 }
 
+std::string SceneTimingConfig::validate() const {
+	for (const auto& [state, scene] : scenes_) {
+		const std::string name = sceneStateToString(state);
+		if (scene.autoDuration.has_value() && !(*scene.autoDuration > 0.0)) {
+			return name + ": autoDuration must be positive";
+		}
+		if (scene.idleReturnDelay.has_value() && *scene.idleReturnDelay < 0.0) {
+			return name + ": idleReturnDelay must not be negative";
+		}
+		if (scene.transitionTo.has_value() && *scene.transitionTo == state) {
+			return name + ": transitionTo must name a different scene";
+		}
+		for (const auto& stage : scene.stages) {
+			if (stage.name.empty()) {
+				return name + ": stage without a name";
+			}
+			if (stage.startAt < 0.0 || stage.duration < 0.0) {
+				return name + "." + stage.name + ": startAt/duration must not be negative";
+			}
+		}
+	}
+	return {};
+}
+
 const SceneTimingConfig::SceneConfig* SceneTimingConfig::find(SceneState state) const noexcept {
 	const auto it = scenes_.find(state);
 	if (it == scenes_.end()) {
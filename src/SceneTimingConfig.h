@@ -24,6 +24,12 @@ class SceneTimingConfig {
 	};
 
 	static SceneTimingConfig load(const std::filesystem::path& relativePath);
+	/// Strict variant used for hot reload: returns nullopt (with a reason) when the file is
+	/// missing, unparsable, or fails validate(), instead of falling back to an empty config.
+	static std::optional<SceneTimingConfig> tryLoad(const std::filesystem::path& relativePath, std::string& error);
+
+	/// Checks value ranges and scene references. Returns an empty string when valid.
+	[[nodiscard]] std::string validate() const;
 
 	[[nodiscard]] bool testModeEnabled() const noexcept { return testModeEnabled_; }
 	[[nodiscard]] double testScaleFactor() const noexcept { return testScaleFactor_; }
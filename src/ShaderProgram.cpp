@@ -0,0 +1,310 @@
+#include "ShaderProgram.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <vector>
+
+// Program binaries need GL 4.1 / GL_ARB_get_program_binary, which the legacy macOS context and
+// the GLES targets do not offer; those always load through ofShader.
+#if defined(TARGET_OPENGLES) || defined(TARGET_OSX)
+#define KNOT_PROGRAM_BINARY_CACHE 0
+#else
+#define KNOT_PROGRAM_BINARY_CACHE 1
+#endif
+
+namespace {
+
+constexpr char kBinaryMagic[8] = {'K', 'N', 'O', 'T', 'P', 'G', 'M', '1'};
+
+bool readText(const std::filesystem::path& path, std::string& text) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+// FNV-1a over each part and a separator, so ("ab", "c") and ("a", "bc") differ.
+std::uint64_t hashParts(std::initializer_list<std::string> parts) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    const auto mix = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ULL;
+    };
+    for (const auto& part : parts) {
+        for (const char c : part) {
+            mix(static_cast<unsigned char>(c));
+        }
+        mix(0xff);
+    }
+    return hash;
+}
+
+std::string glString(GLenum name) {
+    const auto* value = reinterpret_cast<const char*>(glGetString(name));
+    return value ? value : "";
+}
+
+bool binaryCacheAvailable() {
+#if KNOT_PROGRAM_BINARY_CACHE
+    if (!GLEW_ARB_get_program_binary) {
+        return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+#else
+    return false;
+#endif
+}
+
+GLuint compileStage(GLenum type, const std::string& source, const std::string& label) {
+    const GLuint shader = glCreateShader(type);
+    const GLchar* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::string log(static_cast<std::size_t>(std::max(length, 1)), '\0');
+        glGetShaderInfoLog(shader, std::max(length, 1), nullptr, &log[0]);
+        ofLogWarning("ShaderProgram") << label << " failed to compile: " << log.c_str();
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
+ShaderProgram::~ShaderProgram() {
+    release();
+}
+
+bool ShaderProgram::load(const std::filesystem::path& vertPath, const std::filesystem::path& fragPath,
+                         const std::filesystem::path& cacheDirectory) {
+    release();
+    name_ = vertPath.stem().string();
+    if (cacheDirectory.empty() || !binaryCacheAvailable()) {
+        return shader_.load(vertPath.string(), fragPath.string());
+    }
+
+    std::string vertSource;
+    std::string fragSource;
+    if (!readText(vertPath, vertSource) || !readText(fragPath, fragSource)) {
+        ofLogWarning("ShaderProgram") << "Cannot read " << vertPath << " / " << fragPath;
+        return false;
+    }
+    const std::uint64_t key =
+        hashParts({vertSource, fragSource, glString(GL_VENDOR), glString(GL_RENDERER), glString(GL_VERSION)});
+    char hex[17] = {};
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+    const auto cacheFile = cacheDirectory / (name_ + "-" + hex + ".bin");
+    if (restoreBinary(cacheFile)) {
+        loadedFromCache_ = true;
+        return true;
+    }
+    if (!linkFromSource(vertSource, fragSource)) {
+        return false;
+    }
+    storeBinary(cacheFile);
+    return true;
+}
+
+void ShaderProgram::begin() const {
+    if (program_ != 0) {
+        glUseProgram(program_);
+    } else {
+        shader_.begin();
+    }
+}
+
+void ShaderProgram::end() const {
+    if (program_ != 0) {
+        glUseProgram(0);
+    } else {
+        shader_.end();
+    }
+}
+
+void ShaderProgram::setUniform1f(const std::string& name, float v) const {
+    if (program_ == 0) {
+        shader_.setUniform1f(name, v);
+        return;
+    }
+    const GLint location = uniformLocation(name);
+    if (location >= 0) {
+        glUniform1f(location, v);
+    }
+}
+
+void ShaderProgram::setUniform2f(const std::string& name, float v1, float v2) const {
+    if (program_ == 0) {
+        shader_.setUniform2f(name, v1, v2);
+        return;
+    }
+    const GLint location = uniformLocation(name);
+    if (location >= 0) {
+        glUniform2f(location, v1, v2);
+    }
+}
+
+void ShaderProgram::release() {
+    if (program_ != 0) {
+        glDeleteProgram(program_);
+        program_ = 0;
+    }
+    shader_.unload();
+    loadedFromCache_ = false;
+    uniformLocations_.clear();
+}
+
+bool ShaderProgram::linkFromSource(const std::string& vertSource, const std::string& fragSource) {
+    const GLuint vertex = compileStage(GL_VERTEX_SHADER, vertSource, name_ + ".vert");
+    const GLuint fragment = compileStage(GL_FRAGMENT_SHADER, fragSource, name_ + ".frag");
+    if (vertex == 0 || fragment == 0) {
+        if (vertex != 0) {
+            glDeleteShader(vertex);
+        }
+        if (fragment != 0) {
+            glDeleteShader(fragment);
+        }
+        return false;
+    }
+
+    const GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+#if KNOT_PROGRAM_BINARY_CACHE
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+    glLinkProgram(program);
+    glDetachShader(program, vertex);
+    glDetachShader(program, fragment);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(static_cast<std::size_t>(std::max(length, 1)), '\0');
+        glGetProgramInfoLog(program, std::max(length, 1), nullptr, &log[0]);
+        ofLogWarning("ShaderProgram") << name_ << " failed to link: " << log.c_str();
+        glDeleteProgram(program);
+        return false;
+    }
+    program_ = program;
+    return true;
+}
+
+bool ShaderProgram::restoreBinary(const std::filesystem::path& file) {
+#if KNOT_PROGRAM_BINARY_CACHE
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    char magic[sizeof(kBinaryMagic)] = {};
+    GLenum format = 0;
+    std::uint32_t size = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kBinaryMagic, sizeof(magic)) != 0 ||
+        !in.read(reinterpret_cast<char*>(&format), sizeof(format)) ||
+        !in.read(reinterpret_cast<char*>(&size), sizeof(size)) || size == 0) {
+        return false;
+    }
+    std::vector<char> binary(size);
+    if (!in.read(binary.data(), static_cast<std::streamsize>(size))) {
+        return false;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(size));
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        ofLogNotice("ShaderProgram") << "Cached binary for " << name_ << " rejected by the driver; recompiling.";
+        glDeleteProgram(program);
+        return false;
+    }
+    program_ = program;
+    return true;
+#else
+    (void)file;
+    return false;
+#endif
+}
+
+void ShaderProgram::storeBinary(const std::filesystem::path& file) const {
+#if KNOT_PROGRAM_BINARY_CACHE
+    GLint length = 0;
+    glGetProgramiv(program_, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program_, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+
+    std::error_code ec;
+    const auto directory = file.parent_path();
+    std::filesystem::create_directories(directory, ec);
+    // Binaries for earlier sources or drivers are never read again.
+    const std::string prefix = name_ + "-";
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        const auto& path = it->path();
+        if (path != file && path.extension() == ".bin" && path.filename().string().rfind(prefix, 0) == 0) {
+            std::error_code removeError;
+            std::filesystem::remove(path, removeError);
+        }
+    }
+
+    const auto temporary = std::filesystem::path(file.string() + ".tmp");
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        const std::uint32_t size = static_cast<std::uint32_t>(written);
+        out.write(kBinaryMagic, sizeof(kBinaryMagic));
+        out.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(binary.data(), written);
+        if (!out) {
+            ofLogWarning("ShaderProgram") << "Could not write the shader cache " << temporary;
+            return;
+        }
+    }
+    ec.clear();
+    std::filesystem::rename(temporary, file, ec);
+    if (ec) {
+        ofLogWarning("ShaderProgram") << "Could not store the shader cache " << file << ": " << ec.message();
+    }
+#else
+    (void)file;
+#endif
+}
+
+GLint ShaderProgram::uniformLocation(const std::string& name) const {
+    if (program_ == 0) {
+        return -1;
+    }
+    const auto found = uniformLocations_.find(name);
+    if (found != uniformLocations_.end()) {
+        return found->second;
+    }
+    const GLint location = glGetUniformLocation(program_, name.c_str());
+    uniformLocations_.emplace(name, location);
+    return location;
+}
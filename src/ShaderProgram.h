@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+/// GLSL program for the scene layers, restored from a driver program binary cached on disk when
+/// one matches (GL_ARB_get_program_binary), so later launches skip compile and link. The cache
+/// key covers both sources and the GL vendor/renderer/version strings: an edited shader or a
+/// driver update misses and recompiles, and a binary the driver rejects is rebuilt from source.
+/// The cache does not apply on macOS: the legacy 2.1 context the GLSL 1.20 shaders need has no
+/// program binaries, and neither do the GLES targets. There, and wherever the driver lacks the
+/// extension or no cache directory is given, the program is a plain ofShader. A cached program
+/// is bound with glUseProgram, which is all ofGLRenderer does for these shaders. GL thread only.
+class ShaderProgram {
+public:
+    ShaderProgram() = default;
+    ~ShaderProgram();
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    /// Absolute source paths. An empty cacheDirectory disables the binary cache.
+    bool load(const std::filesystem::path& vertPath, const std::filesystem::path& fragPath,
+              const std::filesystem::path& cacheDirectory);
+    bool isLoaded() const { return program_ != 0 || shader_.isLoaded(); }
+    /// The last load() came from the binary cache.
+    bool loadedFromCache() const { return loadedFromCache_; }
+
+    void begin() const;
+    void end() const;
+    void setUniform1f(const std::string& name, float v) const;
+    void setUniform2f(const std::string& name, float v1, float v2) const;
+
+private:
+    void release();
+    bool linkFromSource(const std::string& vertSource, const std::string& fragSource);
+    bool restoreBinary(const std::filesystem::path& file);
+    void storeBinary(const std::filesystem::path& file) const;
+    GLint uniformLocation(const std::string& name) const;
+
+    // Set when the binary cache is in use; otherwise shader_ holds the program.
+    GLuint program_ = 0;
+    ofShader shader_;
+    bool loadedFromCache_ = false;
+    std::string name_;
+    mutable std::unordered_map<std::string, GLint> uniformLocations_;
+};
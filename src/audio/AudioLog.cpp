@@ -0,0 +1,30 @@
+#include "AudioLog.h"
+
+#if defined(KNOT_AUDIO_HEADLESS)
+#include <iostream>
+#else
+#include "ofLog.h"
+#endif
+
+namespace knot::audio {
+
+LogLine::~LogLine() {
+#if defined(KNOT_AUDIO_HEADLESS)
+    static constexpr const char* kLevelNames[] = {"notice", "warning", "error"};
+    std::clog << "[" << kLevelNames[static_cast<int>(level_)] << "] " << module_ << ": " << stream_.str() << '\n';
+#else
+    switch (level_) {
+        case Level::Notice:
+            ofLogNotice(module_) << stream_.str();
+            break;
+        case Level::Warning:
+            ofLogWarning(module_) << stream_.str();
+            break;
+        case Level::Error:
+            ofLogError(module_) << stream_.str();
+            break;
+    }
+#endif
+}
+
+} // namespace knot::audio
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+namespace knot::audio {
+
+/// One log line from the audio library, written when it goes out of scope. In the app it goes to
+/// ofLog; headless builds (KNOT_AUDIO_HEADLESS, no openFrameworks) write it to std::clog. Not for
+/// the audio thread: it allocates.
+class LogLine {
+public:
+    enum class Level {
+        Notice,
+        Warning,
+        Error
+    };
+
+    LogLine(Level level, const char* module) : level_(level), module_(module) {}
+    ~LogLine();
+
+    template <typename T>
+    LogLine& operator<<(const T& value) {
+        stream_ << value;
+        return *this;
+    }
+
+private:
+    Level level_;
+    const char* module_;
+    std::ostringstream stream_;
+};
+
+inline LogLine logNotice(const char* module) {
+    return {LogLine::Level::Notice, module};
+}
+
+inline LogLine logWarning(const char* module) {
+    return {LogLine::Level::Warning, module};
+}
+
+inline LogLine logError(const char* module) {
+    return {LogLine::Level::Error, module};
+}
+
+} // namespace knot::audio
@@ -1,17 +1,30 @@
 #include "AudioPipeline.h"
 
+#include "RealtimeSafety.h"
 #include "Utility.h"
 
+#if !defined(KNOT_AUDIO_HEADLESS)
 #include "ofMain.h"
+#endif
 
 #include <algorithm>
 #include <array>
+#include <random>
 
 namespace knot::audio {
 
 namespace {
 constexpr float kSelfGainDb = -15.0f;
 constexpr float kNoiseGainDb = -24.0f;
+constexpr double kStreamRestartFadeSec = 0.05;
+constexpr double kFallbackStartThreshold = 1.5;
+constexpr double kFallbackStopThreshold = 0.6;
+// Trigger delay assumed behind a heart sound's onset when no latency test has measured it.
+constexpr double kDefaultDetectionLeadSec = 0.015;
+// A predicted pulse that should already have started is still played this late, not later.
+constexpr double kMaxLatePulseSec = 0.05;
+// A verification burst further than this from the stored gains means the calibration is stale.
+constexpr float kCalibrationCheckToleranceDb = 1.0f;
 } // namespace
 
 void AudioPipeline::setup(double sampleRate, std::size_t bufferSize) {
@@ -19,32 +32,71 @@ void AudioPipeline::setup(double sampleRate, std::size_t bufferSize) {
     bufferSize_ = bufferSize;
     calibrationValues_[0] = {"CH1", 1.0f, 0.0f, 0};
     calibrationValues_[1] = {"CH2", 1.0f, 0.0f, 0};
+    appliedCalibration_ = calibrationValues_;
+    calibrationOverriddenRun_ = 0;
+    calibrationReader_ = calibrationResults_.subscribe();
+    calibrationCheckReader_ = calibrationChecks_.subscribe();
+    latencyReader_ = latencyReports_.subscribe();
+    envelopeCalibrationReader_ = envelopeCalibrations_.subscribe();
     calibrationSession_.setup(sampleRate_, bufferSize_, 4);
+    // Same tone swap interval as the full run, so both see the same device latency bias.
+    calibrationCheck_.setup(sampleRate_, bufferSize_, 0, CalibrationSession::kCheckToneSec,
+                            CalibrationSession::kCheckSettleSec);
     beatTimelines_[0].setup(sampleRate_, ParticipantId::Participant1);
     beatTimelines_[1].setup(sampleRate_, ParticipantId::Participant2);
+    for (std::size_t channel = 0; channel < envelopeScopes_.size(); ++channel) {
+        envelopeScopes_[channel].setup(sampleRate_, 1.0);
+        beatTimelines_[channel].setScopeTap(&envelopeScopes_[channel]);
+        beatTimelines_[channel].setEventBus(&beatEvents_);
+    }
     limiter_.setup(sampleRate_, -3.0f, 80.0f);
-    rng_.seed(std::random_device{}());
+    noise_.setup(sampleRate_);
+    noise_.seed(std::random_device{}());
+    // Scratch is sized once here; callbacks larger than this are processed in slices rather
+    // than growing the buffers on the audio thread. The monitor buffers keep every slice of the
+    // block so processOutput() plays each input frame at its own index.
+    maxBlockFrames_ = std::max(bufferSize_, kMaxBlockFrames);
     for (auto& channelBuffer : channelBuffers_) {
-        channelBuffer.assign(bufferSize_, 0.0f);
+        channelBuffer.assign(maxBlockFrames_ * kMonitorSlices, 0.0f);
+    }
+    for (auto& overflowBuffer : overflowBuffers_) {
+        overflowBuffer.assign(maxBlockFrames_, 0.0f);
+    }
+    monitorFrames_ = 0;
+    for (auto& detectionBuffer : detectionBuffers_) {
+        detectionBuffer.assign(maxBlockFrames_, 0.0f);
+    }
+    crosstalkCanceller_.setup(sampleRate_, maxBlockFrames_);
+    // Sizes the probe's own canceller, so starting a latency test on the audio thread reuses it.
+    latencyProbe_.setup(sampleRate_, 1, 1.0f, true);
+    for (auto& agc : inputAgc_) {
+        agc.setup(sampleRate_, inputGainDb_);
+    }
+    calibrationScratch_.assign(maxBlockFrames_ * 2, 0.0f);
+    noiseBuffer_.assign(maxBlockFrames_, 0.0f);
+    heartbeatSynth_.setup(sampleRate_);
+    for (auto& synthBuffer : synthBuffers_) {
+        synthBuffer.assign(maxBlockFrames_, 0.0f);
     }
-    noiseBuffer_.assign(bufferSize_, 0.0f);
-    outputScratch_.assign(bufferSize_ * 2, 0.0f);
+    fadeReader_.skipToLatest();
+    for (auto& pending : pendingFades_) {
+        pending.valid = false;
+    }
+    fadeRamping_ = false;
+    outputFadeGain_.store(outputFade_, std::memory_order_relaxed);
+    outputClockAnchored_ = false;
     totalSamplesProcessed_ = 0.0;
     limiterReductionDb_ = 0.0f;
     lastEnvelopeCalibration_ = {};
     envelopeCalibrationActive_ = false;
     newEnvelopeCalibrationAvailable_ = false;
+    envelopeCalibrationRun_.abandon();
     envelopeShortAvg_ = 0.0f;
     envelopeMidAvg_ = 0.0f;
     envelopeLongAvg_ = 0.0f;
     bpmAvg_ = 0.0f;
-    lastRealBeatSample_ = 0.0;
     lastHealthUpdateSec_ = 0.0;
-    fallbackActive_ = false;
-    fallbackBlend_ = 0.0f;
-    fallbackEnvelope_ = 0.0f;
-    fallbackBpm_ = 60.0f;
-    lastFallbackEmitSec_ = 0.0;
+    resetBeatTracking();
     signalHealth_ = {};
     metrics_ = {};
     for (auto& metrics : channelMetrics_) {
@@ -52,122 +104,210 @@ void AudioPipeline::setup(double sampleRate, std::size_t bufferSize) {
     }
     channelMetrics_[0].participantId = ParticipantId::Participant1;
     channelMetrics_[1].participantId = ParticipantId::Participant2;
-    for (auto& pending : pendingEventsByChannel_) {
-        pending.clear();
-    }
     legacySequenceCounter_ = 0;
 }
 
 void AudioPipeline::setNoiseSeed(std::uint32_t seed) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    rng_.seed(seed);
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::NoiseSeed;
+    command.count = seed;
+    post(command);
+}
+
+void AudioPipeline::setNoiseColor(NoiseColor color) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::NoiseColor;
+    command.count = static_cast<std::uint32_t>(color);
+    post(command);
 }
 
 void AudioPipeline::setInputGainDb(float gainDb) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    inputGainLinear_ = dbToLinear(gainDb);
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::InputGain;
+    command.value = gainDb;
+    post(command);
 }
 
-void AudioPipeline::ensureBufferSizes(std::size_t numFrames) {
-    for (auto& channelBuffer : channelBuffers_) {
-        if (channelBuffer.size() < numFrames) {
-            channelBuffer.assign(numFrames, 0.0f);
-        }
+void AudioPipeline::setInputAgc(bool enabled) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::InputAgc;
+    command.enabled = enabled;
+    post(command);
+}
+
+void AudioPipeline::setCrosstalkCancellation(bool enabled) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::CrosstalkCancellation;
+    command.enabled = enabled;
+    post(command);
+}
+
+void AudioPipeline::setPredictiveHaptics(bool enabled, double leadSec) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::PredictiveHaptics;
+    command.enabled = enabled;
+    // Unmeasured: one input and one output buffer plus the detector's delay behind the onset.
+    const double lead =
+        leadSec > 0.0 ? leadSec : 2.0 * static_cast<double>(bufferSize_) / sampleRate_ + kDefaultDetectionLeadSec;
+    command.value = lead * sampleRate_;
+    post(command);
+}
+
+void AudioPipeline::setResynthesisMix(float mix) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::ResynthesisMix;
+    command.value = std::clamp(mix, 0.0f, 1.0f);
+    post(command);
+}
+
+void AudioPipeline::startCalibration() {
+    // The calibration takes over the output; a check or latency test in progress is dropped.
+    calibrationReady_.store(false, std::memory_order_release);
+    calibrationCheckRun_.abandon();
+    latencyRun_.abandon();
+    envelopeCalibrationRun_.abandon();
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::StartCalibration;
+    command.runId = calibrationRun_.request();
+    post(command);
+}
+
+void AudioPipeline::setCalibration(const std::array<ChannelCalibrationValue, 2>& values) {
+    collectCalibrationResults();
+    calibrationOverriddenRun_ = calibrationRun_.requested.load(std::memory_order_acquire);
+    calibrationValues_ = values;
+    calibrationReady_.store(true, std::memory_order_release);
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::SetCalibration;
+    for (std::size_t channel = 0; channel < values.size(); ++channel) {
+        command.calibration.gain[channel] = values[channel].gain;
+        command.calibration.phaseDeg[channel] = values[channel].phaseDeg;
+        command.calibration.delaySamples[channel] = values[channel].delaySamples;
     }
-    if (noiseBuffer_.size() < numFrames) {
-        noiseBuffer_.assign(numFrames, 0.0f);
+    post(command);
+}
+
+const std::array<ChannelCalibrationValue, 2>& AudioPipeline::calibrationResult() {
+    collectCalibrationResults();
+    return calibrationValues_;
+}
+
+void AudioPipeline::collectCalibrationResults() {
+    CalibrationTrim trim;
+    while (calibrationReader_.tryConsume(trim)) {
+        if (trim.runId <= calibrationOverriddenRun_) {
+            continue;
+        }
+        for (std::size_t channel = 0; channel < calibrationValues_.size(); ++channel) {
+            calibrationValues_[channel].gain = trim.gain[channel];
+            calibrationValues_[channel].phaseDeg = trim.phaseDeg[channel];
+            calibrationValues_[channel].delaySamples = trim.delaySamples[channel];
+        }
     }
-    if (outputScratch_.size() < numFrames * 4) {
-        outputScratch_.assign(numFrames * 4, 0.0f);
+}
+
+bool AudioPipeline::startCalibrationCheck() {
+    if (calibrationRun_.active() || latencyRun_.active()) {
+        return false;
     }
+    calibrationCheckReader_.skipToLatest();
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::StartCalibrationCheck;
+    command.runId = calibrationCheckRun_.request();
+    post(command);
+    return true;
 }
 
-void AudioPipeline::loadCalibrationFile(const std::filesystem::path& path) {
-    auto loaded = CalibrationFileIO::load(path);
-    if (loaded) {
-        calibrationValues_ = *loaded;
-        calibrationCompleted_ = true;
+bool AudioPipeline::isCalibrationCheckActive() const {
+    return calibrationCheckRun_.active();
+}
+
+bool AudioPipeline::pollCalibrationCheck(CalibrationCheck& check) {
+    bool available = false;
+    CalibrationCheck latest;
+    while (calibrationCheckReader_.tryConsume(latest)) {
+        check = latest;
+        available = true;
     }
+    return available;
 }
 
-bool AudioPipeline::saveCalibrationFile(const std::filesystem::path& path) const {
-    if (!calibrationCompleted_) {
+bool AudioPipeline::startLatencyTest(std::size_t pulses) {
+    if (calibrationRun_.active() || calibrationCheckRun_.active()) {
         return false;
     }
-    return CalibrationFileIO::save(path, calibrationValues_);
+    latencyReader_.skipToLatest();
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::StartLatencyTest;
+    command.count = static_cast<std::uint32_t>(pulses);
+    command.runId = latencyRun_.request();
+    post(command);
+    return true;
 }
 
-void AudioPipeline::startCalibration() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    calibrationSession_.start();
-    calibrationArmed_ = true;
-    calibrationCompleted_ = false;
-    limiter_.reset();
-    beatTimelines_[0].setup(sampleRate_, ParticipantId::Participant1);
-    beatTimelines_[1].setup(sampleRate_, ParticipantId::Participant2);
-    metrics_ = {};
-    for (auto& channelMetric : channelMetrics_) {
-        channelMetric = {};
-    }
-    channelMetrics_[0].participantId = ParticipantId::Participant1;
-    channelMetrics_[1].participantId = ParticipantId::Participant2;
-    for (auto& pending : pendingEventsByChannel_) {
-        pending.clear();
+void AudioPipeline::cancelLatencyTest() {
+    // Inactive straight away, even when no callback runs to apply the command.
+    latencyRun_.abandon();
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::CancelLatencyTest;
+    post(command);
+}
+
+bool AudioPipeline::isLatencyTestActive() const {
+    return latencyRun_.active();
+}
+
+bool AudioPipeline::pollLatencyReport(LatencyReport& report) {
+    bool available = false;
+    LatencyReport latest;
+    while (latencyReader_.tryConsume(latest)) {
+        report = latest;
+        available = true;
     }
-    totalSamplesProcessed_ = 0.0;
-    envelopeCalibrationActive_ = false;
-    newEnvelopeCalibrationAvailable_ = false;
-    envelopeShortAvg_ = 0.0f;
-    envelopeMidAvg_ = 0.0f;
-    envelopeLongAvg_ = 0.0f;
-    bpmAvg_ = 0.0f;
-    fallbackActive_ = false;
-    fallbackBlend_ = 0.0f;
-    fallbackEnvelope_ = 0.0f;
-    lastFallbackEmitSec_ = 0.0;
-    signalHealth_ = {};
-    lastRealBeatSample_ = totalSamplesProcessed_;
-    lastHealthUpdateSec_ = totalSamplesProcessed_ / sampleRate_;
-    legacySequenceCounter_ = 0;
+    return available;
 }
 
 bool AudioPipeline::isCalibrationActive() const {
-    return calibrationArmed_;
+    return calibrationRun_.active();
 }
 
 bool AudioPipeline::calibrationReady() const {
-    return calibrationCompleted_;
+    return calibrationReady_.load(std::memory_order_acquire);
 }
 
 void AudioPipeline::applyCalibration(float& ch1, float& ch2) const {
-    ch1 *= calibrationValues_[0].gain;
-    ch2 *= calibrationValues_[1].gain;
+    ch1 *= appliedCalibration_[0].gain;
+    ch2 *= appliedCalibration_[1].gain;
 }
 
 void AudioPipeline::startEnvelopeCalibration(double durationSec) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    beatTimelines_[0].beginEnvelopeCalibration(durationSec);
-    envelopeCalibrationActive_ = beatTimelines_[0].isEnvelopeCalibrating();
+    envelopeCalibrationReader_.skipToLatest();
     newEnvelopeCalibrationAvailable_ = false;
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::StartEnvelopeCalibration;
+    command.value = durationSec;
+    command.runId = envelopeCalibrationRun_.request();
+    post(command);
 }
 
-bool AudioPipeline::isEnvelopeCalibrationActive() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return envelopeCalibrationActive_;
+void AudioPipeline::setBaselineTracking(bool enabled) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::BaselineTracking;
+    command.enabled = enabled;
+    post(command);
 }
 
-float AudioPipeline::envelopeCalibrationProgress() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return beatTimelines_[0].calibrationProgress();
+bool AudioPipeline::isEnvelopeCalibrationActive() const {
+    return envelopeCalibrationRun_.active();
 }
 
-EnvelopeCalibrationStats AudioPipeline::lastEnvelopeCalibration() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+std::array<EnvelopeCalibrationStats, 2> AudioPipeline::lastEnvelopeCalibration() {
+    collectEnvelopeCalibration();
     return lastEnvelopeCalibration_;
 }
 
-bool AudioPipeline::pollEnvelopeCalibrationStats(EnvelopeCalibrationStats& stats) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool AudioPipeline::pollEnvelopeCalibrationStats(std::array<EnvelopeCalibrationStats, 2>& stats) {
+    collectEnvelopeCalibration();
     if (!newEnvelopeCalibrationAvailable_) {
         return false;
     }
@@ -176,60 +316,216 @@ bool AudioPipeline::pollEnvelopeCalibrationStats(EnvelopeCalibrationStats& stats
     return true;
 }
 
-void AudioPipeline::audioIn(const ofSoundBuffer& buffer) {
-    const auto numFrames = static_cast<std::size_t>(buffer.getNumFrames());
-    if (buffer.getNumChannels() < 2 || numFrames == 0) {
+void AudioPipeline::collectEnvelopeCalibration() {
+    std::array<EnvelopeCalibrationStats, 2> stats{};
+    while (envelopeCalibrationReader_.tryConsume(stats)) {
+        lastEnvelopeCalibration_ = stats;
+        newEnvelopeCalibrationAvailable_ = true;
+    }
+}
+
+void AudioPipeline::applyCommands() {
+    commandReader_.poll([this](const PipelineCommand& command) { applyCommand(command); });
+}
+
+void AudioPipeline::applyCommand(const PipelineCommand& command) {
+    switch (command.type) {
+        case PipelineCommand::Type::NoiseSeed:
+            noise_.seed(command.count);
+            break;
+        case PipelineCommand::Type::NoiseColor:
+            noise_.setColor(static_cast<NoiseColor>(command.count));
+            break;
+        case PipelineCommand::Type::InputGain:
+            inputGainDb_ = static_cast<float>(command.value);
+            inputGainLinear_ = dbToLinear(inputGainDb_);
+            for (auto& agc : inputAgc_) {
+                agc.reset(inputGainDb_);
+            }
+            break;
+        case PipelineCommand::Type::InputAgc:
+            if (command.enabled && !inputAgcEnabled_) {
+                for (auto& agc : inputAgc_) {
+                    agc.reset(inputGainDb_);
+                }
+            }
+            inputAgcEnabled_ = command.enabled;
+            break;
+        case PipelineCommand::Type::CrosstalkCancellation:
+            if (command.enabled && !crosstalkCancellationEnabled_) {
+                crosstalkCanceller_.reset();
+            }
+            crosstalkCancellationEnabled_ = command.enabled;
+            break;
+        case PipelineCommand::Type::PredictiveHaptics:
+            predictiveHaptics_ = command.enabled;
+            hapticLeadSamples_ = command.value;
+            break;
+        case PipelineCommand::Type::ResynthesisMix:
+            resynthesisMix_ = static_cast<float>(command.value);
+            break;
+        case PipelineCommand::Type::BaselineTracking:
+            for (auto& timeline : beatTimelines_) {
+                timeline.setBaselineTracking(command.enabled);
+            }
+            break;
+        case PipelineCommand::Type::StartCalibration:
+            if (calibrationCheckArmed_) {
+                calibrationCheckArmed_ = false;
+                calibrationCheckRun_.finished.store(calibrationCheckRunId_, std::memory_order_release);
+            }
+            if (latencyArmed_) {
+                latencyArmed_ = false;
+                latencyRun_.finished.store(latencyRunId_, std::memory_order_release);
+            }
+            calibrationRunId_ = command.runId;
+            beginCalibration();
+            break;
+        case PipelineCommand::Type::SetCalibration:
+            for (std::size_t channel = 0; channel < appliedCalibration_.size(); ++channel) {
+                appliedCalibration_[channel].gain = command.calibration.gain[channel];
+                appliedCalibration_[channel].phaseDeg = command.calibration.phaseDeg[channel];
+                appliedCalibration_[channel].delaySamples = command.calibration.delaySamples[channel];
+            }
+            break;
+        case PipelineCommand::Type::StartCalibrationCheck:
+            calibrationCheckRunId_ = command.runId;
+            if (calibrationArmed_ || latencyArmed_) {
+                calibrationCheckRun_.finished.store(command.runId, std::memory_order_release);
+                break;
+            }
+            calibrationCheck_.start();
+            calibrationCheckArmed_ = true;
+            break;
+        case PipelineCommand::Type::StartLatencyTest: {
+            latencyRunId_ = command.runId;
+            if (calibrationArmed_ || calibrationCheckArmed_) {
+                latencyRun_.finished.store(command.runId, std::memory_order_release);
+                break;
+            }
+            const float probeGain = inputAgcEnabled_ ? dbToLinear(inputAgc_[0].gainDb()) : inputGainLinear_;
+            latencyProbe_.setup(sampleRate_, command.count, probeGain, crosstalkCancellationEnabled_);
+            latencyProbe_.start();
+            latencyArmed_ = true;
+            break;
+        }
+        case PipelineCommand::Type::CancelLatencyTest:
+            if (latencyArmed_) {
+                latencyArmed_ = false;
+                latencyRun_.finished.store(latencyRunId_, std::memory_order_release);
+            }
+            break;
+        case PipelineCommand::Type::StartEnvelopeCalibration:
+            envelopeCalibrationRunId_ = command.runId;
+            envelopeCalibrationActive_ = false;
+            for (auto& timeline : beatTimelines_) {
+                timeline.beginEnvelopeCalibration(command.value);
+                envelopeCalibrationActive_ = envelopeCalibrationActive_ || timeline.isEnvelopeCalibrating();
+            }
+            if (!envelopeCalibrationActive_) {
+                envelopeCalibrationRun_.finished.store(command.runId, std::memory_order_release);
+            }
+            break;
+        case PipelineCommand::Type::StreamRestart: {
+            outputClockAnchored_ = false;
+            monitorFrames_ = 0;
+            limiter_.reset();
+            // Ramp from silence to wherever the master gain was heading; a scene fade due in the
+            // first block simply takes over from the current value.
+            const float target = fadeRamping_ ? fadeTo_ : outputFade_;
+            outputFade_ = 0.0f;
+            fadeTo_ = target;
+            fadeDelay_ = 0;
+            fadePosition_ = 0;
+            fadeLength_ = std::max<std::size_t>(1, static_cast<std::size_t>(kStreamRestartFadeSec * sampleRate_));
+            fadeRamping_ = true;
+            break;
+        }
+        case PipelineCommand::Type::OutputRouter:
+            router_ = command.router;
+            break;
+        case PipelineCommand::Type::InputRecorder:
+            inputRecorder_ = command.recorder;
+            break;
+    }
+}
+
+void AudioPipeline::beginCalibration() {
+    calibrationSession_.start();
+    calibrationArmed_ = true;
+    limiter_.reset();
+    beatTimelines_[0].setup(sampleRate_, ParticipantId::Participant1);
+    beatTimelines_[1].setup(sampleRate_, ParticipantId::Participant2);
+    // Channel gains change with calibration, so leakage weights learnt before it no longer fit.
+    crosstalkCanceller_.reset();
+    metrics_ = {};
+    for (auto& channelMetric : channelMetrics_) {
+        channelMetric = {};
+    }
+    channelMetrics_[0].participantId = ParticipantId::Participant1;
+    channelMetrics_[1].participantId = ParticipantId::Participant2;
+    totalSamplesProcessed_ = 0.0;
+    if (envelopeCalibrationActive_) {
+        envelopeCalibrationActive_ = false;
+        envelopeCalibrationRun_.finished.store(envelopeCalibrationRunId_, std::memory_order_release);
+    }
+    envelopeShortAvg_ = 0.0f;
+    envelopeMidAvg_ = 0.0f;
+    envelopeLongAvg_ = 0.0f;
+    bpmAvg_ = 0.0f;
+    resetBeatTracking();
+    signalHealth_ = {};
+    lastHealthUpdateSec_ = totalSamplesProcessed_ / sampleRate_;
+    legacySequenceCounter_ = 0;
+}
+
+void AudioPipeline::processInput(const float* input, std::size_t numFrames) {
+    if (numFrames == 0) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    ensureBufferSizes(numFrames);
-    const float* input = buffer.getBuffer().data();
+    if (maxBlockFrames_ == 0) {
+        return;
+    }
+    applyCommands();
+    if (inputRecorder_) {
+        inputRecorder_->capture(input, numFrames);
+    }
 
     if (calibrationArmed_) {
         calibrationSession_.capture(input, numFrames);
         totalSamplesProcessed_ += static_cast<double>(numFrames);
         signalHealth_ = {};
+    } else if (latencyArmed_ || calibrationCheckArmed_) {
+        if (latencyArmed_) {
+            latencyProbe_.capture(input, numFrames);
+        } else {
+            calibrationCheck_.capture(input, numFrames);
+        }
+        // Live detection is paused, not reset: keep the beat clock running and do not count the
+        // test as a dropout, so the fallback does not kick in afterwards.
+        totalSamplesProcessed_ += static_cast<double>(numFrames);
+        for (auto& fallback : fallback_) {
+            fallback.lastRealBeatSample += static_cast<double>(numFrames);
+        }
+        monitorFrames_ = 0;
     } else {
-        const bool wasEnvelopeCalibrating = beatTimelines_[0].isEnvelopeCalibrating();
-        for (std::size_t frame = 0; frame < numFrames; ++frame) {
-            float ch1 = input[frame * 2];
-            float ch2 = input[frame * 2 + 1];
-            if (inputGainLinear_ != 1.0f) {
-                ch1 = std::clamp(ch1 * inputGainLinear_, -1.0f, 1.0f);
-                ch2 = std::clamp(ch2 * inputGainLinear_, -1.0f, 1.0f);
+        inputBlockStartSample_ = totalSamplesProcessed_;
+        monitorFrames_ = 0;
+        std::array<bool, 2> triggered{};
+        for (std::size_t offset = 0; offset < numFrames; offset += maxBlockFrames_) {
+            const std::size_t sliceFrames = std::min(maxBlockFrames_, numFrames - offset);
+            processInputSlice(input + offset * 2, offset, sliceFrames);
+            for (std::size_t channel = 0; channel < triggered.size(); ++channel) {
+                triggered[channel] = triggered[channel] || channelMetrics_[channel].triggered;
             }
-            applyCalibration(ch1, ch2);
-            channelBuffers_[0][frame] = ch1;
-            channelBuffers_[1][frame] = ch2;
-        }
-        const double startSample = totalSamplesProcessed_;
-        constexpr std::array<ParticipantId, 2> participants = {
-            ParticipantId::Participant1,
-            ParticipantId::Participant2};
-        for (std::size_t channel = 0; channel < beatTimelines_.size(); ++channel) {
-            beatTimelines_[channel].processBuffer(channelBuffers_[channel].data(), numFrames,
-                                                  startSample);
-            auto& channelMetric = channelMetrics_[channel];
-            const auto participantId = participants[channel];
-            channelMetric.bpm = beatTimelines_[channel].currentBpm();
-            channelMetric.envelope = beatTimelines_[channel].currentEnvelope();
-            channelMetric.timestampSec =
-                (totalSamplesProcessed_ + static_cast<double>(numFrames)) / sampleRate_;
-            channelMetric.triggered = beatTimelines_[channel].lastFrameTriggered();
-            channelMetric.participantId = participantId;
-
-            if (channelMetric.triggered) {
-                const auto& events = beatTimelines_[channel].events();
-                if (!events.empty()) {
-                    pendingEventsByChannel_[channel].push_back(events.back());
-                    if (pendingEventsByChannel_[channel].size() > 128) {
-                        pendingEventsByChannel_[channel].pop_front();
-                    }
-                }
+        }
+        for (std::size_t channel = 0; channel < triggered.size(); ++channel) {
+            channelMetrics_[channel].triggered = triggered[channel];
+            if (triggered[channel]) {
+                fallback_[channel].lastRealBeatSample = totalSamplesProcessed_;
             }
         }
-        totalSamplesProcessed_ += static_cast<double>(numFrames);
 
         metrics_.bpm = channelMetrics_[0].bpm;
         metrics_.envelope = channelMetrics_[0].envelope;
@@ -239,16 +535,19 @@ void AudioPipeline::audioIn(const ofSoundBuffer& buffer) {
             if (metrics_.bpm > 1.0f) {
                 bpmAvg_ = bpmAvg_ + 0.25f * (metrics_.bpm - bpmAvg_);
             }
-            lastRealBeatSample_ = totalSamplesProcessed_;
         }
-        const bool isEnvelopeCalibrating = beatTimelines_[0].isEnvelopeCalibrating();
-        if (wasEnvelopeCalibrating && !isEnvelopeCalibrating) {
-            lastEnvelopeCalibration_ = beatTimelines_[0].calibrationStats();
-            envelopeCalibrationActive_ = false;
-            newEnvelopeCalibrationAvailable_ = true;
-        } else {
-            envelopeCalibrationActive_ = isEnvelopeCalibrating;
+        // Both channels start together; the result is published once the last one finishes.
+        const bool isEnvelopeCalibrating =
+            beatTimelines_[0].isEnvelopeCalibrating() || beatTimelines_[1].isEnvelopeCalibrating();
+        if (envelopeCalibrationActive_ && !isEnvelopeCalibrating) {
+            std::array<EnvelopeCalibrationStats, 2> stats{};
+            for (std::size_t channel = 0; channel < beatTimelines_.size(); ++channel) {
+                stats[channel] = beatTimelines_[channel].calibrationStats();
+            }
+            envelopeCalibrations_.publish(stats);
+            envelopeCalibrationRun_.finished.store(envelopeCalibrationRunId_, std::memory_order_release);
         }
+        envelopeCalibrationActive_ = isEnvelopeCalibrating;
 
         const float env = metrics_.envelope;
         envelopeShortAvg_ = envelopeShortAvg_ + 0.35f * (env - envelopeShortAvg_);
@@ -256,172 +555,604 @@ void AudioPipeline::audioIn(const ofSoundBuffer& buffer) {
         envelopeLongAvg_ = envelopeLongAvg_ + 0.03f * (env - envelopeLongAvg_);
 
         const double nowSec = totalSamplesProcessed_ / sampleRate_;
-        const double dropoutSec = (totalSamplesProcessed_ - lastRealBeatSample_) / sampleRate_;
         const double deltaSec = std::max(0.0, nowSec - lastHealthUpdateSec_);
         lastHealthUpdateSec_ = nowSec;
-
-        constexpr double kFallbackStartThreshold = 1.5;
-        constexpr double kFallbackStopThreshold = 0.6;
-
-        if (!fallbackActive_) {
-            if (dropoutSec > kFallbackStartThreshold) {
-                fallbackActive_ = true;
-                fallbackBlend_ = 0.0f;
-                fallbackBpm_ = std::clamp(bpmAvg_ > 1.0f ? bpmAvg_ : 60.0f, 20.0f, 140.0f);
-                fallbackEnvelope_ = std::clamp(envelopeLongAvg_, 0.18f, 0.6f);
-                const double interval = 60.0 / fallbackBpm_;
-                lastFallbackEmitSec_ = std::max(nowSec - interval, 0.0);
-            }
-        } else {
-            if (dropoutSec < kFallbackStopThreshold) {
-                fallbackBlend_ = std::max(0.0f, fallbackBlend_ - static_cast<float>(deltaSec / 0.8));
-                if (fallbackBlend_ <= 0.02f) {
-                    fallbackActive_ = false;
-                    fallbackBlend_ = 0.0f;
-                }
-            } else {
-                fallbackBlend_ = std::min(1.0f, fallbackBlend_ + static_cast<float>(deltaSec / 1.0));
-                const float targetEnv = std::clamp(envelopeLongAvg_, 0.18f, 0.6f);
-                fallbackEnvelope_ = fallbackEnvelope_ + 0.1f * (targetEnv - fallbackEnvelope_);
-                const double interval = 60.0 / fallbackBpm_;
-                while (nowSec - lastFallbackEmitSec_ >= interval) {
-                    lastFallbackEmitSec_ += interval;
-                    BeatEvent evt;
-                    evt.timestampSec = lastFallbackEmitSec_;
-                    evt.bpm = fallbackBpm_;
-                    evt.envelope = fallbackEnvelope_;
-                    evt.participantId = ParticipantId::Participant1;
-                    evt.sequenceId = legacySequenceCounter_++;
-                    pendingEventsByChannel_[0].push_back(evt);
-                    if (pendingEventsByChannel_[0].size() > 128) {
-                        pendingEventsByChannel_[0].pop_front();
-                    }
-                }
-            }
+        for (std::size_t channel = 0; channel < beatPredictors_.size(); ++channel) {
+            beatPredictors_[channel].advance(nowSec);
+            updateFallback(channel, nowSec, deltaSec);
+            const auto& prediction = beatPredictors_[channel].prediction();
+            signalHealth_.beatTrackerLocked[channel] = prediction.valid;
+            signalHealth_.trackedBpm[channel] =
+                prediction.valid ? static_cast<float>(60.0 / prediction.periodSec) : 0.0f;
+            signalHealth_.beatFallbackActive[channel] = fallback_[channel].active;
+            const auto& timeline = beatTimelines_[channel];
+            const bool tracking = timeline.isBaselineTracking();
+            signalHealth_.baselineMedian[channel] = tracking ? timeline.baselineMedian() : 0.0f;
+            signalHealth_.baselineMad[channel] = tracking ? timeline.baselineMad() : 0.0f;
+            signalHealth_.baselineFloor[channel] = timeline.baselineFloor();
         }
+        const auto& fallback = fallback_[0];
+        const double dropoutSec = (totalSamplesProcessed_ - fallback.lastRealBeatSample) / sampleRate_;
 
         signalHealth_.envelopeShort = envelopeShortAvg_;
         signalHealth_.envelopeMid = envelopeMidAvg_;
         signalHealth_.envelopeLong = envelopeLongAvg_;
         signalHealth_.bpmAverage = bpmAvg_;
         signalHealth_.dropoutSeconds = static_cast<float>(dropoutSec);
-        signalHealth_.fallbackActive = fallbackActive_;
-        signalHealth_.fallbackBlend = fallbackBlend_;
-        signalHealth_.fallbackEnvelope = fallbackActive_ ? fallbackEnvelope_ : envelopeLongAvg_;
+        signalHealth_.fallbackActive = fallback.active;
+        signalHealth_.fallbackBlend = fallback.blend;
+        signalHealth_.fallbackEnvelope = fallback.active ? fallback.envelope : envelopeLongAvg_;
+        if (crosstalkCancellationEnabled_) {
+            const auto& crosstalk = crosstalkCanceller_.stats();
+            signalHealth_.crosstalkLeakageDb = crosstalk.leakageDb;
+            signalHealth_.crosstalkResidualDb = crosstalk.residualDb;
+            signalHealth_.crosstalkConverged = crosstalk.converged;
+        } else {
+            signalHealth_.crosstalkLeakageDb = SignalHealth{}.crosstalkLeakageDb;
+            signalHealth_.crosstalkResidualDb = SignalHealth{}.crosstalkResidualDb;
+            signalHealth_.crosstalkConverged = false;
+        }
     }
 }
 
-void AudioPipeline::audioOut(ofSoundBuffer& buffer) {
-    const auto numFrames = static_cast<std::size_t>(buffer.getNumFrames());
-    if (buffer.getNumChannels() < 2 || numFrames == 0) {
+void AudioPipeline::processInputSlice(const float* input, std::size_t offset, std::size_t numFrames) {
+    // Slices are written at their offset in the block while the monitor has room (always whole
+    // slices, since its capacity is a multiple of the slice size); the rest only feed detection.
+    const bool monitored = offset + numFrames <= channelBuffers_[0].size();
+    auto& buffers = monitored ? channelBuffers_ : overflowBuffers_;
+    const std::size_t base = monitored ? offset : 0;
+    const std::array<float*, 2> channels = {buffers[0].data() + base, buffers[1].data() + base};
+
+    // The AGC replaces the static gain and its clamp; it keeps the peaks below full scale itself.
+    const float staticGain = inputAgcEnabled_ ? 1.0f : inputGainLinear_;
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+        float ch1 = input[frame * 2];
+        float ch2 = input[frame * 2 + 1];
+        if (staticGain != 1.0f) {
+            ch1 = std::clamp(ch1 * staticGain, -1.0f, 1.0f);
+            ch2 = std::clamp(ch2 * staticGain, -1.0f, 1.0f);
+        }
+        applyCalibration(ch1, ch2);
+        channels[0][frame] = ch1;
+        channels[1][frame] = ch2;
+    }
+    if (inputAgcEnabled_) {
+        for (std::size_t channel = 0; channel < inputAgc_.size(); ++channel) {
+            inputAgc_[channel].process(channels[channel], numFrames);
+        }
+    }
+    std::array<const float*, 2> detection = {channels[0], channels[1]};
+    if (crosstalkCancellationEnabled_) {
+        crosstalkCanceller_.process(channels[0], channels[1], detectionBuffers_[0].data(),
+                                    detectionBuffers_[1].data(), numFrames);
+        detection = {detectionBuffers_[0].data(), detectionBuffers_[1].data()};
+    }
+    const double startSample = totalSamplesProcessed_;
+    constexpr std::array<ParticipantId, 2> participants = {
+        ParticipantId::Participant1,
+        ParticipantId::Participant2};
+    for (std::size_t channel = 0; channel < beatTimelines_.size(); ++channel) {
+        beatTimelines_[channel].processBuffer(detection[channel], numFrames, startSample);
+        const auto& event = beatTimelines_[channel].lastEvent();
+        if (event.timestampSec != lastObservedBeatSec_[channel]) {
+            lastObservedBeatSec_[channel] = event.timestampSec;
+            beatPredictors_[channel].observe(event.timestampSec);
+            queueResynthesis(channel, event.timestampSec, event.envelope, event.bpm);
+            if (inputAgcEnabled_) {
+                inputAgc_[channel].onBeat();
+            }
+        }
+        beatPredictors_[channel].trackEnvelope(beatTimelines_[channel].currentEnvelope());
+        auto& channelMetric = channelMetrics_[channel];
+        const auto participantId = participants[channel];
+        channelMetric.bpm = beatTimelines_[channel].currentBpm();
+        channelMetric.envelope = beatTimelines_[channel].currentEnvelope();
+        channelMetric.timestampSec =
+            (totalSamplesProcessed_ + static_cast<double>(numFrames)) / sampleRate_;
+        channelMetric.triggered = beatTimelines_[channel].lastFrameTriggered();
+        channelMetric.participantId = participantId;
+        channelMetric.inputGainDb = inputAgcEnabled_ ? inputAgc_[channel].gainDb() : inputGainDb_;
+    }
+    totalSamplesProcessed_ += static_cast<double>(numFrames);
+    if (monitored) {
+        monitorFrames_ = offset + numFrames;
+    }
+}
+
+void AudioPipeline::resetBeatTracking() {
+    for (auto& fallback : fallback_) {
+        fallback = {};
+        fallback.lastRealBeatSample = totalSamplesProcessed_;
+    }
+    for (auto& predictor : beatPredictors_) {
+        predictor.reset();
+    }
+    lastObservedBeatSec_.fill(0.0);
+    lastPulseBeatSec_.fill(-1.0);
+    pendingResynthesisCount_ = 0;
+    heartbeatSynth_.reset();
+}
+
+void AudioPipeline::updateFallback(std::size_t channel, double nowSec, double deltaSec) {
+    auto& fallback = fallback_[channel];
+    const auto& predictor = beatPredictors_[channel];
+    const auto& prediction = predictor.prediction();
+    fallback.envelopeAverage =
+        fallback.envelopeAverage + 0.03f * (channelMetrics_[channel].envelope - fallback.envelopeAverage);
+    const double dropoutSec = (totalSamplesProcessed_ - fallback.lastRealBeatSample) / sampleRate_;
+
+    if (!fallback.active) {
+        if (dropoutSec > kFallbackStartThreshold) {
+            fallback.active = true;
+            fallback.blend = 0.0f;
+            const float lastBpm = channelMetrics_[channel].bpm;
+            fallback.bpm = prediction.valid ? static_cast<float>(60.0 / prediction.periodSec)
+                                            : std::clamp(lastBpm > 1.0f ? lastBpm : 60.0f, 20.0f, 140.0f);
+            fallback.envelope = std::clamp(fallback.envelopeAverage, 0.18f, 0.6f);
+            fallback.lastEmitSec = std::max(nowSec - 60.0 / fallback.bpm, 0.0);
+        }
+        return;
+    }
+    if (dropoutSec < kFallbackStopThreshold) {
+        fallback.blend = std::max(0.0f, fallback.blend - static_cast<float>(deltaSec / 0.8));
+        if (fallback.blend <= 0.02f) {
+            fallback.active = false;
+            fallback.blend = 0.0f;
+        }
+        return;
+    }
+
+    fallback.blend = std::min(1.0f, fallback.blend + static_cast<float>(deltaSec / 1.0));
+    const float targetEnv = std::clamp(fallback.envelopeAverage, 0.18f, 0.6f);
+    fallback.envelope = fallback.envelope + 0.1f * (targetEnv - fallback.envelope);
+    // Synthetic beats continue the tracked rhythm in phase, so detection can resume without a
+    // jump; a plain metronome only when no rhythm was ever locked on.
+    if (prediction.valid) {
+        fallback.bpm = static_cast<float>(60.0 / prediction.periodSec);
+    }
+    while (true) {
+        const double next = prediction.valid
+                                ? predictor.nextBeatAfter(fallback.lastEmitSec + 0.5 * prediction.periodSec)
+                                : fallback.lastEmitSec + 60.0 / fallback.bpm;
+        if (next > nowSec) {
+            break;
+        }
+        fallback.lastEmitSec = next;
+        BeatEvent evt;
+        evt.timestampSec = next;
+        evt.bpm = fallback.bpm;
+        evt.envelope = fallback.envelope;
+        evt.participantId = channelMetrics_[channel].participantId;
+        evt.sequenceId = legacySequenceCounter_++;
+        beatEvents_.publish(evt);
+        queueResynthesis(channel, next, evt.envelope, evt.bpm);
+    }
+}
+
+void AudioPipeline::queueResynthesis(std::size_t channel, double timeSec, float envelope, float bpm) {
+    if (pendingResynthesisCount_ == pendingResynthesis_.size()) {
+        return;
+    }
+    // The trigger fires early on the rise; the tracked peak is the beat's actual size.
+    const float tracked = beatPredictors_[channel].prediction().amplitude;
+    auto& pending = pendingResynthesis_[pendingResynthesisCount_++];
+    pending.channel = channel;
+    pending.timeSec = timeSec;
+    pending.amplitude = tracked > 0.0f ? tracked : envelope;
+    pending.bpm = bpm;
+}
+
+void AudioPipeline::triggerResynthesis(std::uint64_t blockStartSample) {
+    // In a duplex callback the input block just processed lines up with this output block.
+    const double inputToOutput = static_cast<double>(blockStartSample) - inputBlockStartSample_;
+    for (std::size_t index = 0; index < pendingResynthesisCount_; ++index) {
+        const auto& pending = pendingResynthesis_[index];
+        const double atSample = std::max(std::round(pending.timeSec * sampleRate_ + inputToOutput),
+                                         static_cast<double>(blockStartSample));
+        heartbeatSynth_.trigger(pending.channel, static_cast<std::uint64_t>(atSample), pending.amplitude, pending.bpm);
+    }
+    pendingResynthesisCount_ = 0;
+}
+
+void AudioPipeline::scheduleHapticPulses(std::uint64_t blockStartSample, std::size_t numFrames) {
+    const bool live = predictiveHaptics_ && !calibrationArmed_ && !calibrationCheckArmed_ && !latencyArmed_ &&
+                      monitorFrames_ > 0;
+    const double blockStart = static_cast<double>(blockStartSample);
+    const double blockEnd = blockStart + static_cast<double>(numFrames);
+    // In a duplex callback the input block just processed lines up with this output block.
+    const double inputToOutput = blockStart - inputBlockStartSample_;
+    for (std::size_t channel = 0; channel < beatPredictors_.size(); ++channel) {
+        const auto& predictor = beatPredictors_[channel];
+        const auto& prediction = predictor.prediction();
+        const bool enabled = live && prediction.valid;
+        router_->setHapticPulseMode(channel, enabled);
+        if (!enabled) {
+            continue;
+        }
+        // A beat's pulse starts hapticLeadSamples_ before its trigger would reach the output.
+        // Beats whose start has passed by more than kMaxLatePulseSec are skipped, and the half
+        // period after the last pulse keeps a beat from firing twice when its own detection moves
+        // the estimate after the pulse has started. A beat detected earlier than predicted has no
+        // pulse yet and gets it straight away.
+        const double earliestSec =
+            (blockStart - inputToOutput + hapticLeadSamples_) / sampleRate_ - kMaxLatePulseSec;
+        const double pulsedUntilSec = lastPulseBeatSec_[channel] + 0.5 * prediction.periodSec;
+        const bool detectedUnpulsed = prediction.lastBeatSec > pulsedUntilSec && prediction.lastBeatSec >= earliestSec;
+        const double beatSec = detectedUnpulsed ? prediction.lastBeatSec
+                                                : predictor.nextBeatAfter(std::max(earliestSec, pulsedUntilSec));
+        const double startSample = beatSec * sampleRate_ + inputToOutput - hapticLeadSamples_;
+        if (startSample >= blockEnd) {
+            continue;
+        }
+        router_->scheduleHapticPulse(channel, static_cast<std::uint64_t>(std::max(startSample, blockStart)),
+                                     prediction.amplitude * prediction.confidence);
+        lastPulseBeatSec_[channel] = beatSec;
+    }
+}
+
+void AudioPipeline::prepareStreamRestart() {
+    // Applied by the first callback of the reopened stream.
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::StreamRestart;
+    post(command);
+}
+
+void AudioPipeline::setOutputRouter(AudioRouter* router) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::OutputRouter;
+    command.router = router;
+    post(command);
+}
+
+void AudioPipeline::setInputRecorder(SessionRecorder* recorder) {
+    PipelineCommand command;
+    command.type = PipelineCommand::Type::InputRecorder;
+    command.recorder = recorder;
+    post(command);
+}
+
+void AudioPipeline::setOutputFadeGain(float gain) {
+    scheduleOutputFade(gain, 0, 0);
+}
+
+void AudioPipeline::scheduleOutputFade(float target, std::uint64_t atSample, std::size_t rampSamples) {
+    OutputFadeCommand command;
+    command.type = OutputFadeCommand::Type::Ramp;
+    command.atSample = atSample;
+    command.target = std::clamp(target, 0.0f, 1.0f);
+    command.rampSamples = static_cast<std::uint32_t>(rampSamples);
+    fadeCommands_.publish(command);
+}
+
+void AudioPipeline::cancelScheduledFades() {
+    OutputFadeCommand command;
+    command.type = OutputFadeCommand::Type::CancelPending;
+    fadeCommands_.publish(command);
+}
+
+void AudioPipeline::beginFadeBlock(std::uint64_t blockStartSample, std::size_t numFrames) {
+    const std::uint64_t blockEnd = blockStartSample + numFrames;
+    fadeReader_.poll([&](const OutputFadeCommand& command) {
+        if (command.type == OutputFadeCommand::Type::CancelPending) {
+            for (auto& pending : pendingFades_) {
+                pending.valid = false;
+            }
+            return;
+        }
+        for (auto& pending : pendingFades_) {
+            if (!pending.valid) {
+                pending.command = command;
+                pending.valid = true;
+                return;
+            }
+        }
+    });
+
+    // Like routing changes, only the latest ramp due in this block is started.
+    const PendingFade* due = nullptr;
+    for (const auto& pending : pendingFades_) {
+        if (pending.valid && pending.command.atSample < blockEnd &&
+            (due == nullptr || pending.command.atSample >= due->command.atSample)) {
+            due = &pending;
+        }
+    }
+    if (due == nullptr) {
         return;
     }
+    const OutputFadeCommand command = due->command;
+    for (auto& pending : pendingFades_) {
+        if (pending.valid && pending.command.atSample <= command.atSample) {
+            pending.valid = false;
+        }
+    }
+    const std::uint64_t start = std::max(command.atSample, blockStartSample);
+    fadeDelay_ = static_cast<std::size_t>(start - blockStartSample);
+    fadeTo_ = command.target;
+    fadePosition_ = 0;
+    // An unspecified length still ramps across the rest of the block so the gain never steps.
+    fadeLength_ = command.rampSamples > 0 ? command.rampSamples : std::max<std::size_t>(numFrames - fadeDelay_, 1);
+    fadeRamping_ = true;
+}
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    ensureBufferSizes(numFrames);
-    float* output = buffer.getBuffer().data();
+std::optional<std::uint32_t> AudioPipeline::loadCue(const std::filesystem::path& path) {
+    CueSample sample;
+    if (!CueSample::loadWav(path, sampleRate_, sample)) {
+        return std::nullopt;
+    }
+    rt::CheckedLock lock(cueLoadMutex_);
+    return cuePlayer_.addSample(std::move(sample));
+}
+
+void AudioPipeline::scheduleCue(std::uint32_t cueId, std::uint64_t startSample, float gain) {
+    CueCommand command;
+    command.type = CueCommand::Type::Play;
+    command.cueId = cueId;
+    command.startSample = startSample;
+    command.gain = gain;
+    cuePlayer_.post(command);
+}
+
+void AudioPipeline::cancelPendingCues() {
+    CueCommand command;
+    command.type = CueCommand::Type::CancelPending;
+    cuePlayer_.post(command);
+}
+
+void AudioPipeline::publishClock(std::uint64_t micros) {
+    const std::uint32_t sequence = clockSequence_.load(std::memory_order_relaxed);
+    clockSequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    clockSample_.store(outputSampleClock_, std::memory_order_relaxed);
+    clockMicros_.store(micros, std::memory_order_relaxed);
+    clockSequence_.store(sequence + 2, std::memory_order_release);
+}
 
+double AudioPipeline::clockSecondsAtMicros(std::uint64_t micros) const {
+    return static_cast<double>(sampleIndexAtMicros(micros)) / sampleRate_;
+}
+
+std::uint64_t AudioPipeline::secondsToSample(double seconds) const {
+    return seconds <= 0.0 ? 0 : static_cast<std::uint64_t>(std::llround(seconds * sampleRate_));
+}
+
+std::uint64_t AudioPipeline::sampleIndexAtMicros(std::uint64_t micros) const {
+    std::uint64_t sample = 0;
+    std::uint64_t reference = 0;
+    while (true) {
+        const std::uint32_t before = clockSequence_.load(std::memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        sample = clockSample_.load(std::memory_order_relaxed);
+        reference = clockMicros_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (clockSequence_.load(std::memory_order_relaxed) == before) {
+            break;
+        }
+    }
+    const double deltaSamples =
+        (static_cast<double>(micros) - static_cast<double>(reference)) * 1e-6 * sampleRate_;
+    const double target = static_cast<double>(sample) + deltaSamples;
+    return target <= 0.0 ? 0 : static_cast<std::uint64_t>(std::llround(target));
+}
+
+void AudioPipeline::renderCalibrationSignal(CalibrationSession& session, float* output, std::size_t numFrames,
+                                            std::size_t numChannels, const std::array<float, 2>& envelopes) {
+    for (std::size_t offset = 0; offset < numFrames; offset += maxBlockFrames_) {
+        const std::size_t sliceFrames = std::min(maxBlockFrames_, numFrames - offset);
+        session.generate(calibrationScratch_.data(), sliceFrames);
+        float* sliceOutput = output + offset * numChannels;
+        for (std::size_t frame = 0; frame < sliceFrames; ++frame) {
+            writeOutputFrame(&calibrationScratch_[frame * 2], envelopes.data(), nextOutputFade(), nullptr,
+                             sliceOutput + frame * numChannels, numChannels);
+        }
+    }
+    outputFadeGain_.store(outputFade_, std::memory_order_relaxed);
+}
+
+void AudioPipeline::processOutput(float* output, std::size_t numFrames, std::size_t numChannels,
+                                  std::uint64_t nowMicros) {
+    if (numChannels == 0 || numFrames == 0) {
+        return;
+    }
+
+    if (maxBlockFrames_ == 0) {
+        return;
+    }
+    applyCommands();
+    if (!outputClockAnchored_) {
+        // Continue from the clock's own extrapolation: before the first block that is the system
+        // time, after a device restart it is where the clock would be had the device never stopped.
+        outputSampleClock_ = sampleIndexAtMicros(nowMicros);
+        outputClockAnchored_ = true;
+    }
+    publishClock(nowMicros);
+    const std::uint64_t blockStartSample = outputSampleClock_;
+    outputSampleClock_ += numFrames;
+
+    // Scene events (fade ramps, routing changes) are applied at this block boundary, starting at
+    // their exact sample inside the block.
+    beginFadeBlock(blockStartSample, numFrames);
+    if (router_) {
+        router_->prepareBlock(blockStartSample, numFrames);
+        scheduleHapticPulses(blockStartSample, numFrames);
+    }
+    const std::array<float, 2> envelopes = {
+        std::clamp(channelMetrics_[0].envelope, 0.0f, 1.0f),
+        std::clamp(channelMetrics_[1].envelope, 0.0f, 1.0f)};
+
+    if (calibrationArmed_ || calibrationCheckArmed_ || latencyArmed_) {
+        // Beats queued before a test would land on its first output block.
+        pendingResynthesisCount_ = 0;
+    }
+    if (calibrationCheckArmed_) {
+        // The burst takes the full calibration's output path, so it measures the same gains.
+        renderCalibrationSignal(calibrationCheck_, output, numFrames, numChannels, envelopes);
+        if (calibrationCheck_.isComplete()) {
+            calibrationChecks_.publish(
+                compareCalibration(appliedCalibration_, calibrationCheck_.result(), kCalibrationCheckToleranceDb));
+            calibrationCheckArmed_ = false;
+            calibrationCheckRun_.finished.store(calibrationCheckRunId_, std::memory_order_release);
+        }
+        publishSnapshot(blockStartSample);
+        return;
+    }
     if (calibrationArmed_) {
-        calibrationSession_.generate(output, numFrames);
+        renderCalibrationSignal(calibrationSession_, output, numFrames, numChannels, envelopes);
         if (calibrationSession_.isComplete()) {
-            calibrationValues_ = calibrationSession_.result();
+            const auto& result = calibrationSession_.result();
+            CalibrationTrim trim;
+            trim.runId = calibrationRunId_;
+            for (std::size_t channel = 0; channel < appliedCalibration_.size(); ++channel) {
+                appliedCalibration_[channel].gain = trim.gain[channel] = result[channel].gain;
+                appliedCalibration_[channel].phaseDeg = trim.phaseDeg[channel] = result[channel].phaseDeg;
+                appliedCalibration_[channel].delaySamples = trim.delaySamples[channel] = result[channel].delaySamples;
+            }
+            // The values go out before the run is marked finished, so calibrationResult() has them
+            // once isCalibrationActive() turns false.
+            calibrationResults_.publish(trim);
+            calibrationReady_.store(true, std::memory_order_release);
             calibrationArmed_ = false;
-            calibrationCompleted_ = true;
+            calibrationRun_.finished.store(calibrationRunId_, std::memory_order_release);
             limiter_.reset();
             beatTimelines_[0].setup(sampleRate_, ParticipantId::Participant1);
             beatTimelines_[1].setup(sampleRate_, ParticipantId::Participant2);
             totalSamplesProcessed_ = 0.0;
+            resetBeatTracking();
             metrics_ = {};
-            for (auto& pending : pendingEventsByChannel_) {
-                pending.clear();
-            }
             for (auto& metric : channelMetrics_) {
                 metric = {};
             }
             channelMetrics_[0].participantId = ParticipantId::Participant1;
             channelMetrics_[1].participantId = ParticipantId::Participant2;
         }
+        publishSnapshot(blockStartSample);
+        return;
+    }
+
+    if (latencyArmed_) {
+        latencyProbe_.generate(output, numFrames, numChannels);
+        if (latencyProbe_.isComplete()) {
+            latencyReports_.publish(latencyProbe_.report());
+            latencyArmed_ = false;
+            latencyRun_.finished.store(latencyRunId_, std::memory_order_release);
+        }
+        publishSnapshot(blockStartSample);
         return;
     }
 
     const float selfGain = dbToLinear(kSelfGainDb);
     const float noiseGain = dbToLinear(kNoiseGainDb);
 
-    for (std::size_t frame = 0; frame < numFrames; ++frame) {
-        noiseBuffer_[frame] = noiseDist_(rng_);
-    }
+    cuePlayer_.beginBlock(blockStartSample, numFrames);
+    triggerResynthesis(blockStartSample);
+    const float targetMix = resynthesisMix_;
+    const bool resynthesize = targetMix > 0.0f || appliedResynthesisMix_ > 0.0f;
+    const float mixStep = (targetMix - appliedResynthesisMix_) / static_cast<float>(numFrames);
+    float mix = appliedResynthesisMix_;
 
+    // Single pass: mix heartbeat + noise + cues, limit, route, fade, and write interleaved device frames.
+    std::array<float, 2> stereo{};
+    std::array<float, 2> cue{};
+    std::size_t sliceStart = 0;
+    std::size_t sliceEnd = 0;
     for (std::size_t frame = 0; frame < numFrames; ++frame) {
-        const float heartbeatP1 =
-            frame < channelBuffers_[0].size() ? channelBuffers_[0][frame] : 0.0f;
-        const float heartbeatP2 =
-            frame < channelBuffers_[1].size() ? channelBuffers_[1][frame] : 0.0f;
-        const float noise = noiseBuffer_[frame] * noiseGain;
+        if (frame == sliceEnd) {
+            // Noise and resynthesised beats for the next stretch of up to maxBlockFrames_ frames
+            // in one vectorised pass each.
+            const std::size_t sliceFrames = std::min(maxBlockFrames_, numFrames - frame);
+            noise_.fill(noiseBuffer_.data(), sliceFrames);
+            if (resynthesize) {
+                for (auto& synthBuffer : synthBuffers_) {
+                    std::fill_n(synthBuffer.data(), sliceFrames, 0.0f);
+                }
+                heartbeatSynth_.render(blockStartSample + frame, sliceFrames,
+                                       {synthBuffers_[0].data(), synthBuffers_[1].data()});
+            }
+            sliceStart = frame;
+            sliceEnd = frame + sliceFrames;
+        }
+        float heartbeatP1 = frame < monitorFrames_ ? channelBuffers_[0][frame] : 0.0f;
+        float heartbeatP2 = frame < monitorFrames_ ? channelBuffers_[1][frame] : 0.0f;
+        if (resynthesize) {
+            mix += mixStep;
+            heartbeatP1 += mix * (synthBuffers_[0][frame - sliceStart] - heartbeatP1);
+            heartbeatP2 += mix * (synthBuffers_[1][frame - sliceStart] - heartbeatP2);
+        }
+        const float noise = noiseBuffer_[frame - sliceStart] * noiseGain;
 
         float left = heartbeatP1 * selfGain + noise;
         float right = heartbeatP2 * selfGain + noise;
 
-        const float detectionSample = (std::fabs(left) >= std::fabs(right)) ? left : right;
+        cuePlayer_.next(blockStartSample + frame, cue[0], cue[1]);
+
+        const float peakLeft = left + cue[0];
+        const float peakRight = right + cue[1];
+        const float detectionSample = (std::fabs(peakLeft) >= std::fabs(peakRight)) ? peakLeft : peakRight;
         limiter_.process(detectionSample);
         const float gain = limiter_.currentGain();
-        left *= gain;
-        right *= gain;
+        stereo[0] = left * gain;
+        stereo[1] = right * gain;
+        cue[0] *= gain;
+        cue[1] *= gain;
 
-        output[frame * 2] = left;
-        output[frame * 2 + 1] = right;
+        writeOutputFrame(stereo.data(), envelopes.data(), nextOutputFade(), cue.data(),
+                         output + frame * numChannels, numChannels);
     }
+    outputFadeGain_.store(outputFade_, std::memory_order_relaxed);
+    appliedResynthesisMix_ = targetMix;
 
     limiterReductionDb_ = limiter_.lastReductionDb();
+    publishSnapshot(blockStartSample);
 }
 
-AudioPipeline::SignalHealth AudioPipeline::signalHealth() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return signalHealth_;
-}
-
-AudioPipeline::BeatMetrics AudioPipeline::latestMetrics() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return metrics_;
-}
-
-std::vector<BeatEvent> AudioPipeline::pollBeatEvents() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const std::size_t totalSize =
-        pendingEventsByChannel_[0].size() + pendingEventsByChannel_[1].size();
-    std::vector<BeatEvent> events;
-    events.reserve(totalSize);
-    for (auto& pending : pendingEventsByChannel_) {
-        events.insert(events.end(), pending.begin(), pending.end());
-        pending.clear();
-    }
-    std::stable_sort(events.begin(), events.end(), [](const BeatEvent& a, const BeatEvent& b) {
-        if (a.timestampSec == b.timestampSec) {
-            return a.sequenceId < b.sequenceId;
+void AudioPipeline::publishSnapshot(std::uint64_t blockStartSample) {
+    PipelineSnapshot snapshot;
+    snapshot.blockIndex = ++publishedBlocks_;
+    snapshot.blockStartSample = blockStartSample;
+    snapshot.channels = channelMetrics_;
+    snapshot.metrics = metrics_;
+    snapshot.health = signalHealth_;
+    snapshot.limiterReductionDb = limiterReductionDb_;
+    snapshot.outputFadeGain = outputFade_;
+    snapshot.envelopeCalibrationActive = envelopeCalibrationActive_;
+    snapshot.envelopeCalibrationProgress = 0.0f;
+    if (envelopeCalibrationActive_) {
+        // Slowest channel; a channel that has finished reports 0 and is skipped.
+        float progress = 1.0f;
+        for (const auto& timeline : beatTimelines_) {
+            if (timeline.isEnvelopeCalibrating()) {
+                progress = std::min(progress, timeline.calibrationProgress());
+            }
         }
-        return a.timestampSec < b.timestampSec;
-    });
-    return events;
+        snapshot.envelopeCalibrationProgress = progress;
+    }
+    snapshots_.publish(snapshot);
 }
 
-AudioPipeline::ChannelMetrics AudioPipeline::channelMetrics(ParticipantId id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const auto idx = participantIndex(id);
-    if (!idx) {
-        return {};
+void AudioPipeline::writeOutputFrame(const float* stereo, const float* envelopes, float fade, const float* cue,
+                                     float* out, std::size_t numChannels) {
+    std::size_t written = 0;
+    if (router_) {
+        written = std::min(numChannels, AudioRouter::kOutputChannels);
+        router_->routeFrame(stereo, envelopes, fade, cue, out, written);
+    } else {
+        written = std::min<std::size_t>(numChannels, 2);
+        for (std::size_t channel = 0; channel < written; ++channel) {
+            out[channel] = stereo[channel] * fade + (cue ? cue[channel] : 0.0f);
+        }
+    }
+    for (std::size_t channel = written; channel < numChannels; ++channel) {
+        out[channel] = 0.0f;
     }
-    return channelMetrics_[*idx];
 }
 
-std::vector<BeatEvent> AudioPipeline::pollBeatEvents(ParticipantId id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+const EnvelopeScopeTap* AudioPipeline::envelopeScope(ParticipantId id) const {
     const auto idx = participantIndex(id);
     if (!idx) {
-        return {};
+        return nullptr;
     }
-    std::vector<BeatEvent> events(pendingEventsByChannel_[*idx].begin(),
-                                  pendingEventsByChannel_[*idx].end());
-    pendingEventsByChannel_[*idx].clear();
-    return events;
+    return &envelopeScopes_[*idx];
 }
 
 std::optional<std::size_t> AudioPipeline::participantIndex(ParticipantId id) {
@@ -435,4 +1166,32 @@ std::optional<std::size_t> AudioPipeline::participantIndex(ParticipantId id) {
     }
 }
 
+#if !defined(KNOT_AUDIO_HEADLESS)
+void AudioPipeline::loadCalibrationFile(const std::filesystem::path& path) {
+    auto loaded = CalibrationFileIO::load(path);
+    if (loaded) {
+        setCalibration(*loaded);
+    }
+}
+
+bool AudioPipeline::saveCalibrationFile(const std::filesystem::path& path) {
+    if (!calibrationReady()) {
+        return false;
+    }
+    return CalibrationFileIO::save(path, calibrationResult());
+}
+
+void AudioPipeline::audioIn(const ofSoundBuffer& buffer) {
+    if (buffer.getNumChannels() < 2) {
+        return;
+    }
+    processInput(buffer.getBuffer().data(), buffer.getNumFrames());
+}
+
+void AudioPipeline::audioOut(ofSoundBuffer& buffer) {
+    processOutput(buffer.getBuffer().data(), buffer.getNumFrames(), buffer.getNumChannels(),
+                  ofGetElapsedTimeMicros());
+}
+#endif
+
 } // namespace knot::audio
@@ -1,46 +1,237 @@
 #pragma once
 
+#include "AudioRouter.h"
+#include "BeatPredictor.h"
 #include "BeatTimeline.h"
 #include "Calibration.h"
+#include "CrosstalkCanceller.h"
+#include "EnvelopeScopeTap.h"
+#include "HeartbeatSynth.h"
+#include "InputAgc.h"
+#include "LatencyProbe.h"
+#include "NoiseGenerator.h"
 #include "ParticipantId.h"
+#include "SamplePlayer.h"
+#include "SessionRecording.h"
 #include "SimpleLimiter.h"
+#include "TripleBuffer.h"
 #include "Utility.h"
 
+#if !defined(KNOT_AUDIO_HEADLESS)
 #include "ofSoundBuffer.h"
+#endif
 
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
-#include <deque>
 #include <filesystem>
 #include <mutex>
 #include <optional>
-#include <random>
 #include <string>
 #include <vector>
 
 namespace knot::audio {
 
+/// Output fade ramp stamped with an absolute output sample index.
+struct OutputFadeCommand {
+    enum class Type : std::uint8_t {
+        Ramp,
+        CancelPending
+    };
+    Type type = Type::Ramp;
+    std::uint64_t atSample = 0;
+    float target = 1.0f;
+    std::uint32_t rampSamples = 0;
+};
+
+using OutputFadeBus = EventBus<OutputFadeCommand, 16>;
+
+/// Gains, phases and delays of both channels, without the channel names, so they can cross
+/// between the UI and the audio thread on an EventBus.
+struct CalibrationTrim {
+    std::array<float, 2> gain{{1.0f, 1.0f}};
+    std::array<float, 2> phaseDeg{};
+    std::array<int, 2> delaySamples{};
+    /// Calibration run the values were measured in (0: set from the UI).
+    std::uint64_t runId = 0;
+};
+
+/// UI-thread setting or request, applied by the audio thread at the start of its next callback.
+struct PipelineCommand {
+    enum class Type : std::uint8_t {
+        NoiseSeed,
+        NoiseColor,
+        InputGain,
+        InputAgc,
+        CrosstalkCancellation,
+        PredictiveHaptics,
+        ResynthesisMix,
+        BaselineTracking,
+        StartCalibration,
+        SetCalibration,
+        StartCalibrationCheck,
+        StartLatencyTest,
+        CancelLatencyTest,
+        StartEnvelopeCalibration,
+        StreamRestart,
+        OutputRouter,
+        InputRecorder
+    };
+    Type type = Type::NoiseSeed;
+    bool enabled = false;
+    /// Noise seed or colour, latency test pulses.
+    std::uint32_t count = 0;
+    /// Run started by a Start* command (see RunState).
+    std::uint64_t runId = 0;
+    /// Input gain in dB, resynthesis mix, haptic lead in samples, envelope calibration seconds.
+    double value = 0.0;
+    CalibrationTrim calibration{};
+    AudioRouter* router = nullptr;
+    SessionRecorder* recorder = nullptr;
+};
+
+using PipelineCommandBus = EventBus<PipelineCommand, 64>;
+using CalibrationTrimBus = EventBus<CalibrationTrim, 4>;
+using CalibrationCheckBus = EventBus<CalibrationCheck, 4>;
+using LatencyReportBus = EventBus<LatencyReport, 4>;
+using EnvelopeCalibrationBus = EventBus<std::array<EnvelopeCalibrationStats, 2>, 4>;
+
+/// Setters, start/poll calls and snapshot() belong to the UI thread; processInput() and
+/// processOutput() to the audio thread, which owns the processing state. Settings and requests
+/// reach it as PipelineCommands and results come back on EventBuses, so the callbacks never
+/// take a lock. setup() and the calibration file calls expect the stream to be stopped.
 class AudioPipeline {
 public:
+    /// Scratch capacity reserved in setup() (at least the requested buffer size). audioIn/audioOut
+    /// never allocate; larger device blocks are processed in slices of this size.
+    static constexpr std::size_t kMaxBlockFrames = 4096;
+    /// The monitor keeps this many slices of a device block for the output callback to play back
+    /// (16384 frames, ~340 ms at 48 kHz, by default). Frames beyond that are still detected but
+    /// output as silence on the direct monitor path.
+    static constexpr std::size_t kMonitorSlices = 4;
+
     void setup(double sampleRate, std::size_t bufferSize);
+    /// Longest block one processInput() call keeps whole for the monitor: kMonitorSlices slices
+    /// of the scratch reserved in setup(). 0 before setup().
+    std::size_t monitorCapacityFrames() const { return maxBlockFrames_ * kMonitorSlices; }
+#if !defined(KNOT_AUDIO_HEADLESS)
     void loadCalibrationFile(const std::filesystem::path& path);
-    bool saveCalibrationFile(const std::filesystem::path& path) const;
+    bool saveCalibrationFile(const std::filesystem::path& path);
+#endif
 
     void startCalibration();
     bool isCalibrationActive() const;
     bool calibrationReady() const;
-    const std::array<ChannelCalibrationValue, 2>& calibrationResult() const { return calibrationValues_; }
+    /// Current values, including those of a calibration run that has completed since the last call.
+    const std::array<ChannelCalibrationValue, 2>& calibrationResult();
+    /// Replaces the calibration values, e.g. with a stored profile for the devices just opened.
+    /// A calibration run still in progress no longer overwrites them when it completes.
+    void setCalibration(const std::array<ChannelCalibrationValue, 2>& values);
+    /// Plays a CalibrationSession::kCheckToneSec burst of the calibration tone and measures the
+    /// channel gains against the current values, which it leaves unchanged. Like the latency
+    /// test, live beat detection is paused meanwhile, not reset. Fails while calibration or the
+    /// latency test runs.
+    bool startCalibrationCheck();
+    bool isCalibrationCheckActive() const;
+    bool pollCalibrationCheck(CalibrationCheck& check);
+    /// Reseeds the background noise; the same seed reproduces the same noise samples.
     void setNoiseSeed(std::uint32_t seed);
+    void setNoiseColor(NoiseColor color);
 
+    /// Measures the envelope baseline of both participants over the same durationSec. Beat
+    /// detection keeps running meanwhile; each channel's result resets its own thresholds.
     void startEnvelopeCalibration(double durationSec);
     bool isEnvelopeCalibrationActive() const;
-    float envelopeCalibrationProgress() const;
-    EnvelopeCalibrationStats lastEnvelopeCalibration() const;
-    bool pollEnvelopeCalibrationStats(EnvelopeCalibrationStats& stats);
+    /// Per participant (index 0 = P1).
+    std::array<EnvelopeCalibrationStats, 2> lastEnvelopeCalibration();
+    bool pollEnvelopeCalibrationStats(std::array<EnvelopeCalibrationStats, 2>& stats);
+    /// Continuous baseline tracking on both channels (see BeatTimeline::setBaselineTracking).
+    void setBaselineTracking(bool enabled);
+    /// Static input gain. With the input AGC on, this is where its adaptation restarts from.
     void setInputGainDb(float gainDb);
+    /// Per-channel input AGC (see InputAgc) in place of the static gain: each stethoscope is
+    /// levelled on its own beats, so detection sees a consistent level whatever the placement.
+    void setInputAgc(bool enabled);
+    /// Cancels each stethoscope's pickup of the other participant ahead of beat detection (see
+    /// CrosstalkCanceller). The monitoring mix always hears the uncancelled inputs.
+    void setCrosstalkCancellation(bool enabled);
+    /// Predictive haptics: each participant's beats are tracked by a BeatPredictor and the haptic
+    /// pulse for the next predicted beat starts leadSec early, so it lands on the heartbeat
+    /// instead of a detection latency after it. leadSec is the delay from a heart sound reaching
+    /// the input to its pulse leaving the output when nothing is predicted: the loopback round
+    /// trip plus detection (see LatencyReport). <= 0 estimates it from the buffer size. Until a
+    /// participant's tracker has locked on, and with enabled false, haptics follow the envelope.
+    void setPredictiveHaptics(bool enabled, double leadSec);
+    /// Headphone resynthesis: every beat event (detected or fallback) triggers an S1/S2 voice of
+    /// HeartbeatSynth at the beat's sample in the output block, scaled to the participant's
+    /// tracked beat amplitude. mix crossfades the headphone signal from the calibrated input (0)
+    /// to the resynthesised heartbeat only (1); changes ramp over one block. Haptics are unaffected.
+    void setResynthesisMix(float mix);
+
+    /// Starts the loopback latency test (see LatencyProbe for the wiring). While it runs the
+    /// device output carries only the test signals, bypassing routing, fades and limiter, and the
+    /// live beat detection is paused with its baselines intact. Fails while calibration runs.
+    bool startLatencyTest(std::size_t pulses);
+    void cancelLatencyTest();
+    bool isLatencyTestActive() const;
+    bool pollLatencyReport(LatencyReport& report);
 
+    /// Device-independent input callback: numFrames of interleaved stereo.
+    void processInput(const float* interleavedStereo, std::size_t numFrames);
+    /// Renders straight into the device's interleaved buffer: self mix, limiter, routing to
+    /// up to four outputs, and the per-sample fade ramp. Extra device channels are zeroed.
+    /// nowMicros is the system time of the call, on the clock sampleIndexAtMicros() maps from.
+    void processOutput(float* interleaved, std::size_t numFrames, std::size_t numChannels, std::uint64_t nowMicros);
+#if !defined(KNOT_AUDIO_HEADLESS)
+    /// ofSoundStream callbacks; forward to processInput()/processOutput().
     void audioIn(const ofSoundBuffer& buffer);
     void audioOut(ofSoundBuffer& buffer);
+#endif
+
+    /// Raw input tap: every processInput() block is copied to the recorder before gain and calibration.
+    /// Like setOutputRouter(), it takes effect at the next callback, so a recorder or router that
+    /// is replaced while the stream runs has to outlive that callback.
+    void setInputRecorder(SessionRecorder* recorder);
+
+    /// Call while the device stream is stopped, before it is reopened (device hot-plug). The
+    /// output clock then resumes from its own extrapolation, so scene time and scheduled cues do
+    /// not jump, stale input is dropped and the master gain fades back in from silence.
+    /// Calibration, beat baselines and fallback state are kept.
+    void prepareStreamRestart();
+
+    /// Router used by audioOut(); without one, the stereo mix goes to the first two channels.
+    void setOutputRouter(AudioRouter* router);
+    /// Master output gain target (0..1), reached over the next block. UI thread only.
+    void setOutputFadeGain(float gain);
+    /// Raised-cosine ramp of the master gain from its current value to target, starting exactly at
+    /// atSample and lasting rampSamples. A later ramp takes over from wherever the previous one is.
+    void scheduleOutputFade(float target, std::uint64_t atSample, std::size_t rampSamples);
+    /// Drops fade ramps that have not started yet.
+    void cancelScheduledFades();
+    /// Current master gain as rendered by the audio thread.
+    float outputFadeGain() const { return outputFadeGain_.load(std::memory_order_relaxed); }
+
+    /// Preloads a WAV cue (bell, scene sounds) for sample-accurate playback. Any thread: the file
+    /// is decoded before the loader lock is taken, so a loader thread can call it while the stream
+    /// runs. nullopt when the file does not load or SamplePlayer::kMaxSamples cues are loaded.
+    std::optional<std::uint32_t> loadCue(const std::filesystem::path& path);
+    /// Schedules a cue to start at an absolute output sample index (see sampleIndexAtMicros).
+    /// UI thread only. Cues are mixed ahead of the limiter and sent to CH1/CH2 unfaded.
+    void scheduleCue(std::uint32_t cueId, std::uint64_t startSample, float gain);
+    /// Drops cues that were scheduled but have not started yet.
+    void cancelPendingCues();
+    /// Start reports (requested vs actual sample) for jitter measurement.
+    CueReportBus::Subscriber subscribeCueReports() const { return cuePlayer_.subscribeReports(); }
+    /// Maps an ofGetElapsedTimeMicros() timestamp onto the output sample clock. The clock is
+    /// anchored to the system clock when the stream starts (and to its own extrapolation when a
+    /// stream restarts) and then advances with the device, so it doubles as the scene timeline's
+    /// time base.
+    std::uint64_t sampleIndexAtMicros(std::uint64_t micros) const;
+    /// Output clock time in seconds at the given ofGetElapsedTimeMicros() timestamp.
+    double clockSecondsAtMicros(std::uint64_t micros) const;
+    std::uint64_t secondsToSample(double seconds) const;
+    double sampleRate() const { return sampleRate_; }
 
     struct ChannelMetrics {
         float bpm = 0.0f;
@@ -48,20 +239,20 @@ public:
         double timestampSec = 0.0;
         bool triggered = false;
         ParticipantId participantId = ParticipantId::None;
+        /// Input gain applied to this channel: the AGC's current gain, or the static gain.
+        float inputGainDb = 0.0f;
     };
 
     const BeatTimeline& beatTimeline() const { return beatTimelines_[0]; }
-    float lastLimiterReductionDb() const { return limiterReductionDb_; }
     struct BeatMetrics {
         float bpm = 0.0f;
         float envelope = 0.0f;
         double timestampSec = 0.0;
         bool triggered = false;
     };
-    BeatMetrics latestMetrics() const;
-    std::vector<BeatEvent> pollBeatEvents();
-    ChannelMetrics channelMetrics(ParticipantId id) const;
-    std::vector<BeatEvent> pollBeatEvents(ParticipantId id);
+    /// Detected and fallback beats for both participants, published from the audio thread.
+    BeatEventBus::Subscriber subscribeBeatEvents() const { return beatEvents_.subscribe(); }
+    std::uint64_t publishedBeatEventCount() const { return beatEvents_.publishedCount(); }
     struct SignalHealth {
         float envelopeShort = 0.0f;
         float envelopeMid = 0.0f;
@@ -71,34 +262,171 @@ public:
         bool fallbackActive = false;
         float fallbackBlend = 0.0f;
         float fallbackEnvelope = 0.0f;
+        /// Crosstalk canceller, per channel: estimated pickup of the other participant relative to
+        /// the channel, and what is left of it after cancellation (0 dB: nothing removed).
+        std::array<float, 2> crosstalkLeakageDb{{-120.0f, -120.0f}};
+        std::array<float, 2> crosstalkResidualDb{{0.0f, 0.0f}};
+        bool crosstalkConverged = false;
+        /// Beat tracker per participant: locked on, tempo, and whether synthetic beats are being
+        /// published from its prediction because no beat has been detected for a while. The
+        /// fallback fields above describe P1.
+        std::array<bool, 2> beatTrackerLocked{};
+        std::array<float, 2> trackedBpm{};
+        std::array<bool, 2> beatFallbackActive{};
+        /// Tracked envelope baseline per participant (median, MAD) and the trigger floor derived
+        /// from it; all zero while baseline tracking is off.
+        std::array<float, 2> baselineMedian{};
+        std::array<float, 2> baselineMad{};
+        std::array<float, 2> baselineFloor{};
     };
-    SignalHealth signalHealth() const;
+
+    /// Everything the UI reads per frame, captured together at the end of each output block so
+    /// all values refer to the same block.
+    struct PipelineSnapshot {
+        std::uint64_t blockIndex = 0;
+        std::uint64_t blockStartSample = 0;
+        std::array<ChannelMetrics, 2> channels{};
+        BeatMetrics metrics{};
+        SignalHealth health{};
+        float limiterReductionDb = 0.0f;
+        float outputFadeGain = 1.0f;
+        bool envelopeCalibrationActive = false;
+        float envelopeCalibrationProgress = 0.0f;
+
+        /// Metrics for a participant (default-constructed for unknown ids).
+        ChannelMetrics channel(ParticipantId id) const {
+            const auto idx = participantIndex(id);
+            return idx ? channels[*idx] : ChannelMetrics{};
+        }
+    };
+    /// Latest published block, wait-free. Single consumer: call from the UI thread only.
+    PipelineSnapshot snapshot() { return snapshots_.read(); }
+
+    /// Lock-free ~1 ms min/max envelope scope for a participant (nullptr if unknown).
+    const EnvelopeScopeTap* envelopeScope(ParticipantId id) const;
 
 private:
+    // A run (calibration, check, latency test, envelope calibration) is requested by the UI and
+    // finished by the audio thread, completed or superseded, by storing its id; the UI can also
+    // give up on it. It is active until one of the two has caught up with the latest request.
+    struct RunState {
+        std::atomic<std::uint64_t> requested{0};
+        std::atomic<std::uint64_t> finished{0};
+        std::atomic<std::uint64_t> abandoned{0};
+
+        std::uint64_t request() { return requested.fetch_add(1, std::memory_order_acq_rel) + 1; }
+        void abandon() { abandoned.store(requested.load(std::memory_order_relaxed), std::memory_order_release); }
+        bool active() const {
+            const std::uint64_t latest = requested.load(std::memory_order_acquire);
+            return finished.load(std::memory_order_acquire) != latest &&
+                   abandoned.load(std::memory_order_acquire) != latest;
+        }
+    };
+
     double sampleRate_ = 48000.0;
     std::size_t bufferSize_ = 512;
+
+    // UI thread.
     std::array<ChannelCalibrationValue, 2> calibrationValues_{};
+    // Calibration runs up to this one were superseded by setCalibration().
+    std::uint64_t calibrationOverriddenRun_ = 0;
+    CalibrationTrimBus::Subscriber calibrationReader_{};
+    CalibrationCheckBus::Subscriber calibrationCheckReader_{};
+    LatencyReportBus::Subscriber latencyReader_{};
+    EnvelopeCalibrationBus::Subscriber envelopeCalibrationReader_{};
+    std::array<EnvelopeCalibrationStats, 2> lastEnvelopeCalibration_{};
+    bool newEnvelopeCalibrationAvailable_ = false;
+    // Serialises loadCue() callers; never taken by the audio thread.
+    std::mutex cueLoadMutex_;
+
+    // Shared.
+    PipelineCommandBus commands_;
+    std::atomic<bool> calibrationReady_{false};
+    RunState calibrationRun_;
+    RunState calibrationCheckRun_;
+    RunState latencyRun_;
+    RunState envelopeCalibrationRun_;
+    CalibrationTrimBus calibrationResults_;
+    CalibrationCheckBus calibrationChecks_;
+    LatencyReportBus latencyReports_;
+    EnvelopeCalibrationBus envelopeCalibrations_;
 
+    // Audio thread from here on, apart from the buses, atomics and TripleBuffer further down.
+    PipelineCommandBus::Subscriber commandReader_ = commands_.subscribe();
+    std::array<ChannelCalibrationValue, 2> appliedCalibration_{};
     CalibrationSession calibrationSession_{};
     bool calibrationArmed_ = false;
-    bool calibrationCompleted_ = false;
+    std::uint64_t calibrationRunId_ = 0;
+    CalibrationSession calibrationCheck_{};
+    bool calibrationCheckArmed_ = false;
+    std::uint64_t calibrationCheckRunId_ = 0;
+    LatencyProbe latencyProbe_{};
+    bool latencyArmed_ = false;
+    std::uint64_t latencyRunId_ = 0;
 
     std::array<BeatTimeline, 2> beatTimelines_{};
+    std::array<EnvelopeScopeTap, 2> envelopeScopes_{};
+    BeatEventBus beatEvents_{};
     SimpleLimiter limiter_{};
 
-    mutable std::mutex mutex_;
+    std::size_t maxBlockFrames_ = 0;
+    // Frames of the last input block held in channelBuffers_ for the monitor.
+    std::size_t monitorFrames_ = 0;
+    // Whole input block, kMonitorSlices * maxBlockFrames_; slices beyond it use overflowBuffers_.
     std::array<std::vector<float>, 2> channelBuffers_;
-    std::vector<float> outputScratch_;
+    std::array<std::vector<float>, 2> overflowBuffers_;
+    // Crosstalk-cancelled copy of channelBuffers_, seen only by the beat detectors.
+    std::array<std::vector<float>, 2> detectionBuffers_;
+    CrosstalkCanceller crosstalkCanceller_{};
+    bool crosstalkCancellationEnabled_ = true;
+    std::vector<float> calibrationScratch_;
+    AudioRouter* router_ = nullptr;
+    SessionRecorder* inputRecorder_ = nullptr;
+    SamplePlayer cuePlayer_;
+    std::uint64_t outputSampleClock_ = 0;
+    bool outputClockAnchored_ = false;
+    // Seqlock-published (block start sample, block start time) pair for sampleIndexAtMicros().
+    std::atomic<std::uint32_t> clockSequence_{0};
+    std::atomic<std::uint64_t> clockSample_{0};
+    std::atomic<std::uint64_t> clockMicros_{0};
+    struct PendingFade {
+        OutputFadeCommand command;
+        bool valid = false;
+    };
+    OutputFadeBus fadeCommands_;
+    OutputFadeBus::Subscriber fadeReader_ = fadeCommands_.subscribe();
+    std::array<PendingFade, OutputFadeBus::capacity()> pendingFades_{};
+    float outputFade_ = 1.0f;
+    float fadeFrom_ = 1.0f;
+    float fadeTo_ = 1.0f;
+    std::size_t fadeDelay_ = 0;
+    std::size_t fadePosition_ = 0;
+    std::size_t fadeLength_ = 0;
+    bool fadeRamping_ = false;
+    std::atomic<float> outputFadeGain_{1.0f};
+    NoiseGenerator noise_{};
     std::vector<float> noiseBuffer_;
-    std::mt19937 rng_;
-    std::normal_distribution<float> noiseDist_{0.0f, 1.0f};
+    HeartbeatSynth heartbeatSynth_{};
+    std::array<std::vector<float>, 2> synthBuffers_;
+    float resynthesisMix_ = 0.0f;
+    float appliedResynthesisMix_ = 0.0f;
+    // Beats seen by audioIn() on the input clock, voiced by the next audioOut().
+    struct ResynthesisTrigger {
+        std::size_t channel = 0;
+        double timeSec = 0.0;
+        float amplitude = 0.0f;
+        float bpm = 0.0f;
+    };
+    std::array<ResynthesisTrigger, 16> pendingResynthesis_{};
+    std::size_t pendingResynthesisCount_ = 0;
     float inputGainLinear_ = 1.0f;
+    float inputGainDb_ = 0.0f;
+    std::array<InputAgc, 2> inputAgc_{};
+    bool inputAgcEnabled_ = false;
     BeatMetrics metrics_{};
-    std::array<std::deque<BeatEvent>, 2> pendingEventsByChannel_;
     std::array<ChannelMetrics, 2> channelMetrics_{};
-    EnvelopeCalibrationStats lastEnvelopeCalibration_{};
     bool envelopeCalibrationActive_ = false;
-    bool newEnvelopeCalibrationAvailable_ = false;
+    std::uint64_t envelopeCalibrationRunId_ = 0;
 
     double totalSamplesProcessed_ = 0.0;
     float limiterReductionDb_ = 0.0f;
@@ -106,18 +434,75 @@ private:
     float envelopeMidAvg_ = 0.0f;
     float envelopeLongAvg_ = 0.0f;
     float bpmAvg_ = 0.0f;
-    double lastRealBeatSample_ = 0.0;
     double lastHealthUpdateSec_ = 0.0;
-    bool fallbackActive_ = false;
-    float fallbackBlend_ = 0.0f;
-    float fallbackEnvelope_ = 0.0f;
-    float fallbackBpm_ = 60.0f;
-    double lastFallbackEmitSec_ = 0.0;
+    // Per participant: beats detected on the input clock feed the predictors, which drive both
+    // the haptic pulses and the synthetic beats published through a dropout.
+    struct FallbackState {
+        double lastRealBeatSample = 0.0;
+        bool active = false;
+        float blend = 0.0f;
+        float envelope = 0.0f;
+        float envelopeAverage = 0.0f;
+        float bpm = 60.0f;
+        double lastEmitSec = 0.0;
+    };
+    std::array<FallbackState, 2> fallback_{};
+    std::array<BeatPredictor, 2> beatPredictors_{};
+    std::array<double, 2> lastObservedBeatSec_{};
+    std::array<double, 2> lastPulseBeatSec_{};
+    bool predictiveHaptics_ = false;
+    double hapticLeadSamples_ = 0.0;
+    // Input sample index of the latest audioIn() block; in a duplex callback it lines up with
+    // the start of the output block rendered next.
+    double inputBlockStartSample_ = 0.0;
     SignalHealth signalHealth_{};
     std::uint64_t legacySequenceCounter_ = 0;
+    std::uint64_t publishedBlocks_ = 0;
+    TripleBuffer<PipelineSnapshot> snapshots_;
 
+    void post(const PipelineCommand& command) { commands_.publish(command); }
+    void applyCommands();
+    void applyCommand(const PipelineCommand& command);
+    void beginCalibration();
+    void collectCalibrationResults();
+    void collectEnvelopeCalibration();
     void applyCalibration(float& ch1, float& ch2) const;
-    void ensureBufferSizes(std::size_t numFrames);
+    void processInputSlice(const float* input, std::size_t offset, std::size_t numFrames);
+    void resetBeatTracking();
+    void updateFallback(std::size_t channel, double nowSec, double deltaSec);
+    void scheduleHapticPulses(std::uint64_t blockStartSample, std::size_t numFrames);
+    void queueResynthesis(std::size_t channel, double timeSec, float envelope, float bpm);
+    void triggerResynthesis(std::uint64_t blockStartSample);
+    void writeOutputFrame(const float* stereo, const float* envelopes, float fade, const float* cue, float* out,
+                          std::size_t numChannels);
+    /// Calibration tone of the session through the regular output path (routing and fade, no limiter).
+    void renderCalibrationSignal(CalibrationSession& session, float* output, std::size_t numFrames,
+                                 std::size_t numChannels, const std::array<float, 2>& envelopes);
+    void publishClock(std::uint64_t micros);
+    void publishSnapshot(std::uint64_t blockStartSample);
+    void beginFadeBlock(std::uint64_t blockStartSample, std::size_t numFrames);
+    inline float nextOutputFade() {
+        if (!fadeRamping_) {
+            return outputFade_;
+        }
+        if (fadeDelay_ > 0) {
+            --fadeDelay_;
+            return outputFade_;
+        }
+        if (fadePosition_ == 0) {
+            fadeFrom_ = outputFade_;
+        }
+        ++fadePosition_;
+        if (fadePosition_ >= fadeLength_) {
+            outputFade_ = fadeTo_;
+            fadeRamping_ = false;
+            return outputFade_;
+        }
+        const float progress = static_cast<float>(fadePosition_) / static_cast<float>(fadeLength_);
+        const float eased = 0.5f - 0.5f * std::cos(progress * static_cast<float>(M_PI));
+        outputFade_ = fadeFrom_ + (fadeTo_ - fadeFrom_) * eased;
+        return outputFade_;
+    }
     static std::optional<std::size_t> participantIndex(ParticipantId id);
 };
 
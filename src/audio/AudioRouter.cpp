@@ -1,5 +1,6 @@
 #include "AudioRouter.h"
 
+#include "AudioLog.h"
 #include "SceneController.h"
 #include "Utility.h"
 
@@ -8,11 +9,6 @@
 #include <optional>
 #include <utility>
 
-#include "ofLog.h"
-#include "ofJson.h"
-#include "ofFileUtils.h"
-#include <glm/gtc/constants.hpp>
-
 namespace {
 
 std::optional<std::size_t> participantIndex(knot::audio::ParticipantId id) {
@@ -32,30 +28,48 @@ std::optional<std::size_t> participantIndex(knot::audio::ParticipantId id) {
 namespace knot::audio {
 
 namespace {
-
 constexpr float kDefaultSilentGainDb = -96.0f;
-constexpr float kHapticGain = 0.8f;
-constexpr float kHapticFrequencyHz = 50.0f;
+constexpr double kTwoPi = M_PI * 2.0;
+} // namespace
 
-RoutingRule makeSilentRule() {
+RoutingRule AudioRouter::silentRule() {
     RoutingRule rule;
     rule.source = ParticipantId::None;
     rule.mixMode = MixMode::Silent;
     rule.gainDb = kDefaultSilentGainDb;
     rule.panLR = 0.0f;
+    rule.azimuthDeg = 0.0f;
+    rule.elevationDeg = 0.0f;
+    rule.binaural = false;
     return rule;
 }
 
-} // namespace
-
 void AudioRouter::setup(float sampleRateHz) {
     sampleRateHz_ = std::max(sampleRateHz, 1.0f);
     hapticPhase_.fill(0.0);
+    hapticPulseLength_ = std::max<std::size_t>(2, static_cast<std::size_t>(kHapticPulseSec * sampleRateHz_));
+    hapticPulseAttack_ = std::clamp<std::size_t>(static_cast<std::size_t>(kHapticPulseAttackSec * sampleRateHz_), 1,
+                                                 hapticPulseLength_ - 1);
+    hapticPulseMode_.fill(false);
+    hapticPulses_.fill(HapticPulse{});
+    hapticPulseEnvelope_.fill(0.0f);
     clearRules();
+    // Called before the stream starts, so the audio-side state can be reset directly.
+    changeReader_.skipToLatest();
+    for (auto& pending : pending_) {
+        pending.valid = false;
+    }
+    switchBinauralStage();
+    liveRules_ = rules_;
+    previousRules_ = rules_;
+    resolveRules(liveRules_, resolved_);
+    previousResolved_ = resolved_;
+    crossfading_ = false;
 }
 
 void AudioRouter::setRoutingRule(OutputChannel channel, const RoutingRule& rule) {
     rules_[static_cast<std::size_t>(channel)] = rule;
+    publishRules(0, defaultCrossfadeSamples());
 }
 
 const RoutingRule& AudioRouter::routingRule(OutputChannel channel) const {
@@ -64,10 +78,10 @@ const RoutingRule& AudioRouter::routingRule(OutputChannel channel) const {
 
 void AudioRouter::setRule(OutputChannel channel, const RoutingRule& rule) {
     setRoutingRule(channel, rule);
-    ofLogNotice("AudioRouter") << "Rule updated: ch=" << static_cast<int>(channel)
-                               << " src=" << static_cast<int>(rule.source)
-                               << " mode=" << static_cast<int>(rule.mixMode)
-                               << " gain=" << rule.gainDb << "dB";
+    logNotice("AudioRouter") << "Rule updated: ch=" << static_cast<int>(channel)
+                             << " src=" << static_cast<int>(rule.source)
+                             << " mode=" << static_cast<int>(rule.mixMode)
+                             << " gain=" << rule.gainDb << "dB";
 }
 
 const RoutingRule& AudioRouter::rule(OutputChannel channel) const {
@@ -80,77 +94,8 @@ std::vector<RoutingRule> AudioRouter::rules() const {
 
 void AudioRouter::clearAllRules() {
     clearRules();
-    ofLogNotice("AudioRouter") << "All routing rules cleared";
-}
-
-void AudioRouter::restorePreset(SceneState scene) {
-    applyScenePreset(scene);
-}
-
-bool AudioRouter::savePreset(const std::string& presetName, const std::filesystem::path& file) const {
-    ofJson json;
-    if (std::filesystem::exists(file)) {
-        json = ofLoadJson(file.string());
-    }
-    if (!json.contains("presets") || !json["presets"].is_object()) {
-        json["presets"] = ofJson::object();
-    }
-    json["presets"][presetName] = ofJson::array();
-    for (std::size_t idx = 0; idx < rules_.size(); ++idx) {
-        const auto& rule = rules_[idx];
-        ofJson entry;
-        entry["channel"] = static_cast<int>(idx);
-        entry["source"] = static_cast<int>(rule.source);
-        entry["mode"] = static_cast<int>(rule.mixMode);
-        entry["gainDb"] = rule.gainDb;
-        entry["pan"] = rule.panLR;
-        json["presets"][presetName].push_back(entry);
-    }
-
-    std::error_code ec;
-    if (!file.parent_path().empty()) {
-        std::filesystem::create_directories(file.parent_path(), ec);
-    }
-    if (!ofSavePrettyJson(file.string(), json)) {
-        ofLogError("AudioRouter") << "Failed to save routing preset to " << file;
-        return false;
-    }
-    ofLogNotice("AudioRouter") << "Routing preset '" << presetName << "' saved to " << file;
-    return true;
-}
-
-bool AudioRouter::loadPreset(const std::string& presetName, const std::filesystem::path& file) {
-    if (!std::filesystem::exists(file)) {
-        ofLogError("AudioRouter") << "Preset file not found: " << file;
-        return false;
-    }
-
-    const ofJson json = ofLoadJson(file.string());
-    if (!json.contains("presets") || !json["presets"].contains(presetName)) {
-        ofLogError("AudioRouter") << "Preset '" << presetName << "' not defined in " << file;
-        return false;
-    }
-
-    clearRules();
-    for (const auto& entry : json["presets"][presetName]) {
-        if (!entry.contains("channel")) {
-            continue;
-        }
-        const auto channelIdx = static_cast<std::size_t>(entry.value("channel", 0));
-        if (channelIdx >= rules_.size()) {
-            continue;
-        }
-
-        RoutingRule rule;
-        rule.source = static_cast<ParticipantId>(entry.value("source", static_cast<int>(ParticipantId::None)));
-        rule.mixMode = static_cast<MixMode>(entry.value("mode", static_cast<int>(MixMode::Silent)));
-        rule.gainDb = entry.value("gainDb", kDefaultSilentGainDb);
-        rule.panLR = entry.value("pan", 0.0f);
-        rules_[channelIdx] = rule;
-    }
-
-    ofLogNotice("AudioRouter") << "Routing preset '" << presetName << "' loaded from " << file;
-    return true;
+    publishRules(0, defaultCrossfadeSamples());
+    logNotice("AudioRouter") << "All routing rules cleared";
 }
 
 std::size_t AudioRouter::activeRuleCount() const {
@@ -163,8 +108,23 @@ std::size_t AudioRouter::activeRuleCount() const {
     return count;
 }
 
-void AudioRouter::applyScenePreset(SceneState scene) {
-    clearRules();
+AudioRouter::RuleSet AudioRouter::scenePreset(SceneState scene) const {
+    if (scenePresets_) {
+        const auto it = scenePresets_->find(scene);
+        if (it != scenePresets_->end()) {
+            return it->second;
+        }
+    }
+    return builtInScenePreset(scene);
+}
+
+void AudioRouter::setScenePresets(std::shared_ptr<const ScenePresetTable> presets) {
+    scenePresets_ = std::move(presets);
+}
+
+AudioRouter::RuleSet AudioRouter::builtInScenePreset(SceneState scene) {
+    RuleSet rules;
+    rules.fill(silentRule());
 
     const auto assignRule = [&](OutputChannel channel, ParticipantId source, MixMode mixMode,
                                 float gainDb, float pan) {
@@ -173,7 +133,11 @@ void AudioRouter::applyScenePreset(SceneState scene) {
         rule.mixMode = mixMode;
         rule.gainDb = gainDb;
         rule.panLR = pan;
-        rules_[static_cast<std::size_t>(channel)] = rule;
+        // Headphone sources are placed on the horizontal plane, hard pan = 90 degrees.
+        rule.azimuthDeg = pan * 90.0f;
+        rule.elevationDeg = 0.0f;
+        rule.binaural = mixMode == MixMode::Self || mixMode == MixMode::Partner;
+        rules[static_cast<std::size_t>(channel)] = rule;
     };
 
     switch (scene) {
@@ -201,65 +165,345 @@ void AudioRouter::applyScenePreset(SceneState scene) {
             break;
     }
 
-    ofLogNotice("AudioRouter") << "Scene preset applied: " << sceneStateToString(scene);
+    return rules;
+}
+
+void AudioRouter::cancelScheduledRules() {
+    RoutingChange change;
+    change.type = RoutingChange::Type::CancelPending;
+    changes_.publish(change);
+}
+
+void AudioRouter::publishRules(std::uint64_t atSample, std::size_t crossfadeSamples) {
+    RoutingChange change;
+    change.rules = rules_;
+    change.atSample = atSample;
+    change.crossfadeSamples = static_cast<std::uint32_t>(crossfadeSamples);
+    changes_.publish(change);
+}
+
+std::size_t AudioRouter::defaultCrossfadeSamples() const {
+    return static_cast<std::size_t>(static_cast<double>(sampleRateHz_) * kDefaultCrossfadeSec);
 }
 
+
 void AudioRouter::route(const std::array<float, 2>& headphoneInput,
                         const std::array<float, 2>& inputEnvelopes,
                         std::array<float, 4>& outputBuffer) {
-    outputBuffer.fill(0.0f);
+    prepareBlock(routeSampleClock_++, 1);
+    routeFrame(headphoneInput.data(), inputEnvelopes.data(), 1.0f, nullptr, outputBuffer.data(),
+               outputBuffer.size());
+}
+
+void AudioRouter::setHrirDatabase(std::shared_ptr<const HrirDatabase> database) {
+    auto stage = std::make_unique<BinauralStage>();
+    stage->database = std::move(database);
+    for (auto& source : stage->sources) {
+        source.prepare(stage->database.get());
+    }
+    hrirDatabase_ = stage->database;
+
+    // The audio thread only moves forward through the published stages, so the ones before the
+    // stage it last acknowledged are never read again.
+    const BinauralStage* acknowledged = acknowledgedStage_.load(std::memory_order_acquire);
+    const auto current = std::find_if(binauralStages_.begin(), binauralStages_.end(),
+                                      [acknowledged](const auto& entry) { return entry.get() == acknowledged; });
+    if (current != binauralStages_.end()) {
+        binauralStages_.erase(binauralStages_.begin(), current);
+    }
+    binauralStages_.push_back(std::move(stage));
+    publishedStage_.store(binauralStages_.back().get(), std::memory_order_release);
 
-    for (std::size_t outputIdx = 0; outputIdx < rules_.size(); ++outputIdx) {
-        const auto& rule = rules_[outputIdx];
+    if (binauralAvailable()) {
+        logNotice("AudioRouter") << "Binaural rendering enabled for CH1/CH2 (latency "
+                                 << binauralStages_.back()->sources[0].latencySamples() << " samples)";
+    }
+}
+
+bool AudioRouter::switchBinauralStage() {
+    BinauralStage* published = publishedStage_.load(std::memory_order_acquire);
+    if (published == stage_) {
+        return false;
+    }
+    stage_ = published;
+    binauralReady_ = stage_ != nullptr && stage_->ready();
+    // The new convolvers start from silence at their rule's direction.
+    binauralActive_.fill(false);
+    acknowledgedStage_.store(published, std::memory_order_release);
+    return true;
+}
+
+void AudioRouter::prepareBlock(std::uint64_t blockStartSample, std::size_t numFrames) {
+    const std::uint64_t blockEnd = blockStartSample + numFrames;
+    blockStartSample_ = blockStartSample;
+    const bool stageSwitched = switchBinauralStage();
+    changeReader_.poll([&](const RoutingChange& change) {
+        if (change.type == RoutingChange::Type::CancelPending) {
+            for (auto& pending : pending_) {
+                pending.valid = false;
+            }
+            return;
+        }
+        for (auto& pending : pending_) {
+            if (!pending.valid) {
+                pending.change = change;
+                pending.valid = true;
+                return;
+            }
+        }
+    });
+
+    // Only the latest change due in this block matters; earlier ones would be crossfaded away
+    // before they were heard.
+    const PendingChange* due = nullptr;
+    for (auto& pending : pending_) {
+        if (!pending.valid || pending.change.atSample >= blockEnd) {
+            continue;
+        }
+        if (due == nullptr || pending.change.atSample >= due->change.atSample) {
+            due = &pending;
+        }
+    }
+    if (due != nullptr) {
+        const RoutingChange change = due->change;
+        for (auto& pending : pending_) {
+            if (pending.valid && pending.change.atSample <= change.atSample) {
+                pending.valid = false;
+            }
+        }
+        const std::uint64_t start = std::max(change.atSample, blockStartSample);
+        beginChange(change, static_cast<std::size_t>(start - blockStartSample));
+    } else if (stageSwitched) {
+        // A new HRIR set is applied like the live rules applied again: binaural rules crossfade
+        // between the direct and the binaural path instead of switching at once.
+        RoutingChange change;
+        change.rules = liveRules_;
+        change.atSample = blockStartSample;
+        change.crossfadeSamples = static_cast<std::uint32_t>(defaultCrossfadeSamples());
+        beginChange(change, 0);
+    } else {
+        resolveRules(liveRules_, resolved_);
+    }
+    if (stageSwitched && !binauralReady_) {
+        // The convolvers the outgoing routing used are gone; it fades out on the direct path.
+        for (auto& previous : previousResolved_) {
+            previous.binaural = false;
+        }
+    }
+
+    hapticNeeded_.fill(false);
+    const auto markHaptic = [&](const ResolvedRule& resolved) {
+        if (resolved.mixMode == MixMode::Haptic && resolved.participant >= 0) {
+            hapticNeeded_[static_cast<std::size_t>(resolved.participant)] = true;
+        }
+    };
+    for (std::size_t outputIdx = 0; outputIdx < kOutputChannels; ++outputIdx) {
+        markHaptic(resolved_[outputIdx]);
+        if (crossfading_) {
+            markHaptic(previousResolved_[outputIdx]);
+        }
+    }
+
+    for (std::size_t outputIdx = 0; outputIdx < kBinauralSources; ++outputIdx) {
+        const bool current = resolved_[outputIdx].binaural;
+        const bool previous = crossfading_ && previousResolved_[outputIdx].binaural;
+        if (!current && !previous) {
+            binauralActive_[outputIdx] = false;
+            continue;
+        }
+        // Binaural rules only resolve while the stage is ready.
+        auto& source = stage_->sources[outputIdx];
+        const auto& rule = current ? liveRules_[outputIdx] : previousRules_[outputIdx];
+        if (!binauralActive_[outputIdx]) {
+            // Start from silence and jump straight to the direction; nothing to crossfade from.
+            source.reset();
+            source.setDirection(rule.azimuthDeg, rule.elevationDeg);
+            binauralActive_[outputIdx] = true;
+        } else if (rule.azimuthDeg != binauralAzimuth_[outputIdx] ||
+                   rule.elevationDeg != binauralElevation_[outputIdx]) {
+            source.setDirection(rule.azimuthDeg, rule.elevationDeg);
+        }
+        binauralAzimuth_[outputIdx] = rule.azimuthDeg;
+        binauralElevation_[outputIdx] = rule.elevationDeg;
+    }
+}
+
+void AudioRouter::beginChange(const RoutingChange& change, std::size_t offsetInBlock) {
+    // A change that lands mid-crossfade restarts the fade from the routing currently dominant.
+    // resolved_ still holds the live rules as resolved against the HRIR set they were heard with.
+    previousRules_ = liveRules_;
+    previousResolved_ = resolved_;
+    liveRules_ = change.rules;
+    resolveRules(liveRules_, resolved_);
+    crossfading_ = true;
+    crossfadeDelay_ = offsetInBlock;
+    crossfadeMix_ = 0.0f;
+    crossfadeStep_ = 1.0f / static_cast<float>(std::max<std::uint32_t>(change.crossfadeSamples, 1));
+}
+
+void AudioRouter::resolveRules(const RuleSet& rules, std::array<ResolvedRule, kOutputChannels>& resolved) const {
+    for (std::size_t outputIdx = 0; outputIdx < rules.size(); ++outputIdx) {
+        const auto& rule = rules[outputIdx];
+        auto& entry = resolved[outputIdx];
         const auto participant = participantIndex(rule.source);
         if (!participant || rule.mixMode == MixMode::Silent) {
-            outputBuffer[outputIdx] = 0.0f;
+            entry = {};
             continue;
         }
+        entry.participant = static_cast<int>(*participant);
+        entry.mixMode = rule.mixMode;
+        entry.gainLinear = dbToLinear(rule.gainDb);
+        entry.binaural = binauralReady_ && rule.binaural && outputIdx < kBinauralSources &&
+                         (rule.mixMode == MixMode::Self || rule.mixMode == MixMode::Partner);
+    }
+}
+
+void AudioRouter::routeFrame(const float* headphoneInput, const float* inputEnvelopes, float outputGain,
+                             const float* cue, float* out, std::size_t numOutputs) {
+    const std::size_t count = std::min(numOutputs, resolved_.size());
+    std::fill(out, out + count, 0.0f);
+
+    float currentWeight = 1.0f;
+    if (crossfading_) {
+        if (crossfadeDelay_ > 0) {
+            --crossfadeDelay_;
+            currentWeight = 0.0f;
+        } else {
+            crossfadeMix_ = std::min(crossfadeMix_ + crossfadeStep_, 1.0f);
+            currentWeight = crossfadeMix_;
+        }
+    }
+    for (std::size_t participant = 0; participant < hapticCarrier_.size(); ++participant) {
+        if (hapticNeeded_[participant]) {
+            hapticCarrier_[participant] = advanceHapticCarrier(participant);
+        }
+        if (hapticPulseMode_[participant]) {
+            hapticPulseEnvelope_[participant] = advanceHapticPulse(participant);
+        }
+    }
 
+    std::array<float, kBinauralSources> binauralInput{};
+    const auto mixRule = [&](const ResolvedRule& resolved, std::size_t outputIdx, float weight) {
+        if (resolved.participant < 0 || weight <= 0.0f) {
+            return;
+        }
+        const auto participant = static_cast<std::size_t>(resolved.participant);
         float sample = 0.0f;
-        switch (rule.mixMode) {
+        switch (resolved.mixMode) {
             case MixMode::Self:
             case MixMode::Partner:
-                sample = headphoneInput[*participant];
+                sample = headphoneInput[participant];
                 break;
-            case MixMode::Haptic:
-                sample = generateHapticSample(inputEnvelopes[*participant], rule.source);
+            case MixMode::Haptic: {
+                const float envelope = hapticPulseMode_[participant] ? hapticPulseEnvelope_[participant]
+                                                                     : inputEnvelopes[participant];
+                sample = hapticCarrier_[participant] * std::clamp(envelope, 0.0f, 1.0f) * kHapticGain;
                 break;
+            }
             case MixMode::Silent:
             default:
-                sample = 0.0f;
                 break;
         }
-
-        const float gainLinear = dbToLinear(rule.gainDb);
-        outputBuffer[outputIdx] = sample * gainLinear;
+        sample *= resolved.gainLinear * outputGain * weight;
+        if (resolved.binaural) {
+            binauralInput[outputIdx] += sample;
+        } else {
+            out[outputIdx] += sample;
+        }
+    };
+    for (std::size_t outputIdx = 0; outputIdx < count; ++outputIdx) {
+        mixRule(resolved_[outputIdx], outputIdx, currentWeight);
+        if (crossfading_) {
+            mixRule(previousResolved_[outputIdx], outputIdx, 1.0f - currentWeight);
+        }
+    }
+    for (std::size_t source = 0; source < kBinauralSources; ++source) {
+        if (!binauralActive_[source]) {
+            continue;
+        }
+        float left = 0.0f;
+        float right = 0.0f;
+        stage_->sources[source].process(binauralInput[source], left, right);
+        out[0] += left;
+        if (count > 1) {
+            out[1] += right;
+        }
+    }
+    if (crossfading_ && currentWeight >= 1.0f) {
+        crossfading_ = false;
     }
-}
 
-float AudioRouter::generateHapticSample(float envelope, ParticipantId id) {
-    const auto idx = participantIndex(id);
-    if (!idx) {
-        return 0.0f;
+    if (cue) {
+        for (std::size_t channel = 0; channel < std::min<std::size_t>(count, 2); ++channel) {
+            out[channel] += cue[channel];
+        }
     }
+}
 
+float AudioRouter::advanceHapticCarrier(std::size_t participant) {
     const double phaseIncrement = static_cast<double>(kHapticFrequencyHz) /
                                   std::max(1.0, static_cast<double>(sampleRateHz_));
-    double phase = hapticPhase_[*idx];
-    const float sineSample = std::sin(static_cast<float>(phase * glm::two_pi<double>()));
+    double phase = hapticPhase_[participant];
+    const float sineSample = std::sin(static_cast<float>(phase * kTwoPi));
     phase += phaseIncrement;
     if (phase >= 1.0) {
         phase -= 1.0;
     }
-    hapticPhase_[*idx] = phase;
+    hapticPhase_[participant] = phase;
+    return sineSample;
+}
+
+void AudioRouter::setHapticPulseMode(std::size_t participant, bool enabled) {
+    if (participant >= hapticPulseMode_.size() || hapticPulseMode_[participant] == enabled) {
+        return;
+    }
+    hapticPulseMode_[participant] = enabled;
+    hapticPulses_[participant] = {};
+    hapticPulseEnvelope_[participant] = 0.0f;
+}
 
-    const float clampedEnvelope = std::clamp(envelope, 0.0f, 1.0f);
-    return sineSample * clampedEnvelope * kHapticGain;
+void AudioRouter::scheduleHapticPulse(std::size_t participant, std::uint64_t atSample, float amplitude) {
+    if (participant >= hapticPulses_.size()) {
+        return;
+    }
+    auto& pulse = hapticPulses_[participant];
+    pulse.pending = true;
+    pulse.delay = atSample > blockStartSample_ ? static_cast<std::size_t>(atSample - blockStartSample_) : 0;
+    pulse.nextAmplitude = std::clamp(amplitude, 0.0f, 1.0f);
+}
+
+float AudioRouter::advanceHapticPulse(std::size_t participant) {
+    auto& pulse = hapticPulses_[participant];
+    if (pulse.pending) {
+        if (pulse.delay > 0) {
+            --pulse.delay;
+        } else {
+            pulse.pending = false;
+            pulse.playing = true;
+            pulse.position = 0;
+            pulse.amplitude = pulse.nextAmplitude;
+        }
+    }
+    if (!pulse.playing) {
+        return 0.0f;
+    }
+    const std::size_t position = pulse.position++;
+    if (pulse.position >= hapticPulseLength_) {
+        pulse.playing = false;
+    }
+    // Raised-cosine rise, then a cosine-squared decay to zero at the end of the pulse.
+    const auto halfPi = static_cast<float>(M_PI * 0.5);
+    const float shape =
+        position < hapticPulseAttack_
+            ? std::sin(halfPi * static_cast<float>(position) / static_cast<float>(hapticPulseAttack_))
+            : std::cos(halfPi * static_cast<float>(position - hapticPulseAttack_) /
+                       static_cast<float>(hapticPulseLength_ - hapticPulseAttack_));
+    return pulse.amplitude * shape * shape;
 }
 
 void AudioRouter::clearRules() {
     for (auto& rule : rules_) {
-        rule = makeSilentRule();
+        rule = silentRule();
     }
 }
 
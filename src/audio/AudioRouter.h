@@ -1,10 +1,16 @@
 #pragma once
 
+#include "BinauralConvolver.h"
+#include "EventBus.h"
+#include "HrirDatabase.h"
 #include "ParticipantId.h"
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -31,10 +37,48 @@ struct RoutingRule {
     MixMode mixMode = MixMode::Silent;
     float gainDb = -12.0f;
     float panLR = 0.0f;
+    /// Source direction for binaural rendering on CH1/CH2 (degrees, +azimuth = right).
+    float azimuthDeg = 0.0f;
+    float elevationDeg = 0.0f;
+    /// Self/Partner rules on CH1/CH2 with this set are rendered through the HRIR set onto both
+    /// headphone channels instead of feeding their own channel directly.
+    bool binaural = false;
 };
 
+/// Mixes the two inputs onto the headphone and haptic outputs by per-channel rules. The rendering
+/// path is plain C++; preset files and the named scene presets (AudioRouterPresets.cpp) use
+/// openFrameworks and are left out of headless builds (KNOT_AUDIO_HEADLESS).
 class AudioRouter {
 public:
+    static constexpr std::size_t kOutputChannels = 4;
+    /// Crossfade used when a rule change does not specify one.
+    static constexpr double kDefaultCrossfadeSec = 0.05;
+    /// Haptic mix: a carrier at kHapticFrequencyHz scaled by the participant's envelope.
+    static constexpr float kHapticFrequencyHz = 50.0f;
+    static constexpr float kHapticGain = 0.8f;
+    /// Predictive haptics: each scheduled pulse rises over kHapticPulseAttackSec and has decayed
+    /// to silence kHapticPulseSec after it starts, roughly the envelope of one heart sound.
+    static constexpr double kHapticPulseSec = 0.12;
+    static constexpr double kHapticPulseAttackSec = 0.008;
+
+    using RuleSet = std::array<RoutingRule, kOutputChannels>;
+    /// Per-scene rule sets that override the built-in scene presets.
+    using ScenePresetTable = std::map<SceneState, RuleSet>;
+
+    /// Rule set handed from the UI thread to the audio thread, effective at an absolute output
+    /// sample index (0 = next block).
+    struct RoutingChange {
+        enum class Type : std::uint8_t {
+            Apply,
+            CancelPending
+        };
+        Type type = Type::Apply;
+        RuleSet rules{};
+        std::uint64_t atSample = 0;
+        std::uint32_t crossfadeSamples = 0;
+    };
+    using RoutingChangeBus = EventBus<RoutingChange, 16>;
+
     void setup(float sampleRateHz);
     void setRoutingRule(OutputChannel channel, const RoutingRule& rule);
     const RoutingRule& routingRule(OutputChannel channel) const;
@@ -47,19 +91,134 @@ public:
     bool loadPreset(const std::string& presetName, const std::filesystem::path& file);
     std::size_t activeRuleCount() const;
 
+    /// Replaces the rules with the scene preset and crossfades to it at the next block.
     void applyScenePreset(SceneState scene);
+    /// Same as applyScenePreset() but takes effect exactly at atSample on the output clock.
+    void scheduleScenePreset(SceneState scene, std::uint64_t atSample, std::size_t crossfadeSamples);
+    /// Drops scheduled rule changes that have not taken effect yet.
+    void cancelScheduledRules();
+    /// Rule set for a scene: the loaded override when there is one, else the built-in preset.
+    RuleSet scenePreset(SceneState scene) const;
+    static RuleSet builtInScenePreset(SceneState scene);
+    /// Rule that outputs nothing (no source, Silent, -96 dB).
+    static RoutingRule silentRule();
+
+    /// Parses and validates a preset file whose preset names are scene names (same format as
+    /// savePreset()). Safe to call from any thread; returns nullptr with a reason on failure.
+    static std::shared_ptr<const ScenePresetTable> loadScenePresets(const std::filesystem::path& file,
+                                                                    std::string& error);
+    /// UI thread. Swaps in a new override table; nullptr restores the built-in presets.
+    void setScenePresets(std::shared_ptr<const ScenePresetTable> presets);
+
+    /// UI thread, also while audio runs. Enables binaural rendering for CH1/CH2 rules flagged
+    /// `binaural`; nullptr (or an empty set) falls back to direct routing. The convolvers are
+    /// prepared here and handed to the audio thread by a pointer swap, which prepareBlock()
+    /// picks up at the next block boundary and crossfades to like a rule change, so nothing
+    /// allocates or locks on the audio thread and no rule switches path abruptly. Sets replaced
+    /// earlier are freed by the next call, once the audio thread has moved past them.
+    void setHrirDatabase(std::shared_ptr<const HrirDatabase> database);
+    bool binauralAvailable() const { return hrirDatabase_ != nullptr && !hrirDatabase_->empty(); }
 
     void route(const std::array<float, 2>& headphoneInput,
                const std::array<float, 2>& inputEnvelopes,
-               std::array<float, 4>& outputBuffer);
+                std::array<float, 4>& outputBuffer);
+
+    /// Audio thread. Takes rule changes due in [blockStartSample, blockStartSample + numFrames)
+    /// and resolves the live rules into per-channel source indices and linear gains. A change
+    /// swaps the rule set at this block boundary; the crossfade from the old routing starts at
+    /// the change's exact sample within the block. Call once per block before routeFrame().
+    void prepareBlock(std::uint64_t blockStartSample, std::size_t numFrames);
+    /// Routes one frame into the first numOutputs (<= kOutputChannels) samples of out, scaled by
+    /// outputGain. Uses the rules captured by the last prepareBlock(). cue (stereo, optional) is
+    /// added to CH1/CH2 independent of the scene rules and the output fade.
+    void routeFrame(const float* headphoneInput, const float* inputEnvelopes, float outputGain,
+                    const float* cue, float* out, std::size_t numOutputs);
+    /// Audio thread. Switches the participant's Haptic rules between following the live envelope
+    /// (the default) and playing the pulses started by scheduleHapticPulse().
+    void setHapticPulseMode(std::size_t participant, bool enabled);
+    /// Audio thread, after prepareBlock() and before that block's routeFrame() calls. Starts one
+    /// pulse of peak amplitude (0..1) for the participant at atSample on the output clock; a
+    /// sample before the block starts it on the block's first frame. A playing pulse restarts.
+    void scheduleHapticPulse(std::size_t participant, std::uint64_t atSample, float amplitude);
 
 private:
-    std::array<RoutingRule, 4> rules_{};
+    static constexpr std::size_t kBinauralSources = 2;
+
+    /// An HRIR set with the convolvers prepared for it. Built and freed on the UI thread.
+    struct BinauralStage {
+        std::shared_ptr<const HrirDatabase> database;
+        std::array<BinauralConvolver, kBinauralSources> sources{};
+
+        bool ready() const { return database != nullptr && !database->empty(); }
+    };
+
+    struct ResolvedRule {
+        int participant = -1;
+        MixMode mixMode = MixMode::Silent;
+        float gainLinear = 0.0f;
+        bool binaural = false;
+    };
+
+    struct PendingChange {
+        RoutingChange change;
+        bool valid = false;
+    };
+
+    struct HapticPulse {
+        bool pending = false;
+        bool playing = false;
+        std::size_t delay = 0;
+        std::size_t position = 0;
+        float nextAmplitude = 0.0f;
+        float amplitude = 0.0f;
+    };
+
+    // UI thread: the most recently committed rule set (what rule()/rules()/savePreset() see).
+    RuleSet rules_{};
+    std::shared_ptr<const ScenePresetTable> scenePresets_;
     float sampleRateHz_ = 48000.0f;
+    RoutingChangeBus changes_;
+    RoutingChangeBus::Subscriber changeReader_ = changes_.subscribe();
+    std::shared_ptr<const HrirDatabase> hrirDatabase_;
+    // Every stage handed out, oldest first; those before acknowledgedStage_ are unreachable.
+    std::vector<std::unique_ptr<BinauralStage>> binauralStages_;
+    std::atomic<BinauralStage*> publishedStage_{nullptr};
+    std::atomic<BinauralStage*> acknowledgedStage_{nullptr};
+
+    // Audio thread.
+    RuleSet liveRules_{};
+    RuleSet previousRules_{};
+    std::array<ResolvedRule, kOutputChannels> resolved_{};
+    std::array<ResolvedRule, kOutputChannels> previousResolved_{};
+    std::array<PendingChange, RoutingChangeBus::capacity()> pending_{};
+    bool crossfading_ = false;
+    std::size_t crossfadeDelay_ = 0;
+    float crossfadeMix_ = 1.0f;
+    float crossfadeStep_ = 1.0f;
+    std::uint64_t routeSampleClock_ = 0;
     std::array<double, 2> hapticPhase_{{0.0, 0.0}};
+    std::array<float, 2> hapticCarrier_{};
+    std::array<bool, 2> hapticNeeded_{};
+    std::uint64_t blockStartSample_ = 0;
+    std::array<bool, 2> hapticPulseMode_{};
+    std::array<HapticPulse, 2> hapticPulses_{};
+    std::array<float, 2> hapticPulseEnvelope_{};
+    std::size_t hapticPulseLength_ = 1;
+    std::size_t hapticPulseAttack_ = 1;
+    BinauralStage* stage_ = nullptr;
+    bool binauralReady_ = false;
+    std::array<bool, kBinauralSources> binauralActive_{};
+    std::array<float, kBinauralSources> binauralAzimuth_{};
+    std::array<float, kBinauralSources> binauralElevation_{};
 
     void clearRules();
-    float generateHapticSample(float envelope, ParticipantId id);
+    void publishRules(std::uint64_t atSample, std::size_t crossfadeSamples);
+    std::size_t defaultCrossfadeSamples() const;
+    void beginChange(const RoutingChange& change, std::size_t offsetInBlock);
+    bool switchBinauralStage();
+    void resolveRules(const RuleSet& rules, std::array<ResolvedRule, kOutputChannels>& resolved) const;
+    float advanceHapticCarrier(std::size_t participant);
+    float advanceHapticPulse(std::size_t participant);
 };
 
 } // namespace knot::audio
@@ -0,0 +1,181 @@
+#include "AudioRouter.h"
+
+#include "SceneController.h"
+
+#include <cmath>
+
+#include "ofLog.h"
+#include "ofJson.h"
+#include "ofFileUtils.h"
+
+namespace knot::audio {
+
+namespace {
+
+constexpr float kMinRuleGainDb = -96.0f;
+constexpr float kMaxRuleGainDb = 12.0f;
+
+/// Parses one preset (array of per-channel entries) into rules. Unlisted channels stay silent.
+bool parseRuleEntries(const ofJson& entries, AudioRouter::RuleSet& rules, std::string& error) {
+    rules.fill(AudioRouter::silentRule());
+    if (!entries.is_array()) {
+        error = "preset must be an array of channel entries";
+        return false;
+    }
+    for (const auto& entry : entries) {
+        if (!entry.contains("channel")) {
+            continue;
+        }
+        const int channel = entry.value("channel", -1);
+        if (channel < 0 || channel >= static_cast<int>(rules.size())) {
+            error = "channel out of range: " + std::to_string(channel);
+            return false;
+        }
+        RoutingRule rule;
+        const int source = entry.value("source", static_cast<int>(ParticipantId::None));
+        const int mode = entry.value("mode", static_cast<int>(MixMode::Silent));
+        if (source != static_cast<int>(ParticipantId::Participant1) &&
+            source != static_cast<int>(ParticipantId::Participant2) &&
+            source != static_cast<int>(ParticipantId::Synthetic) && source != static_cast<int>(ParticipantId::None)) {
+            error = "unknown source " + std::to_string(source) + " on channel " + std::to_string(channel);
+            return false;
+        }
+        if (mode < static_cast<int>(MixMode::Self) || mode > static_cast<int>(MixMode::Silent)) {
+            error = "unknown mode " + std::to_string(mode) + " on channel " + std::to_string(channel);
+            return false;
+        }
+        rule.source = static_cast<ParticipantId>(source);
+        rule.mixMode = static_cast<MixMode>(mode);
+        rule.gainDb = entry.value("gainDb", AudioRouter::silentRule().gainDb);
+        rule.panLR = entry.value("pan", 0.0f);
+        rule.azimuthDeg = entry.value("azimuth", rule.panLR * 90.0f);
+        rule.elevationDeg = entry.value("elevation", 0.0f);
+        rule.binaural = entry.value("binaural", false);
+        if (!std::isfinite(rule.gainDb) || rule.gainDb < kMinRuleGainDb || rule.gainDb > kMaxRuleGainDb) {
+            error = "gainDb out of range on channel " + std::to_string(channel);
+            return false;
+        }
+        if (!std::isfinite(rule.panLR) || std::fabs(rule.panLR) > 1.0f || !std::isfinite(rule.azimuthDeg) ||
+            std::fabs(rule.azimuthDeg) > 180.0f || !std::isfinite(rule.elevationDeg) ||
+            std::fabs(rule.elevationDeg) > 90.0f) {
+            error = "pan/azimuth/elevation out of range on channel " + std::to_string(channel);
+            return false;
+        }
+        rules[static_cast<std::size_t>(channel)] = rule;
+    }
+    return true;
+}
+
+} // namespace
+
+void AudioRouter::restorePreset(SceneState scene) {
+    applyScenePreset(scene);
+}
+
+bool AudioRouter::savePreset(const std::string& presetName, const std::filesystem::path& file) const {
+    ofJson json;
+    if (std::filesystem::exists(file)) {
+        json = ofLoadJson(file.string());
+    }
+    if (!json.contains("presets") || !json["presets"].is_object()) {
+        json["presets"] = ofJson::object();
+    }
+    json["presets"][presetName] = ofJson::array();
+    for (std::size_t idx = 0; idx < rules_.size(); ++idx) {
+        const auto& rule = rules_[idx];
+        ofJson entry;
+        entry["channel"] = static_cast<int>(idx);
+        entry["source"] = static_cast<int>(rule.source);
+        entry["mode"] = static_cast<int>(rule.mixMode);
+        entry["gainDb"] = rule.gainDb;
+        entry["pan"] = rule.panLR;
+        entry["azimuth"] = rule.azimuthDeg;
+        entry["elevation"] = rule.elevationDeg;
+        entry["binaural"] = rule.binaural;
+        json["presets"][presetName].push_back(entry);
+    }
+
+    std::error_code ec;
+    if (!file.parent_path().empty()) {
+        std::filesystem::create_directories(file.parent_path(), ec);
+    }
+    if (!ofSavePrettyJson(file.string(), json)) {
+        ofLogError("AudioRouter") << "Failed to save routing preset to " << file;
+        return false;
+    }
+    ofLogNotice("AudioRouter") << "Routing preset '" << presetName << "' saved to " << file;
+    return true;
+}
+
+bool AudioRouter::loadPreset(const std::string& presetName, const std::filesystem::path& file) {
+    if (!std::filesystem::exists(file)) {
+        ofLogError("AudioRouter") << "Preset file not found: " << file;
+        return false;
+    }
+
+    const ofJson json = ofLoadJson(file.string());
+    if (!json.contains("presets") || !json["presets"].contains(presetName)) {
+        ofLogError("AudioRouter") << "Preset '" << presetName << "' not defined in " << file;
+        return false;
+    }
+
+    RuleSet rules;
+    std::string error;
+    if (!parseRuleEntries(json["presets"][presetName], rules, error)) {
+        ofLogError("AudioRouter") << "Preset '" << presetName << "' in " << file << " rejected: " << error;
+        return false;
+    }
+    rules_ = rules;
+    publishRules(0, defaultCrossfadeSamples());
+
+    ofLogNotice("AudioRouter") << "Routing preset '" << presetName << "' loaded from " << file;
+    return true;
+}
+
+std::shared_ptr<const AudioRouter::ScenePresetTable> AudioRouter::loadScenePresets(const std::filesystem::path& file,
+                                                                                   std::string& error) {
+    if (!std::filesystem::exists(file)) {
+        error = "preset file not found: " + file.string();
+        return nullptr;
+    }
+    auto table = std::make_shared<ScenePresetTable>();
+    try {
+        const ofJson json = ofLoadJson(file.string());
+        if (!json.is_object() || !json.contains("presets") || !json["presets"].is_object()) {
+            error = "expected an object with a \"presets\" object";
+            return nullptr;
+        }
+        for (const auto& [name, entries] : json["presets"].items()) {
+            const auto scene = sceneStateFromString(name);
+            if (!scene) {
+                // Named presets for loadPreset() may share the file; only scene names override.
+                continue;
+            }
+            RuleSet rules;
+            if (!parseRuleEntries(entries, rules, error)) {
+                error = name + ": " + error;
+                return nullptr;
+            }
+            table->emplace(*scene, rules);
+        }
+    } catch (const std::exception& ex) {
+        error = ex.what();
+        return nullptr;
+    }
+    return table;
+}
+
+void AudioRouter::applyScenePreset(SceneState scene) {
+    rules_ = scenePreset(scene);
+    publishRules(0, defaultCrossfadeSamples());
+    ofLogNotice("AudioRouter") << "Scene preset applied: " << sceneStateToString(scene);
+}
+
+void AudioRouter::scheduleScenePreset(SceneState scene, std::uint64_t atSample, std::size_t crossfadeSamples) {
+    rules_ = scenePreset(scene);
+    publishRules(atSample, crossfadeSamples);
+    ofLogNotice("AudioRouter") << "Scene preset scheduled: " << sceneStateToString(scene) << " at sample "
+                               << atSample;
+}
+
+} // namespace knot::audio
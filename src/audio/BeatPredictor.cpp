@@ -0,0 +1,214 @@
+#include "BeatPredictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+namespace {
+// Detector timing jitter on a single trigger.
+constexpr double kMeasurementSigmaSec = 0.01;
+// Per-beat process noise: beat-to-beat variability of the heart on top of the period, and drift
+// of the period itself.
+constexpr double kPhaseSigmaSec = 0.02;
+constexpr double kPeriodSigmaSec = 0.01;
+constexpr double kInitialPeriodSigmaSec = 0.05;
+// Triggers within this window of a prediction are always accepted, however tight the filter is.
+constexpr double kMinGateSec = 0.08;
+constexpr double kGateSigmas = 3.0;
+// A gap of more beats than this is a new start rather than missed beats.
+constexpr double kMaxMissedBeats = 4.0;
+// Start-up: consecutive intervals this close (relative) lock the filter.
+constexpr double kLockTolerance = 0.2;
+constexpr std::size_t kMaxSkippedAccepts = 3;
+constexpr std::size_t kMaxHalfwayPeriods = 2;
+constexpr float kAmplitudeSmoothing = 0.3f;
+constexpr double kCoastDecaySec = 8.0;
+constexpr float kMinCoastConfidence = 0.3f;
+
+bool plausibleInterval(double intervalSec) {
+    return intervalSec >= BeatPredictor::kMinPeriodSec && intervalSec <= BeatPredictor::kMaxPeriodSec;
+}
+} // namespace
+
+void BeatPredictor::reset() {
+    locked_ = false;
+    candidates_.fill(0.0);
+    candidateCount_ = 0;
+    lastAcceptedSec_ = 0.0;
+    skippedAccepts_ = 0;
+    skippedSteps_ = 0.0;
+    halfwayPeriods_ = 0;
+    lastHalfwaySec_ = 0.0;
+    beatPeak_ = 0.0f;
+    beatSec_ = 0.0;
+    periodSec_ = 1.0;
+    p00_ = 0.0;
+    p01_ = 0.0;
+    p11_ = 0.0;
+    rejections_ = 0;
+    prediction_ = {};
+}
+
+void BeatPredictor::lock(double previousSec, double timeSec, double periodSec) {
+    constexpr double r = kMeasurementSigmaSec * kMeasurementSigmaSec;
+    locked_ = true;
+    candidateCount_ = 0;
+    rejections_ = 0;
+    skippedAccepts_ = 0;
+    skippedSteps_ = 0.0;
+    halfwayPeriods_ = 0;
+    lastHalfwaySec_ = 0.0;
+    lastAcceptedSec_ = timeSec;
+    beatSec_ = timeSec;
+    periodSec_ = std::clamp(periodSec, kMinPeriodSec, kMaxPeriodSec);
+    // The period comes from differences of noisy triggers and shares the last one's error.
+    p00_ = r;
+    p01_ = r * periodSec_ / std::max(timeSec - previousSec, periodSec_);
+    p11_ = kInitialPeriodSigmaSec * kInitialPeriodSigmaSec;
+    prediction_.amplitude = beatPeak_;
+    beatPeak_ = 0.0f;
+}
+
+void BeatPredictor::foldBeatPeak() {
+    prediction_.amplitude += kAmplitudeSmoothing * (beatPeak_ - prediction_.amplitude);
+    beatPeak_ = 0.0f;
+}
+
+void BeatPredictor::trackEnvelope(float envelope) {
+    beatPeak_ = std::max(beatPeak_, envelope);
+}
+
+bool BeatPredictor::addCandidate(double timeSec) {
+    if (candidateCount_ == candidates_.size()) {
+        const double first = candidates_[0];
+        const double second = candidates_[1];
+        const double earlier = second - first;
+        const double later = timeSec - second;
+        if (plausibleInterval(earlier) && plausibleInterval(later) &&
+            std::fabs(later - earlier) <= kLockTolerance * std::max(earlier, later)) {
+            lock(first, timeSec, 0.5 * (timeSec - first));
+            return true;
+        }
+        candidates_[0] = second;
+        candidates_[1] = timeSec;
+        return false;
+    }
+    candidates_[candidateCount_++] = timeSec;
+    return false;
+}
+
+bool BeatPredictor::observe(double timeSec) {
+    if (!locked_) {
+        const bool locked = addCandidate(timeSec);
+        advance(timeSec);
+        return locked;
+    }
+
+    const double steps = std::round((timeSec - beatSec_) / periodSec_);
+    if (steps > kMaxMissedBeats) {
+        // Too long since the last beat to trust the phase; start over from this trigger.
+        locked_ = false;
+        candidateCount_ = 0;
+        addCandidate(timeSec);
+        advance(timeSec);
+        return false;
+    }
+
+    // Predict n beats ahead (n > 1 when beats were missed): F = [[1, n], [0, 1]].
+    const double n = std::max(steps, 1.0);
+    const double p00 = p00_ + 2.0 * n * p01_ + n * n * p11_ + n * kPhaseSigmaSec * kPhaseSigmaSec;
+    const double p01 = p01_ + n * p11_;
+    const double p11 = p11_ + n * kPeriodSigmaSec * kPeriodSigmaSec;
+    const double innovation = timeSec - (beatSec_ + n * periodSec_);
+    const double s = p00 + kMeasurementSigmaSec * kMeasurementSigmaSec;
+    const double gate = std::max(kMinGateSec, kGateSigmas * std::sqrt(s));
+    // steps == 0: a second trigger on the beat just tracked (S2, a knock on the stethoscope).
+    if (steps < 1.0 || std::fabs(innovation) > gate) {
+        // Evenly splitting the interval between two predictions, one period after the last such
+        // trigger: the lock is on twice the period. Counted whether or not the beats on the
+        // predictions were caught, since those are the ones a double lock loses. (S2 falls well
+        // before halfway and does not split the interval evenly.)
+        const double phase = (timeSec - beatSec_) / periodSec_;
+        const double earlier = (phase - std::floor(phase)) * periodSec_;
+        const double later = periodSec_ - earlier;
+        if (std::fabs(later - earlier) <= kLockTolerance * std::max(earlier, later)) {
+            const double sinceHalfway = timeSec - lastHalfwaySec_;
+            const bool nextPeriod =
+                halfwayPeriods_ > 0 && std::fabs(sinceHalfway - periodSec_) <= kLockTolerance * periodSec_;
+            halfwayPeriods_ = nextPeriod ? halfwayPeriods_ + 1 : 1;
+            lastHalfwaySec_ = timeSec;
+            const double halfPeriod = 0.5 * periodSec_;
+            if (halfwayPeriods_ >= kMaxHalfwayPeriods && plausibleInterval(halfPeriod)) {
+                lock(timeSec - halfPeriod, timeSec, halfPeriod);
+                advance(timeSec);
+                return true;
+            }
+        }
+        addCandidate(timeSec);
+        if (++rejections_ >= kMaxRejections) {
+            // Consistently off the prediction: the tempo has moved beyond what the gate follows.
+            // The rejected triggers lock again as soon as they are evenly spaced.
+            locked_ = false;
+        }
+        advance(timeSec);
+        return false;
+    }
+
+    // Accepted beats that keep skipping the same number of predictions mean the lock is on a
+    // fraction of the period; gaps of varying length are missed beats.
+    if (steps < 2.0) {
+        skippedAccepts_ = 0;
+    } else {
+        skippedAccepts_ = skippedAccepts_ > 0 && steps == skippedSteps_ ? skippedAccepts_ + 1 : 1;
+    }
+    skippedSteps_ = steps;
+    if (skippedAccepts_ >= kMaxSkippedAccepts && plausibleInterval(timeSec - lastAcceptedSec_)) {
+        lock(lastAcceptedSec_, timeSec, timeSec - lastAcceptedSec_);
+        advance(timeSec);
+        return true;
+    }
+
+    const double k0 = p00 / s;
+    const double k1 = p01 / s;
+    beatSec_ = beatSec_ + n * periodSec_ + k0 * innovation;
+    periodSec_ = std::clamp(periodSec_ + k1 * innovation, kMinPeriodSec, kMaxPeriodSec);
+    p00_ = (1.0 - k0) * p00;
+    p01_ = (1.0 - k0) * p01;
+    p11_ = p11 - k1 * p01;
+    rejections_ = 0;
+    candidateCount_ = 0;
+    lastAcceptedSec_ = timeSec;
+    foldBeatPeak();
+    advance(timeSec);
+    return true;
+}
+
+void BeatPredictor::advance(double nowSec) {
+    if (!locked_) {
+        const float amplitude = prediction_.amplitude;
+        prediction_ = {};
+        prediction_.amplitude = amplitude;
+        return;
+    }
+    const double elapsed = std::max(0.0, nowSec - beatSec_);
+    const double coastStart = kCoastPeriods * periodSec_;
+    const double n = std::max(1.0, std::ceil(elapsed / periodSec_));
+    prediction_.valid = true;
+    prediction_.coasting = elapsed > coastStart;
+    prediction_.lastBeatSec = beatSec_;
+    prediction_.periodSec = periodSec_;
+    prediction_.uncertaintySec =
+        std::sqrt(p00_ + 2.0 * n * p01_ + n * n * p11_ + n * kPhaseSigmaSec * kPhaseSigmaSec);
+    prediction_.confidence =
+        prediction_.coasting
+            ? std::max(kMinCoastConfidence, static_cast<float>(std::exp(-(elapsed - coastStart) / kCoastDecaySec)))
+            : 1.0f;
+}
+
+double BeatPredictor::nextBeatAfter(double timeSec) const {
+    const double steps = std::floor((timeSec - beatSec_) / periodSec_) + 1.0;
+    return beatSec_ + std::max(steps, 1.0) * periodSec_;
+}
+
+} // namespace knot::audio
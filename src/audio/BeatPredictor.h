@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace knot::audio {
+
+/// Phase and period tracker for one participant's heartbeat. A two-state Kalman filter (time of
+/// the last beat, beat period) is fed the detector's trigger times and extrapolates the next
+/// ones, so haptics can be started ahead of detection and keep the rhythm through dropouts.
+/// It locks on after three triggers with matching intervals. Observations are associated with
+/// the nearest predicted beat, so a missed beat only widens the uncertainty; triggers far from
+/// any prediction are rejected, and the filter restarts after kMaxRejections of them in a row
+/// (tempo change, new participant). A lock on half the period (a spurious trigger between two
+/// beats at start-up) shows as beats that keep skipping a prediction and is folded back; a lock on
+/// twice the period (every other beat missed while locking) shows as a rejected trigger halfway
+/// between predictions period after period, and is halved. All times are in seconds on the
+/// caller's clock. No allocation; safe on the audio thread.
+class BeatPredictor {
+public:
+    static constexpr double kMinPeriodSec = 0.3;
+    static constexpr double kMaxPeriodSec = 2.0;
+    static constexpr std::size_t kMaxRejections = 3;
+
+    struct Prediction {
+        /// Locked on at least two consecutive beats; the fields below are meaningful.
+        bool valid = false;
+        /// No beat accepted for more than kCoastPeriods periods; predictions run on the last
+        /// period and confidence decays.
+        bool coasting = false;
+        double lastBeatSec = 0.0;
+        double periodSec = 1.0;
+        /// Standard deviation of the next beat's predicted time.
+        double uncertaintySec = 0.0;
+        /// 1 while tracking; while coasting it decays over several seconds to a floor of 0.3.
+        float confidence = 0.0f;
+        /// Smoothed envelope peak of the tracked beats.
+        float amplitude = 0.0f;
+    };
+
+    void reset();
+    /// Detector trigger at timeSec. Returns false if the trigger was rejected as an outlier or only
+    /// kept as the first beat of a new lock.
+    bool observe(double timeSec);
+    /// Detector envelope, once per block. The detector fires early on a beat's rise, so the
+    /// amplitude is taken from the envelope's peak between accepted beats instead.
+    void trackEnvelope(float envelope);
+    /// Updates coasting and confidence for the current time.
+    void advance(double nowSec);
+    /// First predicted beat strictly after timeSec (requires prediction().valid).
+    double nextBeatAfter(double timeSec) const;
+    const Prediction& prediction() const { return prediction_; }
+
+private:
+    static constexpr double kCoastPeriods = 1.6;
+
+    bool locked_ = false;
+    // Recent triggers while unlocked or being rejected, newest last.
+    std::array<double, 2> candidates_{};
+    std::size_t candidateCount_ = 0;
+    double lastAcceptedSec_ = 0.0;
+    std::size_t skippedAccepts_ = 0;
+    double skippedSteps_ = 0.0;
+    // Rejected triggers halfway between two predictions, each one period after the last.
+    std::size_t halfwayPeriods_ = 0;
+    double lastHalfwaySec_ = 0.0;
+    float beatPeak_ = 0.0f;
+    // State: time of the last beat, period. Covariance is symmetric; p01_ doubles as p10.
+    double beatSec_ = 0.0;
+    double periodSec_ = 1.0;
+    double p00_ = 0.0;
+    double p01_ = 0.0;
+    double p11_ = 0.0;
+    std::size_t rejections_ = 0;
+    Prediction prediction_{};
+
+    void lock(double previousSec, double timeSec, double periodSec);
+    /// Adds a trigger to the candidates and locks when the last three are evenly spaced.
+    bool addCandidate(double timeSec);
+    void foldBeatPeak();
+};
+
+} // namespace knot::audio
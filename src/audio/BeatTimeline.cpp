@@ -25,13 +25,25 @@ void BeatTimeline::setup(double sampleRate, ParticipantId participantId) {
     lastTriggerSample_ = 0.0;
     lastEnvelope_ = 0.0f;
     currentBpm_ = 0.0f;
-    events_.clear();
+    lastEvent_ = {};
     eventSequence_ = 0;
     noTriggerCounter_ = 0;
     noTriggerRelaxSamples_ = static_cast<std::size_t>(sampleRate_ * 3.0);
     minTriggerRatio_ = minTriggerRatioDefault_;
     calibrationStats_ = {};
     envelopeCalibrating_ = false;
+    baseline_.setup(sampleRate_);
+    baselineFloor_ = 0.0f;
+    pendingTriggerAge_ = 0;
+}
+
+void BeatTimeline::setBaselineTracking(bool enabled) {
+    if (enabled && !baselineTracking_) {
+        baseline_.reset();
+    }
+    baselineTracking_ = enabled;
+    baselineFloor_ = 0.0f;
+    pendingTriggerAge_ = 0;
 }
 
 void BeatTimeline::beginEnvelopeCalibration(double durationSec) {
@@ -43,12 +55,6 @@ void BeatTimeline::beginEnvelopeCalibration(double durationSec) {
         static_cast<std::size_t>(std::max(1.0, std::round(durationSec * sampleRate_)));
     calibrationSamplesRemaining_ = calibrationSamplesTotal_;
     envelopeCalibrating_ = calibrationSamplesTotal_ > 0;
-    if (!envelopeCalibrating_) {
-        return;
-    }
-    // Reset tracking so calibration is not influenced by stale values.
-    holdCounter_ = 0;
-    refractoryCounter_ = 0;
 }
 
 void BeatTimeline::finalizeEnvelopeCalibration() {
@@ -81,6 +87,10 @@ void BeatTimeline::finalizeEnvelopeCalibration() {
     calibrationSamplesRemaining_ = 0;
 }
 
+double BeatTimeline::filterGroupDelaySec(double freqHz) const {
+    return (bandPass1_.groupDelaySamples(freqHz) + bandPass2_.groupDelaySamples(freqHz)) / sampleRate_;
+}
+
 float BeatTimeline::calibrationProgress() const {
     if (!envelopeCalibrating_ || calibrationSamplesTotal_ == 0) {
         return 0.0f;
@@ -90,6 +100,32 @@ float BeatTimeline::calibrationProgress() const {
                       0.0f, 1.0f);
 }
 
+void BeatTimeline::publishTrigger(double triggerSample, float env) {
+    if (lastTriggerSample_ > 0.0) {
+        const double deltaSamples = triggerSample - lastTriggerSample_;
+        if (deltaSamples > sampleRate_ * 0.25) { // avoid unrealistic high BPM
+            currentBpm_ = static_cast<float>(60.0 * sampleRate_ / deltaSamples);
+        }
+    }
+    lastTriggerSample_ = triggerSample;
+
+    BeatEvent evt;
+    evt.timestampSec = triggerSample / sampleRate_;
+    evt.bpm = currentBpm_;
+    evt.envelope = env;
+    evt.participantId = participantId_;
+    evt.sequenceId = eventSequence_++;
+    lastEvent_ = evt;
+    if (eventBus_) {
+        eventBus_->publish(evt);
+    }
+
+    lastEnvelope_ = env;
+    lastTrigger_ = true;
+    noTriggerCounter_ = 0;
+    minTriggerRatio_ = std::min(minTriggerRatioMax_, minTriggerRatio_ + 0.01f);
+}
+
 void BeatTimeline::processBuffer(const float* monoInput, std::size_t numFrames, double startSampleIndex) {
     if (!monoInput || numFrames == 0) {
         lastTrigger_ = false;
@@ -106,6 +142,13 @@ void BeatTimeline::processBuffer(const float* monoInput, std::size_t numFrames,
         const float env = envelopeFollower_.process(filtered);
         const float lpfCoeff = 0.005f;
         adaptiveThreshold_ = (1.0f - lpfCoeff) * adaptiveThreshold_ + lpfCoeff * env;
+        const float dynamicThreshold = adaptiveThreshold_ * kThresholdScale + 1e-5f;
+        if (baselineTracking_ && baseline_.process(env) && baseline_.ready()) {
+            baselineFloor_ = baseline_.median() + kBaselineFloorSigmas * RobustBaseline::kMadToSigma * baseline_.mad();
+        }
+        if (scopeTap_) {
+            scopeTap_->write(env, std::max(dynamicThreshold, baselineFloor_));
+        }
 
         if (envelopeCalibrating_) {
             calibrationSum_ += static_cast<double>(env);
@@ -117,9 +160,22 @@ void BeatTimeline::processBuffer(const float* monoInput, std::size_t numFrames,
             if (calibrationSamplesRemaining_ == 0) {
                 finalizeEnvelopeCalibration();
             }
-            continue;
         }
 
+        if (pendingTriggerAge_ > 0) {
+            // An onset below the baseline floor becomes a beat only if the envelope clears the
+            // floor within the hold time; the beat keeps the onset's timestamp.
+            if (env > baselineFloor_) {
+                publishTrigger(pendingTriggerSample_, env);
+                holdCounter_ = holdSamples_ - std::min(holdSamples_, pendingTriggerAge_);
+                refractoryCounter_ = refractorySamples_ - std::min(refractorySamples_, pendingTriggerAge_);
+                pendingTriggerAge_ = 0;
+                triggeredThisBuffer = true;
+            } else if (++pendingTriggerAge_ > holdSamples_) {
+                pendingTriggerAge_ = 0;
+            }
+            continue;
+        }
         if (holdCounter_ > 0) {
             --holdCounter_;
             continue;
@@ -129,42 +185,24 @@ void BeatTimeline::processBuffer(const float* monoInput, std::size_t numFrames,
             continue;
         }
 
-        const float dynamicThreshold = adaptiveThreshold_ * 1.45f + 1e-5f;
         const float ratio = dynamicThreshold > 0.0f ? env / dynamicThreshold : 0.0f;
         if (env > dynamicThreshold && ratio >= minTriggerRatio_) {
             const double triggerSample = startSampleIndex + static_cast<double>(i);
-            if (lastTriggerSample_ > 0.0) {
-                const double deltaSamples = triggerSample - lastTriggerSample_;
-                if (deltaSamples > sampleRate_ * 0.25) { // avoid unrealistic high BPM
-                    currentBpm_ = static_cast<float>(60.0 * sampleRate_ / deltaSamples);
-                }
-            }
-            lastTriggerSample_ = triggerSample;
-
-            BeatEvent evt;
-            evt.timestampSec = triggerSample / sampleRate_;
-            evt.bpm = currentBpm_;
-            evt.envelope = env;
-            evt.participantId = participantId_;
-            evt.sequenceId = eventSequence_++;
-            events_.push_back(evt);
-            if (events_.size() > kMaxEvents) {
-                events_.pop_front();
+            if (env <= baselineFloor_) {
+                pendingTriggerSample_ = triggerSample;
+                pendingTriggerAge_ = 1;
+                continue;
             }
-
+            publishTrigger(triggerSample, env);
             holdCounter_ = holdSamples_;
             refractoryCounter_ = refractorySamples_;
-            lastEnvelope_ = env;
-            lastTrigger_ = true;
             triggeredThisBuffer = true;
-            noTriggerCounter_ = 0;
-            minTriggerRatio_ = std::min(minTriggerRatioMax_, minTriggerRatio_ + 0.01f);
         } else {
             lastTrigger_ = false;
         }
     }
 
-    if (!triggeredThisBuffer && !envelopeCalibrating_) {
+    if (!triggeredThisBuffer) {
         noTriggerCounter_ = std::min<std::size_t>(noTriggerCounter_ + numFrames,
                                                   noTriggerRelaxSamples_ * 4);
         if (noTriggerCounter_ >= noTriggerRelaxSamples_) {
@@ -2,10 +2,12 @@
 
 #include "BiquadFilter.h"
 #include "EnvelopeFollower.h"
+#include "EnvelopeScopeTap.h"
+#include "EventBus.h"
 #include "ParticipantId.h"
+#include "RobustBaseline.h"
 
 #include <cstdint>
-#include <deque>
 #include <optional>
 #include <vector>
 
@@ -19,6 +21,8 @@ struct BeatEvent {
     std::uint64_t sequenceId = 0;
 };
 
+using BeatEventBus = EventBus<BeatEvent, 1024>;
+
 struct EnvelopeCalibrationStats {
     double durationSec = 0.0;
     float mean = 0.0f;
@@ -37,13 +41,31 @@ public:
 
     float currentBpm() const { return currentBpm_; }
     float currentEnvelope() const { return envelopeFollower_.value(); }
-    const std::deque<BeatEvent>& events() const { return events_; }
+    const BeatEvent& lastEvent() const { return lastEvent_; }
     bool lastFrameTriggered() const { return lastTrigger_; }
+    /// One-shot baseline measurement over durationSec. Detection keeps running meanwhile; the
+    /// result resets the adaptive threshold and trigger ratio.
     void beginEnvelopeCalibration(double durationSec);
     void finalizeEnvelopeCalibration();
     bool isEnvelopeCalibrating() const { return envelopeCalibrating_; }
     float calibrationProgress() const;
     const EnvelopeCalibrationStats& calibrationStats() const { return calibrationStats_; }
+    /// Continuous baseline tracking: the median and MAD of the envelope over the last
+    /// RobustBaseline::kDefaultWindowSec are kept up to date, and a beat's envelope must also
+    /// clear median + kBaselineFloorSigmas robust standard deviations within the hold time of
+    /// its onset. The onset itself is still found by the adaptive threshold and keeps its
+    /// timestamp, but the event is published once the floor is cleared, typically ~20 ms later.
+    /// The floor follows the background as it drifts and rejects onsets that stay in it.
+    void setBaselineTracking(bool enabled);
+    bool isBaselineTracking() const { return baselineTracking_; }
+    float baselineMedian() const { return baseline_.median(); }
+    float baselineMad() const { return baseline_.mad(); }
+    /// Current trigger floor from the tracked baseline (0 while off or still filling).
+    float baselineFloor() const { return baselineFloor_; }
+    /// Group delay of the detection band-pass (high-pass + low-pass) at freqHz, in seconds.
+    double filterGroupDelaySec(double freqHz) const;
+    void setScopeTap(EnvelopeScopeTap* tap) { scopeTap_ = tap; }
+    void setEventBus(BeatEventBus* bus) { eventBus_ = bus; }
 
 private:
     double sampleRate_ = 48000.0;
@@ -64,7 +86,7 @@ private:
     float lastEnvelope_ = 0.0f;
     float currentBpm_ = 0.0f;
     bool lastTrigger_ = false;
-    std::deque<BeatEvent> events_;
+    BeatEvent lastEvent_{};
     std::size_t noTriggerCounter_ = 0;
     std::size_t noTriggerRelaxSamples_ = 0;
     float minTriggerRatioDefault_ = 1.25f;
@@ -78,8 +100,18 @@ private:
     double calibrationSum_ = 0.0;
     float calibrationMax_ = 0.0f;
     EnvelopeCalibrationStats calibrationStats_;
+    RobustBaseline baseline_;
+    bool baselineTracking_ = false;
+    float baselineFloor_ = 0.0f;
+    double pendingTriggerSample_ = 0.0;
+    std::size_t pendingTriggerAge_ = 0; // samples since an onset below the floor; 0 = none
+    EnvelopeScopeTap* scopeTap_ = nullptr;
+    BeatEventBus* eventBus_ = nullptr;
+
+    void publishTrigger(double triggerSample, float env);
 
-    static constexpr std::size_t kMaxEvents = 256;
+    static constexpr float kThresholdScale = 1.45f;
+    static constexpr float kBaselineFloorSigmas = 3.0f;
 };
 
 } // namespace knot::audio
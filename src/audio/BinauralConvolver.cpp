@@ -0,0 +1,97 @@
+#include "BinauralConvolver.h"
+
+#include <algorithm>
+
+namespace knot::audio {
+
+void BinauralConvolver::prepare(const HrirDatabase* database) {
+    database_ = database;
+    if (!ready()) {
+        partitionSize_ = 0;
+        return;
+    }
+    partitionSize_ = database_->partitionSize();
+    numPartitions_ = database_->numPartitions();
+    numBins_ = database_->numBins();
+    fft_.setup(partitionSize_ * 2);
+
+    inputBlock_.assign(partitionSize_ * 2, 0.0f);
+    delayLineRe_.assign(numPartitions_ * numBins_, 0.0f);
+    delayLineIm_.assign(numPartitions_ * numBins_, 0.0f);
+    accRe_.assign(numBins_, 0.0f);
+    accIm_.assign(numBins_, 0.0f);
+    timeScratch_.assign(partitionSize_ * 2, 0.0f);
+    fadeScratch_.assign(partitionSize_ * 2, 0.0f);
+    outputLeft_.assign(partitionSize_, 0.0f);
+    outputRight_.assign(partitionSize_, 0.0f);
+    currentIndex_ = database_->nearest(0.0f, 0.0f);
+    targetIndex_ = currentIndex_;
+    reset();
+}
+
+void BinauralConvolver::reset() {
+    std::fill(inputBlock_.begin(), inputBlock_.end(), 0.0f);
+    std::fill(delayLineRe_.begin(), delayLineRe_.end(), 0.0f);
+    std::fill(delayLineIm_.begin(), delayLineIm_.end(), 0.0f);
+    std::fill(outputLeft_.begin(), outputLeft_.end(), 0.0f);
+    std::fill(outputRight_.begin(), outputRight_.end(), 0.0f);
+    delayLinePos_ = 0;
+    fill_ = 0;
+}
+
+void BinauralConvolver::setDirection(float azimuthDeg, float elevationDeg) {
+    if (!ready()) {
+        return;
+    }
+    targetIndex_ = database_->nearest(azimuthDeg, elevationDeg);
+}
+
+void BinauralConvolver::accumulate(std::size_t hrirIndex, std::size_t ear, float* re, float* im) const {
+    std::fill(re, re + numBins_, 0.0f);
+    std::fill(im, im + numBins_, 0.0f);
+    const float* filterRe = database_->spectrumRe(hrirIndex, ear);
+    const float* filterIm = database_->spectrumIm(hrirIndex, ear);
+    for (std::size_t p = 0; p < numPartitions_; ++p) {
+        const std::size_t slot = (delayLinePos_ + numPartitions_ - p) % numPartitions_;
+        const float* xr = delayLineRe_.data() + slot * numBins_;
+        const float* xi = delayLineIm_.data() + slot * numBins_;
+        const float* hr = filterRe + p * numBins_;
+        const float* hi = filterIm + p * numBins_;
+        for (std::size_t k = 0; k < numBins_; ++k) {
+            re[k] += xr[k] * hr[k] - xi[k] * hi[k];
+            im[k] += xr[k] * hi[k] + xi[k] * hr[k];
+        }
+    }
+}
+
+void BinauralConvolver::processBlock() {
+    const std::size_t slotOffset = delayLinePos_ * numBins_;
+    fft_.forward(inputBlock_.data(), delayLineRe_.data() + slotOffset, delayLineIm_.data() + slotOffset);
+
+    const bool crossfade = currentIndex_ != targetIndex_;
+    const float fadeStep = 1.0f / static_cast<float>(partitionSize_);
+    for (std::size_t ear = 0; ear < 2; ++ear) {
+        float* output = ear == 0 ? outputLeft_.data() : outputRight_.data();
+        accumulate(targetIndex_, ear, accRe_.data(), accIm_.data());
+        fft_.inverse(accRe_.data(), accIm_.data(), timeScratch_.data());
+        const float* fresh = timeScratch_.data() + partitionSize_;
+        if (!crossfade) {
+            std::copy(fresh, fresh + partitionSize_, output);
+            continue;
+        }
+        accumulate(currentIndex_, ear, accRe_.data(), accIm_.data());
+        fft_.inverse(accRe_.data(), accIm_.data(), fadeScratch_.data());
+        const float* previous = fadeScratch_.data() + partitionSize_;
+        for (std::size_t i = 0; i < partitionSize_; ++i) {
+            const float alpha = static_cast<float>(i + 1) * fadeStep;
+            output[i] = previous[i] + alpha * (fresh[i] - previous[i]);
+        }
+    }
+    currentIndex_ = targetIndex_;
+
+    delayLinePos_ = (delayLinePos_ + 1) % numPartitions_;
+    std::copy(inputBlock_.begin() + static_cast<std::ptrdiff_t>(partitionSize_), inputBlock_.end(),
+              inputBlock_.begin());
+}
+
+} // namespace knot::audio
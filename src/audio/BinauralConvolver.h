@@ -0,0 +1,63 @@
+#pragma once
+
+#include "HrirDatabase.h"
+#include "RealFft.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace knot::audio {
+
+/// Renders one mono source to a binaural pair with uniformly partitioned overlap-save
+/// convolution (partition size B, FFT size 2B). Samples are pushed one at a time so the
+/// renderer fits the per-frame output loop; a block is convolved every B samples, giving a
+/// fixed latency of B samples. Direction changes are applied at the next block boundary and
+/// crossfaded over one block by running the old and new HRIR side by side.
+/// prepare() allocates; setDirection()/process() do not.
+class BinauralConvolver {
+public:
+    void prepare(const HrirDatabase* database);
+    void reset();
+    bool ready() const { return database_ != nullptr && !database_->empty(); }
+
+    /// Selects the HRIR nearest to the given direction (app convention, see HrirDatabase).
+    void setDirection(float azimuthDeg, float elevationDeg);
+    std::size_t latencySamples() const { return partitionSize_; }
+
+    inline void process(float input, float& left, float& right) {
+        inputBlock_[partitionSize_ + fill_] = input;
+        left = outputLeft_[fill_];
+        right = outputRight_[fill_];
+        if (++fill_ == partitionSize_) {
+            processBlock();
+            fill_ = 0;
+        }
+    }
+
+private:
+    void processBlock();
+    void accumulate(std::size_t hrirIndex, std::size_t ear, float* re, float* im) const;
+
+    const HrirDatabase* database_ = nullptr;
+    RealFft fft_;
+    std::size_t partitionSize_ = 0;
+    std::size_t numPartitions_ = 0;
+    std::size_t numBins_ = 0;
+    std::size_t fill_ = 0;
+
+    std::size_t currentIndex_ = 0;
+    std::size_t targetIndex_ = 0;
+
+    std::vector<float> inputBlock_;          // 2B: previous block followed by the block being filled
+    std::vector<float> delayLineRe_;         // P spectra of recent input blocks (frequency-domain delay line)
+    std::vector<float> delayLineIm_;
+    std::size_t delayLinePos_ = 0;
+    std::vector<float> accRe_;
+    std::vector<float> accIm_;
+    std::vector<float> timeScratch_;         // 2B
+    std::vector<float> fadeScratch_;         // 2B, old-HRIR output while crossfading
+    std::vector<float> outputLeft_;          // B
+    std::vector<float> outputRight_;         // B
+};
+
+} // namespace knot::audio
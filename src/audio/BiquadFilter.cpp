@@ -1,6 +1,7 @@
 #include "BiquadFilter.h"
 
 #include <cmath>
+#include <complex>
 
 namespace knot::audio {
 
@@ -61,5 +62,22 @@ void BiquadFilter::computeCoefficients() {
     a2_ = static_cast<float>(a2 * inv_a0);
 }
 
+double BiquadFilter::groupDelaySamples(double freqHz) const {
+    // tau = Re{sum(n * c_n * z^-n) / sum(c_n * z^-n)} of the numerator minus the same for the
+    // denominator, evaluated on the unit circle.
+    const double omega = 2.0 * M_PI * freqHz / sampleRate_;
+    const std::complex<double> z1 = std::polar(1.0, -omega);
+    const std::complex<double> z2 = z1 * z1;
+    const std::complex<double> num = static_cast<double>(b0_) + static_cast<double>(b1_) * z1 +
+                                     static_cast<double>(b2_) * z2;
+    const std::complex<double> numRamp = static_cast<double>(b1_) * z1 + 2.0 * static_cast<double>(b2_) * z2;
+    const std::complex<double> den = 1.0 + static_cast<double>(a1_) * z1 + static_cast<double>(a2_) * z2;
+    const std::complex<double> denRamp = static_cast<double>(a1_) * z1 + 2.0 * static_cast<double>(a2_) * z2;
+    if (std::abs(num) < 1e-12 || std::abs(den) < 1e-12) {
+        return 0.0;
+    }
+    return (numRamp / num).real() - (denRamp / den).real();
+}
+
 } // namespace knot::audio
 
@@ -13,6 +13,8 @@ public:
     };
 
     void setup(Type type, double sampleRate, double freqHz, double q);
+    /// Group delay in samples at freqHz, from the current coefficients.
+    double groupDelaySamples(double freqHz) const;
 
     inline float process(float inSample) {
         const float out = b0_ * inSample + b1_ * x1_ + b2_ * x2_ - a1_ * y1_ - a2_ * y2_;
@@ -1,7 +1,5 @@
 #include "Calibration.h"
 
-#include "ofMain.h"
-
 #include <algorithm>
 #include <cmath>
 #include <numeric>
@@ -10,6 +8,8 @@ namespace knot::audio {
 
 namespace {
 constexpr double kTwoPi = M_PI * 2.0;
+// Tone-only sessions keep listening this long after the tone, covering the device round trip.
+constexpr double kToneOnlyTailSec = 0.05;
 } // namespace
 
 void CalibrationSignalGenerator::setup(const CalibrationPlan& plan) {
@@ -109,7 +109,9 @@ void CalibrationAnalyzer::ingest(const float* interleavedStereo, std::size_t num
         const float sampleR = interleavedStereo[i * 2 + 1];
         const float channelSamples[2] = {sampleL, sampleR};
 
-        if (sampleCursor_ < plan_.toneSamples) {
+        if (sampleCursor_ < plan_.toneSettleSamples) {
+            // Still the signal from before the session.
+        } else if (sampleCursor_ < plan_.toneSamples) {
             const std::uint64_t swapIndex =
                 plan_.toneSwapInterval > 0 ? sampleCursor_ / plan_.toneSwapInterval : 0;
             const int activeChannel = static_cast<int>(swapIndex % 2);
@@ -218,55 +220,13 @@ float CalibrationAnalyzer::measuredGainDbDelta() const {
     return linearToDb(ratio);
 }
 
-bool CalibrationFileIO::save(const std::filesystem::path& path,
-                             const std::array<ChannelCalibrationValue, 2>& values) {
-    ofJson json;
-    json["version"] = 1;
-    json["createdUtc"] = ofGetTimestampString("%FT%TZ");
-    json["channels"] = ofJson::array();
-    for (const auto& value : values) {
-        ofJson ch;
-        ch["name"] = value.name;
-        ch["gain"] = value.gain;
-        ch["phaseDeg"] = value.phaseDeg;
-        ch["delaySamples"] = value.delaySamples;
-        json["channels"].push_back(ch);
-    }
-
-    ofFile file(path, ofFile::WriteOnly, true);
-    if (!file.is_open()) {
-        return false;
-    }
-    file << json.dump(2);
-    return true;
-}
-
-std::optional<std::array<ChannelCalibrationValue, 2>> CalibrationFileIO::load(
-    const std::filesystem::path& path) {
-    ofFile file(path, ofFile::ReadOnly);
-    if (!file.exists()) {
-        return std::nullopt;
-    }
-    ofJson json;
-    file >> json;
-    std::array<ChannelCalibrationValue, 2> values;
-    const auto& channels = json["channels"];
-    for (std::size_t i = 0; i < 2; ++i) {
-        if (i < channels.size()) {
-            values[i].name = channels[i]["name"].get<std::string>();
-            values[i].gain = channels[i]["gain"].get<float>();
-            values[i].phaseDeg = channels[i]["phaseDeg"].get<float>();
-            values[i].delaySamples = channels[i]["delaySamples"].get<int>();
-        }
-    }
-    return values;
-}
-
-void CalibrationSession::setup(double sampleRate, std::uint64_t toneSwapInterval, std::size_t pulsePairs) {
+void CalibrationSession::setup(double sampleRate, std::uint64_t toneSwapInterval, std::size_t pulsePairs,
+                               double toneSec, double settleSec) {
     plan_.sampleRate = sampleRate;
     plan_.toneFrequencyHz = 1000.0;
     plan_.toneAmplitude = 0.25f;
-    plan_.toneSamples = static_cast<std::uint64_t>(sampleRate * 5.0);
+    plan_.toneSettleSamples = static_cast<std::uint64_t>(sampleRate * settleSec);
+    plan_.toneSamples = plan_.toneSettleSamples + static_cast<std::uint64_t>(sampleRate * toneSec);
     plan_.toneSwapInterval = toneSwapInterval > 0 ? toneSwapInterval : 512;
     plan_.pulseLengthSamples = 256;
     plan_.pulseSpacingSamples = static_cast<std::uint64_t>(sampleRate * 0.25); // 250ms 間隔
@@ -279,10 +239,12 @@ void CalibrationSession::setup(double sampleRate, std::uint64_t toneSwapInterval
         plan_.pulseOffsets[1].push_back(offsetBase + plan_.pulseSpacingSamples / 2);
     }
 
-    const std::uint64_t lastPulseOffset =
-        pulsePairs > 0 ? plan_.pulseOffsets[1].back() : 0;
-    plan_.totalSamples = plan_.pulseStartSample + lastPulseOffset + plan_.pulseLengthSamples +
-                         static_cast<std::uint64_t>(sampleRate * 0.25);
+    if (pulsePairs > 0) {
+        plan_.totalSamples = plan_.pulseStartSample + plan_.pulseOffsets[1].back() + plan_.pulseLengthSamples +
+                             static_cast<std::uint64_t>(sampleRate * 0.25);
+    } else {
+        plan_.totalSamples = plan_.toneSamples + static_cast<std::uint64_t>(sampleRate * kToneOnlyTailSec);
+    }
 
     generator_.setup(plan_);
     analyzer_.setup(plan_);
@@ -322,4 +284,17 @@ void CalibrationSession::capture(const float* interleavedStereo, std::size_t num
     }
 }
 
+CalibrationCheck compareCalibration(const std::array<ChannelCalibrationValue, 2>& stored,
+                                    const std::array<ChannelCalibrationValue, 2>& measured, float toleranceDb) {
+    CalibrationCheck check;
+    check.passed = true;
+    for (std::size_t ch = 0; ch < 2; ++ch) {
+        // Gains are corrections, so a louder channel measures a smaller gain: report the level change.
+        const float ratio = measured[ch].gain > 0.0f ? stored[ch].gain / measured[ch].gain : 0.0f;
+        check.gainErrorDb[ch] = ratio > 0.0f ? linearToDb(ratio) : -120.0f;
+        check.passed = check.passed && std::fabs(check.gainErrorDb[ch]) <= toleranceDb;
+    }
+    return check;
+}
+
 } // namespace knot::audio
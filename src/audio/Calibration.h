@@ -21,6 +21,8 @@ struct ChannelCalibrationValue {
 struct CalibrationPlan {
     double sampleRate = 48000.0;
     std::uint64_t toneSamples = 0;
+    /// The tone is measured from here on; before it the input still carries what preceded the session.
+    std::uint64_t toneSettleSamples = 0;
     std::uint64_t toneSwapInterval = 0;
     double toneFrequencyHz = 1000.0;
     float toneAmplitude = 0.25f;
@@ -95,6 +97,7 @@ private:
     std::array<PulseState, 2> pulseStates_{};
 };
 
+/// JSON calibration files. Uses openFrameworks (CalibrationFileIO.cpp); not in headless builds.
 class CalibrationFileIO {
 public:
     static bool save(const std::filesystem::path& path,
@@ -102,9 +105,68 @@ public:
     static std::optional<std::array<ChannelCalibrationValue, 2>> load(const std::filesystem::path& path);
 };
 
+/// The stream a calibration was measured on. Devices are identified by name, as the device
+/// picker and hot-plug recovery do.
+struct CalibrationProfileKey {
+    std::string inputDevice;
+    std::string outputDevice;
+    double sampleRate = 48000.0;
+    std::size_t bufferSize = 512;
+
+    bool operator==(const CalibrationProfileKey& other) const {
+        return inputDevice == other.inputDevice && outputDevice == other.outputDevice &&
+               sampleRate == other.sampleRate && bufferSize == other.bufferSize;
+    }
+    bool operator!=(const CalibrationProfileKey& other) const { return !(*this == other); }
+};
+
+/// Calibration profiles per CalibrationProfileKey. The store directory holds index.json, which
+/// lists the keys, and one CalibrationFileIO file per profile. Uses openFrameworks
+/// (CalibrationFileIO.cpp); not in headless builds.
+class CalibrationStore {
+public:
+    /// Reads the index; a missing directory or index is an empty store.
+    bool open(const std::filesystem::path& directory);
+    bool contains(const CalibrationProfileKey& key) const;
+    std::optional<std::array<ChannelCalibrationValue, 2>> find(const CalibrationProfileKey& key) const;
+    /// Writes the profile and rewrites the index.
+    bool store(const CalibrationProfileKey& key, const std::array<ChannelCalibrationValue, 2>& values);
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        CalibrationProfileKey key;
+        std::string file;
+    };
+
+    std::filesystem::path directory_;
+    std::vector<Entry> entries_;
+
+    const Entry* entry(const CalibrationProfileKey& key) const;
+};
+
+/// Outcome of a verification burst: each channel's measured gain against the stored one.
+struct CalibrationCheck {
+    std::array<float, 2> gainErrorDb{};
+    bool passed = false;
+};
+
+/// passed when both channels are within toleranceDb of the stored gains.
+CalibrationCheck compareCalibration(const std::array<ChannelCalibrationValue, 2>& stored,
+                                    const std::array<ChannelCalibrationValue, 2>& measured, float toleranceDb);
+
 class CalibrationSession {
 public:
-    void setup(double sampleRate, std::uint64_t toneSwapInterval, std::size_t pulsePairs);
+    static constexpr double kToneSec = 5.0;
+    /// Verification burst: kCheckToneSec of measured tone after kCheckSettleSec for the device
+    /// round trip, no delay pulses.
+    static constexpr double kCheckToneSec = 0.2;
+    static constexpr double kCheckSettleSec = 0.05;
+
+    /// The tone plays for settleSec + toneSec and is measured over the last toneSec. pulsePairs
+    /// == 0 plays the tone only, followed by a short tail for the input to catch up.
+    void setup(double sampleRate, std::uint64_t toneSwapInterval, std::size_t pulsePairs,
+               double toneSec = kToneSec, double settleSec = 0.0);
     void start();
     void generate(float* interleavedStereo, std::size_t numFrames);
     void capture(const float* interleavedStereo, std::size_t numFrames);
@@ -0,0 +1,173 @@
+#include "Calibration.h"
+
+#include "ofMain.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+
+namespace knot::audio {
+
+namespace {
+constexpr const char* kStoreIndexFile = "index.json";
+
+/// FNV-1a over the exact device names, sample rate and buffer size.
+std::uint32_t profileKeyHash(const CalibrationProfileKey& key) {
+    std::uint32_t hash = 2166136261u;
+    const auto mix = [&hash](const std::string& part) {
+        for (const char c : part) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        hash ^= 0xffu;
+        hash *= 16777619u;
+    };
+    mix(key.inputDevice);
+    mix(key.outputDevice);
+    mix(std::to_string(key.sampleRate));
+    mix(std::to_string(key.bufferSize));
+    return hash;
+}
+
+/// Readable, filesystem-safe profile file name for the key. Sanitising maps every non-ASCII or
+/// punctuation character to '_', so the hash of the full key keeps distinct devices apart.
+std::string profileFileName(const CalibrationProfileKey& key) {
+    std::string name = key.inputDevice + "__" + key.outputDevice;
+    for (auto& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+    char hash[9] = {};
+    std::snprintf(hash, sizeof(hash), "%08x", static_cast<unsigned>(profileKeyHash(key)));
+    return name + "_" + std::to_string(static_cast<long long>(key.sampleRate)) + "_" +
+           std::to_string(key.bufferSize) + "_" + hash + ".json";
+}
+} // namespace
+
+bool CalibrationFileIO::save(const std::filesystem::path& path,
+                             const std::array<ChannelCalibrationValue, 2>& values) {
+    ofJson json;
+    json["version"] = 1;
+    json["createdUtc"] = ofGetTimestampString("%FT%TZ");
+    json["channels"] = ofJson::array();
+    for (const auto& value : values) {
+        ofJson ch;
+        ch["name"] = value.name;
+        ch["gain"] = value.gain;
+        ch["phaseDeg"] = value.phaseDeg;
+        ch["delaySamples"] = value.delaySamples;
+        json["channels"].push_back(ch);
+    }
+
+    ofFile file(path, ofFile::WriteOnly, true);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << json.dump(2);
+    return true;
+}
+
+std::optional<std::array<ChannelCalibrationValue, 2>> CalibrationFileIO::load(
+    const std::filesystem::path& path) {
+    ofFile file(path, ofFile::ReadOnly);
+    if (!file.exists()) {
+        return std::nullopt;
+    }
+    ofJson json;
+    file >> json;
+    std::array<ChannelCalibrationValue, 2> values;
+    const auto& channels = json["channels"];
+    for (std::size_t i = 0; i < 2; ++i) {
+        if (i < channels.size()) {
+            values[i].name = channels[i]["name"].get<std::string>();
+            values[i].gain = channels[i]["gain"].get<float>();
+            values[i].phaseDeg = channels[i]["phaseDeg"].get<float>();
+            values[i].delaySamples = channels[i]["delaySamples"].get<int>();
+        }
+    }
+    return values;
+}
+
+bool CalibrationStore::open(const std::filesystem::path& directory) {
+    directory_ = directory;
+    entries_.clear();
+    const auto indexPath = directory_ / kStoreIndexFile;
+    if (!std::filesystem::exists(indexPath)) {
+        return true;
+    }
+    const ofJson json = ofLoadJson(indexPath.string());
+    if (!json.contains("profiles") || !json["profiles"].is_array()) {
+        ofLogWarning("CalibrationStore") << "Ignoring malformed profile index " << indexPath;
+        return false;
+    }
+    for (const auto& profile : json["profiles"]) {
+        Entry entry;
+        entry.key.inputDevice = profile.value("inputDevice", std::string());
+        entry.key.outputDevice = profile.value("outputDevice", std::string());
+        entry.key.sampleRate = profile.value("sampleRate", 0.0);
+        entry.key.bufferSize = profile.value("bufferSize", std::size_t{0});
+        entry.file = profile.value("file", std::string());
+        if (entry.file.empty() || entry.key.sampleRate <= 0.0 || entry.key.bufferSize == 0) {
+            continue;
+        }
+        entries_.push_back(std::move(entry));
+    }
+    return true;
+}
+
+const CalibrationStore::Entry* CalibrationStore::entry(const CalibrationProfileKey& key) const {
+    const auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry& e) { return e.key == key; });
+    return it != entries_.end() ? &*it : nullptr;
+}
+
+bool CalibrationStore::contains(const CalibrationProfileKey& key) const {
+    return entry(key) != nullptr;
+}
+
+std::optional<std::array<ChannelCalibrationValue, 2>> CalibrationStore::find(const CalibrationProfileKey& key) const {
+    const Entry* found = entry(key);
+    if (!found) {
+        return std::nullopt;
+    }
+    return CalibrationFileIO::load(directory_ / found->file);
+}
+
+bool CalibrationStore::store(const CalibrationProfileKey& key, const std::array<ChannelCalibrationValue, 2>& values) {
+    if (directory_.empty()) {
+        return false;
+    }
+    if (!entry(key)) {
+        // Never share a file with another profile, even on a hash collision.
+        const auto taken = [this](const std::string& file) {
+            return std::any_of(entries_.begin(), entries_.end(), [&](const Entry& e) { return e.file == file; });
+        };
+        const std::string base = profileFileName(key);
+        std::string file = base;
+        for (int suffix = 2; taken(file); ++suffix) {
+            file = base.substr(0, base.size() - 5) + "-" + std::to_string(suffix) + ".json";
+        }
+        entries_.push_back({key, file});
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (!CalibrationFileIO::save(directory_ / entry(key)->file, values)) {
+        return false;
+    }
+    ofJson json;
+    json["version"] = 1;
+    json["profiles"] = ofJson::array();
+    for (const auto& e : entries_) {
+        ofJson profile;
+        profile["inputDevice"] = e.key.inputDevice;
+        profile["outputDevice"] = e.key.outputDevice;
+        profile["sampleRate"] = e.key.sampleRate;
+        profile["bufferSize"] = e.key.bufferSize;
+        profile["file"] = e.file;
+        json["profiles"].push_back(profile);
+    }
+    return ofSavePrettyJson((directory_ / kStoreIndexFile).string(), json);
+}
+
+} // namespace knot::audio
@@ -0,0 +1,230 @@
+#include "CrosstalkCanceller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+namespace {
+constexpr double kAntiAliasHz = 500.0;
+constexpr float kStepSize = 0.05f;
+// Heart sounds are strongly low-pass; adapting on first-differenced signals flattens the spectrum
+// so the transient onsets converge as fast as the 50 Hz body of a beat. The leakage path is
+// linear, so weights learnt on the differenced pair apply unchanged to the signals themselves.
+constexpr float kPreEmphasis = 0.95f;
+// Adapt only while the reference peaks this much higher than the channel itself: leakage is always
+// weaker than its source, so anything louder is the channel's own participant (double talk).
+// The gate looks at the inputs rather than the filter's error so a wrong filter cannot hold it
+// open. Also only above the noise floor (-60 dBFS) so hiss alone does not move the weights.
+constexpr float kDoubleTalkRatio = 4.0f;
+constexpr float kMinReferencePower = 1e-6f;
+// Keeps the normalised step small while the reference window is close to silent.
+constexpr float kRegularization = static_cast<float>(CrosstalkCanceller::kTaps) * kMinReferencePower;
+constexpr double kPowerWindowSec = 0.05;
+// Health figures average over several beats.
+constexpr double kStatsWindowSec = 2.0;
+// The shadow weights are compared against the active ones once per window.
+constexpr double kPromoteWindowSec = 2.0;
+constexpr float kPromoteRatio = 0.8f;
+// Converged once the shadow filter has failed to improve on the active one this many windows in a
+// row while the other participant was audible.
+constexpr std::size_t kConvergedWindows = 3;
+constexpr float kPowerFloor = 1e-12f;
+
+float powerDb(float numerator, float denominator) {
+    return 10.0f * std::log10(std::max(numerator, kPowerFloor) / std::max(denominator, kPowerFloor));
+}
+} // namespace
+
+void CrosstalkCanceller::setup(double sampleRate, std::size_t maxBlockFrames) {
+    decimation_ = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(sampleRate / kAnalysisRateHz)));
+    const double analysisRate = sampleRate / static_cast<double>(decimation_);
+    powerCoeff_ = static_cast<float>(std::exp(-1.0 / (kPowerWindowSec * analysisRate)));
+    statsCoeff_ = static_cast<float>(std::exp(-1.0 / (kStatsWindowSec * analysisRate)));
+    windowLength_ = std::max<std::size_t>(1, static_cast<std::size_t>(kPromoteWindowSec * analysisRate));
+    const std::size_t maxDecimated = maxBlockFrames / decimation_ + 1;
+    for (auto& channel : channels_) {
+        for (auto& filter : channel.antiAlias) {
+            filter.setup(BiquadFilter::Type::LowPass, sampleRate, kAntiAliasHz, 0.707);
+        }
+        channel.decimated.assign(maxDecimated, 0.0f);
+        channel.cleaned.assign(maxDecimated, 0.0f);
+    }
+    // Interpolation waits one analysis sample for the next point; the anti-alias filter's delay is
+    // taken in the heartbeat band.
+    const auto& filters = channels_[0].antiAlias;
+    latencySamples_ = decimation_ + static_cast<std::size_t>(std::lround(filters[0].groupDelaySamples(60.0) +
+                                                                         filters[1].groupDelaySamples(60.0)));
+    reset();
+}
+
+void CrosstalkCanceller::reset() {
+    for (auto& channel : channels_) {
+        for (auto& filter : channel.antiAlias) {
+            filter.reset();
+        }
+        channel.weights.fill(0.0f);
+        channel.shadow.fill(0.0f);
+        channel.candidate.fill(0.0f);
+        channel.history.fill(0.0f);
+        channel.emphasized.fill(0.0f);
+        channel.lastSample = 0.0f;
+        channel.previous = 0.0f;
+        channel.current = 0.0f;
+        channel.powerIn = 0.0f;
+        channel.peakIn = 0.0f;
+        channel.powerLeak = 0.0f;
+        channel.gatedIn = 0.0f;
+        channel.gatedOut = 0.0f;
+        channel.windowIn = 0.0f;
+        channel.windowOut = 0.0f;
+        channel.windowCandidate = 0.0f;
+        channel.stableWindows = 0;
+    }
+    phase_ = 0;
+    historyPos_ = 0;
+    windowPos_ = 0;
+    stats_ = {};
+}
+
+void CrosstalkCanceller::process(const float* in1, const float* in2, float* out1, float* out2,
+                                 std::size_t numFrames) {
+    const std::array<const float*, 2> inputs = {in1, in2};
+    const std::array<float*, 2> outputs = {out1, out2};
+    const std::size_t startPhase = phase_;
+    const std::size_t maxDecimated = channels_[0].decimated.size();
+
+    // Every frame is read before any is written, so out may alias in.
+    std::size_t numDecimated = 0;
+    for (std::size_t c = 0; c < channels_.size(); ++c) {
+        auto& channel = channels_[c];
+        std::size_t phase = startPhase;
+        std::size_t count = 0;
+        for (std::size_t frame = 0; frame < numFrames; ++frame) {
+            const float filtered = channel.antiAlias[1].process(channel.antiAlias[0].process(inputs[c][frame]));
+            if (phase == 0 && count < maxDecimated) {
+                channel.decimated[count++] = filtered;
+            }
+            phase = phase + 1 == decimation_ ? 0 : phase + 1;
+        }
+        numDecimated = count;
+    }
+
+    adapt(numDecimated);
+
+    const float step = 1.0f / static_cast<float>(decimation_);
+    for (std::size_t c = 0; c < channels_.size(); ++c) {
+        auto& channel = channels_[c];
+        std::size_t phase = startPhase;
+        std::size_t next = 0;
+        float* out = outputs[c];
+        for (std::size_t frame = 0; frame < numFrames; ++frame) {
+            if (phase == 0 && next < numDecimated) {
+                channel.previous = channel.current;
+                channel.current = channel.cleaned[next++];
+            }
+            out[frame] = channel.previous + (channel.current - channel.previous) * (static_cast<float>(phase) * step);
+            phase = phase + 1 == decimation_ ? 0 : phase + 1;
+        }
+    }
+    phase_ = (startPhase + numFrames) % decimation_;
+}
+
+void CrosstalkCanceller::adapt(std::size_t numDecimated) {
+    for (std::size_t n = 0; n < numDecimated; ++n) {
+        historyPos_ = historyPos_ == 0 ? kTaps - 1 : historyPos_ - 1;
+        for (auto& channel : channels_) {
+            const float sample = channel.decimated[n];
+            channel.history[historyPos_] = sample;
+            channel.history[historyPos_ + kTaps] = sample;
+            const float emphasized = sample - kPreEmphasis * channel.lastSample;
+            channel.lastSample = sample;
+            channel.emphasized[historyPos_] = emphasized;
+            channel.emphasized[historyPos_ + kTaps] = emphasized;
+            // Peak envelope with instant attack: the gate closes on the first sample of a beat.
+            channel.peakIn = std::max(sample * sample, powerCoeff_ * channel.peakIn);
+        }
+
+        for (std::size_t c = 0; c < channels_.size(); ++c) {
+            auto& channel = channels_[c];
+            const auto& reference = channels_[1 - c];
+            // Newest reference sample first; plain loops over fixed-size arrays so the compiler
+            // vectorises the dot products and the update.
+            const float* x = reference.history.data() + historyPos_;
+            const float* xe = reference.emphasized.data() + historyPos_;
+            float* w = channel.weights.data();
+            float* shadow = channel.shadow.data();
+            const float* candidate = channel.candidate.data();
+            float estimate = 0.0f;
+            float candidateEstimate = 0.0f;
+            float emphasizedEstimate = 0.0f;
+            float energy = 0.0f;
+            for (std::size_t i = 0; i < kTaps; ++i) {
+                estimate += w[i] * x[i];
+                candidateEstimate += candidate[i] * x[i];
+                emphasizedEstimate += shadow[i] * xe[i];
+                energy += xe[i] * xe[i];
+            }
+            const float input = channel.decimated[n];
+            const float error = input - estimate;
+            const float candidateError = input - candidateEstimate;
+            channel.cleaned[n] = error;
+
+            channel.powerIn = statsCoeff_ * channel.powerIn + (1.0f - statsCoeff_) * input * input;
+            channel.powerLeak = statsCoeff_ * channel.powerLeak + (1.0f - statsCoeff_) * estimate * estimate;
+            const float referencePeak = reference.peakIn;
+            if (referencePeak > kMinReferencePower && referencePeak > kDoubleTalkRatio * channel.peakIn) {
+                const float emphasizedError = channel.emphasized[historyPos_] - emphasizedEstimate;
+                const float gain = kStepSize * emphasizedError / (energy + kRegularization);
+                for (std::size_t i = 0; i < kTaps; ++i) {
+                    shadow[i] += gain * xe[i];
+                }
+                // Both filters are judged only where the leakage is what is left to remove.
+                channel.windowIn += input * input;
+                channel.windowOut += error * error;
+                channel.windowCandidate += candidateError * candidateError;
+                channel.gatedIn = statsCoeff_ * channel.gatedIn + (1.0f - statsCoeff_) * input * input;
+                channel.gatedOut = statsCoeff_ * channel.gatedOut + (1.0f - statsCoeff_) * error * error;
+            }
+        }
+
+        if (++windowPos_ >= windowLength_) {
+            windowPos_ = 0;
+            for (auto& channel : channels_) {
+                promoteShadow(channel);
+            }
+        }
+    }
+
+    for (std::size_t c = 0; c < channels_.size(); ++c) {
+        const auto& channel = channels_[c];
+        stats_.leakageDb[c] = powerDb(channel.powerLeak, channel.powerIn);
+        stats_.residualDb[c] = channel.gatedIn > kPowerFloor ? powerDb(channel.gatedOut, channel.gatedIn) : 0.0f;
+    }
+    stats_.converged =
+        channels_[0].stableWindows >= kConvergedWindows && channels_[1].stableWindows >= kConvergedWindows;
+}
+
+void CrosstalkCanceller::promoteShadow(Channel& channel) {
+    // Two-path update: the shadow filter adapts whenever the gate lets it and may be thrown off by
+    // double talk the gate missed. Its weights are frozen as a candidate for one window, and the
+    // filter that actually cleans the signal only takes them if, frozen, they removed clearly more
+    // than the current ones over that window. A fit to the participant's own beat does not carry
+    // over to the next beats; real leakage does. A moved stethoscope or
+    // vanished leakage is picked up the same way.
+    if (channel.windowIn > kPowerFloor) {
+        if (channel.windowCandidate < kPromoteRatio * channel.windowOut &&
+            channel.windowCandidate < kPromoteRatio * channel.windowIn) {
+            channel.weights = channel.candidate;
+            channel.stableWindows = 0;
+        } else {
+            channel.stableWindows = std::min(channel.stableWindows + 1, kConvergedWindows);
+        }
+    }
+    channel.windowIn = 0.0f;
+    channel.windowOut = 0.0f;
+    channel.windowCandidate = 0.0f;
+    channel.candidate = channel.shadow;
+}
+
+} // namespace knot::audio
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "BiquadFilter.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace knot::audio {
+
+/// Removes each stethoscope's pickup of the other participant before beat detection. Both
+/// channels are low-passed and decimated to about kAnalysisRateHz (the heartbeat band sits below
+/// 150 Hz), a two-channel NLMS filter estimates the leakage of each channel into the other and
+/// subtracts it, and the cleaned signals are interpolated back to the device rate. Adaptation of
+/// a channel pauses while its own signal is within 6 dB of the reference (double talk), and a
+/// shadow filter only replaces the active one after beating it on fresh input, so a participant's
+/// own beat does not train the filter to cancel itself. Leakage louder than -6 dB is left alone.
+/// Decimation, anti-alias filter and interpolation delay the output by latencySamples().
+/// setup() allocates; process() does not.
+class CrosstalkCanceller {
+public:
+    static constexpr double kAnalysisRateHz = 3000.0;
+    /// Leakage path length covered at the analysis rate (8 ms at 3 kHz).
+    static constexpr std::size_t kTaps = 24;
+
+    struct Stats {
+        /// Estimated leakage power relative to the channel's own power.
+        std::array<float, 2> leakageDb{{-120.0f, -120.0f}};
+        /// Power left while the other channel dominates, relative to before cancellation
+        /// (0 dB: nothing removed).
+        std::array<float, 2> residualDb{{0.0f, 0.0f}};
+        /// Neither channel's weights have needed an update for several windows.
+        bool converged = false;
+    };
+
+    void setup(double sampleRate, std::size_t maxBlockFrames);
+    void reset();
+    /// Full-rate in, cleaned full-rate out (band-limited to the analysis band). out may alias in.
+    void process(const float* in1, const float* in2, float* out1, float* out2, std::size_t numFrames);
+    const Stats& stats() const { return stats_; }
+    std::size_t latencySamples() const { return latencySamples_; }
+
+private:
+    struct Channel {
+        std::array<BiquadFilter, 2> antiAlias;
+        std::array<float, kTaps> weights{};
+        std::array<float, kTaps> shadow{};
+        std::array<float, kTaps> candidate{};
+        // Reference history written twice so the newest kTaps samples are always contiguous.
+        std::array<float, kTaps * 2> history{};
+        std::array<float, kTaps * 2> emphasized{};
+        float lastSample = 0.0f;
+        std::vector<float> decimated;
+        std::vector<float> cleaned;
+        float previous = 0.0f;
+        float current = 0.0f;
+        float powerIn = 0.0f;
+        float peakIn = 0.0f;
+        float powerLeak = 0.0f;
+        float gatedIn = 0.0f;
+        float gatedOut = 0.0f;
+        float windowIn = 0.0f;
+        float windowOut = 0.0f;
+        float windowCandidate = 0.0f;
+        std::size_t stableWindows = 0;
+    };
+
+    std::size_t decimation_ = 16;
+    std::size_t phase_ = 0;
+    std::size_t historyPos_ = 0;
+    std::size_t latencySamples_ = 0;
+    std::size_t windowLength_ = 750;
+    std::size_t windowPos_ = 0;
+    float powerCoeff_ = 0.0f;
+    float statsCoeff_ = 0.0f;
+    std::array<Channel, 2> channels_{};
+    Stats stats_{};
+
+    void adapt(std::size_t numDecimated);
+    void promoteShadow(Channel& channel);
+};
+
+} // namespace knot::audio
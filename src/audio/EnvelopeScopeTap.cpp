@@ -0,0 +1,73 @@
+#include "EnvelopeScopeTap.h"
+
+#include <cmath>
+
+namespace knot::audio {
+
+void EnvelopeScopeTap::setup(double sampleRate, double bucketMs, std::size_t capacity) {
+    capacity_ = std::max<std::size_t>(capacity, 2);
+    slots_ = std::make_unique<Slot[]>(capacity_);
+    bucketSamples_ = static_cast<std::size_t>(std::max(1.0, std::round(sampleRate * bucketMs * 0.001)));
+    bucketDurationSec_ = static_cast<double>(bucketSamples_) / std::max(1.0, sampleRate);
+    writeIndex_.store(0, std::memory_order_release);
+    reset();
+}
+
+void EnvelopeScopeTap::reset() {
+    bucketFill_ = 0;
+    bucketMin_ = std::numeric_limits<float>::max();
+    bucketMax_ = std::numeric_limits<float>::lowest();
+    bucketThreshold_ = 0.0f;
+}
+
+void EnvelopeScopeTap::publish() {
+    if (!slots_) {
+        reset();
+        return;
+    }
+    const std::uint64_t index = writeIndex_.load(std::memory_order_relaxed);
+    auto& slot = slots_[static_cast<std::size_t>(index % capacity_)];
+    // Pairs with the acquire fence in readLatest(): a reader that sees any of the stores below
+    // also sees writeIndex_ >= index, so it discards the bucket this slot held before.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.envelopeMin.store(bucketMin_, std::memory_order_relaxed);
+    slot.envelopeMax.store(bucketMax_, std::memory_order_relaxed);
+    slot.threshold.store(bucketThreshold_, std::memory_order_relaxed);
+    writeIndex_.store(index + 1, std::memory_order_release);
+    reset();
+}
+
+std::size_t EnvelopeScopeTap::readLatest(ScopeBucket* out, std::size_t maxBuckets,
+                                         std::uint64_t* lastSequence) const {
+    if (!slots_ || !out || maxBuckets == 0) {
+        return 0;
+    }
+    const std::uint64_t end = writeIndex_.load(std::memory_order_acquire);
+    // Leave one slot of slack for the bucket the writer may be filling right now.
+    const std::uint64_t available = std::min<std::uint64_t>(end, capacity_ - 1);
+    const std::uint64_t count = std::min<std::uint64_t>(available, maxBuckets);
+    const std::uint64_t begin = end - count;
+    for (std::uint64_t seq = begin; seq < end; ++seq) {
+        const auto& slot = slots_[static_cast<std::size_t>(seq % capacity_)];
+        auto& bucket = out[seq - begin];
+        bucket.envelopeMin = slot.envelopeMin.load(std::memory_order_relaxed);
+        bucket.envelopeMax = slot.envelopeMax.load(std::memory_order_relaxed);
+        bucket.threshold = slot.threshold.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Drop anything the writer lapped while we were copying.
+    const std::uint64_t endAfter = writeIndex_.load(std::memory_order_relaxed);
+    const std::uint64_t oldestValid = endAfter >= capacity_ - 1 ? endAfter - (capacity_ - 1) : 0;
+    std::size_t skip = 0;
+    if (oldestValid > begin) {
+        skip = static_cast<std::size_t>(std::min<std::uint64_t>(oldestValid - begin, count));
+        std::copy(out + skip, out + count, out);
+    }
+    if (lastSequence && count > 0) {
+        *lastSequence = end - 1;
+    }
+    return static_cast<std::size_t>(count) - skip;
+}
+
+} // namespace knot::audio
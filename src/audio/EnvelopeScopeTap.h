@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace knot::audio {
+
+struct ScopeBucket {
+    float envelopeMin = 0.0f;
+    float envelopeMax = 0.0f;
+    float threshold = 0.0f;
+};
+
+/// Decimating envelope tap written from the audio thread and read from the UI thread.
+/// Each bucket (~1 ms by default) holds the min/max envelope and the detection threshold.
+/// The writer is wait-free; readers copy the newest buckets and discard any slot the writer
+/// may have overwritten while they were copying.
+class EnvelopeScopeTap {
+public:
+    static constexpr std::size_t kDefaultCapacity = 4096;
+
+    void setup(double sampleRate, double bucketMs = 1.0, std::size_t capacity = kDefaultCapacity);
+    void reset();
+
+    inline void write(float envelope, float threshold) {
+        bucketMin_ = std::min(bucketMin_, envelope);
+        bucketMax_ = std::max(bucketMax_, envelope);
+        bucketThreshold_ = threshold;
+        if (++bucketFill_ >= bucketSamples_) {
+            publish();
+        }
+    }
+
+    /// Copies up to maxBuckets of the newest buckets (oldest first) into out and returns the
+    /// count. lastSequence receives the sequence number of the final copied bucket.
+    std::size_t readLatest(ScopeBucket* out, std::size_t maxBuckets, std::uint64_t* lastSequence = nullptr) const;
+
+    double bucketDurationSec() const { return bucketDurationSec_; }
+    std::size_t capacity() const { return capacity_; }
+    std::uint64_t publishedCount() const { return writeIndex_.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<float> envelopeMin{0.0f};
+        std::atomic<float> envelopeMax{0.0f};
+        std::atomic<float> threshold{0.0f};
+    };
+
+    void publish();
+
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t capacity_ = 0;
+    std::atomic<std::uint64_t> writeIndex_{0};
+
+    std::size_t bucketSamples_ = 48;
+    double bucketDurationSec_ = 0.001;
+    std::size_t bucketFill_ = 0;
+    float bucketMin_ = std::numeric_limits<float>::max();
+    float bucketMax_ = std::numeric_limits<float>::lowest();
+    float bucketThreshold_ = 0.0f;
+};
+
+} // namespace knot::audio
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace knot::audio {
+
+/// Single-producer, multi-consumer broadcast ring for small trivially-copyable events.
+/// Storage is preallocated; publishing and consuming never allocate or block. Each subscriber
+/// owns its read cursor, so consumers never interfere with each other. A subscriber that falls
+/// more than Capacity events behind skips the lost events and accounts for them in
+/// overflowCount() instead of dropping them silently.
+template <typename T, std::size_t Capacity>
+class EventBus {
+    static_assert(std::is_trivially_copyable_v<T>, "EventBus events must be trivially copyable");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    class Subscriber {
+    public:
+        Subscriber() = default;
+
+        /// Consumes the next event. Returns false when the subscriber is caught up.
+        bool tryConsume(T& out) noexcept {
+            if (!bus_) {
+                return false;
+            }
+            while (true) {
+                const std::uint64_t head = bus_->head_.load(std::memory_order_acquire);
+                if (cursor_ >= head) {
+                    return false;
+                }
+                if (head - cursor_ > Capacity) {
+                    overflow_ += head - cursor_ - Capacity;
+                    cursor_ = head - Capacity;
+                }
+                const auto& slot = bus_->slots_[static_cast<std::size_t>(cursor_ & kMask)];
+                const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+                if (before != cursor_ + 1) {
+                    // The producer has already lapped this slot.
+                    ++overflow_;
+                    ++cursor_;
+                    continue;
+                }
+                T value = slot.value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != before) {
+                    ++overflow_;
+                    ++cursor_;
+                    continue;
+                }
+                out = value;
+                ++cursor_;
+                ++consumed_;
+                return true;
+            }
+        }
+
+        /// Invokes fn for up to maxEvents pending events and returns how many were delivered.
+        template <typename Fn>
+        std::size_t poll(Fn&& fn, std::size_t maxEvents = Capacity) {
+            std::size_t delivered = 0;
+            T event{};
+            while (delivered < maxEvents && tryConsume(event)) {
+                fn(event);
+                ++delivered;
+            }
+            return delivered;
+        }
+
+        /// Discards everything pending without counting it as overflow.
+        void skipToLatest() noexcept {
+            if (bus_) {
+                cursor_ = bus_->head_.load(std::memory_order_acquire);
+            }
+        }
+
+        std::uint64_t overflowCount() const noexcept { return overflow_; }
+        std::uint64_t consumedCount() const noexcept { return consumed_; }
+        std::uint64_t pendingCount() const noexcept {
+            return bus_ ? bus_->head_.load(std::memory_order_acquire) - cursor_ : 0;
+        }
+
+    private:
+        friend class EventBus;
+        Subscriber(const EventBus* bus, std::uint64_t cursor) : bus_(bus), cursor_(cursor) {}
+
+        const EventBus* bus_ = nullptr;
+        std::uint64_t cursor_ = 0;
+        std::uint64_t overflow_ = 0;
+        std::uint64_t consumed_ = 0;
+    };
+
+    /// Producer side; must only ever be called from one thread at a time.
+    void publish(const T& event) noexcept {
+        const std::uint64_t sequence = head_.load(std::memory_order_relaxed);
+        auto& slot = slots_[static_cast<std::size_t>(sequence & kMask)];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = event;
+        slot.sequence.store(sequence + 1, std::memory_order_release);
+        head_.store(sequence + 1, std::memory_order_release);
+    }
+
+    /// New subscribers start at the current head and only see events published afterwards.
+    Subscriber subscribe() const noexcept {
+        return Subscriber(this, head_.load(std::memory_order_acquire));
+    }
+
+    std::uint64_t publishedCount() const noexcept { return head_.load(std::memory_order_acquire); }
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+private:
+    static constexpr std::uint64_t kMask = Capacity - 1;
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        T value{};
+    };
+
+    std::array<Slot, Capacity> slots_{};
+    std::atomic<std::uint64_t> head_{0};
+};
+
+} // namespace knot::audio
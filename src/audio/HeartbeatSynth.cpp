@@ -0,0 +1,146 @@
+#include "HeartbeatSynth.h"
+
+#include "EnvelopeFollower.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+namespace {
+constexpr double kTwoPi = M_PI * 2.0;
+
+struct Partial {
+    double frequencyHz;
+    double gain;
+};
+
+struct VoiceShape {
+    std::array<Partial, 3> partials;
+    double attackSec;
+    double decaySec;
+    double lengthSec;
+};
+
+// S1 (valve closure at the start of systole): low and long. S2 (end of systole): higher, shorter.
+constexpr VoiceShape kS1Shape{{{{40.0, 1.0}, {80.0, 0.5}, {115.0, 0.2}}}, 0.008, 0.030, 0.15};
+constexpr VoiceShape kS2Shape{{{{60.0, 1.0}, {120.0, 0.4}, {0.0, 0.0}}}, 0.005, 0.018, 0.10};
+constexpr double kTaperSec = 0.01;
+// BeatTimeline's envelope follower, to measure the voices on the detector's scale.
+constexpr float kEnvelopeAttackMs = 5.0f;
+constexpr float kEnvelopeReleaseMs = 60.0f;
+// S1 onset to S2 onset (Weissler: systole shortens by 1.7 ms per beat/min).
+constexpr double kSystoleAtZeroBpmSec = 0.44;
+constexpr double kSystoleSlopeSec = 0.0017;
+constexpr double kMinSystoleSec = 0.2;
+constexpr double kMaxSystoleFraction = 0.45;
+constexpr float kDefaultBpm = 60.0f;
+
+/// Renders the shape normalised so the detector's envelope follower peaks at 1 on it: a voice
+/// played at gain g then reads as an envelope peak of g, like the beat it replaces.
+std::vector<float> renderVoice(const VoiceShape& shape, double sampleRate) {
+    const auto length = static_cast<std::size_t>(shape.lengthSec * sampleRate);
+    std::vector<float> table(length, 0.0f);
+    for (std::size_t n = 0; n < length; ++n) {
+        const double t = static_cast<double>(n) / sampleRate;
+        double envelope = t < shape.attackSec ? 0.5 - 0.5 * std::cos(M_PI * t / shape.attackSec)
+                                              : std::exp(-(t - shape.attackSec) / shape.decaySec);
+        const double remaining = shape.lengthSec - t;
+        if (remaining < kTaperSec) {
+            envelope *= 0.5 - 0.5 * std::cos(M_PI * remaining / kTaperSec);
+        }
+        double sample = 0.0;
+        for (const auto& partial : shape.partials) {
+            sample += partial.gain * std::sin(kTwoPi * partial.frequencyHz * t);
+        }
+        table[n] = static_cast<float>(envelope * sample);
+    }
+    EnvelopeFollower follower;
+    follower.setup(sampleRate, kEnvelopeAttackMs, kEnvelopeReleaseMs);
+    float peak = 0.0f;
+    for (const float sample : table) {
+        peak = std::max(peak, follower.process(sample));
+    }
+    if (peak > 0.0f) {
+        for (auto& sample : table) {
+            sample /= peak;
+        }
+    }
+    return table;
+}
+} // namespace
+
+void HeartbeatSynth::setup(double sampleRate) {
+    sampleRate_ = sampleRate;
+    s1_ = renderVoice(kS1Shape, sampleRate_);
+    s2_ = renderVoice(kS2Shape, sampleRate_);
+    reset();
+}
+
+void HeartbeatSynth::reset() {
+    for (auto& voice : voices_) {
+        voice = {};
+    }
+    activeVoices_ = 0;
+}
+
+void HeartbeatSynth::trigger(std::size_t participant, std::uint64_t atSample, float amplitude, float bpm) {
+    if (participant >= 2 || !(amplitude > 0.0f) || s1_.empty()) {
+        return;
+    }
+    const double rate = bpm > 0.0f ? static_cast<double>(bpm) : static_cast<double>(kDefaultBpm);
+    const double systoleSec = std::clamp(kSystoleAtZeroBpmSec - kSystoleSlopeSec * rate, kMinSystoleSec,
+                                         std::max(kMinSystoleSec, kMaxSystoleFraction * 60.0 / rate));
+    start(participant, s1_, atSample, amplitude);
+    start(participant, s2_, atSample + static_cast<std::uint64_t>(systoleSec * sampleRate_), amplitude * kS2Gain);
+}
+
+void HeartbeatSynth::start(std::size_t participant, const std::vector<float>& table, std::uint64_t atSample,
+                           float gain) {
+    auto voice = std::find_if(voices_.begin(), voices_.end(), [](const Voice& v) { return !v.active; });
+    if (voice == voices_.end()) {
+        voice = std::min_element(voices_.begin(), voices_.end(),
+                                 [](const Voice& a, const Voice& b) { return a.startSample < b.startSample; });
+    } else {
+        ++activeVoices_;
+    }
+    voice->active = true;
+    voice->participant = participant;
+    voice->table = &table;
+    voice->startSample = atSample;
+    voice->gain = gain;
+}
+
+void HeartbeatSynth::render(std::uint64_t blockStartSample, std::size_t numFrames, const std::array<float*, 2>& out) {
+    if (activeVoices_ == 0) {
+        return;
+    }
+    const std::uint64_t blockEnd = blockStartSample + numFrames;
+    for (auto& voice : voices_) {
+        if (!voice.active || voice.startSample >= blockEnd) {
+            continue;
+        }
+        const std::vector<float>& table = *voice.table;
+        const std::uint64_t voiceEnd = voice.startSample + table.size();
+        if (voiceEnd <= blockStartSample) {
+            voice.active = false;
+            --activeVoices_;
+            continue;
+        }
+        const std::uint64_t from = std::max(voice.startSample, blockStartSample);
+        const std::uint64_t to = std::min(voiceEnd, blockEnd);
+        float* dst = out[voice.participant] + (from - blockStartSample);
+        const float* src = table.data() + (from - voice.startSample);
+        const auto count = static_cast<std::size_t>(to - from);
+        const float gain = voice.gain;
+        for (std::size_t i = 0; i < count; ++i) {
+            dst[i] += src[i] * gain;
+        }
+        if (voiceEnd <= blockEnd) {
+            voice.active = false;
+            --activeVoices_;
+        }
+    }
+}
+
+} // namespace knot::audio
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace knot::audio {
+
+/// Resynthesised heartbeat for the headphone mix. Each trigger plays a precomputed S1 voice and,
+/// one systole later, a quieter S2 voice, both damped tones in the stethoscope band. Voices are
+/// scheduled on the output sample clock and start on their exact sample within a block; the
+/// pool is fixed and the oldest voice is stolen when it runs out. setup() allocates the voice
+/// tables; trigger() and render() do not.
+class HeartbeatSynth {
+public:
+    static constexpr std::size_t kMaxVoices = 8;
+    /// S2 peak relative to S1.
+    static constexpr float kS2Gain = 0.6f;
+
+    void setup(double sampleRate);
+    void reset();
+    /// Audio thread. Starts a beat for the participant (0 or 1) at atSample. amplitude is the
+    /// detector envelope peak of the beat being replaced; bpm sets the S1-S2 interval (<= 0: 60).
+    void trigger(std::size_t participant, std::uint64_t atSample, float amplitude, float bpm);
+    /// Audio thread. Adds the voices sounding in [blockStartSample, blockStartSample + numFrames)
+    /// to out[0] (participant 1) and out[1] (participant 2).
+    void render(std::uint64_t blockStartSample, std::size_t numFrames, const std::array<float*, 2>& out);
+    std::size_t activeVoiceCount() const { return activeVoices_; }
+
+private:
+    struct Voice {
+        bool active = false;
+        std::size_t participant = 0;
+        const std::vector<float>* table = nullptr;
+        std::uint64_t startSample = 0;
+        float gain = 0.0f;
+    };
+
+    double sampleRate_ = 48000.0;
+    std::vector<float> s1_;
+    std::vector<float> s2_;
+    std::array<Voice, kMaxVoices> voices_{};
+    std::size_t activeVoices_ = 0;
+
+    void start(std::size_t participant, const std::vector<float>& table, std::uint64_t atSample, float gain);
+};
+
+} // namespace knot::audio
@@ -0,0 +1,288 @@
+#include "HrirDatabase.h"
+
+#include "AudioLog.h"
+#include "RealFft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#if defined(KNOT_WITH_HDF5)
+#include <hdf5.h>
+#endif
+
+namespace knot::audio {
+
+namespace {
+
+constexpr double kDegToRad = M_PI / 180.0;
+
+#if defined(KNOT_WITH_HDF5)
+constexpr int kResampleHalfWidth = 16;
+
+float wrapAzimuth(float degrees) {
+    float wrapped = std::fmod(degrees + 180.0f, 360.0f);
+    if (wrapped < 0.0f) {
+        wrapped += 360.0f;
+    }
+    return wrapped - 180.0f;
+}
+
+/// Band-limited (Hann-windowed sinc) resampling of one impulse response. Scaling by
+/// sourceRate / targetRate keeps the magnitude response unchanged.
+std::vector<float> resampleImpulse(const float* input, std::size_t length, double sourceRate, double targetRate) {
+    if (std::fabs(sourceRate - targetRate) < 1e-6) {
+        return std::vector<float>(input, input + length);
+    }
+    const double ratio = sourceRate / targetRate;
+    const double cutoff = std::min(1.0, targetRate / sourceRate);
+    const auto outLength = static_cast<std::size_t>(std::ceil(static_cast<double>(length) / ratio));
+    std::vector<float> output(outLength, 0.0f);
+    for (std::size_t n = 0; n < outLength; ++n) {
+        const double t = static_cast<double>(n) * ratio;
+        const auto center = static_cast<long>(std::floor(t));
+        double acc = 0.0;
+        for (long k = center - kResampleHalfWidth + 1; k <= center + kResampleHalfWidth; ++k) {
+            if (k < 0 || k >= static_cast<long>(length)) {
+                continue;
+            }
+            const double x = t - static_cast<double>(k);
+            const double sinc = std::fabs(x) < 1e-9 ? cutoff : std::sin(M_PI * cutoff * x) / (M_PI * x);
+            const double window = 0.5 + 0.5 * std::cos(M_PI * x / kResampleHalfWidth);
+            acc += input[k] * sinc * window;
+        }
+        output[n] = static_cast<float>(acc * ratio);
+    }
+    return output;
+}
+
+bool readDataset(hid_t file, const char* name, std::vector<double>& out, std::vector<hsize_t>& dims) {
+    const hid_t dataset = H5Dopen2(file, name, H5P_DEFAULT);
+    if (dataset < 0) {
+        return false;
+    }
+    const hid_t space = H5Dget_space(dataset);
+    const int rank = H5Sget_simple_extent_ndims(space);
+    dims.assign(static_cast<std::size_t>(std::max(rank, 0)), 0);
+    if (rank > 0) {
+        H5Sget_simple_extent_dims(space, dims.data(), nullptr);
+    }
+    hsize_t count = 1;
+    for (const auto dim : dims) {
+        count *= dim;
+    }
+    out.assign(static_cast<std::size_t>(count), 0.0);
+    const herr_t status = H5Dread(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, out.data());
+    H5Sclose(space);
+    H5Dclose(dataset);
+    return status >= 0;
+}
+
+std::string readStringAttribute(hid_t file, const char* object, const char* name) {
+    if (H5Aexists_by_name(file, object, name, H5P_DEFAULT) <= 0) {
+        return {};
+    }
+    const hid_t attribute = H5Aopen_by_name(file, object, name, H5P_DEFAULT, H5P_DEFAULT);
+    const hid_t type = H5Aget_type(attribute);
+    std::string value;
+    if (H5Tget_class(type) == H5T_STRING && !H5Tis_variable_str(type)) {
+        value.assign(H5Tget_size(type), '\0');
+        H5Aread(attribute, type, value.data());
+        value.erase(std::find(value.begin(), value.end(), '\0'), value.end());
+    }
+    H5Tclose(type);
+    H5Aclose(attribute);
+    return value;
+}
+#endif
+
+} // namespace
+
+bool HrirDatabase::loadSofa(const std::filesystem::path& path, [[maybe_unused]] double targetSampleRate,
+                            [[maybe_unused]] std::size_t partitionSize) {
+#if defined(KNOT_WITH_HDF5)
+    if (!std::filesystem::exists(path)) {
+        logWarning("HrirDatabase") << "SOFA file not found: " << path;
+        return false;
+    }
+    H5Eset_auto2(H5E_DEFAULT, nullptr, nullptr);
+    const hid_t file = H5Fopen(path.string().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) {
+        logError("HrirDatabase") << "Failed to open SOFA file: " << path;
+        return false;
+    }
+
+    std::vector<double> ir;
+    std::vector<double> positions;
+    std::vector<double> sampleRate;
+    std::vector<hsize_t> irDims;
+    std::vector<hsize_t> positionDims;
+    std::vector<hsize_t> rateDims;
+    const bool ok = readDataset(file, "Data.IR", ir, irDims) &&
+                    readDataset(file, "SourcePosition", positions, positionDims) &&
+                    readDataset(file, "Data.SamplingRate", sampleRate, rateDims);
+    const std::string positionType = readStringAttribute(file, "SourcePosition", "Type");
+    H5Fclose(file);
+
+    if (!ok || irDims.size() != 3 || irDims[1] != 2 || positionDims.size() != 2 || positionDims[1] != 3 ||
+        positionDims[0] != irDims[0] || sampleRate.empty()) {
+        logError("HrirDatabase") << "Unsupported SOFA layout in " << path
+                                 << " (expected SimpleFreeFieldHRIR with 2 receivers)";
+        return false;
+    }
+
+    const auto measurements = static_cast<std::size_t>(irDims[0]);
+    const auto sourceLength = static_cast<std::size_t>(irDims[2]);
+    std::vector<float> azimuth(measurements);
+    std::vector<float> elevation(measurements);
+    for (std::size_t m = 0; m < measurements; ++m) {
+        double az = positions[m * 3];
+        double el = positions[m * 3 + 1];
+        if (positionType == "cartesian") {
+            const double x = positions[m * 3];
+            const double y = positions[m * 3 + 1];
+            const double z = positions[m * 3 + 2];
+            az = std::atan2(y, x) / kDegToRad;
+            el = std::atan2(z, std::sqrt(x * x + y * y)) / kDegToRad;
+        }
+        azimuth[m] = wrapAzimuth(static_cast<float>(-az));
+        elevation[m] = static_cast<float>(el);
+    }
+
+    std::vector<float> sourceIr(sourceLength);
+    std::vector<float> left;
+    std::vector<float> right;
+    std::size_t length = 0;
+    for (std::size_t m = 0; m < measurements; ++m) {
+        for (std::size_t ear = 0; ear < 2; ++ear) {
+            const double* src = ir.data() + (m * 2 + ear) * sourceLength;
+            std::transform(src, src + sourceLength, sourceIr.begin(),
+                           [](double value) { return static_cast<float>(value); });
+            const auto resampled = resampleImpulse(sourceIr.data(), sourceLength, sampleRate[0], targetSampleRate);
+            if (length == 0) {
+                length = resampled.size();
+                left.reserve(measurements * length);
+                right.reserve(measurements * length);
+            }
+            auto& dest = ear == 0 ? left : right;
+            dest.insert(dest.end(), resampled.begin(), resampled.begin() + std::min(length, resampled.size()));
+            dest.resize((m + 1) * length, 0.0f);
+        }
+    }
+
+    // Normalise to unit diffuse-field power so spatialised sources keep roughly the level of
+    // the plain stereo mix.
+    double power = 0.0;
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        power += static_cast<double>(left[i]) * left[i] + static_cast<double>(right[i]) * right[i];
+    }
+    power /= static_cast<double>(measurements * 2);
+    if (power > 0.0) {
+        const auto scale = static_cast<float>(1.0 / std::sqrt(power));
+        for (auto& value : left) {
+            value *= scale;
+        }
+        for (auto& value : right) {
+            value *= scale;
+        }
+    }
+
+    if (!setImpulseResponses(azimuth, elevation, left, right, length, partitionSize)) {
+        return false;
+    }
+    logNotice("HrirDatabase") << "Loaded " << measurements << " HRIRs from " << path.filename() << " ("
+                              << sampleRate[0] << " Hz -> " << targetSampleRate << " Hz, " << length
+                              << " taps, " << numPartitions_ << " x " << partitionSize_ << " partitions)";
+    return true;
+#else
+    logWarning("HrirDatabase") << "Built without HDF5 (KNOT_WITH_HDF5); cannot read " << path
+                               << ". Binaural rendering disabled.";
+    return false;
+#endif
+}
+
+bool HrirDatabase::setImpulseResponses(const std::vector<float>& azimuthDeg, const std::vector<float>& elevationDeg,
+                                       const std::vector<float>& left, const std::vector<float>& right,
+                                       std::size_t irLength, std::size_t partitionSize) {
+    const std::size_t measurements = azimuthDeg.size();
+    if (measurements == 0 || irLength == 0 || partitionSize == 0 || elevationDeg.size() != measurements ||
+        left.size() != measurements * irLength || right.size() != measurements * irLength) {
+        logError("HrirDatabase") << "Inconsistent HRIR data";
+        return false;
+    }
+
+    RealFft fft;
+    fft.setup(partitionSize * 2);
+    partitionSize_ = fft.size() / 2;
+    irLength_ = irLength;
+    numPartitions_ = (irLength + partitionSize_ - 1) / partitionSize_;
+    numMeasurements_ = measurements;
+    azimuth_ = azimuthDeg;
+    elevation_ = elevationDeg;
+    directionX_.resize(measurements);
+    directionY_.resize(measurements);
+    directionZ_.resize(measurements);
+    for (std::size_t m = 0; m < measurements; ++m) {
+        const double az = azimuth_[m] * kDegToRad;
+        const double el = elevation_[m] * kDegToRad;
+        directionX_[m] = static_cast<float>(std::cos(el) * std::cos(az));
+        directionY_[m] = static_cast<float>(std::cos(el) * std::sin(az));
+        directionZ_[m] = static_cast<float>(std::sin(el));
+    }
+
+    const std::size_t bins = numBins();
+    const std::size_t perEar = numPartitions_ * bins;
+    spectraRe_.assign(measurements * 2 * perEar, 0.0f);
+    spectraIm_.assign(measurements * 2 * perEar, 0.0f);
+    const float scale = 1.0f / static_cast<float>(fft.size());
+    std::vector<float> block(fft.size(), 0.0f);
+    for (std::size_t m = 0; m < measurements; ++m) {
+        for (std::size_t ear = 0; ear < 2; ++ear) {
+            const float* ir = (ear == 0 ? left.data() : right.data()) + m * irLength;
+            for (std::size_t p = 0; p < numPartitions_; ++p) {
+                std::fill(block.begin(), block.end(), 0.0f);
+                const std::size_t begin = p * partitionSize_;
+                const std::size_t count = std::min(partitionSize_, irLength - begin);
+                std::copy(ir + begin, ir + begin + count, block.begin());
+                const std::size_t offset = (m * 2 + ear) * perEar + p * bins;
+                fft.forward(block.data(), spectraRe_.data() + offset, spectraIm_.data() + offset);
+                for (std::size_t k = 0; k < bins; ++k) {
+                    spectraRe_[offset + k] *= scale;
+                    spectraIm_[offset + k] *= scale;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::size_t HrirDatabase::nearest(float azimuthDeg, float elevationDeg) const {
+    if (numMeasurements_ == 0) {
+        return 0;
+    }
+    const double az = azimuthDeg * kDegToRad;
+    const double el = elevationDeg * kDegToRad;
+    const auto x = static_cast<float>(std::cos(el) * std::cos(az));
+    const auto y = static_cast<float>(std::cos(el) * std::sin(az));
+    const auto z = static_cast<float>(std::sin(el));
+    std::size_t best = 0;
+    float bestDot = -2.0f;
+    for (std::size_t m = 0; m < numMeasurements_; ++m) {
+        const float dot = x * directionX_[m] + y * directionY_[m] + z * directionZ_[m];
+        if (dot > bestDot) {
+            bestDot = dot;
+            best = m;
+        }
+    }
+    return best;
+}
+
+const float* HrirDatabase::spectrumRe(std::size_t index, std::size_t ear) const {
+    return spectraRe_.data() + (index * 2 + ear) * numPartitions_ * numBins();
+}
+
+const float* HrirDatabase::spectrumIm(std::size_t index, std::size_t ear) const {
+    return spectraIm_.data() + (index * 2 + ear) * numPartitions_ * numBins();
+}
+
+} // namespace knot::audio
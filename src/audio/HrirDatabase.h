@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace knot::audio {
+
+/// HRIR set loaded from a SOFA (SimpleFreeFieldHRIR) file, resampled to the stream rate and
+/// pre-transformed into uniformly partitioned spectra for BinauralConvolver. Everything is
+/// computed at load time; the audio thread only does index lookups.
+///
+/// Directions use the app convention: azimuth in degrees, positive to the listener's right,
+/// 0 = front; elevation in degrees, positive up. (SOFA stores azimuth counter-clockwise.)
+///
+/// Reading SOFA needs HDF5; builds without KNOT_WITH_HDF5 get a loader that logs and fails,
+/// and routing falls back to the plain stereo mix.
+class HrirDatabase {
+public:
+    static constexpr std::size_t kDefaultPartitionSize = 128;
+
+    bool loadSofa(const std::filesystem::path& path, double targetSampleRate,
+                  std::size_t partitionSize = kDefaultPartitionSize);
+    /// Builds the partitioned spectra from raw impulse responses (already at targetSampleRate).
+    /// left/right hold numMeasurements * irLength samples each.
+    bool setImpulseResponses(const std::vector<float>& azimuthDeg, const std::vector<float>& elevationDeg,
+                             const std::vector<float>& left, const std::vector<float>& right,
+                             std::size_t irLength, std::size_t partitionSize = kDefaultPartitionSize);
+
+    bool empty() const { return numMeasurements_ == 0; }
+    std::size_t numMeasurements() const { return numMeasurements_; }
+    std::size_t partitionSize() const { return partitionSize_; }
+    std::size_t numPartitions() const { return numPartitions_; }
+    std::size_t numBins() const { return partitionSize_ + 1; }
+    std::size_t irLength() const { return irLength_; }
+
+    /// Nearest measured direction (great-circle distance). Allocation-free.
+    std::size_t nearest(float azimuthDeg, float elevationDeg) const;
+    float azimuthAt(std::size_t index) const { return azimuth_[index]; }
+    float elevationAt(std::size_t index) const { return elevation_[index]; }
+
+    /// Partition spectra for one measurement and ear (0 = left, 1 = right): numPartitions()
+    /// consecutive blocks of numBins() values. Already scaled by 1 / (2 * partitionSize).
+    const float* spectrumRe(std::size_t index, std::size_t ear) const;
+    const float* spectrumIm(std::size_t index, std::size_t ear) const;
+
+private:
+    std::size_t numMeasurements_ = 0;
+    std::size_t partitionSize_ = 0;
+    std::size_t numPartitions_ = 0;
+    std::size_t irLength_ = 0;
+    std::vector<float> azimuth_;
+    std::vector<float> elevation_;
+    std::vector<float> directionX_;
+    std::vector<float> directionY_;
+    std::vector<float> directionZ_;
+    std::vector<float> spectraRe_;
+    std::vector<float> spectraIm_;
+};
+
+} // namespace knot::audio
@@ -0,0 +1,70 @@
+#include "InputAgc.h"
+
+#include "Utility.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+void InputAgc::setup(double sampleRate, float initialGainDb, float targetPeakDb) {
+    sampleRate_ = sampleRate;
+    targetPeakDb_ = targetPeakDb;
+    reset(initialGainDb);
+}
+
+void InputAgc::reset(float gainDb) {
+    gainDb_ = std::clamp(gainDb, kMinGainDb, kMaxGainDb);
+    protectionDb_ = 0.0f;
+    appliedDb_ = gainDb_;
+    appliedLinear_ = dbToLinear(appliedDb_);
+    peakSinceBeat_ = 0.0f;
+    samplesSinceBeat_ = 0;
+}
+
+void InputAgc::process(float* samples, std::size_t numFrames) {
+    if (!samples || numFrames == 0) {
+        return;
+    }
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < numFrames; ++i) {
+        peak = std::max(peak, std::fabs(samples[i]));
+    }
+    peakSinceBeat_ = std::max(peakSinceBeat_, peak);
+
+    const float blockSec = static_cast<float>(static_cast<double>(numFrames) / sampleRate_);
+    samplesSinceBeat_ += numFrames;
+    if (static_cast<double>(samplesSinceBeat_) > kStarveSec * sampleRate_) {
+        gainDb_ = std::min(kMaxGainDb, gainDb_ + kStarveRiseDbPerSec * blockSec);
+    }
+    protectionDb_ = std::min(0.0f, protectionDb_ + kReleaseDbPerSec * blockSec);
+
+    const float safeDb = peak > 0.0f ? linearToDb(kCeiling / peak) : kMaxGainDb;
+    if (gainDb_ + protectionDb_ > safeDb) {
+        protectionDb_ = safeDb - gainDb_;
+    }
+    const float targetDb = gainDb_ + protectionDb_;
+    const float target = dbToLinear(targetDb);
+    // Never start the ramp above what this block can take.
+    const float start = appliedDb_ > safeDb ? target : appliedLinear_;
+    const float step = (target - start) / static_cast<float>(numFrames);
+    float gain = start;
+    for (std::size_t i = 0; i < numFrames; ++i) {
+        gain += step;
+        samples[i] *= gain;
+    }
+    appliedDb_ = targetDb;
+    appliedLinear_ = target;
+}
+
+void InputAgc::onBeat() {
+    if (peakSinceBeat_ > 1e-6f) {
+        const float desiredDb = targetPeakDb_ - linearToDb(peakSinceBeat_);
+        const float stepDb = std::clamp(kAdaptRate * (desiredDb - gainDb_), -kMaxStepDb, kMaxStepDb);
+        gainDb_ = std::clamp(gainDb_ + stepDb, kMinGainDb, kMaxGainDb);
+    }
+    peakSinceBeat_ = 0.0f;
+    samplesSinceBeat_ = 0;
+}
+
+} // namespace knot::audio
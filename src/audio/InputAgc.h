@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+namespace knot::audio {
+
+/// Automatic gain for one stethoscope input, applied block-wise ahead of beat detection.
+/// The gain only adapts on beats: onBeat() takes the input peak since the previous beat and moves
+/// the gain kAdaptRate of the way towards putting that peak at the target, by at most
+/// kMaxStepDb. A channel with no beat for kStarveSec is assumed starved and its gain creeps up at
+/// kStarveRiseDbPerSec. Each block is scanned before it is scaled (the block is the look-ahead):
+/// if its peak would pass kCeiling, the block starts at the safe gain and that reduction releases
+/// at kReleaseDbPerSec; otherwise the gain ramps linearly across the block, so nothing clips and
+/// nothing steps. process() does not allocate.
+class InputAgc {
+public:
+    static constexpr float kDefaultTargetPeakDb = -12.0f;
+    static constexpr float kMinGainDb = 0.0f;
+    static constexpr float kMaxGainDb = 40.0f;
+    static constexpr float kAdaptRate = 0.3f;
+    static constexpr float kMaxStepDb = 1.5f;
+    static constexpr float kCeiling = 0.89f; // -1 dBFS
+    static constexpr float kReleaseDbPerSec = 3.0f;
+    static constexpr double kStarveSec = 4.0;
+    static constexpr float kStarveRiseDbPerSec = 1.0f;
+
+    void setup(double sampleRate, float initialGainDb, float targetPeakDb = kDefaultTargetPeakDb);
+    /// Restarts adaptation from gainDb (e.g. the operator's static input gain).
+    void reset(float gainDb);
+    /// Scales samples in place.
+    void process(float* samples, std::size_t numFrames);
+    /// A beat was detected on this channel.
+    void onBeat();
+
+    /// Gain applied at the end of the last block, including clip protection.
+    float gainDb() const { return appliedDb_; }
+    /// Clip protection currently in effect (<= 0 dB).
+    float protectionDb() const { return protectionDb_; }
+
+private:
+    double sampleRate_ = 48000.0;
+    float targetPeakDb_ = kDefaultTargetPeakDb;
+    float gainDb_ = 0.0f;      // beat-adapted gain
+    float protectionDb_ = 0.0f;
+    float appliedDb_ = 0.0f;
+    float appliedLinear_ = 1.0f;
+    float peakSinceBeat_ = 0.0f;
+    std::size_t samplesSinceBeat_ = 0;
+};
+
+} // namespace knot::audio
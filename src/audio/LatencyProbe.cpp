@@ -0,0 +1,254 @@
+#include "LatencyProbe.h"
+
+#include "AudioRouter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+namespace {
+constexpr double kTwoPi = M_PI * 2.0;
+constexpr double kLeadSec = 0.5;
+constexpr double kIntervalSec = 1.0;
+constexpr double kStimulusSec = 0.06;
+constexpr double kStimulusTaperSec = 0.002;
+// Level the detector should see after input gain; roughly a strong stethoscope beat.
+constexpr float kStimulusLevel = 0.5f;
+constexpr float kHapticOnsetThreshold = 0.02f;
+} // namespace
+
+void LatencyProbe::setup(double sampleRate, std::size_t pulses, float inputGainLinear, bool crosstalkCancellation) {
+    sampleRate_ = sampleRate;
+    pulses_ = std::clamp<std::size_t>(pulses, 1, kMaxPulses);
+    inputGainLinear_ = inputGainLinear > 0.0f ? inputGainLinear : 1.0f;
+    leadSamples_ = static_cast<std::uint64_t>(kLeadSec * sampleRate_);
+    intervalSamples_ = static_cast<std::uint64_t>(kIntervalSec * sampleRate_);
+    stimulusSamples_ = static_cast<std::uint64_t>(kStimulusSec * sampleRate_);
+    totalSamples_ = leadSamples_ + intervalSamples_ * pulses_;
+    // Played at the level a heartbeat reaches the input at, so the detector runs in its usual range.
+    stimulusAmplitude_ = std::clamp(kStimulusLevel / inputGainLinear_, 0.005f, kStimulusLevel);
+    stimulusThreshold_ = stimulusAmplitude_ * 0.1f;
+    crosstalkCancellation_ = crosstalkCancellation;
+    if (crosstalkCancellation_) {
+        crosstalkCanceller_.setup(sampleRate_, monoScratch_.size());
+    }
+    // Sized here, so start() on the audio thread only resets it.
+    timeline_.setup(sampleRate_, ParticipantId::Participant1);
+    running_ = false;
+    complete_ = false;
+    report_ = {};
+}
+
+void LatencyProbe::start() {
+    timeline_.setup(sampleRate_, ParticipantId::Participant1);
+    crosstalkCanceller_.reset();
+    lastTriggerSec_ = -1.0;
+    stimulusOnsetOffset_ = 0;
+    hapticEnvelope_ = 0.0f;
+    hapticPhase_ = 0.0;
+    inputCursor_ = 0;
+    outputCursor_ = 0;
+    inputStarted_ = false;
+    hapticOutputAvailable_ = false;
+    times_.fill(PulseTimes{});
+    report_ = {};
+    running_ = true;
+    complete_ = false;
+}
+
+int LatencyProbe::pulseAt(std::uint64_t sample) const {
+    if (sample < leadSamples_ || intervalSamples_ == 0) {
+        return -1;
+    }
+    const std::uint64_t index = (sample - leadSamples_) / intervalSamples_;
+    return index < pulses_ ? static_cast<int>(index) : -1;
+}
+
+float LatencyProbe::stimulusAt(std::uint64_t sample) const {
+    if (pulseAt(sample) < 0) {
+        return 0.0f;
+    }
+    const std::uint64_t position = (sample - leadSamples_) % intervalSamples_;
+    if (position >= stimulusSamples_) {
+        return 0.0f;
+    }
+    // Short raised-cosine taper at both ends keeps the pulse inside the detector's band.
+    const double t = static_cast<double>(position) / sampleRate_;
+    const double remaining = static_cast<double>(stimulusSamples_ - position) / sampleRate_;
+    const double edge = std::min(t, remaining);
+    const double taper = edge >= kStimulusTaperSec ? 1.0 : 0.5 - 0.5 * std::cos(M_PI * edge / kStimulusTaperSec);
+    return static_cast<float>(std::sin(kTwoPi * kStimulusHz * t) * taper) * stimulusAmplitude_;
+}
+
+void LatencyProbe::capture(const float* interleavedStereo, std::size_t numFrames) {
+    if (!running_ || !interleavedStereo || numFrames == 0) {
+        return;
+    }
+    inputStarted_ = true;
+
+    for (std::size_t offset = 0; offset < numFrames; offset += monoScratch_.size()) {
+        const std::size_t sliceFrames = std::min(monoScratch_.size(), numFrames - offset);
+        for (std::size_t frame = 0; frame < sliceFrames; ++frame) {
+            const std::uint64_t sample = inputCursor_ + frame;
+            const float p1 = interleavedStereo[(offset + frame) * 2];
+            const float p2 = interleavedStereo[(offset + frame) * 2 + 1];
+            // Same input gain stage as the live pipeline ahead of BeatTimeline.
+            monoScratch_[frame] = std::clamp(p1 * inputGainLinear_, -1.0f, 1.0f);
+
+            const int pulse = pulseAt(sample);
+            if (pulse < 0) {
+                continue;
+            }
+            auto& times = times_[static_cast<std::size_t>(pulse)];
+            const auto index = static_cast<std::int64_t>(sample);
+            if (times.stimulusIn < 0 && times.stimulusOut >= 0 && index >= times.stimulusOut &&
+                std::fabs(p1) > stimulusThreshold_) {
+                times.stimulusIn = index - stimulusOnsetOffset_;
+            }
+            if (times.hapticIn < 0 && times.hapticOut >= 0 && index >= times.hapticOut &&
+                std::fabs(p2) > kHapticOnsetThreshold) {
+                times.hapticIn = index;
+            }
+        }
+
+        if (crosstalkCancellation_) {
+            crosstalkCanceller_.process(monoScratch_.data(), silentScratch_.data(), monoScratch_.data(),
+                                        silentScratch_.data(), sliceFrames);
+        }
+        timeline_.processBuffer(monoScratch_.data(), sliceFrames, static_cast<double>(inputCursor_));
+        const double triggerSec = timeline_.lastEvent().timestampSec;
+        if (triggerSec != lastTriggerSec_) {
+            lastTriggerSec_ = triggerSec;
+            const auto triggerSample = static_cast<std::int64_t>(std::llround(triggerSec * sampleRate_));
+            const int pulse = triggerSample >= 0 ? pulseAt(static_cast<std::uint64_t>(triggerSample)) : -1;
+            if (pulse >= 0) {
+                auto& times = times_[static_cast<std::size_t>(pulse)];
+                if (times.trigger < 0 && times.stimulusIn >= 0 && triggerSample >= times.stimulusIn) {
+                    times.trigger = triggerSample;
+                }
+            }
+        }
+        inputCursor_ += sliceFrames;
+    }
+
+    // What AudioPipeline hands to the router for the next output block.
+    hapticEnvelope_ = std::clamp(timeline_.currentEnvelope(), 0.0f, 1.0f);
+    if (inputCursor_ >= totalSamples_ && outputCursor_ >= totalSamples_) {
+        finalize();
+    }
+}
+
+void LatencyProbe::generate(float* interleaved, std::size_t numFrames, std::size_t numChannels) {
+    if (!interleaved || numFrames == 0 || numChannels == 0) {
+        return;
+    }
+    std::fill(interleaved, interleaved + numFrames * numChannels, 0.0f);
+    if (!running_ || !inputStarted_) {
+        return;
+    }
+
+    hapticOutputAvailable_ = numChannels > static_cast<std::size_t>(OutputChannel::CH3_HapticP1);
+    const double phaseIncrement = static_cast<double>(AudioRouter::kHapticFrequencyHz) / sampleRate_;
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+        const std::uint64_t sample = outputCursor_ + frame;
+        const float stimulus = stimulusAt(sample);
+        const float haptic = static_cast<float>(std::sin(kTwoPi * hapticPhase_)) * hapticEnvelope_ *
+                             AudioRouter::kHapticGain;
+        hapticPhase_ += phaseIncrement;
+        if (hapticPhase_ >= 1.0) {
+            hapticPhase_ -= 1.0;
+        }
+
+        const int pulse = pulseAt(sample);
+        if (pulse >= 0) {
+            auto& times = times_[static_cast<std::size_t>(pulse)];
+            const auto index = static_cast<std::int64_t>(sample);
+            if (times.stimulusOut < 0 && std::fabs(stimulus) > stimulusThreshold_) {
+                // Both sides are timed from the pulse start; the crossing offset is the same on
+                // the way out and the way back in.
+                const auto pulseStart =
+                    static_cast<std::int64_t>(leadSamples_ + intervalSamples_ * static_cast<std::uint64_t>(pulse));
+                stimulusOnsetOffset_ = index - pulseStart;
+                times.stimulusOut = pulseStart;
+            }
+            if (hapticOutputAvailable_ && times.hapticOut < 0 && times.stimulusOut >= 0 &&
+                std::fabs(haptic) > kHapticOnsetThreshold) {
+                times.hapticOut = index;
+            }
+        }
+
+        float* out = interleaved + frame * numChannels;
+        out[static_cast<std::size_t>(OutputChannel::CH1_HeadphoneLeft)] = stimulus;
+        for (const auto channel : {OutputChannel::CH3_HapticP1, OutputChannel::CH4_HapticP2}) {
+            const auto idx = static_cast<std::size_t>(channel);
+            if (idx < numChannels) {
+                out[idx] = haptic;
+            }
+        }
+    }
+    outputCursor_ += numFrames;
+    if (inputCursor_ >= totalSamples_ && outputCursor_ >= totalSamples_) {
+        finalize();
+    }
+}
+
+void LatencyProbe::finalize() {
+    if (complete_) {
+        return;
+    }
+    running_ = false;
+    complete_ = true;
+
+    LatencyReport report;
+    report.sampleRate = sampleRate_;
+    report.pulsesSent = pulses_;
+    report.filterDelayMs = timeline_.filterGroupDelaySec(kStimulusHz) * 1000.0;
+    report.hapticOutputAvailable = hapticOutputAvailable_;
+
+    const auto complete = [](const PulseTimes& t) {
+        return t.stimulusOut >= 0 && t.stimulusIn >= 0 && t.trigger >= 0 && t.hapticOut >= 0 && t.hapticIn >= 0;
+    };
+    // Fixed-size scratch: this runs on the audio thread.
+    std::array<std::int64_t, kMaxPulses> values{};
+    const auto summarize = [&](std::int64_t PulseTimes::*to, std::int64_t PulseTimes::*from,
+                               std::int64_t& spread) {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < pulses_; ++i) {
+            if (complete(times_[i])) {
+                values[count++] = times_[i].*to - times_[i].*from;
+            }
+        }
+        LatencyStageStats stats;
+        stats.count = count;
+        spread = 0;
+        if (count == 0) {
+            return stats;
+        }
+        std::sort(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(count));
+        const double toMs = 1000.0 / sampleRate_;
+        const double median = count % 2 == 1
+                                  ? static_cast<double>(values[count / 2])
+                                  : 0.5 * static_cast<double>(values[count / 2 - 1] + values[count / 2]);
+        stats.minMs = static_cast<double>(values[0]) * toMs;
+        stats.medianMs = median * toMs;
+        stats.maxMs = static_cast<double>(values[count - 1]) * toMs;
+        spread = values[count - 1] - values[0];
+        return stats;
+    };
+
+    std::int64_t roundTripSpread = 0;
+    std::int64_t hapticReturnSpread = 0;
+    std::int64_t unused = 0;
+    report.roundTrip = summarize(&PulseTimes::stimulusIn, &PulseTimes::stimulusOut, roundTripSpread);
+    report.detection = summarize(&PulseTimes::trigger, &PulseTimes::stimulusIn, unused);
+    report.hapticRender = summarize(&PulseTimes::hapticOut, &PulseTimes::stimulusIn, unused);
+    report.hapticReturn = summarize(&PulseTimes::hapticIn, &PulseTimes::hapticOut, hapticReturnSpread);
+    report.inputToHaptic = summarize(&PulseTimes::hapticIn, &PulseTimes::stimulusIn, unused);
+    report.pulsesMeasured = report.roundTrip.count;
+    report.stable = report.pulsesMeasured == pulses_ && roundTripSpread <= kStableSpreadSamples &&
+                    hapticReturnSpread <= kStableSpreadSamples;
+    report_ = report;
+}
+
+} // namespace knot::audio
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "BeatTimeline.h"
+#include "CrosstalkCanceller.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace knot::audio {
+
+struct LatencyStageStats {
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double maxMs = 0.0;
+    std::size_t count = 0;
+};
+
+/// Result of one LatencyProbe run. Stages are measured per pulse and summarised over pulses.
+struct LatencyReport {
+    double sampleRate = 48000.0;
+    std::size_t pulsesSent = 0;
+    /// Pulses for which every stage below was observed.
+    std::size_t pulsesMeasured = 0;
+    /// Steady-state group delay of the detector band-pass at the stimulus frequency. The onset
+    /// detector usually fires on the leading edge, before this much has elapsed.
+    double filterDelayMs = 0.0;
+    /// CH1 out -> loopback -> input P1: converters plus input and output buffering.
+    LatencyStageStats roundTrip;
+    /// Stimulus arrival at input P1 -> BeatTimeline trigger (filter, envelope attack, threshold).
+    /// Arrival is the pulse start as it reaches the input.
+    LatencyStageStats detection;
+    /// Stimulus arrival -> first haptic sample rendered, on the callback-aligned sample clock. The
+    /// haptic envelope is taken once per block, so this is negative when the block carrying the
+    /// arrival already drives the burst, and at most one block late otherwise.
+    LatencyStageStats hapticRender;
+    /// CH3 out -> loopback -> input P2; matches roundTrip when both cables share the interface.
+    LatencyStageStats hapticReturn;
+    /// Stimulus arrival -> haptic burst arrival: the stethoscope-to-vibration latency.
+    LatencyStageStats inputToHaptic;
+    bool hapticOutputAvailable = false;
+    /// Every pulse measured and both round trips constant to within kStableSpreadSamples; an
+    /// over- or underrun shifts input against output by a block and breaks that.
+    bool stable = false;
+};
+
+/// Loopback latency test of the input-to-haptic path. Wiring: output CH1 -> input P1 (the
+/// stethoscope input) and output CH3 (haptic P1) -> input P2. A heartbeat-band pulse is played on
+/// CH1, detected by a private BeatTimeline exactly as the live pipeline detects P1, and its
+/// envelope drives a haptic burst on CH3 the way AudioRouter renders MixMode::Haptic: 50 Hz
+/// carrier, envelope sampled once per input block. Like CalibrationSession, generate() and
+/// capture() count samples from the same callback, so input and output sample indices compare
+/// directly. Onsets are threshold crossings referred back to the pulse start, and the crossing
+/// offset is the same on the way out and back, so it cancels.
+class LatencyProbe {
+public:
+    static constexpr std::size_t kMaxPulses = 32;
+    static constexpr double kStimulusHz = 60.0;
+    static constexpr std::int64_t kStableSpreadSamples = 2;
+
+    /// inputGainLinear is the pipeline's input gain; the detector sees the stimulus through it, and
+    /// through the crosstalk canceller's resampling delay when the pipeline has it enabled.
+    void setup(double sampleRate, std::size_t pulses, float inputGainLinear, bool crosstalkCancellation);
+    void start();
+    /// Interleaved stereo input block: P1 carries the looped-back stimulus, P2 the haptic burst.
+    void capture(const float* interleavedStereo, std::size_t numFrames);
+    /// Writes the stimulus to CH1 and the haptic burst to CH3 (and CH4); other channels are
+    /// zeroed. Stays silent until the first capture() so both sample counts start together.
+    void generate(float* interleaved, std::size_t numFrames, std::size_t numChannels);
+    bool isRunning() const { return running_; }
+    bool isComplete() const { return complete_; }
+    const LatencyReport& report() const { return report_; }
+
+private:
+    struct PulseTimes {
+        std::int64_t stimulusOut = -1;
+        std::int64_t stimulusIn = -1;
+        std::int64_t trigger = -1;
+        std::int64_t hapticOut = -1;
+        std::int64_t hapticIn = -1;
+    };
+
+    double sampleRate_ = 48000.0;
+    std::size_t pulses_ = 8;
+    std::uint64_t leadSamples_ = 0;
+    std::uint64_t intervalSamples_ = 0;
+    std::uint64_t stimulusSamples_ = 0;
+    std::uint64_t totalSamples_ = 0;
+    float inputGainLinear_ = 1.0f;
+    float stimulusAmplitude_ = 0.5f;
+    float stimulusThreshold_ = 0.05f;
+
+    BeatTimeline timeline_{};
+    CrosstalkCanceller crosstalkCanceller_{};
+    bool crosstalkCancellation_ = false;
+    double lastTriggerSec_ = -1.0;
+    std::int64_t stimulusOnsetOffset_ = 0;
+    float hapticEnvelope_ = 0.0f;
+    double hapticPhase_ = 0.0;
+    std::uint64_t inputCursor_ = 0;
+    std::uint64_t outputCursor_ = 0;
+    bool inputStarted_ = false;
+    bool hapticOutputAvailable_ = false;
+    bool running_ = false;
+    bool complete_ = false;
+    std::array<PulseTimes, kMaxPulses> times_{};
+    std::array<float, 256> monoScratch_{};
+    // P2 carries the haptic burst, which follows P1; the canceller gets silence as P2 so it adds
+    // its delay without cancelling the stimulus.
+    std::array<float, 256> silentScratch_{};
+    LatencyReport report_{};
+
+    /// Pulse whose window [lead + k * interval, lead + (k + 1) * interval) holds sample, or -1.
+    int pulseAt(std::uint64_t sample) const;
+    float stimulusAt(std::uint64_t sample) const;
+    void finalize();
+};
+
+} // namespace knot::audio
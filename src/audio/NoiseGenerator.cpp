@@ -0,0 +1,148 @@
+#include "NoiseGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+namespace {
+// Sum of kTerms = 4 U(0,1) has mean 2 and variance 1/3.
+constexpr float kUniformScale = 1.0f / 16777216.0f;
+const float kIrwinHallScale = std::sqrt(3.0f);
+constexpr float kIrwinHallMean = 2.0f;
+
+std::uint64_t splitMix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+} // namespace
+
+std::string noiseColorToString(NoiseColor color) {
+    switch (color) {
+        case NoiseColor::Pink:
+            return "pink";
+        case NoiseColor::Brown:
+            return "brown";
+        case NoiseColor::White:
+        default:
+            return "white";
+    }
+}
+
+std::optional<NoiseColor> noiseColorFromString(const std::string& name) {
+    if (name == "white") {
+        return NoiseColor::White;
+    }
+    if (name == "pink") {
+        return NoiseColor::Pink;
+    }
+    if (name == "brown") {
+        return NoiseColor::Brown;
+    }
+    return std::nullopt;
+}
+
+void NoiseGenerator::setup(double sampleRate) {
+    const double leak = std::exp(-2.0 * M_PI * kBrownCornerHz / std::max(sampleRate, 1.0));
+    brownLeak_ = static_cast<float>(leak);
+    // Stationary variance of y = leak * y + scale * w is scale^2 / (1 - leak^2).
+    brownScale_ = static_cast<float>(std::sqrt(1.0 - leak * leak));
+}
+
+void NoiseGenerator::seed(std::uint64_t seed) {
+    std::uint64_t state = seed;
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        const std::uint64_t a = splitMix64(state);
+        const std::uint64_t b = splitMix64(state);
+        s0_[lane] = static_cast<std::uint32_t>(a);
+        s1_[lane] = static_cast<std::uint32_t>(a >> 32);
+        s2_[lane] = static_cast<std::uint32_t>(b);
+        s3_[lane] = static_cast<std::uint32_t>(b >> 32) | 1u; // never all zero
+    }
+    spareCount_ = 0;
+    pinkRows_.fill(0.0f);
+    pinkSum_ = 0.0f;
+    pinkCounter_ = 0;
+    brownState_ = 0.0f;
+}
+
+void NoiseGenerator::step(float* out) {
+    std::array<float, kLanes> uniforms{};
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        const std::uint32_t result = s0_[lane] + s3_[lane];
+        const std::uint32_t t = s1_[lane] << 9;
+        s2_[lane] ^= s0_[lane];
+        s3_[lane] ^= s1_[lane];
+        s1_[lane] ^= s2_[lane];
+        s0_[lane] ^= s3_[lane];
+        s2_[lane] ^= t;
+        s3_[lane] = (s3_[lane] << 11) | (s3_[lane] >> 21);
+        // Top 24 bits (the low bits of xoshiro128+ are its weakest); signed so it converts packed.
+        uniforms[lane] = static_cast<float>(static_cast<std::int32_t>(result >> 8)) * kUniformScale;
+    }
+    std::array<float, kSamplesPerStep> sum{};
+    for (std::size_t term = 0; term < kTerms; ++term) {
+        for (std::size_t i = 0; i < kSamplesPerStep; ++i) {
+            sum[i] += uniforms[term * kSamplesPerStep + i];
+        }
+    }
+    for (std::size_t i = 0; i < kSamplesPerStep; ++i) {
+        out[i] = (sum[i] - kIrwinHallMean) * kIrwinHallScale;
+    }
+}
+
+void NoiseGenerator::fillWhite(float* out, std::size_t numFrames) {
+    std::size_t frame = 0;
+    // Samples left over from the previous call come first, so any split of the output into
+    // blocks reads the same sequence.
+    while (frame < numFrames && spareCount_ > 0) {
+        out[frame++] = spare_[kSamplesPerStep - spareCount_--];
+    }
+    for (; frame + kSamplesPerStep <= numFrames; frame += kSamplesPerStep) {
+        step(out + frame);
+    }
+    if (frame < numFrames) {
+        step(spare_.data());
+        spareCount_ = kSamplesPerStep;
+        while (frame < numFrames) {
+            out[frame++] = spare_[kSamplesPerStep - spareCount_--];
+        }
+    }
+}
+
+void NoiseGenerator::fill(float* out, std::size_t numFrames) {
+    if (color_ == NoiseColor::White) {
+        fillWhite(out, numFrames);
+        return;
+    }
+    const float pinkNorm = 1.0f / std::sqrt(static_cast<float>(kPinkRows + 1));
+    for (std::size_t offset = 0; offset < numFrames; offset += kChunk) {
+        const std::size_t count = std::min(kChunk, numFrames - offset);
+        float* chunk = out + offset;
+        if (color_ == NoiseColor::Pink) {
+            fillWhite(pinkDraws_.data(), 2 * count);
+            for (std::size_t i = 0; i < count; ++i) {
+                // Row k is redrawn every 2^(k+1) samples: the lowest set bit of the counter picks it.
+                const std::uint32_t counter = ++pinkCounter_;
+                std::size_t row = 0;
+                for (std::uint32_t bits = counter; (bits & 1u) == 0 && row + 1 < kPinkRows; bits >>= 1) {
+                    ++row;
+                }
+                const float draw = pinkDraws_[2 * i + 1];
+                pinkSum_ += draw - pinkRows_[row];
+                pinkRows_[row] = draw;
+                chunk[i] = (pinkSum_ + pinkDraws_[2 * i]) * pinkNorm;
+            }
+        } else {
+            fillWhite(white_.data(), count);
+            for (std::size_t i = 0; i < count; ++i) {
+                brownState_ = brownLeak_ * brownState_ + brownScale_ * white_[i];
+                chunk[i] = brownState_;
+            }
+        }
+    }
+}
+
+} // namespace knot::audio
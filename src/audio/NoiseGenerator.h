@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace knot::audio {
+
+enum class NoiseColor : std::uint8_t {
+    White,
+    Pink,
+    Brown
+};
+
+std::string noiseColorToString(NoiseColor color);
+std::optional<NoiseColor> noiseColorFromString(const std::string& name);
+
+/// Unit-variance background noise for the monitor mix. kLanes xoshiro128+ generators run side by
+/// side in plain loops over fixed arrays, so the compiler vectorises the state updates; each
+/// step yields kSamplesPerStep Gaussian samples, each the sum of kTerms uniforms from different
+/// lanes (Irwin-Hall; tails cut at +-3.5 sigma, which is inaudible in a noise bed). Pink noise is Voss-McCartney over
+/// kPinkRows octave rows, brown noise a leaky integrator with its corner at kBrownCornerHz; both
+/// are scaled back to unit variance. The same seed always gives the same samples, however the
+/// output is split into blocks. No allocation.
+class NoiseGenerator {
+public:
+    static constexpr std::size_t kTerms = 4;
+    static constexpr std::size_t kSamplesPerStep = 4;
+    static constexpr std::size_t kLanes = kTerms * kSamplesPerStep;
+    static constexpr std::size_t kPinkRows = 12;
+    static constexpr double kBrownCornerHz = 20.0;
+
+    void setup(double sampleRate);
+    void seed(std::uint64_t seed);
+    /// Switching colour keeps the generator state, so the sequence stays reproducible.
+    void setColor(NoiseColor color) { color_ = color; }
+    NoiseColor color() const { return color_; }
+    void fill(float* out, std::size_t numFrames);
+
+private:
+    static constexpr std::size_t kChunk = 64;
+
+    // xoshiro128+ state, one column per lane.
+    std::array<std::uint32_t, kLanes> s0_{};
+    std::array<std::uint32_t, kLanes> s1_{};
+    std::array<std::uint32_t, kLanes> s2_{};
+    std::array<std::uint32_t, kLanes> s3_{};
+    std::array<float, kSamplesPerStep> spare_{};
+    std::size_t spareCount_ = 0;
+    NoiseColor color_ = NoiseColor::White;
+    std::array<float, kPinkRows> pinkRows_{};
+    float pinkSum_ = 0.0f;
+    std::uint32_t pinkCounter_ = 0;
+    float brownState_ = 0.0f;
+    float brownLeak_ = 0.999f;
+    float brownScale_ = 0.04f;
+    std::array<float, kChunk> white_{};
+    // Pink: the white sample and the row redraw of each output sample, interleaved, so both come
+    // from one sequence whatever the block split.
+    std::array<float, 2 * kChunk> pinkDraws_{};
+
+    /// One step of every lane: kSamplesPerStep white samples into out.
+    void step(float* out);
+    void fillWhite(float* out, std::size_t numFrames);
+};
+
+} // namespace knot::audio
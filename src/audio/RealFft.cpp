@@ -0,0 +1,134 @@
+#include "RealFft.h"
+
+#include <cmath>
+#include <utility>
+
+namespace knot::audio {
+
+void RealFft::setup(std::size_t size) {
+    size_ = 2;
+    while (size_ < size) {
+        size_ <<= 1;
+    }
+    half_ = size_ / 2;
+
+    std::size_t bits = 0;
+    while ((std::size_t{1} << bits) < half_) {
+        ++bits;
+    }
+    bitReverse_.assign(half_, 0);
+    for (std::size_t i = 0; i < half_; ++i) {
+        std::size_t reversed = 0;
+        for (std::size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bitReverse_[i] = reversed;
+    }
+
+    // Twiddles for the N/2 complex FFT (first half) and the real split step (second half).
+    twiddleRe_.assign(half_ + half_, 0.0f);
+    twiddleIm_.assign(half_ + half_, 0.0f);
+    for (std::size_t k = 0; k < half_; ++k) {
+        const double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(half_);
+        twiddleRe_[k] = static_cast<float>(std::cos(angle));
+        twiddleIm_[k] = static_cast<float>(std::sin(angle));
+        const double splitAngle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(size_);
+        twiddleRe_[half_ + k] = static_cast<float>(std::cos(splitAngle));
+        twiddleIm_[half_ + k] = static_cast<float>(std::sin(splitAngle));
+    }
+
+    splitRe_.assign(half_, 0.0f);
+    splitIm_.assign(half_, 0.0f);
+    workRe_.assign(half_, 0.0f);
+    workIm_.assign(half_, 0.0f);
+}
+
+void RealFft::complexFft(float* re, float* im, bool inverse) const {
+    for (std::size_t i = 0; i < half_; ++i) {
+        const std::size_t j = bitReverse_[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (std::size_t span = 1; span < half_; span <<= 1) {
+        const std::size_t stride = half_ / (span * 2);
+        for (std::size_t start = 0; start < half_; start += span * 2) {
+            for (std::size_t k = 0; k < span; ++k) {
+                const float wr = twiddleRe_[k * stride];
+                const float wi = sign * twiddleIm_[k * stride];
+                const std::size_t a = start + k;
+                const std::size_t b = a + span;
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void RealFft::forward(const float* input, float* re, float* im) {
+    for (std::size_t n = 0; n < half_; ++n) {
+        workRe_[n] = input[2 * n];
+        workIm_[n] = input[2 * n + 1];
+    }
+    complexFft(workRe_.data(), workIm_.data(), false);
+
+    // X[k] = E[k] + W^k O[k], with E/O recovered from Z[k] and conj(Z[M-k]).
+    for (std::size_t k = 0; k <= half_; ++k) {
+        const std::size_t a = k % half_;
+        const std::size_t b = (half_ - k) % half_;
+        const float zr = workRe_[a];
+        const float zi = workIm_[a];
+        const float cr = workRe_[b];
+        const float ci = -workIm_[b];
+        const float er = 0.5f * (zr + cr);
+        const float ei = 0.5f * (zi + ci);
+        // (Z - conj) / (2i) = -i/2 * (Z - conj)
+        const float orr = 0.5f * (zi - ci);
+        const float oi = -0.5f * (zr - cr);
+        float wr = 1.0f;
+        float wi = 0.0f;
+        if (k < half_) {
+            wr = twiddleRe_[half_ + k];
+            wi = twiddleIm_[half_ + k];
+        } else {
+            wr = -1.0f;
+        }
+        re[k] = er + (orr * wr - oi * wi);
+        im[k] = ei + (orr * wi + oi * wr);
+    }
+}
+
+void RealFft::inverse(const float* re, const float* im, float* output) {
+    // E[k] = X[k] + conj(X[M-k]), O[k] = (X[k] - conj(X[M-k])) * conj(W^k); Z = E + iO.
+    // Skipping the 1/2 here makes the unnormalised M-point inverse yield N * x.
+    for (std::size_t k = 0; k < half_; ++k) {
+        const std::size_t b = half_ - k;
+        const float xr = re[k];
+        const float xi = im[k];
+        const float cr = re[b];
+        const float ci = -im[b];
+        const float er = xr + cr;
+        const float ei = xi + ci;
+        const float dr = xr - cr;
+        const float di = xi - ci;
+        const float wr = twiddleRe_[half_ + k];
+        const float wi = -twiddleIm_[half_ + k];
+        const float orr = dr * wr - di * wi;
+        const float oi = dr * wi + di * wr;
+        splitRe_[k] = er - oi;
+        splitIm_[k] = ei + orr;
+    }
+    complexFft(splitRe_.data(), splitIm_.data(), true);
+    for (std::size_t n = 0; n < half_; ++n) {
+        output[2 * n] = splitRe_[n];
+        output[2 * n + 1] = splitIm_[n];
+    }
+}
+
+} // namespace knot::audio
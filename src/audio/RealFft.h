@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace knot::audio {
+
+/// Radix-2 real FFT of a fixed power-of-two size N, computed as an N/2 complex FFT plus a
+/// split step. Spectra are stored split (separate real/imaginary arrays) with N/2 + 1 bins.
+/// All tables are built in setup(); forward()/inverse() never allocate.
+class RealFft {
+public:
+    void setup(std::size_t size);
+
+    std::size_t size() const { return size_; }
+    std::size_t numBins() const { return size_ / 2 + 1; }
+
+    /// input: size() samples. re/im: numBins() values each.
+    void forward(const float* input, float* re, float* im);
+    /// Unnormalised inverse: output is size() times the original signal. Callers fold the
+    /// 1/size() factor into whatever spectrum they multiply with.
+    void inverse(const float* re, const float* im, float* output);
+
+private:
+    void complexFft(float* re, float* im, bool inverse) const;
+
+    std::size_t size_ = 0;
+    std::size_t half_ = 0;
+    std::vector<std::size_t> bitReverse_;
+    std::vector<float> twiddleRe_;
+    std::vector<float> twiddleIm_;
+    std::vector<float> splitRe_;
+    std::vector<float> splitIm_;
+    std::vector<float> workRe_;
+    std::vector<float> workIm_;
+};
+
+} // namespace knot::audio
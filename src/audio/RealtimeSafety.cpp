@@ -0,0 +1,104 @@
+#include "RealtimeSafety.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace knot::audio::rt {
+
+namespace {
+thread_local bool tAudioThread = false;
+std::atomic<std::uint64_t> gAllocations{0};
+std::atomic<std::uint64_t> gDeallocations{0};
+std::atomic<std::uint64_t> gBlockingWaits{0};
+} // namespace
+
+ScopedAudioThread::ScopedAudioThread() {
+    if constexpr (kChecksEnabled) {
+        previous_ = tAudioThread;
+        tAudioThread = true;
+    }
+}
+
+ScopedAudioThread::~ScopedAudioThread() {
+    if constexpr (kChecksEnabled) {
+        tAudioThread = previous_;
+    }
+}
+
+bool isAudioThread() {
+    return kChecksEnabled && tAudioThread;
+}
+
+void noteBlockingWait() {
+    gBlockingWaits.fetch_add(1, std::memory_order_relaxed);
+}
+
+ViolationCounts violations() {
+    ViolationCounts counts;
+    counts.allocations = gAllocations.load(std::memory_order_relaxed);
+    counts.deallocations = gDeallocations.load(std::memory_order_relaxed);
+    counts.blockingWaits = gBlockingWaits.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void resetViolations() {
+    gAllocations.store(0, std::memory_order_relaxed);
+    gDeallocations.store(0, std::memory_order_relaxed);
+    gBlockingWaits.store(0, std::memory_order_relaxed);
+}
+
+#if KNOT_RT_SAFETY_CHECKS
+namespace detail {
+
+void* checkedAllocate(std::size_t size) {
+    if (tAudioThread) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* checkedAllocateNoThrow(std::size_t size) noexcept {
+    if (tAudioThread) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void checkedFree(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    if (tAudioThread) {
+        gDeallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::free(ptr);
+}
+
+} // namespace detail
+#endif
+
+} // namespace knot::audio::rt
+
+#if KNOT_RT_SAFETY_CHECKS
+// Replacing the global allocation functions is the only portable way to see allocations made
+// inside std:: and openFrameworks code called from the audio callback. Over-aligned new/delete
+// are left to the runtime; nothing in the audio path uses them.
+void* operator new(std::size_t size) { return knot::audio::rt::detail::checkedAllocate(size); }
+void* operator new[](std::size_t size) { return knot::audio::rt::detail::checkedAllocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return knot::audio::rt::detail::checkedAllocateNoThrow(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return knot::audio::rt::detail::checkedAllocateNoThrow(size);
+}
+void operator delete(void* ptr) noexcept { knot::audio::rt::detail::checkedFree(ptr); }
+void operator delete[](void* ptr) noexcept { knot::audio::rt::detail::checkedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { knot::audio::rt::detail::checkedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { knot::audio::rt::detail::checkedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { knot::audio::rt::detail::checkedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { knot::audio::rt::detail::checkedFree(ptr); }
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+// Real-time safety checks are compiled into debug builds by default. Define
+// KNOT_RT_SAFETY_CHECKS=0 to disable them, or =1 to force them on in release builds.
+#if !defined(KNOT_RT_SAFETY_CHECKS)
+#if defined(NDEBUG)
+#define KNOT_RT_SAFETY_CHECKS 0
+#else
+#define KNOT_RT_SAFETY_CHECKS 1
+#endif
+#endif
+
+namespace knot::audio::rt {
+
+struct ViolationCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t blockingWaits = 0;
+
+    std::uint64_t total() const { return allocations + deallocations + blockingWaits; }
+};
+
+constexpr bool kChecksEnabled = KNOT_RT_SAFETY_CHECKS != 0;
+
+/// Marks the current thread as running audio-callback code for the guard's lifetime.
+/// While active (and checks are compiled in), heap allocation/free through global
+/// operator new/delete and CheckedLock acquisitions are counted as violations.
+class ScopedAudioThread {
+public:
+    ScopedAudioThread();
+    ~ScopedAudioThread();
+    ScopedAudioThread(const ScopedAudioThread&) = delete;
+    ScopedAudioThread& operator=(const ScopedAudioThread&) = delete;
+
+private:
+    bool previous_ = false;
+};
+
+bool isAudioThread();
+void noteBlockingWait();
+ViolationCounts violations();
+void resetViolations();
+
+/// lock_guard replacement that reports a blocking wait whenever the audio thread takes the
+/// mutex. Whether it actually had to wait depends on timing, so an uncontended acquisition
+/// counts too: it blocks as soon as another thread happens to hold the mutex.
+template <typename Mutex>
+class CheckedLock {
+public:
+    explicit CheckedLock(Mutex& mutex) : mutex_(mutex) {
+        if constexpr (kChecksEnabled) {
+            if (isAudioThread()) {
+                noteBlockingWait();
+            }
+        }
+        mutex_.lock();
+    }
+    ~CheckedLock() { mutex_.unlock(); }
+    CheckedLock(const CheckedLock&) = delete;
+    CheckedLock& operator=(const CheckedLock&) = delete;
+
+private:
+    Mutex& mutex_;
+};
+
+} // namespace knot::audio::rt
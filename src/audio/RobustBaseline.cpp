@@ -0,0 +1,94 @@
+#include "RobustBaseline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace knot::audio {
+
+void RobustBaseline::setup(double sampleRate, double windowSec, double hopSec) {
+    hopSamples_ = static_cast<std::size_t>(std::max(1.0, std::round(hopSec * sampleRate)));
+    capacity_ = static_cast<std::size_t>(std::max(1.0, std::round(windowSec / std::max(hopSec, 1e-6))));
+    ring_.assign(capacity_, 0.0f);
+    sorted_.assign(capacity_, 0.0f);
+    reset();
+}
+
+void RobustBaseline::reset() {
+    hopFill_ = 0;
+    hopPeak_ = 0.0f;
+    ringHead_ = 0;
+    count_ = 0;
+    median_ = 0.0f;
+    mad_ = 0.0f;
+}
+
+bool RobustBaseline::process(float envelope) {
+    if (capacity_ == 0) {
+        return false;
+    }
+    hopPeak_ = std::max(hopPeak_, envelope);
+    if (++hopFill_ < hopSamples_) {
+        return false;
+    }
+    push(hopPeak_);
+    hopFill_ = 0;
+    hopPeak_ = 0.0f;
+    updateStatistics();
+    return true;
+}
+
+void RobustBaseline::push(float value) {
+    const auto begin = sorted_.begin();
+    if (count_ == capacity_) {
+        // Replace the oldest value in place: shift the values between its slot and the new
+        // value's slot by one, in whichever direction the new value lies.
+        const float oldest = ring_[ringHead_];
+        auto out = std::lower_bound(begin, begin + count_, oldest);
+        auto in = std::lower_bound(begin, begin + count_, value);
+        if (in > out) {
+            std::move(out + 1, in, out);
+            *(in - 1) = value;
+        } else {
+            std::move_backward(in, out, out + 1);
+            *in = value;
+        }
+    } else {
+        auto in = std::upper_bound(begin, begin + count_, value);
+        std::move_backward(in, begin + count_, begin + count_ + 1);
+        *in = value;
+        ++count_;
+    }
+    ring_[ringHead_] = value;
+    ringHead_ = (ringHead_ + 1) % capacity_;
+}
+
+void RobustBaseline::updateStatistics() {
+    const std::size_t n = count_;
+    const float* x = sorted_.data();
+    const std::size_t mid = n / 2;
+    median_ = (n % 2 == 1) ? x[mid] : 0.5f * (x[mid - 1] + x[mid]);
+
+    // Deviations below the median, read downwards from it, and above it, read upwards, are each
+    // ascending; merging them yields the sorted deviations, of which the median is the MAD.
+    std::size_t below = mid;     // next candidate x[below - 1]
+    std::size_t above = mid;     // next candidate x[above]
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+    float previous = 0.0f;
+    float current = 0.0f;
+    for (std::size_t taken = 0; taken <= mid; ++taken) {
+        const float down = below > 0 ? median_ - x[below - 1] : kInf;
+        const float up = above < n ? x[above] - median_ : kInf;
+        previous = current;
+        if (down <= up) {
+            current = down;
+            --below;
+        } else {
+            current = up;
+            ++above;
+        }
+    }
+    mad_ = (n % 2 == 1) ? current : 0.5f * (previous + current);
+}
+
+} // namespace knot::audio
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace knot::audio {
+
+/// Running median and MAD (median absolute deviation) of an envelope over a sliding window.
+/// The envelope is reduced to one value per hop (its peak), and the window keeps those values
+/// twice: in arrival order, to know which one leaves, and sorted. Each hop removes the oldest
+/// value from the sorted copy and inserts the new one, a binary search and a shift each; the
+/// median is then read directly and the MAD by merging the deviations on either side of it.
+/// setup() allocates; process() does not.
+class RobustBaseline {
+public:
+    static constexpr double kDefaultWindowSec = 20.0;
+    static constexpr double kDefaultHopSec = 0.05;
+    /// Consistency factor: MAD * kMadToSigma estimates the standard deviation of Gaussian noise.
+    static constexpr float kMadToSigma = 1.4826f;
+
+    void setup(double sampleRate, double windowSec = kDefaultWindowSec, double hopSec = kDefaultHopSec);
+    void reset();
+    /// Adds one envelope sample; returns true when a hop completed and the statistics moved.
+    bool process(float envelope);
+
+    /// The window is at least a quarter full; before that the statistics are not trusted.
+    bool ready() const { return count_ * 4 >= capacity_ && count_ > 0; }
+    float median() const { return median_; }
+    float mad() const { return mad_; }
+    std::size_t count() const { return count_; }
+
+private:
+    std::size_t capacity_ = 0;
+    std::size_t hopSamples_ = 1;
+    std::size_t hopFill_ = 0;
+    float hopPeak_ = 0.0f;
+    std::vector<float> ring_;
+    std::size_t ringHead_ = 0;
+    std::vector<float> sorted_;
+    std::size_t count_ = 0;
+    float median_ = 0.0f;
+    float mad_ = 0.0f;
+
+    void push(float value);
+    void updateStatistics();
+};
+
+} // namespace knot::audio
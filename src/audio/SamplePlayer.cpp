@@ -0,0 +1,202 @@
+#include "SamplePlayer.h"
+
+#include "AudioLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace knot::audio {
+
+namespace {
+
+std::uint32_t readU32(const unsigned char* data) {
+    return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+           (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+std::uint16_t readU16(const unsigned char* data) {
+    return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+}
+
+float decodeSample(const unsigned char* data, std::uint16_t format, std::uint16_t bits) {
+    if (format == 3 && bits == 32) {
+        float value = 0.0f;
+        std::memcpy(&value, data, sizeof(float));
+        return value;
+    }
+    switch (bits) {
+        case 16:
+            return static_cast<float>(static_cast<std::int16_t>(readU16(data))) / 32768.0f;
+        case 24: {
+            std::int32_t value = static_cast<std::int32_t>(data[0] | (data[1] << 8) | (data[2] << 16));
+            if (value & 0x800000) {
+                value -= 0x1000000;
+            }
+            return static_cast<float>(value) / 8388608.0f;
+        }
+        case 32:
+            return static_cast<float>(static_cast<std::int32_t>(readU32(data))) / 2147483648.0f;
+        default:
+            return 0.0f;
+    }
+}
+
+std::vector<float> resampleLinear(const std::vector<float>& input, double ratio) {
+    if (input.empty() || std::fabs(ratio - 1.0) < 1e-9) {
+        return input;
+    }
+    const auto outLength = static_cast<std::size_t>(std::floor(static_cast<double>(input.size() - 1) / ratio)) + 1;
+    std::vector<float> output(outLength);
+    for (std::size_t n = 0; n < outLength; ++n) {
+        const double position = static_cast<double>(n) * ratio;
+        const auto index = static_cast<std::size_t>(position);
+        const auto frac = static_cast<float>(position - static_cast<double>(index));
+        const float a = input[index];
+        const float b = index + 1 < input.size() ? input[index + 1] : a;
+        output[n] = a + (b - a) * frac;
+    }
+    return output;
+}
+
+} // namespace
+
+bool CueSample::loadWav(const std::filesystem::path& path, double targetSampleRate, CueSample& out) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        logWarning("SamplePlayer") << "Cue file not found: " << path;
+        return false;
+    }
+    const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        logError("SamplePlayer") << "Not a RIFF/WAVE file: " << path;
+        return false;
+    }
+
+    std::uint16_t format = 0;
+    std::uint16_t channels = 0;
+    std::uint32_t sampleRate = 0;
+    std::uint16_t bits = 0;
+    const unsigned char* data = nullptr;
+    std::size_t dataSize = 0;
+    std::size_t offset = 12;
+    while (offset + 8 <= bytes.size()) {
+        const unsigned char* chunk = bytes.data() + offset;
+        const std::uint32_t chunkSize = readU32(chunk + 4);
+        const std::size_t available = std::min<std::size_t>(chunkSize, bytes.size() - offset - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+            format = readU16(chunk + 8);
+            channels = readU16(chunk + 10);
+            sampleRate = readU32(chunk + 12);
+            bits = readU16(chunk + 22);
+            if (format == 0xFFFE && available >= 26) {
+                format = readU16(chunk + 32);  // WAVE_FORMAT_EXTENSIBLE sub-format tag
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataSize = available;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1u);
+    }
+
+    const bool supported = (format == 1 && (bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32);
+    if (!data || channels == 0 || sampleRate == 0 || !supported) {
+        logError("SamplePlayer") << "Unsupported WAV encoding in " << path << " (format " << format << ", "
+                                 << bits << " bit, " << channels << " ch)";
+        return false;
+    }
+
+    const std::size_t frameBytes = static_cast<std::size_t>(bits / 8) * channels;
+    const std::size_t frames = dataSize / frameBytes;
+    std::vector<float> left(frames);
+    std::vector<float> right(frames);
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        const unsigned char* base = data + frame * frameBytes;
+        left[frame] = decodeSample(base, format, bits);
+        right[frame] = channels > 1 ? decodeSample(base + bits / 8, format, bits) : left[frame];
+    }
+
+    const double ratio = static_cast<double>(sampleRate) / targetSampleRate;
+    out.name = path.stem().string();
+    out.left = resampleLinear(left, ratio);
+    out.right = resampleLinear(right, ratio);
+    logNotice("SamplePlayer") << "Cue '" << out.name << "' loaded: " << out.length() << " frames ("
+                              << sampleRate << " Hz -> " << targetSampleRate << " Hz)";
+    return true;
+}
+
+std::optional<std::uint32_t> SamplePlayer::addSample(CueSample sample) {
+    const std::size_t index = sampleCount_.load(std::memory_order_relaxed);
+    if (index == samples_.size()) {
+        logWarning("SamplePlayer") << "Cue '" << sample.name << "' not added: all " << kMaxSamples
+                                   << " cue slots are in use";
+        return std::nullopt;
+    }
+    samples_[index] = std::move(sample);
+    sampleCount_.store(index + 1, std::memory_order_release);
+    return static_cast<std::uint32_t>(index);
+}
+
+const CueSample* SamplePlayer::sample(std::uint32_t cueId) const {
+    return cueId < sampleCount() ? &samples_[cueId] : nullptr;
+}
+
+void SamplePlayer::beginBlock(std::uint64_t blockStartSample, std::size_t numFrames) {
+    const std::uint64_t blockEnd = blockStartSample + numFrames;
+    commandReader_.poll([&](const CueCommand& command) {
+        if (command.type == CueCommand::Type::CancelPending) {
+            for (auto& pending : pending_) {
+                pending.valid = false;
+            }
+            return;
+        }
+        if (command.cueId >= sampleCount()) {
+            return;
+        }
+        if (command.startSample < blockEnd) {
+            start(command, std::max(command.startSample, blockStartSample));
+            return;
+        }
+        for (auto& pending : pending_) {
+            if (!pending.valid) {
+                pending.command = command;
+                pending.valid = true;
+                return;
+            }
+        }
+        CueReport report;
+        report.cueId = command.cueId;
+        report.requestedSample = command.startSample;
+        report.dropped = true;
+        reports_.publish(report);
+    });
+
+    for (auto& pending : pending_) {
+        if (pending.valid && pending.command.startSample < blockEnd) {
+            pending.valid = false;
+            start(pending.command, std::max(pending.command.startSample, blockStartSample));
+        }
+    }
+}
+
+void SamplePlayer::start(const CueCommand& command, std::uint64_t startSample) {
+    CueReport report;
+    report.cueId = command.cueId;
+    report.requestedSample = command.startSample;
+    report.startSample = startSample;
+    auto voice = std::find_if(voices_.begin(), voices_.end(), [](const Voice& v) { return !v.active; });
+    if (voice == voices_.end()) {
+        report.dropped = true;
+        reports_.publish(report);
+        return;
+    }
+    voice->active = true;
+    voice->cueId = command.cueId;
+    voice->startSample = startSample;
+    voice->gain = command.gain;
+    ++activeVoices_;
+    reports_.publish(report);
+}
+
+} // namespace knot::audio
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "EventBus.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace knot::audio {
+
+/// Decoded, in-memory stereo sample (mono files are duplicated to both channels).
+struct CueSample {
+    std::string name;
+    std::vector<float> left;
+    std::vector<float> right;
+
+    std::size_t length() const { return left.size(); }
+    /// Reads a PCM (16/24/32-bit) or float32 WAV file, resampling linearly to targetSampleRate.
+    static bool loadWav(const std::filesystem::path& path, double targetSampleRate, CueSample& out);
+};
+
+struct CueCommand {
+    enum class Type : std::uint8_t {
+        Play,
+        CancelPending
+    };
+    Type type = Type::Play;
+    std::uint32_t cueId = 0;
+    std::uint64_t startSample = 0;
+    float gain = 1.0f;
+};
+
+/// Published by the audio thread when a scheduled cue actually starts.
+struct CueReport {
+    std::uint32_t cueId = 0;
+    std::uint64_t requestedSample = 0;
+    std::uint64_t startSample = 0;
+    bool dropped = false;
+};
+
+using CueCommandBus = EventBus<CueCommand, 64>;
+using CueReportBus = EventBus<CueReport, 64>;
+
+/// Fixed voice pool that plays preloaded CueSamples at absolute output sample positions.
+/// Samples go into a fixed table, so they can be added while audio runs; the UI thread posts
+/// CueCommands and the audio thread mixes voices without allocating or locking.
+class SamplePlayer {
+public:
+    static constexpr std::size_t kMaxVoices = 8;
+    static constexpr std::size_t kMaxSamples = 32;
+
+    /// One caller at a time, concurrently with rendering. The sample is playable once its id is
+    /// returned; nullopt when the table is full.
+    std::optional<std::uint32_t> addSample(CueSample sample);
+    const CueSample* sample(std::uint32_t cueId) const;
+    std::size_t sampleCount() const { return sampleCount_.load(std::memory_order_acquire); }
+
+    /// UI thread (single producer).
+    void post(const CueCommand& command) { commands_.publish(command); }
+    CueReportBus::Subscriber subscribeReports() const { return reports_.subscribe(); }
+
+    /// Audio thread: consume pending commands and start voices due in [blockStart, blockStart + numFrames).
+    void beginBlock(std::uint64_t blockStartSample, std::size_t numFrames);
+
+    /// Audio thread: mixes all voices for the given absolute sample position.
+    inline void next(std::uint64_t sampleIndex, float& left, float& right) {
+        left = 0.0f;
+        right = 0.0f;
+        if (activeVoices_ == 0) {
+            return;
+        }
+        for (auto& voice : voices_) {
+            if (!voice.active || sampleIndex < voice.startSample) {
+                continue;
+            }
+            const auto position = static_cast<std::size_t>(sampleIndex - voice.startSample);
+            const CueSample& cue = samples_[voice.cueId];
+            if (position >= cue.length()) {
+                voice.active = false;
+                --activeVoices_;
+                continue;
+            }
+            left += cue.left[position] * voice.gain;
+            right += cue.right[position] * voice.gain;
+        }
+    }
+
+    std::size_t activeVoiceCount() const { return activeVoices_; }
+
+private:
+    struct Voice {
+        bool active = false;
+        std::uint32_t cueId = 0;
+        std::uint64_t startSample = 0;
+        float gain = 1.0f;
+    };
+
+    struct PendingCue {
+        CueCommand command;
+        bool valid = false;
+    };
+
+    void start(const CueCommand& command, std::uint64_t startSample);
+
+    std::array<CueSample, kMaxSamples> samples_{};
+    std::atomic<std::size_t> sampleCount_{0};
+    std::array<Voice, kMaxVoices> voices_{};
+    std::size_t activeVoices_ = 0;
+    std::array<PendingCue, CueCommandBus::capacity()> pending_{};
+
+    CueCommandBus commands_;
+    CueCommandBus::Subscriber commandReader_ = commands_.subscribe();
+    CueReportBus reports_;
+};
+
+} // namespace knot::audio
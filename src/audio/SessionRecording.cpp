@@ -0,0 +1,249 @@
+#include "SessionRecording.h"
+
+#include "AudioLog.h"
+#include "SamplePlayer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace knot::audio {
+
+namespace {
+
+constexpr std::size_t kWavHeaderBytes = 44;
+constexpr std::size_t kBytesPerFrame = 2 * sizeof(float);
+// RIFF sizes are 32-bit; stop appending before the header would overflow (~3 h at 48 kHz).
+constexpr std::uint64_t kMaxDataFrames = (0xFFFFFFFFull - kWavHeaderBytes) / kBytesPerFrame;
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+constexpr auto kHeaderRefreshInterval = std::chrono::seconds(1);
+
+void putU32(unsigned char* out, std::uint32_t value) {
+    out[0] = static_cast<unsigned char>(value & 0xFF);
+    out[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+    out[2] = static_cast<unsigned char>((value >> 16) & 0xFF);
+    out[3] = static_cast<unsigned char>((value >> 24) & 0xFF);
+}
+
+void putU16(unsigned char* out, std::uint16_t value) {
+    out[0] = static_cast<unsigned char>(value & 0xFF);
+    out[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+}
+
+} // namespace
+
+SessionRecorder::~SessionRecorder() {
+    stop();
+}
+
+std::filesystem::path SessionRecorder::markerPathFor(const std::filesystem::path& wavPath) {
+    auto markerPath = wavPath;
+    markerPath.replace_extension(".markers.csv");
+    return markerPath;
+}
+
+bool SessionRecorder::start(const std::filesystem::path& wavPath, double sampleRate) {
+    stop();
+    std::error_code ec;
+    std::filesystem::create_directories(wavPath.parent_path(), ec);
+    wav_.open(wavPath, std::ios::binary | std::ios::trunc);
+    markers_.open(markerPathFor(wavPath), std::ios::trunc);
+    if (!wav_ || !markers_) {
+        logError("SessionRecorder") << "Cannot open recording " << wavPath;
+        wav_.close();
+        markers_.close();
+        return false;
+    }
+    markers_ << "frame,label\n";
+    markers_.flush();
+
+    wavPath_ = wavPath;
+    sampleRate_ = sampleRate;
+    ring_.assign(kRingFrames * 2, 0.0f);
+    writeFrames_.store(0, std::memory_order_relaxed);
+    readFrames_.store(0, std::memory_order_relaxed);
+    droppedFrames_.store(0, std::memory_order_relaxed);
+    writtenFrames_ = 0;
+    sizeLimitReached_ = false;
+    writeHeader(0);
+
+    stopRequested_.store(false, std::memory_order_release);
+    recording_.store(true, std::memory_order_release);
+    thread_ = std::thread(&SessionRecorder::run, this);
+    logNotice("SessionRecorder") << "Recording raw input to " << wavPath;
+    return true;
+}
+
+void SessionRecorder::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    // Stop accepting audio first so the final drain sees a stable write position.
+    recording_.store(false, std::memory_order_release);
+    stopRequested_.store(true, std::memory_order_release);
+    thread_.join();
+    wav_.close();
+    markers_.close();
+    logNotice("SessionRecorder") << "Recording closed: " << wavPath_ << " ("
+                                 << static_cast<double>(writtenFrames_) / sampleRate_ << " s, "
+                                 << droppedFrames() << " frames dropped)";
+}
+
+void SessionRecorder::capture(const float* interleavedStereo, std::size_t numFrames) noexcept {
+    if (!recording_.load(std::memory_order_acquire)) {
+        return;
+    }
+    const std::uint64_t write = writeFrames_.load(std::memory_order_relaxed);
+    const std::uint64_t read = readFrames_.load(std::memory_order_acquire);
+    const auto space = static_cast<std::size_t>(kRingFrames - (write - read));
+    const std::size_t frames = std::min(numFrames, space);
+    if (frames < numFrames) {
+        droppedFrames_.fetch_add(numFrames - frames, std::memory_order_relaxed);
+    }
+    const auto start = static_cast<std::size_t>(write % kRingFrames);
+    const std::size_t first = std::min(frames, kRingFrames - start);
+    std::memcpy(ring_.data() + start * 2, interleavedStereo, first * kBytesPerFrame);
+    std::memcpy(ring_.data(), interleavedStereo + first * 2, (frames - first) * kBytesPerFrame);
+    writeFrames_.store(write + frames, std::memory_order_release);
+}
+
+void SessionRecorder::mark(const std::string& label) {
+    if (!recording()) {
+        return;
+    }
+    markers_ << capturedFrames() << ',' << label << '\n';
+    markers_.flush();
+}
+
+void SessionRecorder::run() {
+    auto lastHeaderWrite = std::chrono::steady_clock::now();
+    while (!stopRequested_.load(std::memory_order_acquire)) {
+        if (drain() == 0) {
+            std::this_thread::sleep_for(kDrainInterval);
+        }
+        // Keep the header current so a crash still leaves a playable file.
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastHeaderWrite >= kHeaderRefreshInterval) {
+            writeHeader(writtenFrames_);
+            lastHeaderWrite = now;
+        }
+    }
+    while (drain() > 0) {
+    }
+    writeHeader(writtenFrames_);
+}
+
+std::size_t SessionRecorder::drain() {
+    const std::uint64_t read = readFrames_.load(std::memory_order_relaxed);
+    const std::uint64_t write = writeFrames_.load(std::memory_order_acquire);
+    if (write == read) {
+        return 0;
+    }
+    const auto start = static_cast<std::size_t>(read % kRingFrames);
+    const auto frames = static_cast<std::size_t>(std::min<std::uint64_t>(write - read, kRingFrames - start));
+    const std::uint64_t room = kMaxDataFrames - writtenFrames_;
+    const auto toWrite = static_cast<std::size_t>(std::min<std::uint64_t>(frames, room));
+    if (toWrite > 0) {
+        wav_.write(reinterpret_cast<const char*>(ring_.data() + start * 2),
+                   static_cast<std::streamsize>(toWrite * kBytesPerFrame));
+        writtenFrames_ += toWrite;
+    }
+    if (toWrite < frames && !sizeLimitReached_) {
+        sizeLimitReached_ = true;
+        logWarning("SessionRecorder") << "WAV size limit reached; further input is not recorded.";
+    }
+    readFrames_.store(read + frames, std::memory_order_release);
+    return frames;
+}
+
+void SessionRecorder::writeHeader(std::uint64_t dataFrames) {
+    const auto dataBytes = static_cast<std::uint32_t>(dataFrames * kBytesPerFrame);
+    std::array<unsigned char, kWavHeaderBytes> header{};
+    std::memcpy(header.data(), "RIFF", 4);
+    putU32(header.data() + 4, dataBytes + static_cast<std::uint32_t>(kWavHeaderBytes - 8));
+    std::memcpy(header.data() + 8, "WAVEfmt ", 8);
+    putU32(header.data() + 16, 16);
+    putU16(header.data() + 20, 3);  // IEEE float
+    putU16(header.data() + 22, 2);
+    putU32(header.data() + 24, static_cast<std::uint32_t>(sampleRate_));
+    putU32(header.data() + 28, static_cast<std::uint32_t>(sampleRate_ * kBytesPerFrame));
+    putU16(header.data() + 32, static_cast<std::uint16_t>(kBytesPerFrame));
+    putU16(header.data() + 34, 32);
+    std::memcpy(header.data() + 36, "data", 4);
+    putU32(header.data() + 40, dataBytes);
+
+    const auto end = wav_.tellp();
+    wav_.seekp(0);
+    wav_.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    if (end > static_cast<std::streamoff>(kWavHeaderBytes)) {
+        wav_.seekp(end);
+    }
+    wav_.flush();
+}
+
+bool SessionRecordingData::load(const std::filesystem::path& wavPath, double targetSampleRate,
+                                SessionRecordingData& out) {
+    CueSample audio;
+    if (!CueSample::loadWav(wavPath, targetSampleRate, audio)) {
+        return false;
+    }
+    out.left = std::move(audio.left);
+    out.right = std::move(audio.right);
+    out.markers.clear();
+
+    std::ifstream markers(SessionRecorder::markerPathFor(wavPath));
+    if (!markers) {
+        logNotice("SessionReplay") << "No marker file for " << wavPath;
+        return true;
+    }
+    // Marker frames are at the recording rate; the header of the WAV tells us what that was.
+    std::ifstream header(wavPath, std::ios::binary);
+    std::array<unsigned char, kWavHeaderBytes> bytes{};
+    header.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    const std::uint32_t recordedRate = static_cast<std::uint32_t>(bytes[24]) | (static_cast<std::uint32_t>(bytes[25]) << 8) |
+                                       (static_cast<std::uint32_t>(bytes[26]) << 16) |
+                                       (static_cast<std::uint32_t>(bytes[27]) << 24);
+    const double frameScale = recordedRate > 0 ? targetSampleRate / static_cast<double>(recordedRate) : 1.0;
+
+    std::string line;
+    std::getline(markers, line);  // header
+    while (std::getline(markers, line)) {
+        const auto comma = line.find(',');
+        if (comma == std::string::npos) {
+            continue;
+        }
+        RecordingMarker marker;
+        std::istringstream frameStream(line.substr(0, comma));
+        std::uint64_t frame = 0;
+        if (!(frameStream >> frame)) {
+            continue;
+        }
+        marker.frame = static_cast<std::uint64_t>(static_cast<double>(frame) * frameScale);
+        marker.label = line.substr(comma + 1);
+        out.markers.push_back(std::move(marker));
+    }
+    std::stable_sort(out.markers.begin(), out.markers.end(),
+                     [](const RecordingMarker& a, const RecordingMarker& b) { return a.frame < b.frame; });
+    return true;
+}
+
+void SessionReplayer::prepare(std::shared_ptr<const SessionRecordingData> recording) {
+    recording_ = std::move(recording);
+    position_.store(0, std::memory_order_release);
+}
+
+void SessionReplayer::read(float* interleavedStereo, std::size_t numFrames) noexcept {
+    const std::uint64_t position = position_.load(std::memory_order_relaxed);
+    const std::size_t length = recording_ ? recording_->length() : 0;
+    for (std::size_t frame = 0; frame < numFrames; ++frame) {
+        const std::uint64_t index = position + frame;
+        const bool inRange = index < length;
+        interleavedStereo[frame * 2] = inRange ? recording_->left[index] : 0.0f;
+        interleavedStereo[frame * 2 + 1] = inRange ? recording_->right[index] : 0.0f;
+    }
+    position_.store(position + numFrames, std::memory_order_release);
+}
+
+} // namespace knot::audio
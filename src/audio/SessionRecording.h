@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace knot::audio {
+
+/// Records the raw stereo device input (before input gain and calibration) so a field session
+/// can be re-run through the current pipeline. audioIn() copies each block into a preallocated
+/// SPSC ring; a background thread drains it into a float32 WAV file. Scene markers go to a
+/// "<name>.markers.csv" sidecar as (input frame, label) rows.
+class SessionRecorder {
+public:
+    /// Ring capacity in frames (~5.5 s at 48 kHz) that absorbs disk stalls.
+    static constexpr std::size_t kRingFrames = std::size_t{1} << 18;
+
+    SessionRecorder() = default;
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    /// UI thread. Allocates the ring, writes the WAV header and starts the writer thread.
+    bool start(const std::filesystem::path& wavPath, double sampleRate);
+    /// UI thread. Drains what is left, finalises the header and joins the writer.
+    void stop();
+    bool recording() const noexcept { return recording_.load(std::memory_order_acquire); }
+
+    /// Audio thread. Never blocks; frames that do not fit in the ring are counted as dropped.
+    void capture(const float* interleavedStereo, std::size_t numFrames) noexcept;
+    /// UI thread. Stamps a marker at the current capture position.
+    void mark(const std::string& label);
+
+    std::uint64_t capturedFrames() const noexcept { return writeFrames_.load(std::memory_order_acquire); }
+    std::uint64_t droppedFrames() const noexcept { return droppedFrames_.load(std::memory_order_relaxed); }
+    const std::filesystem::path& path() const noexcept { return wavPath_; }
+
+    static std::filesystem::path markerPathFor(const std::filesystem::path& wavPath);
+
+private:
+    void run();
+    std::size_t drain();
+    void writeHeader(std::uint64_t dataFrames);
+
+    std::filesystem::path wavPath_;
+    std::ofstream wav_;
+    std::ofstream markers_;
+    double sampleRate_ = 48000.0;
+    std::vector<float> ring_;  // kRingFrames interleaved stereo frames
+    std::atomic<std::uint64_t> writeFrames_{0};
+    std::atomic<std::uint64_t> readFrames_{0};
+    std::atomic<std::uint64_t> droppedFrames_{0};
+    std::uint64_t writtenFrames_ = 0;
+    bool sizeLimitReached_ = false;
+    std::thread thread_;
+    std::atomic<bool> recording_{false};
+    std::atomic<bool> stopRequested_{false};
+};
+
+struct RecordingMarker {
+    std::uint64_t frame = 0;
+    std::string label;
+};
+
+/// A recording loaded back into memory, resampled to the pipeline rate if necessary.
+struct SessionRecordingData {
+    std::vector<float> left;
+    std::vector<float> right;
+    std::vector<RecordingMarker> markers;  // sorted by frame, in pipeline-rate frames
+
+    std::size_t length() const { return left.size(); }
+    static bool load(const std::filesystem::path& wavPath, double targetSampleRate, SessionRecordingData& out);
+};
+
+/// Feeds a loaded recording into AudioPipeline::audioIn() in place of the device input.
+/// read() is called from the audio thread (or the headless replay loop) and never allocates.
+class SessionReplayer {
+public:
+    void prepare(std::shared_ptr<const SessionRecordingData> recording);
+    bool active() const noexcept { return recording_ != nullptr; }
+
+    /// Writes numFrames interleaved stereo frames, zero-filled once the recording has ended.
+    void read(float* interleavedStereo, std::size_t numFrames) noexcept;
+    std::uint64_t position() const noexcept { return position_.load(std::memory_order_acquire); }
+    bool finished() const noexcept { return !recording_ || position() >= recording_->length(); }
+    const SessionRecordingData* recording() const noexcept { return recording_.get(); }
+
+private:
+    std::shared_ptr<const SessionRecordingData> recording_;
+    std::atomic<std::uint64_t> position_{0};
+};
+
+} // namespace knot::audio
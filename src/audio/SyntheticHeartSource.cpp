@@ -0,0 +1,273 @@
+#include "SyntheticHeartSource.h"
+
+#include "Utility.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace knot::audio {
+
+namespace {
+constexpr double kTwoPi = M_PI * 2.0;
+
+// Tricuspid closure follows mitral closure by ~25 ms at 60% of its amplitude; P2 is quieter than A2.
+constexpr double kT1DelaySec = 0.025;
+constexpr double kT1Gain = 0.6;
+constexpr double kP2Gain = 0.5;
+constexpr double kP2FrequencyRatio = 0.85;
+// A2-P2 split at full expiration; inspiration adds SyntheticHeartParams::s2SplitMs.
+constexpr double kBaseSplitSec = 0.008;
+// S1 onset to S2 onset (Weissler, as in HeartbeatSynth).
+constexpr double kSystoleAtZeroBpmSec = 0.44;
+constexpr double kSystoleSlopeSec = 0.0017;
+constexpr double kMinSystoleSec = 0.2;
+constexpr double kMaxSystoleFraction = 0.45;
+constexpr double kMinRrSec = 0.3;
+constexpr double kMaxRrSec = 2.0;
+constexpr double kAmplitudeJitter = 0.08;
+constexpr double kContactFadeSec = 0.02;
+constexpr double kFirstBeatSec = 0.5;
+
+/// A damped tone that glides down from 1.3x to frequencyHz, with a raised-cosine attack over the
+/// first 15% and an exponential decay; peak 1. The onset is the first sample.
+void addComponent(std::vector<float>& table, double sampleRate, double offsetSec, double frequencyHz,
+                  double durationSec, double gain) {
+    const auto offset = static_cast<std::size_t>(offsetSec * sampleRate);
+    const auto length = static_cast<std::size_t>(durationSec * sampleRate);
+    table.resize(std::max(table.size(), offset + length), 0.0f);
+    const double attackSec = 0.15 * durationSec;
+    const double decaySec = 0.3 * durationSec;
+    double phase = 0.0;
+    for (std::size_t n = 0; n < length; ++n) {
+        const double t = static_cast<double>(n) / sampleRate;
+        double envelope = t < attackSec ? 0.5 - 0.5 * std::cos(M_PI * t / attackSec)
+                                        : std::exp(-(t - attackSec) / decaySec);
+        const double remaining = durationSec - t;
+        if (remaining < 0.1 * durationSec) {
+            envelope *= remaining / (0.1 * durationSec);
+        }
+        phase += kTwoPi * frequencyHz * (1.0 + 0.3 * (1.0 - t / durationSec)) / sampleRate;
+        table[offset + n] += static_cast<float>(gain * envelope * std::sin(phase));
+    }
+}
+
+void normalisePeak(std::vector<float>& table) {
+    float peak = 0.0f;
+    for (const float sample : table) {
+        peak = std::max(peak, std::fabs(sample));
+    }
+    if (peak > 0.0f) {
+        for (auto& sample : table) {
+            sample /= peak;
+        }
+    }
+}
+
+std::uint64_t splitMix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+} // namespace
+
+void SyntheticHeartSource::setup(double sampleRate, const std::array<SyntheticHeartParams, 2>& params,
+                                 std::uint64_t seed) {
+    sampleRate_ = sampleRate;
+    std::uint64_t seeder = seed;
+    position_ = 0;
+    contactStep_ = static_cast<float>(1.0 / (kContactFadeSec * sampleRate_));
+    for (auto& voice : voices_) {
+        voice = {};
+    }
+    for (std::size_t c = 0; c < channels_.size(); ++c) {
+        auto& channel = channels_[c];
+        const auto& p = params[c];
+        channel.params = p;
+        channel.s1.clear();
+        addComponent(channel.s1, sampleRate_, 0.0, p.s1FrequencyHz, p.s1DurationMs * 0.001, 1.0);
+        addComponent(channel.s1, sampleRate_, kT1DelaySec, p.s1FrequencyHz * 1.2, p.s1DurationMs * 0.001 * 0.8,
+                     kT1Gain);
+        normalisePeak(channel.s1);
+        channel.a2.clear();
+        addComponent(channel.a2, sampleRate_, 0.0, p.s2FrequencyHz, p.s2DurationMs * 0.001, 1.0);
+        channel.p2.clear();
+        addComponent(channel.p2, sampleRate_, 0.0, p.s2FrequencyHz * kP2FrequencyRatio, p.s2DurationMs * 0.001,
+                     kP2Gain);
+        channel.gain = dbToLinear(p.levelDb);
+        channel.noiseGain = dbToLinear(p.noiseDb);
+        channel.crosstalkGain = dbToLinear(p.crosstalkDb);
+        channel.beatRng = splitMix64(seeder);
+        channel.dropoutRng = splitMix64(seeder);
+        channel.breathOffset = kTwoPi * uniform(channel.beatRng);
+        channel.contact = 1.0f;
+        channel.sequence = 0;
+        channel.noise.setup(sampleRate_);
+        channel.noise.seed(splitMix64(seeder));
+        channel.noise.setColor(NoiseColor::Pink);
+        channel.nextBeat = static_cast<std::uint64_t>((kFirstBeatSec + 0.5 * uniform(channel.beatRng)) * sampleRate_);
+        channel.dropoutEnd = 0;
+        scheduleDropout(c, 0);
+    }
+}
+
+bool SyntheticHeartSource::inDropout(std::size_t participant) const noexcept {
+    const auto& channel = channels_[participant];
+    return position_ >= channel.nextDropout && position_ < channel.dropoutEnd;
+}
+
+double SyntheticHeartSource::uniform(std::uint64_t& state) {
+    return static_cast<double>(splitMix64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double SyntheticHeartSource::gaussian(std::uint64_t& state) {
+    const double u1 = std::max(uniform(state), 1e-12);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(kTwoPi * uniform(state));
+}
+
+double SyntheticHeartSource::inspiration(const Channel& channel, std::uint64_t sample) const {
+    const double t = static_cast<double>(sample) / sampleRate_;
+    return 0.5 - 0.5 * std::cos(kTwoPi * channel.params.breathsPerMin / 60.0 * t + channel.breathOffset);
+}
+
+void SyntheticHeartSource::scheduleDropout(std::size_t channel, std::uint64_t from) {
+    auto& ch = channels_[channel];
+    if (!(ch.params.dropoutsPerMin > 0.0f)) {
+        ch.nextDropout = UINT64_MAX;
+        ch.dropoutEnd = UINT64_MAX;
+        return;
+    }
+    // Poisson arrivals: exponential gaps between the end of one dropout and the start of the next.
+    const double gapSec = -std::log(std::max(uniform(ch.dropoutRng), 1e-12)) * 60.0 / ch.params.dropoutsPerMin;
+    ch.nextDropout = from + static_cast<std::uint64_t>(gapSec * sampleRate_);
+    ch.dropoutEnd = ch.nextDropout + static_cast<std::uint64_t>(std::max(0.0f, ch.params.dropoutSec) * sampleRate_);
+}
+
+void SyntheticHeartSource::scheduleBeat(std::size_t channel) {
+    auto& ch = channels_[channel];
+    const auto& p = ch.params;
+    const std::uint64_t onset = ch.nextBeat;
+    const double insp = inspiration(ch, onset);
+
+    const double meanRr = 60.0 / std::max(20.0f, p.bpm);
+    double rr = meanRr * (1.0 - p.rsaDepth * (2.0 * insp - 1.0)) + 0.001 * p.hrvMs * gaussian(ch.beatRng);
+    rr = std::clamp(rr, kMinRrSec, kMaxRrSec);
+    const double bpm = 60.0 / rr;
+    const double systoleSec = std::clamp(kSystoleAtZeroBpmSec - kSystoleSlopeSec * bpm, kMinSystoleSec,
+                                         std::max(kMinSystoleSec, kMaxSystoleFraction * rr));
+    const double splitSec = kBaseSplitSec + 0.001 * p.s2SplitMs * insp;
+    const float amplitude = ch.gain * static_cast<float>((1.0 - p.breathingDepth * insp) *
+                                                         std::max(0.5, 1.0 + kAmplitudeJitter * gaussian(ch.beatRng)));
+
+    const auto s2Onset = onset + static_cast<std::uint64_t>(systoleSec * sampleRate_);
+    startVoice(channel, ch.s1, onset, amplitude);
+    startVoice(channel, ch.a2, s2Onset, amplitude * p.s2Gain);
+    startVoice(channel, ch.p2, s2Onset + static_cast<std::uint64_t>(splitSec * sampleRate_), amplitude * p.s2Gain);
+
+    const std::uint64_t contactLost = ch.nextDropout;
+    const std::uint64_t contactBack = ch.dropoutEnd + static_cast<std::uint64_t>(kContactFadeSec * sampleRate_);
+    const bool audible = onset < contactLost || onset >= contactBack;
+    if (truthBus_ && audible) {
+        BeatEvent truth;
+        truth.timestampSec = static_cast<double>(onset) / sampleRate_;
+        truth.bpm = static_cast<float>(bpm);
+        truth.envelope = amplitude;
+        truth.participantId = channel == 0 ? ParticipantId::Participant1 : ParticipantId::Participant2;
+        truth.sequenceId = ch.sequence;
+        truthBus_->publish(truth);
+    }
+    ++ch.sequence;
+    ch.nextBeat = onset + static_cast<std::uint64_t>(rr * sampleRate_);
+}
+
+void SyntheticHeartSource::startVoice(std::size_t channel, const std::vector<float>& table, std::uint64_t atSample,
+                                      float gain) {
+    auto voice = std::find_if(voices_.begin(), voices_.end(), [](const Voice& v) { return !v.active; });
+    if (voice == voices_.end()) {
+        voice = std::min_element(voices_.begin(), voices_.end(),
+                                 [](const Voice& a, const Voice& b) { return a.startSample < b.startSample; });
+    }
+    voice->active = true;
+    voice->channel = channel;
+    voice->table = &table;
+    voice->startSample = atSample;
+    voice->gain = gain;
+}
+
+void SyntheticHeartSource::renderVoices(std::uint64_t chunkStart, std::size_t numFrames) {
+    const std::uint64_t chunkEnd = chunkStart + numFrames;
+    for (auto& voice : voices_) {
+        if (!voice.active || voice.startSample >= chunkEnd) {
+            continue;
+        }
+        const std::vector<float>& table = *voice.table;
+        const std::uint64_t voiceEnd = voice.startSample + table.size();
+        const std::uint64_t from = std::max(voice.startSample, chunkStart);
+        const std::uint64_t to = std::min(voiceEnd, chunkEnd);
+        if (from < to) {
+            float* dst = heart_[voice.channel].data() + (from - chunkStart);
+            const float* src = table.data() + (from - voice.startSample);
+            const auto count = static_cast<std::size_t>(to - from);
+            for (std::size_t i = 0; i < count; ++i) {
+                dst[i] += src[i] * voice.gain;
+            }
+        }
+        if (voiceEnd <= chunkEnd) {
+            voice.active = false;
+        }
+    }
+}
+
+void SyntheticHeartSource::read(float* interleavedStereo, std::size_t numFrames) noexcept {
+    if (!interleavedStereo) {
+        return;
+    }
+    std::size_t done = 0;
+    while (done < numFrames) {
+        // Chunks follow a fixed grid on the input clock, so any block size renders the same samples.
+        const auto offset = static_cast<std::size_t>(position_ % kChunk);
+        const std::size_t frames = std::min(kChunk - offset, numFrames - done);
+        const std::uint64_t chunkEnd = position_ + frames;
+        for (std::size_t c = 0; c < channels_.size(); ++c) {
+            auto& ch = channels_[c];
+            while (ch.nextBeat < chunkEnd) {
+                scheduleBeat(c);
+            }
+            std::fill_n(heart_[c].begin(), frames, 0.0f);
+        }
+        renderVoices(position_, frames);
+
+        // Contact fades after the voices are summed, so a dropout mutes beats already sounding.
+        for (std::size_t c = 0; c < channels_.size(); ++c) {
+            auto& ch = channels_[c];
+            for (std::size_t i = 0; i < frames; ++i) {
+                const std::uint64_t sample = position_ + i;
+                const bool lifted = sample >= ch.nextDropout && sample < ch.dropoutEnd;
+                ch.contact = lifted ? std::max(0.0f, ch.contact - contactStep_) : std::min(1.0f, ch.contact + contactStep_);
+                heart_[c][i] *= ch.contact;
+            }
+            if (chunkEnd >= ch.dropoutEnd) {
+                scheduleDropout(c, ch.dropoutEnd);
+            }
+        }
+
+        float* out = interleavedStereo + done * 2;
+        for (std::size_t c = 0; c < channels_.size(); ++c) {
+            auto& ch = channels_[c];
+            const auto& own = heart_[c];
+            const auto& other = heart_[1 - c];
+            if (offset == 0) {
+                ch.noise.fill(ch.noiseChunk.data(), kChunk);
+            }
+            const float* noise = ch.noiseChunk.data() + offset;
+            for (std::size_t i = 0; i < frames; ++i) {
+                const float sample = own[i] + ch.crosstalkGain * other[i] + ch.noiseGain * noise[i];
+                out[i * 2 + c] = std::clamp(sample, -1.0f, 1.0f);
+            }
+        }
+        position_ = chunkEnd;
+        done += frames;
+    }
+}
+
+} // namespace knot::audio
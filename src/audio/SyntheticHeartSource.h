@@ -0,0 +1,107 @@
+#pragma once
+
+#include "BeatTimeline.h"
+#include "NoiseGenerator.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace knot::audio {
+
+/// One simulated participant. Levels are raw device input in dBFS, before the input gain.
+struct SyntheticHeartParams {
+    float bpm = 68.0f;
+    float hrvMs = 30.0f;           // random beat-to-beat RR jitter (standard deviation)
+    float breathsPerMin = 14.0f;
+    float rsaDepth = 0.05f;        // respiratory sinus arrhythmia: RR swing as a fraction of RR
+    float breathingDepth = 0.3f;   // heart-sound attenuation at full inspiration
+    float s1FrequencyHz = 45.0f;
+    float s1DurationMs = 110.0f;
+    float s2FrequencyHz = 65.0f;
+    float s2DurationMs = 70.0f;
+    float s2Gain = 0.5f;           // A2 peak relative to S1
+    float s2SplitMs = 30.0f;       // A2-P2 split at full inspiration
+    float levelDb = -36.0f;        // S1 peak
+    float noiseDb = -66.0f;        // background noise RMS
+    float crosstalkDb = -30.0f;    // the other participant's heart sounds on this input
+    float dropoutsPerMin = 0.0f;   // stethoscope lifted off the chest
+    float dropoutSec = 2.0f;
+};
+
+/// Phonocardiogram-like stereo input for simulation, soak tests and benchmarks: read() writes
+/// interleaved frames the way the input device would, so they go through AudioPipeline::audioIn()
+/// and exercise detection, fallback and routing. Each beat is S1 (mitral then tricuspid closure)
+/// and, one systole later, S2 (aortic then pulmonic closure), all damped down-chirps. Breathing
+/// shortens RR on inspiration, attenuates the heart sounds and widens the A2-P2 split; RR also
+/// gets Gaussian jitter. Pink background noise, cross-pickup of the other heart and dropouts
+/// (heart sounds faded out, noise kept) complete the picture. The same seed gives the same input,
+/// whatever the block sizes.
+/// setup() allocates; read() does not.
+class SyntheticHeartSource {
+public:
+    static constexpr std::size_t kMaxVoices = 16;
+
+    void setup(double sampleRate, const std::array<SyntheticHeartParams, 2>& params, std::uint64_t seed);
+    /// Audio thread. Writes numFrames interleaved stereo frames, clipped to [-1, 1].
+    void read(float* interleavedStereo, std::size_t numFrames) noexcept;
+    /// Ground truth: every S1 onset outside a dropout is published here when it is scheduled, with
+    /// timestampSec on the input sample clock and the instantaneous bpm.
+    void setTruthBus(BeatEventBus* bus) { truthBus_ = bus; }
+
+    std::uint64_t position() const noexcept { return position_; }
+    bool inDropout(std::size_t participant) const noexcept;
+    const SyntheticHeartParams& params(std::size_t participant) const { return channels_[participant].params; }
+
+private:
+    static constexpr std::size_t kChunk = 256;
+
+    struct Voice {
+        bool active = false;
+        std::size_t channel = 0;
+        const std::vector<float>* table = nullptr;
+        std::uint64_t startSample = 0;
+        float gain = 0.0f;
+    };
+
+    struct Channel {
+        SyntheticHeartParams params;
+        std::vector<float> s1;   // M1 + T1, peak 1
+        std::vector<float> a2;   // peak 1
+        std::vector<float> p2;
+        float gain = 0.0f;
+        float noiseGain = 0.0f;
+        float crosstalkGain = 0.0f;
+        double breathOffset = 0.0;
+        std::uint64_t nextBeat = 0;
+        std::uint64_t nextDropout = 0;
+        std::uint64_t dropoutEnd = 0;
+        float contact = 1.0f;    // fades to 0 in a dropout
+        std::uint64_t sequence = 0;
+        // Separate streams per channel and purpose keep the output independent of the block size.
+        std::uint64_t beatRng = 0;
+        std::uint64_t dropoutRng = 0;
+        NoiseGenerator noise;
+        std::array<float, kChunk> noiseChunk{};  // filled kChunk at a time, on the kChunk grid
+    };
+
+    double sampleRate_ = 48000.0;
+    std::array<Channel, 2> channels_{};
+    std::array<Voice, kMaxVoices> voices_{};
+    std::array<std::array<float, kChunk>, 2> heart_{};
+    std::uint64_t position_ = 0;
+    float contactStep_ = 0.0f;
+    BeatEventBus* truthBus_ = nullptr;
+
+    void scheduleBeat(std::size_t channel);
+    void scheduleDropout(std::size_t channel, std::uint64_t from);
+    void startVoice(std::size_t channel, const std::vector<float>& table, std::uint64_t atSample, float gain);
+    void renderVoices(std::uint64_t chunkStart, std::size_t numFrames);
+    /// 0 at full expiration, 1 at full inspiration.
+    double inspiration(const Channel& channel, std::uint64_t sample) const;
+    static double uniform(std::uint64_t& state);
+    static double gaussian(std::uint64_t& state);
+};
+
+} // namespace knot::audio
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace knot::audio {
+
+/// Wait-free single-producer, single-consumer handoff of the latest value. The producer
+/// always has a private slot to write, the consumer always has a private slot to read, and
+/// the third slot is swapped between them with one atomic exchange, so neither side ever
+/// waits and the consumer always sees one complete value (never a mix of two publishes).
+/// Intermediate values are skipped when the producer is faster than the consumer.
+template <typename T>
+class TripleBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "TripleBuffer values must be trivially copyable");
+
+public:
+    /// Producer: copies value into the back slot and makes it the latest.
+    void publish(const T& value) noexcept {
+        slots_[back_] = value;
+        const std::uint8_t previous = middle_.exchange(static_cast<std::uint8_t>(back_ | kFreshBit),
+                                                       std::memory_order_acq_rel);
+        back_ = previous & kIndexMask;
+    }
+
+    /// Consumer: returns the most recently published value (or the previous one if nothing new
+    /// arrived since the last call). The reference stays valid until the next read().
+    const T& read() noexcept {
+        if (middle_.load(std::memory_order_relaxed) & kFreshBit) {
+            const std::uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = previous & kIndexMask;
+        }
+        return slots_[front_];
+    }
+
+private:
+    static constexpr std::uint8_t kFreshBit = 0x4;
+    static constexpr std::uint8_t kIndexMask = 0x3;
+
+    std::array<T, 3> slots_{};
+    std::uint8_t back_ = 0;                 // producer only
+    std::atomic<std::uint8_t> middle_{1};   // shared: slot index plus fresh bit
+    std::uint8_t front_ = 2;                // consumer only
+};
+
+} // namespace knot::audio
@@ -0,0 +1,71 @@
+#include "AudioDeviceMonitor.h"
+
+#include <algorithm>
+
+namespace infra {
+
+namespace {
+
+// Granularity of the stop check while waiting for the next enumeration.
+constexpr auto kStopCheckInterval = std::chrono::milliseconds(50);
+
+bool sameDevices(const AudioDeviceMonitor::DeviceList& a, const AudioDeviceMonitor::DeviceList& b) {
+	return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const ofSoundDevice& x, const ofSoundDevice& y) {
+		return x.name == y.name && x.deviceID == y.deviceID && x.inputChannels == y.inputChannels &&
+			   x.outputChannels == y.outputChannels;
+	});
+}
+
+}  // namespace
+
+AudioDeviceMonitor::~AudioDeviceMonitor() {
+	stop();
+}
+
+void AudioDeviceMonitor::start(std::chrono::milliseconds interval) {
+	if (running()) {
+		return;
+	}
+	interval_ = interval;
+	stopRequested_.store(false, std::memory_order_release);
+	running_.store(true, std::memory_order_release);
+	thread_ = std::thread(&AudioDeviceMonitor::run, this);
+}
+
+void AudioDeviceMonitor::stop() {
+	stopRequested_.store(true, std::memory_order_release);
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+	running_.store(false, std::memory_order_release);
+}
+
+bool AudioDeviceMonitor::listed(const DeviceList& devices, const std::string& name) {
+	return std::any_of(devices.begin(), devices.end(), [&](const ofSoundDevice& device) { return device.name == name; });
+}
+
+bool AudioDeviceMonitor::contains(const DeviceList& devices, const std::string& name, bool input) {
+	return std::any_of(devices.begin(), devices.end(), [&](const ofSoundDevice& device) {
+		return device.name == name && (input ? device.inputChannels > 0 : device.outputChannels > 0);
+	});
+}
+
+void AudioDeviceMonitor::run() {
+	// A private stream object: enumeration opens its own driver handle and never touches the
+	// stream the app is playing through.
+	ofSoundStream enumerator;
+	while (!stopRequested_.load(std::memory_order_acquire)) {
+		auto next = std::make_shared<DeviceList>(enumerator.getDeviceList());
+		const auto previous = std::atomic_load(&devices_);
+		if (!previous || !sameDevices(*previous, *next)) {
+			std::atomic_store(&devices_, std::shared_ptr<const DeviceList>(std::move(next)));
+			generation_.fetch_add(1, std::memory_order_acq_rel);
+		}
+		const auto wakeAt = std::chrono::steady_clock::now() + interval_;
+		while (!stopRequested_.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < wakeAt) {
+			std::this_thread::sleep_for(kStopCheckInterval);
+		}
+	}
+}
+
+}  // namespace infra
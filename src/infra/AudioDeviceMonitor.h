@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace infra {
+
+/// Re-enumerates audio devices on a background thread so that an interface which disappears or
+/// comes back is noticed without anyone pressing "Refresh". Enumeration probes every device and
+/// can take tens of milliseconds, which is why it stays off the UI thread. The latest list is
+/// handed over with std::atomic_store; the UI thread compares it with the devices in use by
+/// name, because device IDs are renumbered when an interface is plugged back in.
+class AudioDeviceMonitor {
+  public:
+	using DeviceList = std::vector<ofSoundDevice>;
+
+	AudioDeviceMonitor() = default;
+	~AudioDeviceMonitor();
+
+	AudioDeviceMonitor(const AudioDeviceMonitor&) = delete;
+	AudioDeviceMonitor& operator=(const AudioDeviceMonitor&) = delete;
+
+	void start(std::chrono::milliseconds interval);
+	void stop();
+	bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+	/// Latest enumeration (null before the first one finishes).
+	std::shared_ptr<const DeviceList> devices() const { return std::atomic_load(&devices_); }
+	/// Bumped whenever the published list differs from the previous one.
+	std::uint64_t generation() const noexcept { return generation_.load(std::memory_order_acquire); }
+
+	/// A device of that name is listed at all. Use this for the device the stream has open: some
+	/// drivers enumerate a busy device with no channels, so the channel counts say nothing.
+	static bool listed(const DeviceList& devices, const std::string& name);
+	/// A device of that name is listed with input (or output) channels, i.e. can be opened.
+	static bool contains(const DeviceList& devices, const std::string& name, bool input);
+
+  private:
+	void run();
+
+	std::chrono::milliseconds interval_{1000};
+	std::shared_ptr<const DeviceList> devices_;
+	std::atomic<std::uint64_t> generation_{0};
+	std::thread thread_;
+	std::atomic<bool> running_{false};
+	std::atomic<bool> stopRequested_{false};
+};
+
+}  // namespace infra
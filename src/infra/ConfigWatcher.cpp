@@ -0,0 +1,175 @@
+#include "ConfigWatcher.h"
+
+#include "ofLog.h"
+
+#include <algorithm>
+#include <map>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace infra {
+
+namespace {
+
+// Editors often write a file in several steps; wait for this much quiet before reloading.
+constexpr auto kSettleTime = std::chrono::milliseconds(200);
+constexpr int kPollIntervalMs = 100;
+constexpr auto kTimestampPollInterval = std::chrono::milliseconds(500);
+
+bool readFileStamp(const std::filesystem::path& path, std::filesystem::file_time_type& writeTime,
+				   std::uintmax_t& size) {
+	std::error_code ec;
+	writeTime = std::filesystem::last_write_time(path, ec);
+	if (ec) {
+		return false;
+	}
+	size = std::filesystem::file_size(path, ec);
+	return !ec;
+}
+
+}  // namespace
+
+ConfigWatcher::~ConfigWatcher() {
+	stop();
+}
+
+void ConfigWatcher::watch(const std::filesystem::path& absolutePath, ReloadCallback callback) {
+	if (running()) {
+		ofLogWarning("ConfigWatcher") << "watch() ignored while running: " << absolutePath;
+		return;
+	}
+	Entry entry;
+	entry.path = absolutePath.lexically_normal();
+	entry.callback = std::move(callback);
+	readFileStamp(entry.path, entry.lastWriteTime, entry.lastSize);
+	entries_.push_back(std::move(entry));
+}
+
+void ConfigWatcher::start() {
+	if (running() || entries_.empty()) {
+		return;
+	}
+	stopRequested_.store(false, std::memory_order_release);
+	running_.store(true, std::memory_order_release);
+	thread_ = std::thread(&ConfigWatcher::run, this);
+}
+
+void ConfigWatcher::stop() {
+	stopRequested_.store(true, std::memory_order_release);
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+	running_.store(false, std::memory_order_release);
+}
+
+void ConfigWatcher::markDirty(const std::filesystem::path& directory, const std::string& fileName) {
+	for (auto& entry : entries_) {
+		if (entry.path.parent_path() == directory && entry.path.filename() == fileName) {
+			entry.dirty = true;
+			entry.dirtySince = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+void ConfigWatcher::pollTimestamps() {
+	for (auto& entry : entries_) {
+		std::filesystem::file_time_type writeTime{};
+		std::uintmax_t size = 0;
+		if (!readFileStamp(entry.path, writeTime, size)) {
+			continue;
+		}
+		if (writeTime != entry.lastWriteTime || size != entry.lastSize) {
+			entry.lastWriteTime = writeTime;
+			entry.lastSize = size;
+			entry.dirty = true;
+			entry.dirtySince = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+void ConfigWatcher::dispatchSettled() {
+	const auto now = std::chrono::steady_clock::now();
+	for (auto& entry : entries_) {
+		if (!entry.dirty || now - entry.dirtySince < kSettleTime) {
+			continue;
+		}
+		entry.dirty = false;
+		if (!std::filesystem::exists(entry.path)) {
+			// Mid-replace (deleted, not yet renamed back); the follow-up event re-marks it.
+			continue;
+		}
+		readFileStamp(entry.path, entry.lastWriteTime, entry.lastSize);
+		ofLogNotice("ConfigWatcher") << "Change detected: " << entry.path;
+		entry.callback(entry.path);
+	}
+}
+
+void ConfigWatcher::run() {
+#if defined(__linux__)
+	const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	std::map<int, std::filesystem::path> directories;
+	if (fd >= 0) {
+		for (const auto& entry : entries_) {
+			const auto directory = entry.path.parent_path();
+			const bool known = std::any_of(directories.begin(), directories.end(),
+										   [&](const auto& item) { return item.second == directory; });
+			if (known) {
+				continue;
+			}
+			const int wd = inotify_add_watch(fd, directory.c_str(),
+											 IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY);
+			if (wd < 0) {
+				ofLogWarning("ConfigWatcher") << "inotify_add_watch failed for " << directory;
+				continue;
+			}
+			directories.emplace(wd, directory);
+		}
+	}
+	if (fd >= 0 && !directories.empty()) {
+		ofLogNotice("ConfigWatcher") << "Watching " << entries_.size() << " config files (inotify)";
+		alignas(inotify_event) char buffer[4096];
+		while (!stopRequested_.load(std::memory_order_acquire)) {
+			pollfd descriptor{fd, POLLIN, 0};
+			const int ready = ::poll(&descriptor, 1, kPollIntervalMs);
+			if (ready > 0 && (descriptor.revents & POLLIN)) {
+				ssize_t length = 0;
+				while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+					for (char* cursor = buffer; cursor < buffer + length;) {
+						const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+						const auto directory = directories.find(event->wd);
+						if (event->len > 0 && directory != directories.end()) {
+							markDirty(directory->second, event->name);
+						}
+						cursor += sizeof(inotify_event) + event->len;
+					}
+				}
+			}
+			dispatchSettled();
+		}
+		::close(fd);
+		return;
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+	ofLogWarning("ConfigWatcher") << "inotify unavailable; falling back to polling";
+#endif
+
+	ofLogNotice("ConfigWatcher") << "Watching " << entries_.size() << " config files (polling)";
+	auto nextPoll = std::chrono::steady_clock::now();
+	while (!stopRequested_.load(std::memory_order_acquire)) {
+		const auto now = std::chrono::steady_clock::now();
+		if (now >= nextPoll) {
+			pollTimestamps();
+			nextPoll = now + kTimestampPollInterval;
+		}
+		dispatchSettled();
+		std::this_thread::sleep_for(std::chrono::milliseconds(kPollIntervalMs));
+	}
+}
+
+}  // namespace infra
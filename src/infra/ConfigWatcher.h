@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace infra {
+
+/// Watches config files on a background thread and invokes a reload callback after a change
+/// has settled. On Linux this uses inotify on the parent directories (editors usually replace
+/// files by rename); elsewhere it falls back to polling modification times.
+/// Callbacks run on the watcher thread: parse and validate there, then hand the result to the
+/// UI thread (e.g. with std::atomic_store on a shared_ptr) instead of touching app state.
+class ConfigWatcher {
+  public:
+	using ReloadCallback = std::function<void(const std::filesystem::path&)>;
+
+	ConfigWatcher() = default;
+	~ConfigWatcher();
+
+	ConfigWatcher(const ConfigWatcher&) = delete;
+	ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+	/// Registers a file. Call before start().
+	void watch(const std::filesystem::path& absolutePath, ReloadCallback callback);
+	void start();
+	void stop();
+	bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+  private:
+	struct Entry {
+		std::filesystem::path path;
+		ReloadCallback callback;
+		std::filesystem::file_time_type lastWriteTime{};
+		std::uintmax_t lastSize = 0;
+		bool dirty = false;
+		std::chrono::steady_clock::time_point dirtySince{};
+	};
+
+	void run();
+	void markDirty(const std::filesystem::path& directory, const std::string& fileName);
+	void pollTimestamps();
+	void dispatchSettled();
+
+	std::vector<Entry> entries_;
+	std::thread thread_;
+	std::atomic<bool> running_{false};
+	std::atomic<bool> stopRequested_{false};
+};
+
+}  // namespace infra
@@ -0,0 +1,807 @@
+#include "infra/LogQuery.h"
+
+#include "SceneController.h"
+
+#include "ofLog.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace infra {
+
+namespace {
+
+constexpr char kSidecarMagic[8] = {'K', 'N', 'O', 'T', 'L', 'I', 'X', '1'};
+constexpr std::string_view kSessionHeader = "timestampMicros,bpm,envelopePeak,sceneId";
+constexpr std::string_view kHapticHeader = "timestampMicros,label,intensity";
+constexpr std::string_view kTransitionHeaderPrefix = "timestampMicros,sceneFrom,sceneTo";
+constexpr std::string_view kCurrentSessionKey = "current";
+
+/// Calls fn(begin, end, offset) for every complete line in [from, to); a trailing line without a
+/// newline is still being written and is skipped. fn returns false to stop early.
+template <typename Fn>
+void forEachLine(const char* data, std::uint64_t from, std::uint64_t to, Fn&& fn) {
+	const char* cursor = data + from;
+	const char* const limit = data + to;
+	while (cursor < limit) {
+		const auto* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(limit - cursor)));
+		if (newline == nullptr) {
+			return;
+		}
+		const char* lineEnd = (newline > cursor && newline[-1] == '\r') ? newline - 1 : newline;
+		if (!fn(cursor, lineEnd, static_cast<std::uint64_t>(cursor - data))) {
+			return;
+		}
+		cursor = newline + 1;
+	}
+}
+
+/// Splits on commas (these logs never quote); the last field keeps the remainder of the line.
+template <std::size_t N>
+std::size_t splitFields(const char* begin, const char* end, std::array<std::string_view, N>& fields) {
+	std::size_t count = 0;
+	const char* fieldBegin = begin;
+	while (count + 1 < N) {
+		const auto* comma = static_cast<const char*>(std::memchr(fieldBegin, ',', static_cast<std::size_t>(end - fieldBegin)));
+		if (comma == nullptr) {
+			break;
+		}
+		fields[count++] = std::string_view(fieldBegin, static_cast<std::size_t>(comma - fieldBegin));
+		fieldBegin = comma + 1;
+	}
+	fields[count++] = std::string_view(fieldBegin, static_cast<std::size_t>(end - fieldBegin));
+	return count;
+}
+
+bool parseU64(std::string_view text, std::uint64_t& out) {
+	if (text.empty()) {
+		return false;
+	}
+	std::uint64_t value = 0;
+	for (const char c : text) {
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		value = value * 10 + static_cast<std::uint64_t>(c - '0');
+	}
+	out = value;
+	return true;
+}
+
+double parseDouble(std::string_view text) {
+	char buffer[48];
+	const std::size_t length = std::min(text.size(), sizeof(buffer) - 1);
+	std::memcpy(buffer, text.data(), length);
+	buffer[length] = '\0';
+	return std::strtod(buffer, nullptr);
+}
+
+LogKind classifyHeader(std::string_view header) {
+	if (header == kSessionHeader) {
+		return LogKind::Session;
+	}
+	if (header == kHapticHeader) {
+		return LogKind::Haptic;
+	}
+	if (header.substr(0, kTransitionHeaderPrefix.size()) == kTransitionHeaderPrefix) {
+		return LogKind::Transition;
+	}
+	return LogKind::Unknown;
+}
+
+/// Rotated logs end in _YYYYMMDD-HHMMSS (see SessionLogger::rotateIfNeeded); the live log has none.
+std::string sessionKeyFor(const std::filesystem::path& csvPath) {
+	const std::string stem = csvPath.stem().string();
+	constexpr std::size_t kSuffixLength = 15;
+	if (stem.size() <= kSuffixLength || stem[stem.size() - kSuffixLength - 1] != '_') {
+		return std::string(kCurrentSessionKey);
+	}
+	const std::string suffix = stem.substr(stem.size() - kSuffixLength);
+	for (std::size_t i = 0; i < suffix.size(); ++i) {
+		const bool ok = (i == 8) ? suffix[i] == '-' : (suffix[i] >= '0' && suffix[i] <= '9');
+		if (!ok) {
+			return std::string(kCurrentSessionKey);
+		}
+	}
+	return suffix;
+}
+
+std::int64_t toUnixSeconds(std::int64_t fileTime) {
+	using namespace std::chrono;
+	const std::filesystem::file_time_type time{std::filesystem::file_time_type::duration(fileTime)};
+	const auto system =
+		time_point_cast<system_clock::duration>(time - std::filesystem::file_time_type::clock::now() + system_clock::now());
+	return duration_cast<seconds>(system.time_since_epoch()).count();
+}
+
+/// Local time encoded in a rotation suffix, or -1 for the live log.
+std::int64_t rotationUnixSeconds(const std::string& key) {
+	if (key == kCurrentSessionKey) {
+		return -1;
+	}
+	std::tm tm {};
+	std::istringstream iss(key);
+	iss >> std::get_time(&tm, "%Y%m%d-%H%M%S");
+	if (iss.fail()) {
+		return -1;
+	}
+	tm.tm_isdst = -1;
+	return static_cast<std::int64_t>(std::mktime(&tm));
+}
+
+std::string formatLocal(std::int64_t unixSeconds, const char* format) {
+	const auto tt = static_cast<std::time_t>(unixSeconds);
+	std::tm tm {};
+#if defined(_WIN32)
+	localtime_s(&tm, &tt);
+#else
+	localtime_r(&tt, &tm);
+#endif
+	std::ostringstream oss;
+	oss << std::put_time(&tm, format);
+	return oss.str();
+}
+
+template <typename T>
+void writePod(std::ofstream& out, const T& value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readPod(std::ifstream& in, T& value) {
+	return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeString(std::ofstream& out, const std::string& value) {
+	writePod(out, static_cast<std::uint32_t>(value.size()));
+	out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool readString(std::ifstream& in, std::string& value) {
+	std::uint32_t length = 0;
+	if (!readPod(in, length) || length > 4096) {
+		return false;
+	}
+	value.resize(length);
+	return static_cast<bool>(in.read(value.data(), length));
+}
+
+/// Runs fn(i) for i in [0, count) on up to `threads` threads (the caller is one of them).
+template <typename Fn>
+void parallelFor(std::size_t count, unsigned threads, Fn&& fn) {
+	std::atomic<std::size_t> next{0};
+	auto worker = [&] {
+		for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+			fn(i);
+		}
+	};
+	const std::size_t workers = std::min<std::size_t>(std::max(1u, threads), count);
+	std::vector<std::thread> pool;
+	for (std::size_t i = 1; i < workers; ++i) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : pool) {
+		thread.join();
+	}
+}
+
+}  // namespace
+
+bool MappedFile::open(const std::filesystem::path& path) {
+	close();
+#if defined(_WIN32)
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+							  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size {};
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		return false;
+	}
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return true;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		if (mapping) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+	file_ = file;
+	mapping_ = mapping;
+	data_ = static_cast<const char*>(view);
+	size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info {};
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+	if (info.st_size == 0) {
+		::close(fd);
+		return true;
+	}
+	const auto size = static_cast<std::size_t>(info.st_size);
+	void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	madvise(view, size, MADV_SEQUENTIAL);
+	data_ = static_cast<const char*>(view);
+	size_ = size;
+#endif
+	return true;
+}
+
+void MappedFile::close() {
+	if (data_ == nullptr) {
+		return;
+	}
+#if defined(_WIN32)
+	UnmapViewOfFile(data_);
+	CloseHandle(mapping_);
+	CloseHandle(file_);
+	mapping_ = nullptr;
+	file_ = nullptr;
+#else
+	munmap(const_cast<char*>(data_), size_);
+#endif
+	data_ = nullptr;
+	size_ = 0;
+}
+
+std::filesystem::path LogFileIndex::sidecarPathFor(const std::filesystem::path& csvPath) {
+	auto path = csvPath;
+	path += ".idx";
+	return path;
+}
+
+bool LogFileIndex::loadOrBuild(const std::filesystem::path& csvPath, LogFileIndex& out, bool* reused) {
+	std::error_code ec;
+	const auto size = std::filesystem::file_size(csvPath, ec);
+	const auto time = std::filesystem::last_write_time(csvPath, ec);
+	if (ec) {
+		return false;
+	}
+	const auto fileTime = static_cast<std::int64_t>(time.time_since_epoch().count());
+	const auto sidecar = sidecarPathFor(csvPath);
+	if (load(sidecar, out) && out.fileSize == size && out.fileTime == fileTime) {
+		if (reused) {
+			*reused = true;
+		}
+		return true;
+	}
+	if (reused) {
+		*reused = false;
+	}
+	MappedFile file;
+	if (!file.open(csvPath) || !build(file, out)) {
+		return false;
+	}
+	out.fileTime = fileTime;
+	if (!out.save(sidecar)) {
+		ofLogVerbose("LogFileIndex") << "Cannot write index " << sidecar << "; it will be rebuilt next time";
+	}
+	return true;
+}
+
+bool LogFileIndex::build(const MappedFile& file, LogFileIndex& out) {
+	out = LogFileIndex {};
+	out.fileSize = file.size();
+	const char* data = file.data();
+	const auto* headerEnd = data ? static_cast<const char*>(std::memchr(data, '\n', file.size())) : nullptr;
+	if (headerEnd == nullptr) {
+		return false;
+	}
+	std::string_view header(data, static_cast<std::size_t>(headerEnd - data));
+	if (!header.empty() && header.back() == '\r') {
+		header.remove_suffix(1);
+	}
+	out.kind = classifyHeader(header);
+	if (out.kind == LogKind::Unknown) {
+		return false;
+	}
+
+	std::uint64_t previous = 0;
+	forEachLine(data, static_cast<std::uint64_t>(headerEnd - data) + 1, file.size(),
+				[&](const char* begin, const char* end, std::uint64_t offset) {
+					std::array<std::string_view, 4> fields;
+					const std::size_t count = splitFields(begin, end, fields);
+					std::uint64_t timestamp = 0;
+					if (count < 2 || !parseU64(fields[0], timestamp)) {
+						return true;
+					}
+					if (out.rows % kCheckpointStride == 0) {
+						out.checkpoints.push_back({timestamp, offset});
+					}
+					if (out.rows == 0) {
+						out.firstMicros = timestamp;
+					} else if (timestamp < previous) {
+						out.monotonic = false;
+					}
+					previous = timestamp;
+					out.lastMicros = std::max(out.lastMicros, timestamp);
+					++out.rows;
+
+					if (out.kind == LogKind::Session && count == 4) {
+						if (out.scenes.empty() || out.scenes.back().scene != fields[3]) {
+							if (!out.scenes.empty()) {
+								out.scenes.back().endMicros = timestamp;
+							}
+							SceneSpan span;
+							span.scene = std::string(fields[3]);
+							span.beginMicros = timestamp;
+							out.scenes.push_back(std::move(span));
+						}
+						auto& span = out.scenes.back();
+						span.endMicros = timestamp;
+						++span.rows;
+						span.bpmSum += parseDouble(fields[1]);
+						span.envelopeSum += parseDouble(fields[2]);
+					} else if (out.kind == LogKind::Haptic) {
+						auto it = std::find_if(out.labels.begin(), out.labels.end(),
+											   [&](const LabelCount& entry) { return entry.label == fields[1]; });
+						if (it == out.labels.end()) {
+							out.labels.push_back({std::string(fields[1]), 0});
+							it = std::prev(out.labels.end());
+						}
+						++it->rows;
+					}
+					return true;
+				});
+	return true;
+}
+
+bool LogFileIndex::save(const std::filesystem::path& indexPath) const {
+	// Written aside and renamed so a concurrent reader never sees a half-written index.
+	auto temporary = indexPath;
+	temporary += ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		if (!out) {
+			return false;
+		}
+		out.write(kSidecarMagic, sizeof(kSidecarMagic));
+		writePod(out, static_cast<std::uint8_t>(kind));
+		writePod(out, static_cast<std::uint8_t>(monotonic ? 1 : 0));
+		writePod(out, fileSize);
+		writePod(out, fileTime);
+		writePod(out, rows);
+		writePod(out, firstMicros);
+		writePod(out, lastMicros);
+		writePod(out, static_cast<std::uint64_t>(checkpoints.size()));
+		out.write(reinterpret_cast<const char*>(checkpoints.data()),
+				  static_cast<std::streamsize>(checkpoints.size() * sizeof(Checkpoint)));
+		writePod(out, static_cast<std::uint64_t>(scenes.size()));
+		for (const auto& span : scenes) {
+			writeString(out, span.scene);
+			writePod(out, span.beginMicros);
+			writePod(out, span.endMicros);
+			writePod(out, span.rows);
+			writePod(out, span.bpmSum);
+			writePod(out, span.envelopeSum);
+		}
+		writePod(out, static_cast<std::uint64_t>(labels.size()));
+		for (const auto& entry : labels) {
+			writeString(out, entry.label);
+			writePod(out, entry.rows);
+		}
+		if (!out) {
+			return false;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(temporary, indexPath, ec);
+	return !ec;
+}
+
+bool LogFileIndex::load(const std::filesystem::path& indexPath, LogFileIndex& out) {
+	std::ifstream in(indexPath, std::ios::binary);
+	char magic[sizeof(kSidecarMagic)] = {};
+	if (!in || !in.read(magic, sizeof(magic)) || std::memcmp(magic, kSidecarMagic, sizeof(magic)) != 0) {
+		return false;
+	}
+	out = LogFileIndex {};
+	std::uint8_t kindValue = 0;
+	std::uint8_t monotonicValue = 0;
+	std::uint64_t count = 0;
+	if (!readPod(in, kindValue) || !readPod(in, monotonicValue) || !readPod(in, out.fileSize) ||
+		!readPod(in, out.fileTime) || !readPod(in, out.rows) || !readPod(in, out.firstMicros) ||
+		!readPod(in, out.lastMicros) || !readPod(in, count) || count > out.rows + 1) {
+		return false;
+	}
+	out.kind = static_cast<LogKind>(kindValue);
+	out.monotonic = monotonicValue != 0;
+	out.checkpoints.resize(static_cast<std::size_t>(count));
+	if (!in.read(reinterpret_cast<char*>(out.checkpoints.data()), static_cast<std::streamsize>(count * sizeof(Checkpoint))) ||
+		!readPod(in, count) || count > out.rows) {
+		return false;
+	}
+	out.scenes.resize(static_cast<std::size_t>(count));
+	for (auto& span : out.scenes) {
+		if (!readString(in, span.scene) || !readPod(in, span.beginMicros) || !readPod(in, span.endMicros) ||
+			!readPod(in, span.rows) || !readPod(in, span.bpmSum) || !readPod(in, span.envelopeSum)) {
+			return false;
+		}
+	}
+	if (!readPod(in, count) || count > out.rows) {
+		return false;
+	}
+	out.labels.resize(static_cast<std::size_t>(count));
+	for (auto& entry : out.labels) {
+		if (!readString(in, entry.label) || !readPod(in, entry.rows)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::pair<std::uint64_t, std::uint64_t> LogFileIndex::byteRange(std::uint64_t beginMicros,
+																 std::uint64_t endMicros) const {
+	if (checkpoints.empty()) {
+		return {0, 0};
+	}
+	if (!monotonic) {
+		return {checkpoints.front().offset, fileSize};
+	}
+	const auto byTime = [](const Checkpoint& checkpoint, std::uint64_t micros) {
+		return checkpoint.timestampMicros < micros;
+	};
+	// Start at the last checkpoint strictly before beginMicros: rows ahead of it are all earlier.
+	const auto first = std::lower_bound(checkpoints.begin(), checkpoints.end(), beginMicros, byTime);
+	const std::uint64_t begin = (first == checkpoints.begin()) ? checkpoints.front().offset : std::prev(first)->offset;
+	const auto last = std::lower_bound(first, checkpoints.end(), endMicros, byTime);
+	const std::uint64_t end = (last == checkpoints.end()) ? fileSize : last->offset;
+	return {begin, end};
+}
+
+bool LogArchive::open(const std::filesystem::path& directory, unsigned threads) {
+	const auto started = std::chrono::steady_clock::now();
+	sessions_.clear();
+	transitionLogs_.clear();
+	openStats_ = {};
+	threads_ = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(directory, ec)) {
+		ofLogError("LogArchive") << "Not a log directory: " << directory;
+		return false;
+	}
+	std::vector<std::filesystem::path> csvPaths;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".csv") {
+			csvPaths.push_back(entry.path());
+		}
+	}
+	std::sort(csvPaths.begin(), csvPaths.end());
+
+	std::vector<LogFileIndex> indexes(csvPaths.size());
+	std::vector<char> indexed(csvPaths.size(), 0);
+	std::vector<char> reused(csvPaths.size(), 0);
+	parallelFor(csvPaths.size(), threads_, [&](std::size_t i) {
+		bool wasReused = false;
+		indexed[i] = LogFileIndex::loadOrBuild(csvPaths[i], indexes[i], &wasReused) ? 1 : 0;
+		reused[i] = wasReused ? 1 : 0;
+	});
+
+	std::map<std::string, Session> byKey;
+	for (std::size_t i = 0; i < csvPaths.size(); ++i) {
+		if (!indexed[i]) {
+			continue;
+		}
+		++openStats_.files;
+		openStats_.indexesReused += reused[i] ? 1 : 0;
+		openStats_.bytes += indexes[i].fileSize;
+		const std::string key = sessionKeyFor(csvPaths[i]);
+		switch (indexes[i].kind) {
+			case LogKind::Session: {
+				auto& session = byKey[key];
+				session.sessionCsv = csvPaths[i];
+				session.session = std::move(indexes[i]);
+				break;
+			}
+			case LogKind::Haptic: {
+				auto& session = byKey[key];
+				session.hapticCsv = csvPaths[i];
+				session.haptic = std::move(indexes[i]);
+				break;
+			}
+			case LogKind::Transition:
+				transitionLogs_.push_back(csvPaths[i]);
+				break;
+			case LogKind::Unknown:
+				break;
+		}
+	}
+	for (auto& [key, session] : byKey) {
+		session.key = key;
+		const LogFileIndex& clock = session.sessionCsv.empty() ? session.haptic : session.session;
+		// A log is rotated after its last write, so a modification time later than the rotation
+		// suffix means the file was copied; the suffix is then the better end-of-session bound.
+		std::int64_t endSec = toUnixSeconds(clock.fileTime);
+		const std::int64_t rotatedSec = rotationUnixSeconds(key);
+		if (rotatedSec >= 0 && endSec > rotatedSec) {
+			endSec = rotatedSec;
+		}
+		session.wallStartSec = endSec - static_cast<std::int64_t>(clock.lastMicros / 1'000'000);
+		session.date = formatLocal(session.wallStartSec, "%Y-%m-%d");
+		sessions_.push_back(std::move(session));
+	}
+	std::sort(sessions_.begin(), sessions_.end(),
+			  [](const Session& a, const Session& b) { return a.wallStartSec < b.wallStartSec; });
+	openStats_.elapsedMs =
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+	return true;
+}
+
+bool LogArchive::sessionMatches(const Session& session, const Filter& filter) const {
+	return filter.date.empty() || session.date == filter.date;
+}
+
+std::vector<LogArchive::SceneSummary> LogArchive::sceneSummary(const Filter& filter) const {
+	std::vector<SceneSummary> summaries;
+	for (const auto& session : sessions_) {
+		if (!sessionMatches(session, filter)) {
+			continue;
+		}
+		std::vector<std::size_t> seen;
+		for (const auto& span : session.session.scenes) {
+			if (!filter.scene.empty() && span.scene != filter.scene) {
+				continue;
+			}
+			auto it = std::find_if(summaries.begin(), summaries.end(),
+								   [&](const SceneSummary& summary) { return summary.scene == span.scene; });
+			if (it == summaries.end()) {
+				summaries.push_back({});
+				it = std::prev(summaries.end());
+				it->scene = span.scene;
+			}
+			const auto slot = static_cast<std::size_t>(it - summaries.begin());
+			if (std::find(seen.begin(), seen.end(), slot) == seen.end()) {
+				seen.push_back(slot);
+				++it->sessions;
+			}
+			it->rows += span.rows;
+			it->seconds += static_cast<double>(span.endMicros - span.beginMicros) * 1e-6;
+			it->averageBpm += span.bpmSum;
+			it->averageEnvelope += span.envelopeSum;
+		}
+	}
+	for (auto& summary : summaries) {
+		if (summary.rows > 0) {
+			summary.averageBpm /= static_cast<double>(summary.rows);
+			summary.averageEnvelope /= static_cast<double>(summary.rows);
+		}
+	}
+	return summaries;
+}
+
+std::vector<LogArchive::BeatCount> LogArchive::countBeats(const Filter& filter) const {
+	std::vector<const Session*> selected;
+	for (const auto& session : sessions_) {
+		if (sessionMatches(session, filter) && !session.hapticCsv.empty()) {
+			selected.push_back(&session);
+		}
+	}
+	// Haptic labels are P1_detected, P2_fallback, ... (ofApp::handleBeatEvent) or "synthetic".
+	const std::string labelPrefix = filter.participant.empty() ? std::string() : filter.participant + "_";
+	const auto labelMatches = [&](std::string_view label) {
+		return labelPrefix.empty() || label.substr(0, labelPrefix.size()) == labelPrefix;
+	};
+
+	std::vector<BeatCount> results(selected.size());
+	parallelFor(selected.size(), threads_, [&](std::size_t i) {
+		const Session& session = *selected[i];
+		BeatCount& result = results[i];
+		result.session = session.key;
+		result.date = session.date;
+		if (filter.scene.empty()) {
+			for (const auto& entry : session.haptic.labels) {
+				result.beats += labelMatches(entry.label) ? entry.rows : 0;
+			}
+			const LogFileIndex& clock = session.sessionCsv.empty() ? session.haptic : session.session;
+			result.seconds = static_cast<double>(clock.lastMicros - clock.firstMicros) * 1e-6;
+			return;
+		}
+
+		MappedFile file;
+		if (!file.open(session.hapticCsv)) {
+			return;
+		}
+		const auto& scenes = session.session.scenes;
+		for (std::size_t s = 0; s < scenes.size(); ++s) {
+			const auto& span = scenes[s];
+			if (span.scene != filter.scene) {
+				continue;
+			}
+			// The last span runs until the app exited, past the final session row.
+			const std::uint64_t endMicros =
+				(s + 1 == scenes.size()) ? std::numeric_limits<std::uint64_t>::max() : span.endMicros;
+			result.seconds += static_cast<double>(span.endMicros - span.beginMicros) * 1e-6;
+			auto [from, to] = session.haptic.byteRange(span.beginMicros, endMicros);
+			to = std::min<std::uint64_t>(to, file.size());
+			forEachLine(file.data(), from, to, [&](const char* begin, const char* end, std::uint64_t) {
+				std::array<std::string_view, 3> fields;
+				std::uint64_t timestamp = 0;
+				if (splitFields(begin, end, fields) < 2 || !parseU64(fields[0], timestamp)) {
+					return true;
+				}
+				if (timestamp >= endMicros) {
+					return !session.haptic.monotonic;
+				}
+				if (timestamp >= span.beginMicros && labelMatches(fields[1])) {
+					++result.beats;
+				}
+				return true;
+			});
+		}
+	});
+	return results;
+}
+
+std::vector<LogArchive::TransitionSummary> LogArchive::transitionSummary() const {
+	std::vector<TransitionSummary> summaries;
+	for (const auto& path : transitionLogs_) {
+		MappedFile file;
+		if (!file.open(path) || file.size() == 0) {
+			continue;
+		}
+		const auto* headerEnd = static_cast<const char*>(std::memchr(file.data(), '\n', file.size()));
+		if (headerEnd == nullptr) {
+			continue;
+		}
+		forEachLine(file.data(), static_cast<std::uint64_t>(headerEnd - file.data()) + 1, file.size(),
+					[&](const char* begin, const char* end, std::uint64_t) {
+						std::array<std::string_view, 10> fields;
+						if (splitFields(begin, end, fields) < 10) {
+							return true;
+						}
+						auto it = std::find_if(summaries.begin(), summaries.end(), [&](const TransitionSummary& s) {
+							return s.sceneFrom == fields[1] && s.sceneTo == fields[2];
+						});
+						if (it == summaries.end()) {
+							summaries.push_back({});
+							it = std::prev(summaries.end());
+							it->sceneFrom = std::string(fields[1]);
+							it->sceneTo = std::string(fields[2]);
+						}
+						++it->count;
+						it->completed += (fields[9] == "1") ? 1 : 0;
+						it->averageTimeInStateSec += parseDouble(fields[5]);
+						return true;
+					});
+	}
+	for (auto& summary : summaries) {
+		summary.averageTimeInStateSec /= static_cast<double>(std::max<std::uint64_t>(summary.count, 1));
+	}
+	return summaries;
+}
+
+int runLogQueryCli(int argc, char* argv[]) {
+	std::string command;
+	std::filesystem::path directory = "../logs";
+	LogArchive::Filter filter;
+	unsigned threads = 0;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--query" && hasValue) {
+			command = argv[++i];
+		} else if (arg == "--logs" && hasValue) {
+			directory = argv[++i];
+		} else if (arg == "--scene" && hasValue) {
+			filter.scene = argv[++i];
+		} else if (arg == "--date" && hasValue) {
+			filter.date = argv[++i];
+		} else if (arg == "--participant" && hasValue) {
+			filter.participant = argv[++i];
+		} else if (arg == "--threads" && hasValue) {
+			threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+		}
+	}
+	if (!filter.scene.empty()) {
+		if (const auto state = sceneStateFromString(filter.scene)) {
+			filter.scene = sceneStateToString(*state);
+		}
+	}
+	if (filter.participant.size() == 1) {
+		filter.participant = "P" + filter.participant;
+	}
+	std::transform(filter.participant.begin(), filter.participant.end(), filter.participant.begin(),
+				   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+
+	if (command != "sessions" && command != "scenes" && command != "beats" && command != "transitions") {
+		std::cerr << "usage: --query <sessions|scenes|beats|transitions> [--logs DIR] [--scene NAME]"
+				  << " [--date YYYY-MM-DD] [--participant P1|P2] [--threads N]" << std::endl;
+		return 2;
+	}
+
+	LogArchive archive;
+	if (!archive.open(std::filesystem::absolute(directory), threads)) {
+		return 1;
+	}
+	const auto& stats = archive.openStats();
+	std::cerr << "Indexed " << stats.files << " logs (" << stats.indexesReused << " cached, "
+			  << std::fixed << std::setprecision(1) << static_cast<double>(stats.bytes) / (1024.0 * 1024.0)
+			  << " MiB) in " << stats.elapsedMs << " ms" << std::endl;
+
+	const auto started = std::chrono::steady_clock::now();
+	std::cout << std::fixed << std::setprecision(3);
+	if (command == "sessions") {
+		std::cout << "session,date,start,rows,durationSec,hapticRows\n";
+		for (const auto& session : archive.sessions()) {
+			if (!filter.date.empty() && session.date != filter.date) {
+				continue;
+			}
+			std::cout << session.key << ',' << session.date << ',' << formatLocal(session.wallStartSec, "%H:%M:%S") << ','
+					  << session.session.rows << ','
+					  << static_cast<double>(session.session.lastMicros - session.session.firstMicros) * 1e-6 << ','
+					  << session.haptic.rows << '\n';
+		}
+	} else if (command == "scenes") {
+		std::cout << "scene,sessions,rows,seconds,averageBpm,averageEnvelope\n";
+		for (const auto& summary : archive.sceneSummary(filter)) {
+			std::cout << summary.scene << ',' << summary.sessions << ',' << summary.rows << ',' << summary.seconds << ','
+					  << summary.averageBpm << ',' << summary.averageEnvelope << '\n';
+		}
+	} else if (command == "beats") {
+		std::uint64_t total = 0;
+		std::cout << "session,date,seconds,beats\n";
+		for (const auto& count : archive.countBeats(filter)) {
+			std::cout << count.session << ',' << count.date << ',' << count.seconds << ',' << count.beats << '\n';
+			total += count.beats;
+		}
+		std::cerr << "Total beats: " << total << std::endl;
+	} else {
+		std::cout << "sceneFrom,sceneTo,count,completed,averageTimeInStateSec\n";
+		for (const auto& summary : archive.transitionSummary()) {
+			std::cout << summary.sceneFrom << ',' << summary.sceneTo << ',' << summary.count << ','
+					  << summary.completed << ',' << summary.averageTimeInStateSec << '\n';
+		}
+	}
+	std::cout.flush();
+	std::cerr << "Query took "
+			  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count() << " ms"
+			  << std::endl;
+	return 0;
+}
+
+}  // namespace infra
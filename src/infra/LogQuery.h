@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace infra {
+
+/// Read-only memory map of a whole file. Empty or unreadable files map to an empty view.
+class MappedFile {
+  public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::filesystem::path& path);
+	void close();
+	const char* data() const noexcept { return data_; }
+	std::size_t size() const noexcept { return size_; }
+
+  private:
+	const char* data_ = nullptr;
+	std::size_t size_ = 0;
+#if defined(_WIN32)
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#endif
+};
+
+enum class LogKind : std::uint8_t { Unknown = 0, Session, Haptic, Transition };
+
+/// Per-file index of a session, haptic or transition CSV, cached in a binary sidecar next to
+/// the log (<name>.csv.idx). The sidecar is rebuilt whenever the CSV's size or modification
+/// time changes, so the live log is re-indexed while older rotated logs are never re-read.
+struct LogFileIndex {
+	/// Rows between checkpoints; a time-range query reads at most this many extra rows.
+	static constexpr std::uint64_t kCheckpointStride = 256;
+
+	struct Checkpoint {
+		std::uint64_t timestampMicros = 0;
+		std::uint64_t offset = 0;  // byte offset of the row
+	};
+	/// Run of consecutive session rows in the same scene.
+	struct SceneSpan {
+		std::string scene;
+		std::uint64_t beginMicros = 0;
+		std::uint64_t endMicros = 0;  // first row of the next span, or the last row of the file
+		std::uint64_t rows = 0;
+		double bpmSum = 0.0;
+		double envelopeSum = 0.0;
+	};
+	struct LabelCount {
+		std::string label;
+		std::uint64_t rows = 0;
+	};
+
+	LogKind kind = LogKind::Unknown;
+	std::uint64_t fileSize = 0;
+	std::int64_t fileTime = 0;
+	std::uint64_t rows = 0;
+	std::uint64_t firstMicros = 0;
+	std::uint64_t lastMicros = 0;
+	bool monotonic = true;
+	std::vector<Checkpoint> checkpoints;
+	std::vector<SceneSpan> scenes;   // session logs
+	std::vector<LabelCount> labels;  // haptic logs
+
+	static std::filesystem::path sidecarPathFor(const std::filesystem::path& csvPath);
+	/// Loads a current sidecar or indexes the CSV and writes one. reused reports which happened.
+	static bool loadOrBuild(const std::filesystem::path& csvPath, LogFileIndex& out, bool* reused = nullptr);
+	static bool build(const MappedFile& file, LogFileIndex& out);
+	bool save(const std::filesystem::path& indexPath) const;
+	static bool load(const std::filesystem::path& indexPath, LogFileIndex& out);
+
+	/// Byte range holding every row with beginMicros <= timestamp < endMicros (plus up to one
+	/// checkpoint stride of neighbours); the whole file when timestamps are not monotonic.
+	std::pair<std::uint64_t, std::uint64_t> byteRange(std::uint64_t beginMicros, std::uint64_t endMicros) const;
+};
+
+/// A directory of session, haptic and scene transition logs for post-session analysis.
+/// Session and haptic logs rotated at the same start-up share their _YYYYMMDD-HHMMSS suffix
+/// and are paired into one session; the live, unrotated pair is the session "current".
+/// Files are classified by their header line, so renamed logs are still picked up.
+/// Indexing and per-session queries run on a small worker pool, one file at a time per worker.
+class LogArchive {
+  public:
+	struct Session {
+		std::string key;
+		std::filesystem::path sessionCsv;
+		std::filesystem::path hapticCsv;
+		LogFileIndex session;
+		LogFileIndex haptic;
+		/// Timestamps count from app start; the wall-clock start is estimated as the session
+		/// log's modification time (or its rotation suffix, if the file was copied since) minus
+		/// its last timestamp.
+		std::int64_t wallStartSec = 0;
+		std::string date;  // YYYY-MM-DD, local time
+	};
+	struct Filter {
+		std::string scene;        // empty: all scenes
+		std::string date;         // YYYY-MM-DD; empty: all dates
+		std::string participant;  // P1 / P2; empty: both
+	};
+	struct SceneSummary {
+		std::string scene;
+		std::uint64_t sessions = 0;
+		std::uint64_t rows = 0;
+		double seconds = 0.0;
+		double averageBpm = 0.0;
+		double averageEnvelope = 0.0;
+	};
+	struct BeatCount {
+		std::string session;
+		std::string date;
+		std::uint64_t beats = 0;
+		double seconds = 0.0;
+	};
+	struct TransitionSummary {
+		std::string sceneFrom;
+		std::string sceneTo;
+		std::uint64_t count = 0;
+		std::uint64_t completed = 0;
+		double averageTimeInStateSec = 0.0;
+	};
+	struct OpenStats {
+		std::size_t files = 0;
+		std::size_t indexesReused = 0;
+		std::uint64_t bytes = 0;
+		double elapsedMs = 0.0;
+	};
+
+	/// Scans directory (not recursively) and indexes every log. threads == 0 uses all cores.
+	bool open(const std::filesystem::path& directory, unsigned threads = 0);
+	const std::vector<Session>& sessions() const noexcept { return sessions_; }
+	const OpenStats& openStats() const noexcept { return openStats_; }
+
+	/// Per-scene row counts, time and averages, answered from the indexes alone.
+	std::vector<SceneSummary> sceneSummary(const Filter& filter) const;
+	/// Haptic beats per session. Without a scene filter the indexed label counts are used;
+	/// with one, only the haptic rows inside that scene's spans are read.
+	std::vector<BeatCount> countBeats(const Filter& filter) const;
+	std::vector<TransitionSummary> transitionSummary() const;
+
+  private:
+	bool sessionMatches(const Session& session, const Filter& filter) const;
+
+	unsigned threads_ = 1;
+	std::vector<Session> sessions_;
+	std::vector<std::filesystem::path> transitionLogs_;
+	OpenStats openStats_;
+};
+
+/// --query <sessions|scenes|beats|transitions> [--logs DIR] [--scene NAME] [--date YYYY-MM-DD]
+///         [--participant P1|P2] [--threads N]
+/// Prints a CSV table to stdout and returns the process exit code.
+int runLogQueryCli(int argc, char* argv[]);
+
+}  // namespace infra
@@ -1,5 +1,7 @@
 #include "infra/TelemetryLogging.h"
 
+#include "audio/NoiseGenerator.h"
+
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -81,8 +83,96 @@ namespace infra {
 
 AppConfig AppConfigLoader::load(const std::filesystem::path& configRelativePath) const {
 	const auto absolutePath = std::filesystem::path(ofToDataPath(configRelativePath.string(), true));
-	const ofJson json = loadOrCreateDefault(absolutePath);
+	return parse(loadOrCreateDefault(absolutePath));
+}
+
+std::optional<AppConfig> AppConfigLoader::tryLoad(const std::filesystem::path& configRelativePath,
+												  std::string& error) const {
+	const auto absolutePath = std::filesystem::path(ofToDataPath(configRelativePath.string(), true));
+	if (!std::filesystem::exists(absolutePath)) {
+		error = "Config not found: " + absolutePath.string();
+		return std::nullopt;
+	}
+	try {
+		const ofJson json = ofLoadJson(absolutePath.string());
+		if (!json.is_object()) {
+			error = "Failed to parse config: " + absolutePath.string();
+			return std::nullopt;
+		}
+		AppConfig config = parse(json);
+		error = validate(config);
+		if (!error.empty()) {
+			return std::nullopt;
+		}
+		return config;
+	} catch (const std::exception& ex) {
+		error = std::string("Failed to parse config: ") + ex.what();
+		return std::nullopt;
+	}
+}
+
+std::string AppConfigLoader::validate(const AppConfig& config) {
+	if (!std::isfinite(config.inputGainDb) || config.inputGainDb < -24.0f || config.inputGainDb > 60.0f) {
+		return "inputGainDb out of range [-24, 60]";
+	}
+	if (config.audio.bufferSize < 32 || config.audio.bufferSize > 4096) {
+		return "audio.bufferSize out of range [32, 4096]";
+	}
+	if (config.audio.numBuffers == 0 || config.audio.numBuffers > 16) {
+		return "audio.numBuffers out of range [1, 16]";
+	}
+	if (!(config.audio.hapticLeadMs >= 0.0 && config.audio.hapticLeadMs <= 250.0)) {
+		return "audio.hapticLeadMs out of range [0, 250]";
+	}
+	if (!knot::audio::noiseColorFromString(config.audio.noiseColor)) {
+		return "audio.noiseColor must be white, pink or brown";
+	}
+	if (!(config.audio.resynthesisMix >= 0.0f && config.audio.resynthesisMix <= 1.0f)) {
+		return "audio.resynthesisMix out of range [0, 1]";
+	}
+	if (config.gui.keyboardToggleHoldTime < 0.0) {
+		return "gui.keyboardToggleHoldTime must not be negative";
+	}
+	if (!(config.streaming.envelopeRateHz > 0.0 && config.streaming.envelopeRateHz <= 1000.0)) {
+		return "streaming.envelopeRateHz out of range (0, 1000]";
+	}
+	if (config.streaming.envelopesPerPacket == 0 || config.streaming.envelopesPerPacket > 64) {
+		return "streaming.envelopesPerPacket out of range [1, 64]";
+	}
+	if (!(config.streaming.statusRateHz > 0.0 && config.streaming.statusRateHz <= 60.0)) {
+		return "streaming.statusRateHz out of range (0, 60]";
+	}
+	for (std::size_t i = 0; i < 2; ++i) {
+		if (!(config.simulation.bpm[i] >= 30.0f && config.simulation.bpm[i] <= 200.0f)) {
+			return "simulation.bpm out of range [30, 200]";
+		}
+		if (!(config.simulation.levelDb[i] >= -90.0f && config.simulation.levelDb[i] <= 0.0f)) {
+			return "simulation.levelDb out of range [-90, 0]";
+		}
+	}
+	if (!(config.simulation.hrvMs >= 0.0f && config.simulation.hrvMs <= 200.0f)) {
+		return "simulation.hrvMs out of range [0, 200]";
+	}
+	if (!(config.simulation.breathsPerMin >= 4.0f && config.simulation.breathsPerMin <= 40.0f)) {
+		return "simulation.breathsPerMin out of range [4, 40]";
+	}
+	if (!(config.simulation.noiseDb >= -120.0f && config.simulation.noiseDb <= -20.0f)) {
+		return "simulation.noiseDb out of range [-120, -20]";
+	}
+	if (!(config.simulation.crosstalkDb >= -120.0f && config.simulation.crosstalkDb <= 0.0f)) {
+		return "simulation.crosstalkDb out of range [-120, 0]";
+	}
+	if (!(config.simulation.dropoutsPerMin >= 0.0f && config.simulation.dropoutsPerMin <= 30.0f)) {
+		return "simulation.dropoutsPerMin out of range [0, 30]";
+	}
+	const std::string mode = ofToLower(config.operationMode);
+	if (mode != "debug" && mode != "operator" && mode != "exhibition") {
+		return "operationMode must be debug, operator or exhibition";
+	}
+	return {};
+}
 
+AppConfig AppConfigLoader::parse(const ofJson& json) {
 	AppConfig config;
 	const auto telemetryJson = json.value("telemetry", ofJson::object());
 	config.telemetry.sessionCsvPath = makeAbsolute(std::filesystem::path(telemetryJson.value("sessionCsv", "../logs/proto_session.csv")));
@@ -100,6 +190,17 @@ AppConfig AppConfigLoader::load(const std::filesystem::path& configRelativePath)
 	config.operationMode = json.value("operationMode", "debug");
 	config.inputGainDb = json.value("inputGainDb", 0.0f);
 
+	const auto audioJson = json.value("audio", ofJson::object());
+	config.audio.bufferSize = audioJson.value("bufferSize", 512u);
+	config.audio.numBuffers = audioJson.value("numBuffers", 4u);
+	config.audio.crosstalkCancellation = audioJson.value("crosstalkCancellation", true);
+	config.audio.inputAgc = audioJson.value("inputAgc", true);
+	config.audio.baselineTracking = audioJson.value("baselineTracking", false);
+	config.audio.predictiveHaptics = audioJson.value("predictiveHaptics", true);
+	config.audio.hapticLeadMs = audioJson.value("hapticLeadMs", 0.0);
+	config.audio.noiseColor = audioJson.value("noiseColor", "white");
+	config.audio.resynthesisMix = audioJson.value("resynthesisMix", 0.0f);
+
 	const auto guiJson = json.value("gui", ofJson::object());
 	config.gui.showControlPanel = guiJson.value("showControlPanel", true);
 	config.gui.showStatusPanel = guiJson.value("showStatusPanel", true);
@@ -108,7 +209,35 @@ AppConfig AppConfigLoader::load(const std::filesystem::path& configRelativePath)
 	config.gui.keyboardToggleHoldTime = guiJson.value("keyboardToggleHoldTime", 0.0);
 	config.gui.allowCornerUnlock = guiJson.value("allowCornerUnlock", false);
 
+	const auto recordingJson = json.value("recording", ofJson::object());
+	config.recording.enabled = recordingJson.value("enabled", false);
+	config.recording.directory = makeAbsolute(std::filesystem::path(recordingJson.value("directory", "../logs/recordings")));
+
+	const auto streamingJson = json.value("streaming", ofJson::object());
+	config.streaming.enabled = streamingJson.value("enabled", false);
+	config.streaming.destinations = streamingJson.value("destinations", std::vector<std::string>{"127.0.0.1:9000"});
+	config.streaming.envelopeRateHz = streamingJson.value("envelopeRateHz", 50.0);
+	config.streaming.envelopesPerPacket = streamingJson.value("envelopesPerPacket", 5u);
+	config.streaming.statusRateHz = streamingJson.value("statusRateHz", 4.0);
+
+	const auto simulationJson = json.value("simulation", ofJson::object());
+	const auto simulationPair = [&simulationJson](const char* key, std::array<float, 2> fallback) {
+		const auto values = simulationJson.value(key, std::vector<float>{fallback[0], fallback[1]});
+		if (values.size() >= 2) {
+			fallback = {values[0], values[1]};
+		}
+		return fallback;
+	};
+	config.simulation.bpm = simulationPair("bpm", config.simulation.bpm);
+	config.simulation.levelDb = simulationPair("levelDb", config.simulation.levelDb);
+	config.simulation.hrvMs = simulationJson.value("hrvMs", 30.0f);
+	config.simulation.breathsPerMin = simulationJson.value("breathsPerMin", 14.0f);
+	config.simulation.noiseDb = simulationJson.value("noiseDb", -66.0f);
+	config.simulation.crosstalkDb = simulationJson.value("crosstalkDb", -24.0f);
+	config.simulation.dropoutsPerMin = simulationJson.value("dropoutsPerMin", 0.0f);
+
 	config.sceneTimingConfigPath = std::filesystem::path(json.value("sceneTimingConfig", "config/scene_timing.json"));
+	config.routingPresetsPath = std::filesystem::path(json.value("routingPresets", "config/routing_presets.json"));
 	config.sceneTransitionCsvPath =
 		makeAbsolute(std::filesystem::path(json.value("sceneTransitionCsv", "../logs/scene_transitions.csv")));
 	return config;
@@ -147,6 +276,18 @@ ofJson AppConfigLoader::makeDefaultConfig(const std::filesystem::path& absoluteP
 			{"defaultScene", "Idle"},
 			{"operationMode", "debug"},
 			{"inputGainDb", 0.0},
+			{"audio",
+			 {
+				 {"bufferSize", 512},
+				 {"numBuffers", 4},
+				 {"crosstalkCancellation", true},
+				 {"inputAgc", true},
+				 {"baselineTracking", false},
+				 {"predictiveHaptics", true},
+				 {"hapticLeadMs", 0.0},
+				 {"noiseColor", "white"},
+				 {"resynthesisMix", 0.0},
+			 }},
 			{"gui",
 			 {
 				 {"showControlPanel", true},
@@ -156,7 +297,31 @@ ofJson AppConfigLoader::makeDefaultConfig(const std::filesystem::path& absoluteP
 				 {"keyboardToggleHoldTime", 0.0},
 				 {"allowCornerUnlock", false},
 			 }},
+			{"recording",
+			 {
+				 {"enabled", false},
+				 {"directory", "../logs/recordings"},
+			 }},
+			{"streaming",
+			 {
+				 {"enabled", false},
+				 {"destinations", {"127.0.0.1:9000"}},
+				 {"envelopeRateHz", 50.0},
+				 {"envelopesPerPacket", 5},
+				 {"statusRateHz", 4.0},
+			 }},
+			{"simulation",
+			 {
+				 {"bpm", {68.0, 74.0}},
+				 {"levelDb", {-36.0, -38.0}},
+				 {"hrvMs", 30.0},
+				 {"breathsPerMin", 14.0},
+				 {"noiseDb", -66.0},
+				 {"crosstalkDb", -24.0},
+				 {"dropoutsPerMin", 0.0},
+			 }},
 			{"sceneTimingConfig", "config/scene_timing.json"},
+			{"routingPresets", "config/routing_presets.json"},
 			{"sceneTransitionCsv", "../logs/scene_transitions.csv"},
 		};
 }
@@ -164,6 +329,8 @@ ofJson AppConfigLoader::makeDefaultConfig(const std::filesystem::path& absoluteP
 void SummaryAggregator::reset() {
 	bpmSamples_.clear();
 	rrIntervalsMs_.clear();
+	deviceOutages_.clear();
+	startup_.reset();
 	firstTimestampMicros_ = 0;
 	lastTimestampMicros_ = 0;
 	wallClockStart_.reset();
@@ -185,6 +352,14 @@ void SummaryAggregator::ingest(const TelemetryFrame& frame) {
 	}
 }
 
+void SummaryAggregator::recordDeviceOutage(const DeviceOutageFrame& outage) {
+	deviceOutages_.push_back(outage);
+}
+
+void SummaryAggregator::recordStartup(const StartupTimingFrame& startup) {
+	startup_ = startup;
+}
+
 ofJson SummaryAggregator::buildSummaryJson() const {
 	const double avgBpm = computeMean(bpmSamples_);
 	const double sdnn = computeStddev(rrIntervalsMs_, computeMean(rrIntervalsMs_));
@@ -212,6 +387,51 @@ ofJson SummaryAggregator::buildSummaryJson() const {
 		};
 	}
 
+	if (!deviceOutages_.empty()) {
+		double totalSec = 0.0;
+		double maxSec = 0.0;
+		ofJson events = ofJson::array();
+		for (const auto& outage : deviceOutages_) {
+			const double recoverSec = static_cast<double>(outage.recoveredAtMicros - outage.lostAtMicros) / 1'000'000.0;
+			totalSec += recoverSec;
+			maxSec = std::max(maxSec, recoverSec);
+			ofJson event = {
+				{"lostAtMicros", outage.lostAtMicros},
+				{"recoverSec", recoverSec},
+				{"reopenMs", static_cast<double>(outage.reopenMicros) / 1000.0},
+				{"reason", outage.reason},
+				{"device", outage.device},
+			};
+			events.push_back(event);
+		}
+		summary["audioDeviceOutages"] = {
+			{"count", deviceOutages_.size()},
+			{"totalRecoverSec", totalSec},
+			{"maxRecoverSec", maxSec},
+			{"events", events},
+		};
+	}
+
+	if (startup_.has_value()) {
+		// null for a milestone that was not reached (e.g. no output device, so no audio callback).
+		const auto milestoneMs = [](uint64_t micros) -> ofJson {
+			if (micros == 0) {
+				return nullptr;
+			}
+			return static_cast<double>(micros) / 1000.0;
+		};
+		summary["startup"] = {
+			{"setupMs", milestoneMs(startup_->setupMicros)},
+			{"firstAudioMs", milestoneMs(startup_->firstAudioMicros)},
+			{"firstFrameMs", milestoneMs(startup_->firstFrameMicros)},
+			{"audioAssetsMs", milestoneMs(startup_->audioAssetsMicros)},
+			{"graphicsAssetsMs", milestoneMs(startup_->graphicsAssetsMicros)},
+			{"hrirLoadMs", static_cast<double>(startup_->hrirLoadMicros) / 1000.0},
+			{"shaders", startup_->shaderCount},
+			{"shaderCacheHits", startup_->shaderCacheHits},
+		};
+	}
+
 	return summary;
 }
 
@@ -248,6 +468,14 @@ void SessionLogger::append(const TelemetryFrame& frame) {
 	aggregator_.ingest(frame);
 }
 
+void SessionLogger::recordDeviceOutage(const DeviceOutageFrame& outage) {
+	aggregator_.recordDeviceOutage(outage);
+}
+
+void SessionLogger::recordStartup(const StartupTimingFrame& startup) {
+	aggregator_.recordStartup(startup);
+}
+
 void SessionLogger::flushIfDue(uint64_t nowMicros) {
 	const uint64_t flushIntervalMicros = static_cast<uint64_t>(config_.flushIntervalMs) * 1000ULL;
 	if (flushIntervalMicros == 0) {
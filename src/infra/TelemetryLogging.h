@@ -1,6 +1,9 @@
 #pragma once
 
+#include "infra/TelemetryStreamer.h"
+
 #include "ofMain.h"
+#include <array>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -22,6 +25,27 @@ struct HapticEventFrame {
 	float intensity = 0.0f;
 };
 
+/// One audio device loss and the automatic reopen that ended it.
+struct DeviceOutageFrame {
+	uint64_t lostAtMicros = 0;
+	uint64_t recoveredAtMicros = 0;
+	uint64_t reopenMicros = 0;  // time spent in the successful stream setup
+	std::string reason;         // output_removed / input_removed / stream_stalled
+	std::string device;
+};
+
+/// Staged startup milestones, in microseconds since process launch (0 = not reached).
+struct StartupTimingFrame {
+	uint64_t setupMicros = 0;           // ofApp::setup() returned
+	uint64_t firstAudioMicros = 0;      // first output callback
+	uint64_t firstFrameMicros = 0;      // first draw()
+	uint64_t audioAssetsMicros = 0;     // HRIR set, routing presets and bell cue attached
+	uint64_t graphicsAssetsMicros = 0;  // shaders and fonts loaded
+	uint64_t hrirLoadMicros = 0;        // loader thread time spent on the HRIR set (duration)
+	uint32_t shaderCount = 0;
+	uint32_t shaderCacheHits = 0;
+};
+
 struct TelemetryConfig {
 	std::filesystem::path sessionCsvPath;
 	std::filesystem::path summaryJsonPath;
@@ -39,6 +63,34 @@ struct GuiConfig {
 	bool allowCornerUnlock = false;
 };
 
+struct RecordingConfig {
+	bool enabled = false;
+	std::filesystem::path directory;
+};
+
+struct AudioStreamConfig {
+	uint32_t bufferSize = 512;  // frames per callback
+	uint32_t numBuffers = 4;
+	bool crosstalkCancellation = true;  // cancel stethoscope cross-pickup before beat detection
+	bool inputAgc = true;               // level each stethoscope on its own beats, starting at inputGainDb
+	bool baselineTracking = false;      // confirm beats against a running median/MAD floor (~20 ms later)
+	bool predictiveHaptics = true;      // start haptic pulses on the predicted beat, not after detection
+	double hapticLeadMs = 0.0;          // input->trigger delay to make up; 0 = latency sweep or estimate
+	std::string noiseColor = "white";   // background noise: white, pink or brown
+	float resynthesisMix = 0.0f;        // headphones: 0 = calibrated input, 1 = resynthesised S1/S2 only
+};
+
+// Synthetic stethoscope input for the "Synthetic Signal" mode (see knot::audio::SyntheticHeartSource).
+struct SimulationConfig {
+	std::array<float, 2> bpm{68.0f, 74.0f};
+	std::array<float, 2> levelDb{-36.0f, -38.0f};  // raw S1 peak, before the input gain
+	float hrvMs = 30.0f;                           // RR jitter (standard deviation)
+	float breathsPerMin = 14.0f;
+	float noiseDb = -66.0f;
+	float crosstalkDb = -24.0f;
+	float dropoutsPerMin = 0.0f;
+};
+
 struct AppConfig {
 	TelemetryConfig telemetry;
 	std::filesystem::path calibrationPath;
@@ -48,16 +100,26 @@ struct AppConfig {
 	std::string defaultScene = "Idle";
 	std::string operationMode = "debug";
 	float inputGainDb = 0.0f;
+	AudioStreamConfig audio;
 	GuiConfig gui;
+	RecordingConfig recording;
+	StreamingConfig streaming;
+	SimulationConfig simulation;
 	std::filesystem::path sceneTimingConfigPath;
+	std::filesystem::path routingPresetsPath;
 	std::filesystem::path sceneTransitionCsvPath;
 };
 
 class AppConfigLoader {
   public:
 	AppConfig load(const std::filesystem::path& configRelativePath) const;
+	/// Hot-reload variant: never writes a default file; returns nullopt with a reason when the
+	/// file is missing, unparsable or out of range.
+	std::optional<AppConfig> tryLoad(const std::filesystem::path& configRelativePath, std::string& error) const;
 
   private:
+	static AppConfig parse(const ofJson& json);
+	static std::string validate(const AppConfig& config);
 	static ofJson loadOrCreateDefault(const std::filesystem::path& absolutePath);
 	static ofJson makeDefaultConfig(const std::filesystem::path& absolutePath);
 };
@@ -66,10 +128,14 @@ class SummaryAggregator {
   public:
 	void reset();
 	void ingest(const TelemetryFrame& frame);
+	void recordDeviceOutage(const DeviceOutageFrame& outage);
+	void recordStartup(const StartupTimingFrame& startup);
 	[[nodiscard]] ofJson buildSummaryJson() const;
 
   private:
 	std::vector<double> bpmSamples_;
+	std::vector<DeviceOutageFrame> deviceOutages_;
+	std::optional<StartupTimingFrame> startup_;
 	std::vector<double> rrIntervalsMs_;
 	uint64_t firstTimestampMicros_ = 0;
 	uint64_t lastTimestampMicros_ = 0;
@@ -88,6 +154,10 @@ class SessionLogger {
 	SessionLogger& operator=(SessionLogger&&) = delete;
 
 	void append(const TelemetryFrame& frame);
+	/// Adds a device outage to the summary's "audioDeviceOutages" block.
+	void recordDeviceOutage(const DeviceOutageFrame& outage);
+	/// Sets the summary's "startup" block.
+	void recordStartup(const StartupTimingFrame& startup);
 	void flushIfDue(uint64_t nowMicros);
 	void writeSummary();
 
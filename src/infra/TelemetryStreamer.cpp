@@ -0,0 +1,566 @@
+#include "infra/TelemetryStreamer.h"
+
+#include "audio/AudioLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace infra {
+
+namespace {
+
+constexpr auto kPumpInterval = std::chrono::milliseconds(1);
+constexpr std::intptr_t kInvalidSocket = -1;
+constexpr std::size_t kMaxDatagramBytes = 1472;
+
+static_assert(sizeof(sockaddr_in) == 16, "Destination stores a sockaddr_in in 16 bytes");
+
+/// Minimal OSC 1.0 encoder: big-endian arguments and 4-byte aligned strings.
+class OscWriter {
+  public:
+	explicit OscWriter(std::vector<unsigned char>& out) : out_(out) {}
+
+	void string(const char* value) {
+		// resize + memcpy rather than a range insert, which GCC 12 misreports as an overflow.
+		const std::size_t offset = out_.size();
+		const std::size_t length = std::strlen(value) + 1;
+		out_.resize(offset + length);
+		std::memcpy(out_.data() + offset, value, length);
+		while (out_.size() % 4 != 0) {
+			out_.push_back(0);
+		}
+	}
+	void int32(std::int32_t value) { bigEndian(static_cast<std::uint32_t>(value), 4); }
+	void int64(std::int64_t value) { bigEndian(static_cast<std::uint64_t>(value), 8); }
+	void float32(float value) {
+		std::uint32_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		bigEndian(bits, 4);
+	}
+	void float64(double value) {
+		std::uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		bigEndian(bits, 8);
+	}
+	void bundleHeader() {
+		string("#bundle");
+		bigEndian(1, 8);  // time tag "immediately"
+	}
+	/// Reserves an element size field; pass the result to endElement() once the element is written.
+	std::size_t beginElement() {
+		const std::size_t offset = out_.size();
+		int32(0);
+		return offset;
+	}
+	void endElement(std::size_t offset) {
+		const auto size = static_cast<std::uint32_t>(out_.size() - offset - 4);
+		for (std::size_t i = 0; i < 4; ++i) {
+			out_[offset + i] = static_cast<unsigned char>((size >> (8 * (3 - i))) & 0xFF);
+		}
+	}
+
+  private:
+	void bigEndian(std::uint64_t value, int bytes) {
+		for (int i = bytes - 1; i >= 0; --i) {
+			out_.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+		}
+	}
+
+	std::vector<unsigned char>& out_;
+};
+
+std::int32_t participantNumber(knot::audio::ParticipantId id) {
+	switch (id) {
+		case knot::audio::ParticipantId::Participant1:
+			return 1;
+		case knot::audio::ParticipantId::Participant2:
+			return 2;
+		default:
+			return 0;
+	}
+}
+
+std::intptr_t openUdpSocket() {
+#if defined(_WIN32)
+	static const bool winsockReady = [] {
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+	if (!winsockReady) {
+		return kInvalidSocket;
+	}
+	const SOCKET handle = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (handle == INVALID_SOCKET) {
+		return kInvalidSocket;
+	}
+	u_long nonBlocking = 1;
+	ioctlsocket(handle, FIONBIO, &nonBlocking);
+	return static_cast<std::intptr_t>(handle);
+#else
+	const int handle = ::socket(AF_INET, SOCK_DGRAM, 0);
+	if (handle < 0) {
+		return kInvalidSocket;
+	}
+	fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+	return handle;
+#endif
+}
+
+void closeUdpSocket(std::intptr_t handle) {
+	if (handle == kInvalidSocket) {
+		return;
+	}
+#if defined(_WIN32)
+	closesocket(static_cast<SOCKET>(handle));
+#else
+	::close(static_cast<int>(handle));
+#endif
+}
+
+bool sendDatagram(std::intptr_t handle, const unsigned char* data, std::size_t size, const sockaddr_in& address) {
+#if defined(_WIN32)
+	const int sent = ::sendto(static_cast<SOCKET>(handle), reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+							  reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+#else
+	const auto sent = ::sendto(static_cast<int>(handle), data, size, 0, reinterpret_cast<const sockaddr*>(&address),
+							   sizeof(address));
+#endif
+	return sent >= 0 && static_cast<std::size_t>(sent) == size;
+}
+
+long receiveDatagram(std::intptr_t handle, unsigned char* data, std::size_t capacity) {
+#if defined(_WIN32)
+	return ::recv(static_cast<SOCKET>(handle), reinterpret_cast<char*>(data), static_cast<int>(capacity), 0);
+#else
+	return static_cast<long>(::recv(static_cast<int>(handle), data, capacity, 0));
+#endif
+}
+
+/// Binds to 127.0.0.1 on an ephemeral port and writes the chosen address back.
+bool bindLoopback(std::intptr_t handle, sockaddr_in& address) {
+	address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t length = sizeof(address);
+#if defined(_WIN32)
+	const auto native = static_cast<SOCKET>(handle);
+#else
+	const auto native = static_cast<int>(handle);
+#endif
+	return ::bind(native, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+		   ::getsockname(native, reinterpret_cast<sockaddr*>(&address), &length) == 0;
+}
+
+bool resolveDestination(const std::string& hostPort, sockaddr_in& out) {
+	const auto colon = hostPort.rfind(':');
+	if (colon == std::string::npos || colon == 0 || colon + 1 >= hostPort.size()) {
+		return false;
+	}
+	addrinfo hints{};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo* result = nullptr;
+	const std::string host = hostPort.substr(0, colon);
+	const std::string port = hostPort.substr(colon + 1);
+	if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+		return false;
+	}
+	std::memcpy(&out, result->ai_addr, sizeof(sockaddr_in));
+	freeaddrinfo(result);
+	return true;
+}
+
+}  // namespace
+
+TelemetryStreamer::~TelemetryStreamer() {
+	stop();
+	closeSocket();
+}
+
+bool TelemetryStreamer::configure(const StreamingConfig& config) {
+	if (running()) {
+		knot::audio::logWarning("TelemetryStreamer") << "configure() ignored while running";
+		return false;
+	}
+	closeSocket();
+	destinations_.clear();
+	socket_ = openUdpSocket();
+	if (socket_ == kInvalidSocket) {
+		knot::audio::logError("TelemetryStreamer") << "Cannot open UDP socket";
+		return false;
+	}
+	for (const auto& hostPort : config.destinations) {
+		sockaddr_in address{};
+		if (!resolveDestination(hostPort, address)) {
+			knot::audio::logWarning("TelemetryStreamer") << "Skipping unresolvable destination '" << hostPort << "'";
+			continue;
+		}
+		Destination destination;
+		destination.label = hostPort;
+		std::memcpy(destination.address.data(), &address, sizeof(address));
+		destinations_.push_back(std::move(destination));
+	}
+	envelopeRateHz_ = config.envelopeRateHz;
+	envelopesPerPacket_ = std::clamp<std::size_t>(config.envelopesPerPacket, 1, kMaxEnvelopesPerPacket);
+	statusIntervalSec_ = 1.0 / config.statusRateHz;
+	return !destinations_.empty();
+}
+
+void TelemetryStreamer::setBeatSource(knot::audio::BeatEventBus::Subscriber subscriber) {
+	beats_ = subscriber;
+}
+
+void TelemetryStreamer::setEnvelopeSources(const knot::audio::EnvelopeScopeTap* participant1,
+										   const knot::audio::EnvelopeScopeTap* participant2) {
+	envelopes_[0].tap = participant1;
+	envelopes_[1].tap = participant2;
+}
+
+void TelemetryStreamer::start() {
+	if (running() || destinations_.empty()) {
+		return;
+	}
+	std::size_t scratch = 0;
+	for (auto& stream : envelopes_) {
+		stream.pending.clear();
+		stream.pending.reserve(kMaxEnvelopesPerPacket * 2);
+		stream.bucketFill = 0;
+		stream.peak = 0.0f;
+		if (!stream.tap) {
+			continue;
+		}
+		const double bucketsPerSample = 1.0 / (envelopeRateHz_ * stream.tap->bucketDurationSec());
+		stream.bucketsPerSample = static_cast<std::size_t>(std::max(1.0, std::round(bucketsPerSample)));
+		stream.nextSequence = stream.tap->publishedCount();
+		scratch = std::max(scratch, stream.tap->capacity());
+	}
+	scopeScratch_.assign(scratch, {});
+	packet_.reserve(kMaxDatagramBytes * 2);
+	beats_.skipToLatest();
+	lastStatusSequence_ = 0;
+	lastStatusSent_ = {};
+
+	stopRequested_.store(false, std::memory_order_release);
+	running_.store(true, std::memory_order_release);
+	thread_ = std::thread(&TelemetryStreamer::run, this);
+	for (const auto& destination : destinations_) {
+		knot::audio::logNotice("TelemetryStreamer") << "Streaming OSC telemetry to " << destination.label;
+	}
+}
+
+void TelemetryStreamer::stop() {
+	stopRequested_.store(true, std::memory_order_release);
+	if (thread_.joinable()) {
+		thread_.join();
+	}
+	running_.store(false, std::memory_order_release);
+}
+
+TelemetryStreamer::Stats TelemetryStreamer::stats() const noexcept {
+	Stats result;
+	result.packets = packets_.load(std::memory_order_relaxed);
+	result.bytes = bytes_.load(std::memory_order_relaxed);
+	result.sendErrors = sendErrors_.load(std::memory_order_relaxed);
+	result.beats = beatsSent_.load(std::memory_order_relaxed);
+	return result;
+}
+
+void TelemetryStreamer::run() {
+	while (!stopRequested_.load(std::memory_order_acquire)) {
+		pumpBeats();
+		pumpEnvelopes();
+		pumpStatus(std::chrono::steady_clock::now());
+		std::this_thread::sleep_for(kPumpInterval);
+	}
+	pumpBeats();
+	sendEnvelopeBundle();
+}
+
+void TelemetryStreamer::pumpBeats() {
+	beats_.poll([this](const knot::audio::BeatEvent& event) {
+		packet_.clear();
+		OscWriter osc(packet_);
+		osc.string("/knot/beat");
+		osc.string(",idffh");
+		osc.int32(participantNumber(event.participantId));
+		osc.float64(event.timestampSec);
+		osc.float32(event.bpm);
+		osc.float32(event.envelope);
+		osc.int64(static_cast<std::int64_t>(event.sequenceId));
+		send(packet_.data(), packet_.size());
+		beatsSent_.fetch_add(1, std::memory_order_relaxed);
+	});
+}
+
+void TelemetryStreamer::pumpEnvelopes() {
+	for (auto& stream : envelopes_) {
+		if (!stream.tap) {
+			continue;
+		}
+		const std::uint64_t published = stream.tap->publishedCount();
+		if (published <= stream.nextSequence) {
+			continue;
+		}
+		const auto wanted =
+			static_cast<std::size_t>(std::min<std::uint64_t>(published - stream.nextSequence, scopeScratch_.size()));
+		std::uint64_t lastSequence = 0;
+		const std::size_t count = stream.tap->readLatest(scopeScratch_.data(), wanted, &lastSequence);
+		if (count == 0) {
+			continue;
+		}
+		const std::uint64_t firstSequence = lastSequence + 1 - count;
+		if (firstSequence > stream.nextSequence) {
+			// The tap lapped us; what is pending no longer lines up in time, so send it as is.
+			sendEnvelopeBundle();
+			stream.bucketFill = 0;
+		}
+		const double bucketSec = stream.tap->bucketDurationSec();
+		for (std::size_t i = 0; i < count; ++i) {
+			const std::uint64_t sequence = firstSequence + i;
+			if (sequence < stream.nextSequence) {
+				continue;
+			}
+			if (stream.bucketFill == 0) {
+				if (stream.pending.empty()) {
+					stream.pendingStartSec = static_cast<double>(sequence) * bucketSec;
+				}
+				stream.peak = scopeScratch_[i].envelopeMax;
+			} else {
+				stream.peak = std::max(stream.peak, scopeScratch_[i].envelopeMax);
+			}
+			if (++stream.bucketFill >= stream.bucketsPerSample) {
+				stream.pending.push_back(stream.peak);
+				stream.bucketFill = 0;
+			}
+		}
+		stream.nextSequence = lastSequence + 1;
+	}
+	if (envelopes_[0].pending.size() >= envelopesPerPacket_ || envelopes_[1].pending.size() >= envelopesPerPacket_) {
+		sendEnvelopeBundle();
+	}
+}
+
+void TelemetryStreamer::sendEnvelopeBundle() {
+	packet_.clear();
+	OscWriter osc(packet_);
+	osc.bundleHeader();
+	bool hasElements = false;
+	for (std::size_t index = 0; index < envelopes_.size(); ++index) {
+		auto& stream = envelopes_[index];
+		if (stream.pending.empty() || !stream.tap) {
+			continue;
+		}
+		const std::size_t count = std::min(stream.pending.size(), kMaxEnvelopesPerPacket);
+		const double periodSec = static_cast<double>(stream.bucketsPerSample) * stream.tap->bucketDurationSec();
+		char tags[kMaxEnvelopesPerPacket + 5] = ",idf";
+		std::memset(tags + 4, 'f', count);
+		tags[4 + count] = '\0';
+
+		const std::size_t element = osc.beginElement();
+		osc.string("/knot/envelope");
+		osc.string(tags);
+		osc.int32(static_cast<std::int32_t>(index + 1));
+		osc.float64(stream.pendingStartSec);
+		osc.float32(static_cast<float>(periodSec));
+		for (std::size_t i = 0; i < count; ++i) {
+			osc.float32(stream.pending[i]);
+		}
+		osc.endElement(element);
+		hasElements = true;
+
+		stream.pending.erase(stream.pending.begin(), stream.pending.begin() + static_cast<std::ptrdiff_t>(count));
+		stream.pendingStartSec += static_cast<double>(count) * periodSec;
+	}
+	if (hasElements) {
+		send(packet_.data(), packet_.size());
+	}
+}
+
+void TelemetryStreamer::pumpStatus(std::chrono::steady_clock::time_point now) {
+	const StreamStatus& status = status_.read();
+	if (status.sequence == lastStatusSequence_ ||
+		std::chrono::duration<double>(now - lastStatusSent_).count() < statusIntervalSec_) {
+		return;
+	}
+	lastStatusSequence_ = status.sequence;
+	lastStatusSent_ = now;
+
+	char scene[sizeof(status.scene) + 1] = {};
+	std::memcpy(scene, status.scene, sizeof(status.scene));
+	packet_.clear();
+	OscWriter osc(packet_);
+	osc.string("/knot/status");
+	osc.string(",fffffffffiffffs");
+	osc.float32(status.bpm[0]);
+	osc.float32(status.bpm[1]);
+	osc.float32(status.envelope[0]);
+	osc.float32(status.envelope[1]);
+	osc.float32(status.envelopeShort);
+	osc.float32(status.envelopeMid);
+	osc.float32(status.envelopeLong);
+	osc.float32(status.bpmAverage);
+	osc.float32(status.dropoutSeconds);
+	osc.int32(status.fallbackActive ? 1 : 0);
+	osc.float32(status.fallbackBlend);
+	osc.float32(status.limiterReductionDb);
+	osc.float32(status.inputGainDb[0]);
+	osc.float32(status.inputGainDb[1]);
+	osc.string(scene);
+	send(packet_.data(), packet_.size());
+}
+
+void TelemetryStreamer::send(const unsigned char* data, std::size_t size) {
+	for (const auto& destination : destinations_) {
+		sockaddr_in address{};
+		std::memcpy(&address, destination.address.data(), sizeof(address));
+		if (sendDatagram(socket_, data, size, address)) {
+			packets_.fetch_add(1, std::memory_order_relaxed);
+			bytes_.fetch_add(size, std::memory_order_relaxed);
+		} else {
+			sendErrors_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+void TelemetryStreamer::closeSocket() {
+	closeUdpSocket(socket_);
+	socket_ = kInvalidSocket;
+}
+
+TelemetryStreamer::LoopbackReport TelemetryStreamer::measureLoopback(const StreamingConfig& config) {
+	using Clock = std::chrono::steady_clock;
+	constexpr double kSampleRate = 48000.0;
+	constexpr std::size_t kSamplesPerTick = 48;  // 1 ms of audio per tick
+	constexpr std::uint64_t kTicks = 300;
+	constexpr std::uint64_t kBeatEveryTicks = 10;
+	constexpr std::uint64_t kStatusEveryTicks = 16;
+
+	LoopbackReport report;
+	const std::intptr_t receiver = openUdpSocket();
+	sockaddr_in address{};
+	if (receiver == kInvalidSocket || !bindLoopback(receiver, address)) {
+		closeUdpSocket(receiver);
+		return report;
+	}
+	report.receiverBound = true;
+
+	StreamingConfig loopback = config;
+	loopback.destinations = {"127.0.0.1:" + std::to_string(ntohs(address.sin_port))};
+	knot::audio::BeatEventBus bus;
+	std::array<knot::audio::EnvelopeScopeTap, 2> taps;
+	for (auto& tap : taps) {
+		tap.setup(kSampleRate);
+	}
+	TelemetryStreamer streamer;
+	if (!streamer.configure(loopback)) {
+		closeUdpSocket(receiver);
+		report.receiverBound = false;
+		return report;
+	}
+	streamer.setBeatSource(bus.subscribe());
+	streamer.setEnvelopeSources(&taps[0], &taps[1]);
+	streamer.start();
+
+	std::vector<Clock::time_point> sentAt;
+	sentAt.reserve(kTicks / kBeatEveryTicks + 1);
+	std::vector<bool> delivered(kTicks / kBeatEveryTicks + 1, false);
+	std::vector<double> latenciesUs;
+	std::array<unsigned char, 2048> datagram{};
+	const auto begin = Clock::now();
+	const auto drainUntil = begin + std::chrono::milliseconds(kTicks + 50);
+	std::uint64_t tick = 0;
+	while (Clock::now() < drainUntil) {
+		if (tick < kTicks && Clock::now() >= begin + std::chrono::milliseconds(tick)) {
+			for (std::size_t n = 0; n < kSamplesPerTick; ++n) {
+				const float envelope = 0.5f + 0.5f * std::sin(static_cast<float>(tick * kSamplesPerTick + n) * 0.001f);
+				taps[0].write(envelope, 0.3f);
+				taps[1].write(1.0f - envelope, 0.3f);
+			}
+			if (tick % kBeatEveryTicks == 0) {
+				knot::audio::BeatEvent event;
+				event.participantId = (sentAt.size() % 2 == 0) ? knot::audio::ParticipantId::Participant1
+																: knot::audio::ParticipantId::Participant2;
+				event.sequenceId = sentAt.size();
+				event.timestampSec = static_cast<double>(tick) * 1e-3;
+				sentAt.push_back(Clock::now());
+				bus.publish(event);
+			}
+			if (tick % kStatusEveryTicks == 0) {
+				StreamStatus status;
+				status.sequence = tick + 1;
+				std::strncpy(status.scene, "Loopback", sizeof(status.scene) - 1);
+				streamer.publishStatus(status);
+			}
+			++tick;
+		}
+		long received = 0;
+		while ((received = receiveDatagram(receiver, datagram.data(), datagram.size())) > 0) {
+			const char* text = reinterpret_cast<const char*>(datagram.data());
+			if (std::strncmp(text, "/knot/beat", 11) == 0 && received >= 48) {
+				std::uint64_t sequence = 0;
+				for (std::size_t i = 40; i < 48; ++i) {
+					sequence = (sequence << 8) | datagram[i];
+				}
+				if (sequence < sentAt.size() && !delivered[sequence]) {
+					delivered[sequence] = true;
+					latenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sentAt[sequence]).count());
+				}
+			} else if (std::strncmp(text, "#bundle", 8) == 0) {
+				++report.envelopeBundles;
+			} else if (std::strncmp(text, "/knot/status", 13) == 0) {
+				++report.statusMessages;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+	streamer.stop();
+	closeUdpSocket(receiver);
+
+	report.stats = streamer.stats();
+	report.beatsSent = sentAt.size();
+	report.beatsReceived = latenciesUs.size();
+	report.durationSec = static_cast<double>(kTicks) * 1e-3;
+	std::sort(latenciesUs.begin(), latenciesUs.end());
+	if (!latenciesUs.empty()) {
+		report.beatLatencyMedianUs = latenciesUs[latenciesUs.size() / 2];
+		report.beatLatencyMaxUs = latenciesUs.back();
+	}
+	return report;
+}
+
+bool TelemetryStreamer::runLoopbackCheck(const StreamingConfig& config) {
+	const LoopbackReport report = measureLoopback(config);
+	if (!report.receiverBound) {
+		knot::audio::logError("TelemetryStreamer") << "Loopback check failed: cannot bind a local receiver";
+		return false;
+	}
+	const bool passed = report.passed();
+	std::ostringstream summary;
+	summary << "Loopback check " << (passed ? "passed" : "FAILED") << ": beats " << report.beatsReceived << "/"
+		<< report.beatsSent << ", " << report.lostBeats() << " lost (latency median " << report.beatLatencyMedianUs
+		<< " us, max " << report.beatLatencyMaxUs << " us), " << report.envelopeBundles << " envelope bundles, "
+		<< report.statusMessages << " status, " << report.stats.packets << " packets, "
+		<< report.bytesPerSecond() / 1024.0 << " KiB/s, " << report.stats.sendErrors << " send errors";
+	if (passed) {
+		knot::audio::logNotice("TelemetryStreamer") << summary.str();
+	} else {
+		knot::audio::logError("TelemetryStreamer") << summary.str();
+	}
+	return passed;
+}
+
+}  // namespace infra
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "audio/BeatTimeline.h"
+#include "audio/EnvelopeScopeTap.h"
+#include "audio/TripleBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace infra {
+
+struct StreamingConfig {
+	bool enabled = false;
+	std::vector<std::string> destinations;  // "host:port"
+	double envelopeRateHz = 50.0;
+	std::uint32_t envelopesPerPacket = 5;
+	double statusRateHz = 4.0;
+};
+
+/// Per-frame status handed from the UI thread to the streamer (wait-free, latest wins).
+struct StreamStatus {
+	std::uint64_t sequence = 0;
+	std::array<float, 2> bpm{};
+	std::array<float, 2> envelope{};
+	float envelopeShort = 0.0f;
+	float envelopeMid = 0.0f;
+	float envelopeLong = 0.0f;
+	float bpmAverage = 0.0f;
+	float dropoutSeconds = 0.0f;
+	bool fallbackActive = false;
+	float fallbackBlend = 0.0f;
+	float limiterReductionDb = 0.0f;
+	std::array<float, 2> inputGainDb{};
+	char scene[16] = {};
+};
+
+/// Streams live telemetry as OSC over UDP to one or more destinations from a background thread:
+///   /knot/beat      ,idffh  participant, timestampSec, bpm, envelope, sequenceId (sent at once)
+///   /knot/envelope  ,idf f… participant, tap time of the first sample, sample period, envelope
+///                           peaks decimated to envelopeRateHz (both participants in one bundle)
+///   /knot/status    ,fffffffffiffffs  bpm P1/P2, envelope P1/P2, envelope short/mid/long, bpm
+///                           average, dropout s, fallback flag, fallback blend, limiter dB, input
+///                           gain dB P1/P2, scene
+/// Beats are read from their own EventBus subscriber and envelopes from the scope taps, so the
+/// audio thread is never touched; the UI thread only publishes StreamStatus. Sockets are
+/// non-blocking and a failed send is counted, never retried.
+class TelemetryStreamer {
+  public:
+	/// Hard cap so an envelope bundle stays well under a 1472-byte UDP payload.
+	static constexpr std::size_t kMaxEnvelopesPerPacket = 64;
+
+	struct Stats {
+		std::uint64_t packets = 0;
+		std::uint64_t bytes = 0;
+		std::uint64_t sendErrors = 0;
+		std::uint64_t beats = 0;
+	};
+
+	TelemetryStreamer() = default;
+	~TelemetryStreamer();
+
+	TelemetryStreamer(const TelemetryStreamer&) = delete;
+	TelemetryStreamer& operator=(const TelemetryStreamer&) = delete;
+
+	/// Call before start(). Destinations are "host:port"; unresolvable entries are skipped.
+	bool configure(const StreamingConfig& config);
+	void setBeatSource(knot::audio::BeatEventBus::Subscriber subscriber);
+	void setEnvelopeSources(const knot::audio::EnvelopeScopeTap* participant1,
+							const knot::audio::EnvelopeScopeTap* participant2);
+	void start();
+	void stop();
+	bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+	/// UI thread: latest status, picked up by the sender at statusRateHz.
+	void publishStatus(const StreamStatus& status) noexcept { status_.publish(status); }
+	Stats stats() const noexcept;
+
+	/// What a loopback run delivered to its receiver.
+	struct LoopbackReport {
+		bool receiverBound = false;
+		std::size_t beatsSent = 0;
+		std::size_t beatsReceived = 0;
+		std::uint64_t envelopeBundles = 0;
+		std::uint64_t statusMessages = 0;
+		Stats stats;
+		double durationSec = 0.0;
+		double beatLatencyMedianUs = 0.0;
+		double beatLatencyMaxUs = 0.0;
+
+		std::size_t lostBeats() const { return beatsSent - std::min(beatsSent, beatsReceived); }
+		double bytesPerSecond() const { return durationSec > 0.0 ? static_cast<double>(stats.bytes) / durationSec : 0.0; }
+		bool passed() const {
+			return receiverBound && beatsSent > 0 && lostBeats() == 0 && envelopeBundles > 0 && statusMessages > 0 &&
+				   stats.sendErrors == 0;
+		}
+	};
+
+	/// Streams synthetic beats (every 10 ms), envelopes and status with the config's rates to a
+	/// receiver on 127.0.0.1 for ~0.3 s and reports what arrived. Blocks the calling thread
+	/// throughout; the config's destinations are ignored.
+	static LoopbackReport measureLoopback(const StreamingConfig& config);
+	/// `--streaming-check`: measureLoopback() with the result logged. Fails when a beat is lost,
+	/// no envelope bundle or status arrives, or a send fails.
+	static bool runLoopbackCheck(const StreamingConfig& config);
+
+  private:
+	struct Destination {
+		std::string label;
+		std::array<unsigned char, 16> address{};  // sockaddr_in
+	};
+	struct EnvelopeStream {
+		const knot::audio::EnvelopeScopeTap* tap = nullptr;
+		std::uint64_t nextSequence = 0;
+		std::size_t bucketsPerSample = 1;
+		std::size_t bucketFill = 0;
+		float peak = 0.0f;
+		std::vector<float> pending;
+		double pendingStartSec = 0.0;
+	};
+
+	void run();
+	void pumpBeats();
+	void pumpEnvelopes();
+	void pumpStatus(std::chrono::steady_clock::time_point now);
+	void sendEnvelopeBundle();
+	void send(const unsigned char* data, std::size_t size);
+	void closeSocket();
+
+	std::vector<Destination> destinations_;
+	std::intptr_t socket_ = -1;
+	std::size_t envelopesPerPacket_ = 5;
+	double envelopeRateHz_ = 50.0;
+	double statusIntervalSec_ = 0.25;
+	knot::audio::BeatEventBus::Subscriber beats_;
+	std::array<EnvelopeStream, 2> envelopes_;
+	std::vector<knot::audio::ScopeBucket> scopeScratch_;
+	knot::audio::TripleBuffer<StreamStatus> status_;
+	std::uint64_t lastStatusSequence_ = 0;
+	std::chrono::steady_clock::time_point lastStatusSent_{};
+	std::vector<unsigned char> packet_;
+
+	std::thread thread_;
+	std::atomic<bool> running_{false};
+	std::atomic<bool> stopRequested_{false};
+	std::atomic<std::uint64_t> packets_{0};
+	std::atomic<std::uint64_t> bytes_{0};
+	std::atomic<std::uint64_t> sendErrors_{0};
+	std::atomic<std::uint64_t> beatsSent_{0};
+};
+
+}  // namespace infra
@@ -1,8 +1,43 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "infra/LogQuery.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
+
+	// --query <sessions|scenes|beats|transitions> ...: answer a log query and exit (see LogQuery.h).
+	// --replay <recording.wav> [--headless]: re-run a raw-input recording through the pipeline.
+	// --simulate <participants> [--seconds <s>]: headless soak test / CPU benchmark with synthetic hearts.
+	// --streaming-check: telemetry loopback test on 127.0.0.1; exits non-zero if a beat is lost.
+	std::filesystem::path replayPath;
+	bool headless = false;
+	std::size_t simulatedParticipants = 0;
+	double simulatedSeconds = 600.0;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			replayPath = std::filesystem::absolute(argv[++i]);
+		} else if (std::strcmp(argv[i], "--simulate") == 0 && i + 1 < argc) {
+			simulatedParticipants = std::strtoul(argv[++i], nullptr, 10);
+		} else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+			simulatedSeconds = std::strtod(argv[++i], nullptr);
+		} else if (std::strcmp(argv[i], "--headless") == 0) {
+			headless = true;
+		} else if (std::strcmp(argv[i], "--query") == 0) {
+			return infra::runLogQueryCli(argc, argv);
+		} else if (std::strcmp(argv[i], "--streaming-check") == 0) {
+			return ofApp::runStreamingCheck();
+		}
+	}
+	if (simulatedParticipants > 0) {
+		return ofApp::runSyntheticBenchmark(simulatedParticipants, simulatedSeconds);
+	}
+	if (headless && !replayPath.empty()) {
+		return ofApp::runHeadlessReplay(replayPath);
+	}
 
 	//Use ofGLFWWindowSettings for more options like multi-monitor fullscreen
 	ofGLWindowSettings settings;
@@ -11,7 +46,11 @@ int main( ){
 
 	auto window = ofCreateWindow(settings);
 
-	ofRunApp(window, std::make_shared<ofApp>());
+	auto app = std::make_shared<ofApp>();
+	if (!replayPath.empty()) {
+		app->setReplayFile(replayPath);
+	}
+	ofRunApp(window, app);
 	ofRunMainLoop();
 
 }
@@ -2,8 +2,9 @@
 
 #include <algorithm>
 #include <array>
-#include <deque>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -23,6 +24,40 @@
 namespace {
 
 constexpr double kEnvelopeSampleIntervalSec = 0.05;  // 50 ms
+constexpr double kEnvelopeScopeWindowSec = 2.5;
+constexpr const char* kAppConfigPath = "config/app_config.json";
+constexpr const char* kHrirSofaPath = "hrir/mit_kemar_normal_pinna.sofa";
+constexpr const char* kBellCuePath = "audio/bell.wav";
+// Program binaries of the scene shaders (see ShaderProgram); safe to delete.
+constexpr const char* kShaderCachePath = "cache/shaders";
+constexpr float kBellCueGain = 0.6f;
+// Stage cues further in the past than this are not replayed when a scene is rescheduled.
+constexpr double kStaleCueSec = 0.25;
+// Recording markers for scene changes: "scene:<SceneName>".
+constexpr const char* kSceneMarkerPrefix = "scene:";
+// Cues are scheduled this far ahead of their nominal time so they land on an exact output sample
+// even when update() runs late relative to the audio callback.
+constexpr double kCueScheduleLeadSec = 0.05;
+// Device hot-plug: enumeration period, how long the callback may go quiet before the stream
+// counts as lost, and how often a reopen is retried while the devices are listed but fail.
+constexpr auto kAudioDevicePollInterval = std::chrono::milliseconds(1000);
+constexpr std::uint64_t kAudioStallMicros = 1'000'000;
+constexpr std::uint64_t kAudioReopenRetryMicros = 2'000'000;
+// Latency sweep: stream settings tried, lowest nominal latency first, and pulses per setting.
+constexpr std::array<std::pair<std::size_t, std::size_t>, 8> kLatencySweepCandidates = {{
+    {64, 2}, {64, 4}, {128, 2}, {128, 4}, {256, 2}, {256, 4}, {512, 2}, {512, 4}}};
+constexpr std::size_t kLatencyTestPulses = 6;
+// Lead-in plus one second per pulse, plus slack for devices that take a moment to start.
+constexpr std::uint64_t kLatencyStepTimeoutMicros = 10'000'000;
+
+// Startup milestones are measured from here: static initialisation runs before main().
+const auto kLaunchTime = std::chrono::steady_clock::now();
+
+std::uint64_t microsSinceLaunch() {
+    const auto elapsed = std::chrono::steady_clock::now() - kLaunchTime;
+    return std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+}
 
 float easedBlend(float t) {
     const float clamped = std::clamp(t, 0.0f, 1.0f);
@@ -45,6 +80,36 @@ ofMesh& fullscreenQuadMesh() {
     return mesh;
 }
 
+std::optional<SceneState> sceneFromMarker(const std::string& label) {
+    const std::string prefix = kSceneMarkerPrefix;
+    if (label.compare(0, prefix.size(), prefix) != 0) {
+        return std::nullopt;
+    }
+    return sceneStateFromString(label.substr(prefix.size()));
+}
+
+std::string describeLatencyReport(const knot::audio::LatencyReport& report) {
+    const auto stage = [](const knot::audio::LatencyStageStats& stats) {
+        return ofToString(stats.medianMs, 2) + " ms [" + ofToString(stats.minMs, 2) + ".." +
+               ofToString(stats.maxMs, 2) + "]";
+    };
+    std::ostringstream oss;
+    oss << "round trip " << stage(report.roundTrip) << ", detection " << stage(report.detection) << " (filter "
+        << ofToString(report.filterDelayMs, 2) << " ms), haptic render " << stage(report.hapticRender)
+        << ", haptic return " << stage(report.hapticReturn) << ", input->haptic " << stage(report.inputToHaptic)
+        << ", " << report.pulsesMeasured << '/' << report.pulsesSent << " pulses"
+        << (report.stable ? ", stable" : ", unstable");
+    return oss.str();
+}
+
+ofJson latencyStageJson(const knot::audio::LatencyStageStats& stats) {
+    return ofJson{{"minMs", stats.minMs}, {"medianMs", stats.medianMs}, {"maxMs", stats.maxMs}};
+}
+
+float envelopeRatio(const knot::audio::EnvelopeCalibrationStats& stats) {
+    return (stats.mean > 1e-6f) ? (stats.peak / stats.mean) : 0.0f;
+}
+
 std::optional<std::size_t> participantIndex(knot::audio::ParticipantId id) {
     using knot::audio::ParticipantId;
     switch (id) {
@@ -57,6 +122,33 @@ std::optional<std::size_t> participantIndex(knot::audio::ParticipantId id) {
     }
 }
 
+std::array<knot::audio::SyntheticHeartParams, 2> syntheticHeartParams(const infra::SimulationConfig& config) {
+    std::array<knot::audio::SyntheticHeartParams, 2> params{};
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        params[i].bpm = config.bpm[i];
+        params[i].levelDb = config.levelDb[i];
+        params[i].hrvMs = config.hrvMs;
+        params[i].breathsPerMin = config.breathsPerMin;
+        params[i].noiseDb = config.noiseDb;
+        params[i].crosstalkDb = config.crosstalkDb;
+        params[i].dropoutsPerMin = config.dropoutsPerMin;
+    }
+    return params;
+}
+
+/// Audio settings shared by the device-less runs (headless replay, synthetic benchmark).
+void configureOfflinePipeline(knot::audio::AudioPipeline& pipeline, const infra::AppConfig& config) {
+    using namespace knot::audio;
+    pipeline.loadCalibrationFile(config.calibrationPath);
+    pipeline.setInputGainDb(config.inputGainDb);
+    pipeline.setInputAgc(config.audio.inputAgc);
+    pipeline.setCrosstalkCancellation(config.audio.crosstalkCancellation);
+    pipeline.setBaselineTracking(config.audio.baselineTracking);
+    pipeline.setNoiseColor(noiseColorFromString(config.audio.noiseColor).value_or(NoiseColor::White));
+    pipeline.setResynthesisMix(config.audio.resynthesisMix);
+    pipeline.setPredictiveHaptics(config.audio.predictiveHaptics, config.audio.hapticLeadMs / 1000.0);
+}
+
 }  // namespace
 
 void ofApp::setup() {
@@ -64,39 +156,11 @@ void ofApp::setup() {
     ofSetFrameRate(60);
 
     infra::AppConfigLoader loader;
-    appConfig_ = loader.load("config/app_config.json");
-    operationMode_ = ofToLower(appConfig_.operationMode);
-    showControlPanel_ = appConfig_.gui.showControlPanel;
-    showStatusPanel_ = appConfig_.gui.showStatusPanel;
-    allowKeyboardToggle_ = appConfig_.gui.allowKeyboardToggle;
-    allowCornerUnlock_ = appConfig_.gui.allowCornerUnlock;
-    guiToggleHoldTimeSec_ = std::max(0.0, appConfig_.gui.keyboardToggleHoldTime);
-    if (!appConfig_.gui.keyboardToggleKey.empty()) {
-        guiToggleKey_ = static_cast<int>(appConfig_.gui.keyboardToggleKey.front());
-    }
-
-    if (operationMode_ == "exhibition") {
-        showControlPanel_ = false;
-        showStatusPanel_ = false;
-        allowKeyboardToggle_ = false;
-    } else if (operationMode_ == "operator") {
-        showControlPanel_ = false;
-        showStatusPanel_ = true;
-    }
+    appConfig_ = loader.load(kAppConfigPath);
+    applyGuiConfig();
 
     sceneTransitionLogger_.setup(appConfig_.sceneTransitionCsvPath);
 
-    bool displayLoaded = displayFont_.load("fonts/NotoSansJP-Thin.otf", 120, true, true, true);
-    if (!displayLoaded) {
-        ofLogWarning("ofApp") << "Failed to load fonts/NotoSansJP-Thin.otf. Falling back to system font.";
-        displayFont_.load(OF_TTF_SANS, 120, true, true, true);
-    }
-    bool guideLoaded = guideFont_.load("fonts/NotoSansJP-Regular.otf", 48, true, true, true);
-    if (!guideLoaded) {
-        ofLogWarning("ofApp") << "Failed to load fonts/NotoSansJP-Regular.otf. Falling back to system font.";
-        guideFont_.load(OF_TTF_SANS, 48, true, true, true);
-    }
-
     auto timingConfig = SceneTimingConfig::load(appConfig_.sceneTimingConfigPath);
     sceneTimingConfig_ = std::make_shared<SceneTimingConfig>(std::move(timingConfig));
 
@@ -116,7 +180,7 @@ void ofApp::setup() {
 
     const double nowSeconds = ofGetElapsedTimef();
     sceneController_.setTimingConfig(sceneTimingConfig_);
-    sceneController_.setup(nowSeconds, 1.2);
+    sceneController_.setup(sceneClockSeconds(), 1.2);
     envelopeHistory_.setHorizon(30.0);
     for (auto& history : participantEnvelopeHistory_) {
         history.setHorizon(30.0);
@@ -174,35 +238,58 @@ void ofApp::setup() {
     statusPanel_.add(guidanceParam_.set("ガイダンス", "-"));
 
     sampleRate_ = 48000.0;
-    bufferSize_ = 512;
+    bufferSize_ = std::clamp<std::size_t>(appConfig_.audio.bufferSize, 32, knot::audio::AudioPipeline::kMaxBlockFrames);
+    numBuffers_ = std::clamp<std::size_t>(appConfig_.audio.numBuffers, 1, 16);
     audioPipeline_.setup(sampleRate_, bufferSize_);
     audioPipeline_.loadCalibrationFile(calibrationFilePath_);
+    {
+        const auto profileDirectory = calibrationFilePath_.parent_path() / "profiles";
+        if (calibrationStore_.open(profileDirectory)) {
+            ofLogNotice("ofApp") << calibrationStore_.size() << " calibration profile(s) in " << profileDirectory;
+        }
+    }
     audioPipeline_.setInputGainDb(appConfig_.inputGainDb);
-    ofLogNotice("ofApp") << "Input gain set to " << appConfig_.inputGainDb << " dB";
+    audioPipeline_.setInputAgc(appConfig_.audio.inputAgc);
+    audioPipeline_.setCrosstalkCancellation(appConfig_.audio.crosstalkCancellation);
+    audioPipeline_.setBaselineTracking(appConfig_.audio.baselineTracking);
+    audioPipeline_.setNoiseColor(
+        knot::audio::noiseColorFromString(appConfig_.audio.noiseColor).value_or(knot::audio::NoiseColor::White));
+    audioPipeline_.setResynthesisMix(appConfig_.audio.resynthesisMix);
+    applyPredictiveHaptics();
+    beatEventSubscriber_ = audioPipeline_.subscribeBeatEvents();
+    reportedBeatEventOverflow_ = 0;
+    ofLogNotice("ofApp") << "Input gain set to " << appConfig_.inputGainDb << " dB"
+                         << (appConfig_.audio.inputAgc ? " (AGC start)" : "");
+    // Built-in presets and direct routing until attachStartupAssets() brings the HRIR set and
+    // the preset file; the stream does not wait for them.
     audioRouter_.setup(static_cast<float>(sampleRate_));
     audioRouter_.applyScenePreset(sceneController_.currentState());
-    ofLogNotice("ofApp") << "AudioRouter initialised with scene preset: "
-                         << sceneStateToString(sceneController_.currentState());
-    loadShaders();
+    audioPipeline_.setOutputRouter(&audioRouter_);
+    cueReportSubscriber_ = audioPipeline_.subscribeCueReports();
+    startStartupLoader();
 
-    bellSoundLoaded_ = bellSound_.load("audio/bell.wav");
-    if (bellSoundLoaded_) {
-        bellSound_.setVolume(0.6f);
-        bellSound_.setMultiPlay(false);
-        ofLogNotice("ofApp") << "Bell sound loaded: audio/bell.wav";
-    } else {
-        ofLogWarning("ofApp") << "Failed to load bell sound: audio/bell.wav";
+    audioPipeline_.setOutputFadeGain(1.0f);
+
+    if (!replayPath_.empty()) {
+        startReplay();
+    } else if (appConfig_.recording.enabled) {
+        startSessionRecording();
     }
 
-    audioFadeGain_ = 1.0f;
-    targetAudioFadeGain_ = 1.0f;
-    audioFading_ = false;
+    if (appConfig_.streaming.enabled) {
+        startTelemetryStreaming();
+    }
 
     initializeSessionSeed();
-    calibrationSaved_ = audioPipeline_.calibrationReady();
-    calibrationSaveAttempted_ = calibrationSaved_;
-    calibrationReportAppended_ = false;
-    const bool pendingAutoCalibration = !calibrationSaved_;
+    syntheticSource_.setup(sampleRate_, syntheticHeartParams(appConfig_.simulation), sessionSeed_);
+    // Sized once, like replayInput_: feedSyntheticInput() and the pump only shrink them.
+    syntheticInput_.allocate(audioPipeline_.monitorCapacityFrames(), 2);
+    syntheticOutput_.allocate(audioPipeline_.monitorCapacityFrames(), knot::audio::AudioRouter::kOutputChannels);
+    // Calibration runs through the full routing, so it waits for attachStartupAssets(); until
+    // then there is nothing to save or report.
+    calibrationSaved_ = true;
+    calibrationSaveAttempted_ = true;
+    calibrationReportAppended_ = true;
 
     refreshAudioDeviceList();
     if (!setupSoundStreamWithSelection()) {
@@ -210,18 +297,10 @@ void ofApp::setup() {
         simulateTelemetry_ = true;
     }
 
-    if (pendingAutoCalibration) {
-        if (soundStreamActive_) {
-            ensureParentDirectory(calibrationFilePath_);
-            ofLogNotice("ofApp") << "Calibration file not ready. Starting calibration.";
-            audioPipeline_.startCalibration();
-        } else {
-            ofLogWarning("ofApp")
-                << "Skip auto calibration because sound stream is inactive. Proceeding with degraded settings.";
-            calibrationSaved_ = true;
-            calibrationSaveAttempted_ = true;
-            calibrationReportAppended_ = true;
-        }
+    audioDeviceMonitor_.start(kAudioDevicePollInterval);
+
+    if (sessionReplayer_.active() && !soundStreamActive_) {
+        ofLogWarning("ofApp") << "Replay needs an output device to run at 1x; use --headless to replay offline.";
     }
 
     sessionStartMicros_ = ofGetElapsedTimeMicros();
@@ -235,36 +314,173 @@ void ofApp::setup() {
 
     if (const auto defaultScene = sceneStateFromString(appConfig_.defaultScene)) {
         if (*defaultScene != SceneState::Idle) {
-            sceneController_.requestState(*defaultScene, nowSeconds, false, "config_default");
+            sceneController_.requestState(*defaultScene, sceneClockSeconds(), false, "config_default");
         }
     }
+
+    startupTiming_.setupMicros = microsSinceLaunch();
+    ofLogNotice("ofApp") << "Setup done in " << ofToString(startupTiming_.setupMicros / 1000.0, 1)
+                         << " ms since launch; loading assets.";
 }
 
-void ofApp::update() {
-    const uint64_t nowMicros = ofGetElapsedTimeMicros();
-    const double nowSeconds = static_cast<double>(nowMicros) * 1e-6;
+void ofApp::startStartupLoader() {
+    // Paths resolve here: ofToDataPath() reads the data root, which belongs to this thread.
+    const auto hrirPath = std::filesystem::path(ofToDataPath(kHrirSofaPath, true));
+    const auto presetPath = std::filesystem::path(ofToDataPath(appConfig_.routingPresetsPath.string(), true));
+    const auto bellPath = std::filesystem::path(ofToDataPath(kBellCuePath, true));
+    const double sampleRate = sampleRate_;
+    startupLoader_ = std::thread([this, hrirPath, presetPath, bellPath, sampleRate] {
+        auto assets = std::make_shared<StartupAssets>();
+        const auto hrirStart = std::chrono::steady_clock::now();
+        auto hrirDatabase = std::make_shared<knot::audio::HrirDatabase>();
+        if (hrirDatabase->loadSofa(hrirPath, sampleRate)) {
+            assets->hrirDatabase = std::move(hrirDatabase);
+        }
+        assets->hrirLoadMicros = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hrirStart)
+                .count());
+        assets->routingPresets = knot::audio::AudioRouter::loadScenePresets(presetPath, assets->routingPresetError);
+        assets->bellCueId = audioPipeline_.loadCue(bellPath);
+        std::atomic_store(&pendingStartupAssets_, std::move(assets));
+    });
+}
 
-    sceneController_.update(nowSeconds);
-    processSceneTransitionEvents();
+void ofApp::advanceStartup() {
+    if (startupTimingLogged_) {
+        return;
+    }
+    attachStartupAssets();
+    // GL work waits for the first frame so the window shows up at once.
+    if (startupTiming_.firstFrameMicros != 0) {
+        advanceStartupGraphics();
+    }
+    if (!startupAssetsAttached_ || graphicsStage_ != GraphicsStage::Ready) {
+        return;
+    }
+
+    startupTiming_.firstAudioMicros = firstAudioMicros_.load(std::memory_order_relaxed);
+    const auto ms = [](std::uint64_t micros) {
+        return micros == 0 ? std::string("-") : ofToString(micros / 1000.0, 1) + " ms";
+    };
+    ofLogNotice("ofApp") << "Startup: first audio " << ms(startupTiming_.firstAudioMicros) << ", first frame "
+                         << ms(startupTiming_.firstFrameMicros) << ", audio assets "
+                         << ms(startupTiming_.audioAssetsMicros) << " (HRIR " << ms(startupTiming_.hrirLoadMicros)
+                         << "), graphics " << ms(startupTiming_.graphicsAssetsMicros) << " ("
+                         << startupTiming_.shaderCacheHits << "/" << startupTiming_.shaderCount
+                         << " shaders from cache)";
+    if (sessionLogger_) {
+        sessionLogger_->recordStartup(startupTiming_);
+    }
+    startupTimingLogged_ = true;
+}
 
-    // オーディオフェード処理
-    if (audioFading_) {
-        const double elapsed = nowSeconds - audioFadeStartTime_;
-        const double progress = std::clamp(elapsed / audioFadeDuration_, 0.0, 1.0);
+void ofApp::attachStartupAssets() {
+    if (startupAssetsAttached_) {
+        return;
+    }
+    auto assets = std::atomic_exchange(&pendingStartupAssets_, std::shared_ptr<StartupAssets>{});
+    if (!assets) {
+        return;
+    }
+    startupLoader_.join();
 
-        // イーズイン・イーズアウト曲線
-        const float easedProgress = static_cast<float>(0.5 - 0.5 * std::cos(progress * M_PI));
-        audioFadeGain_ = audioFadeGain_ + (targetAudioFadeGain_ - audioFadeGain_) * easedProgress;
+    if (assets->hrirDatabase) {
+        hrirDatabase_ = std::move(assets->hrirDatabase);
+        // Safe while the stream runs: the router swaps the prepared set in at a block boundary.
+        audioRouter_.setHrirDatabase(hrirDatabase_);
+    } else {
+        ofLogWarning("ofApp") << "HRIR set unavailable; headphone outputs use the direct stereo mix.";
+    }
+    if (assets->routingPresets) {
+        audioRouter_.setScenePresets(std::move(assets->routingPresets));
+        ofLogNotice("ofApp") << "Routing presets loaded from " << appConfig_.routingPresetsPath;
+    } else {
+        ofLogNotice("ofApp") << "Using built-in routing presets (" << assets->routingPresetError << ")";
+    }
+    bellCueId_ = assets->bellCueId;
+    if (!bellCueId_) {
+        ofLogWarning("ofApp") << "Failed to load bell sound: " << kBellCuePath;
+    }
+    if (!sceneController_.isTransitioning()) {
+        // As for a preset reload: reschedule (picks up the bell), then crossfade to the loaded
+        // preset, binaural where the rules ask for it.
+        rescheduleCurrentSceneAudio();
+        audioRouter_.applyScenePreset(sceneController_.currentState());
+    }
+    ofLogNotice("ofApp") << "AudioRouter initialised with scene preset: "
+                         << sceneStateToString(sceneController_.currentState());
+    startupAssetsAttached_ = true;
+    startupTiming_.hrirLoadMicros = assets->hrirLoadMicros;
+    startupTiming_.audioAssetsMicros = microsSinceLaunch();
 
-        if (progress >= 1.0) {
-            audioFadeGain_ = targetAudioFadeGain_;
-            audioFading_ = false;
-            ofLogNotice("ofApp") << "Audio fade completed. Gain: " << audioFadeGain_;
+    calibrationSaved_ = audioPipeline_.calibrationReady();
+    calibrationSaveAttempted_ = calibrationSaved_;
+    calibrationReportAppended_ = false;
+    if (soundStreamActive_) {
+        selectCalibrationProfile();
+    }
+    if (!audioPipeline_.calibrationReady() && !audioPipeline_.isCalibrationActive()) {
+        if (sessionReplayer_.active()) {
+            // The recording already went through the venue's calibration; keep the stored values.
+            ofLogNotice("ofApp") << "Skip auto calibration during replay.";
+        } else {
+            ofLogWarning("ofApp") << "Skip auto calibration because no input/output stream is active. Proceeding "
+                                     "with degraded settings.";
         }
+        calibrationSaved_ = true;
+        calibrationSaveAttempted_ = true;
+        calibrationReportAppended_ = true;
+    }
+
+    // Started last so a preset reload cannot be overtaken by the startup copy.
+    startConfigWatcher();
+}
+
+void ofApp::advanceStartupGraphics() {
+    // One stage per frame: a font load blocks for as long as it rasterises its glyphs.
+    switch (graphicsStage_) {
+        case GraphicsStage::Shaders:
+            loadShaders();
+            graphicsStage_ = GraphicsStage::DisplayFont;
+            break;
+        case GraphicsStage::DisplayFont:
+            if (!displayFont_.load("fonts/NotoSansJP-Thin.otf", 120, true, true, true)) {
+                ofLogWarning("ofApp") << "Failed to load fonts/NotoSansJP-Thin.otf. Falling back to system font.";
+                displayFont_.load(OF_TTF_SANS, 120, true, true, true);
+            }
+            graphicsStage_ = GraphicsStage::GuideFont;
+            break;
+        case GraphicsStage::GuideFont:
+            if (!guideFont_.load("fonts/NotoSansJP-Regular.otf", 48, true, true, true)) {
+                ofLogWarning("ofApp") << "Failed to load fonts/NotoSansJP-Regular.otf. Falling back to system font.";
+                guideFont_.load(OF_TTF_SANS, 48, true, true, true);
+            }
+            graphicsStage_ = GraphicsStage::Ready;
+            startupTiming_.graphicsAssetsMicros = microsSinceLaunch();
+            break;
+        case GraphicsStage::Ready:
+            break;
     }
+}
+
+void ofApp::update() {
+    const uint64_t nowMicros = ofGetElapsedTimeMicros();
+    const double nowSeconds = static_cast<double>(nowMicros) * 1e-6;
+
+    // シーン進行はオーディオ出力クロックで駆動する(音声イベントと同じ時間軸)
+    advanceStartup();
+    sceneController_.update(sceneClockSeconds());
+    processSceneTransitionEvents();
+    pollCueReports();
+    applyPendingConfigReloads();
+    applyReplayMarkers();
 
     simulateTelemetry_ = simulateSignalParam_.get();
 
+    knot::audio::CalibrationCheck calibrationCheck;
+    if (audioPipeline_.pollCalibrationCheck(calibrationCheck)) {
+        handleCalibrationCheck(calibrationCheck);
+    }
     if (audioPipeline_.isCalibrationActive()) {
         calibrationSaved_ = false;
         calibrationSaveAttempted_ = false;
@@ -279,6 +495,12 @@ void ofApp::update() {
                 ofLogWarning("ofApp") << "Failed to save calibration to " << calibrationFilePath_
                                       << ". Continuing with current calibration values.";
             }
+            if (calibrationProfileKey_ &&
+                !calibrationStore_.store(*calibrationProfileKey_, audioPipeline_.calibrationResult())) {
+                ofLogWarning("ofApp") << "Failed to store the calibration profile for '"
+                                      << calibrationProfileKey_->inputDevice << "' / '"
+                                      << calibrationProfileKey_->outputDevice << "'.";
+            }
             calibrationSaved_ = true;
             calibrationSaveAttempted_ = true;
         }
@@ -289,19 +511,30 @@ void ofApp::update() {
         calibrationReportAppended_ = true;
     }
 
+    // Synthetic input stands in for the stethoscopes, except while the stream measures itself.
+    const bool measuring = audioPipeline_.isCalibrationActive() || latencySweep_.active;
+    syntheticInputActive_.store(simulateTelemetry_ && !sessionReplayer_.active() && !measuring,
+                                std::memory_order_release);
+    pumpSyntheticPipeline(nowMicros);
+
+    // One wait-free read per frame; every audio value shown below comes from the same block.
+    pipelineSnapshot_ = audioPipeline_.snapshot();
+    superviseAudioDevices(nowMicros);
+    updateLatencySweep(nowMicros);
     updateEnvelopeCalibrationUi(nowSeconds);
 
-    const bool calibrationActive = audioPipeline_.isCalibrationActive();
-    const bool useSynthetic = simulateTelemetry_ || !soundStreamActive_ || calibrationActive;
+    const bool calibrationActive = audioPipeline_.isCalibrationActive() || latencySweep_.active;
+    const bool pipelineFed = soundStreamActive_ || syntheticInputActive_.load(std::memory_order_acquire);
+    const bool useSynthetic = calibrationActive || !pipelineFed;
 
     if (useSynthetic) {
+        // Placeholder beats drive the UI; do not replay stale live events when switching back.
+        beatEventSubscriber_.skipToLatest();
         updateFakeSignal(nowSeconds);
         limiterReductionDbSmooth_ = ofLerp(limiterReductionDbSmooth_, 0.0f, 0.15f);
     } else {
-        const auto metricsP1 =
-            audioPipeline_.channelMetrics(knot::audio::ParticipantId::Participant1);
-        const auto metricsP2 =
-            audioPipeline_.channelMetrics(knot::audio::ParticipantId::Participant2);
+        const auto metricsP1 = pipelineSnapshot_.channel(knot::audio::ParticipantId::Participant1);
+        const auto metricsP2 = pipelineSnapshot_.channel(knot::audio::ParticipantId::Participant2);
         const bool metricsAvailable =
             (metricsP1.timestampSec > 0.0) || (metricsP2.timestampSec > 0.0) ||
             (metricsP1.envelope > 0.0f) || (metricsP2.envelope > 0.0f);
@@ -309,24 +542,25 @@ void ofApp::update() {
             applyBeatMetrics(knot::audio::ParticipantId::Participant1, metricsP1, nowSeconds);
             applyBeatMetrics(knot::audio::ParticipantId::Participant2, metricsP2, nowSeconds);
 
-            const auto eventsP1 =
-                audioPipeline_.pollBeatEvents(knot::audio::ParticipantId::Participant1);
-            if (!eventsP1.empty()) {
-                handleBeatEvents(knot::audio::ParticipantId::Participant1, eventsP1, nowSeconds);
-            }
-            const auto eventsP2 =
-                audioPipeline_.pollBeatEvents(knot::audio::ParticipantId::Participant2);
-            if (!eventsP2.empty()) {
-                handleBeatEvents(knot::audio::ParticipantId::Participant2, eventsP2, nowSeconds);
+            beatEventSubscriber_.poll([&](const knot::audio::BeatEvent& evt) {
+                handleBeatEvent(evt, nowSeconds);
+            });
+            if (beatEventSubscriber_.overflowCount() != reportedBeatEventOverflow_) {
+                ofLogWarning("ofApp") << "Beat event bus overflow: "
+                                      << beatEventSubscriber_.overflowCount() - reportedBeatEventOverflow_
+                                      << " events lost (total " << beatEventSubscriber_.overflowCount() << ")";
+                reportedBeatEventOverflow_ = beatEventSubscriber_.overflowCount();
             }
+            reportRealtimeViolations(nowSeconds);
 
             limiterReductionDbSmooth_ =
-                ofLerp(limiterReductionDbSmooth_, audioPipeline_.lastLimiterReductionDb(), 0.18f);
+                ofLerp(limiterReductionDbSmooth_, pipelineSnapshot_.limiterReductionDb, 0.18f);
         } else {
+            beatEventSubscriber_.skipToLatest();
             updateFakeSignal(nowSeconds);
             limiterReductionDbSmooth_ = ofLerp(limiterReductionDbSmooth_, 0.0f, 0.15f);
         }
-        signalHealth_ = audioPipeline_.signalHealth();
+        signalHealth_ = pipelineSnapshot_.health;
     }
 
     latestMetrics_.timestampSec = nowSeconds;
@@ -340,6 +574,8 @@ void ofApp::update() {
         signalHealth_.fallbackBlend = 0.0f;
     }
     updateEnvelopeHistories(nowSeconds);
+    updateEnvelopeScope();
+    publishStreamStatus();
 
     if (lastFallbackActive_ != signalHealth_.fallbackActive) {
         if (signalHealth_.fallbackActive) {
@@ -372,8 +608,11 @@ void ofApp::update() {
 }
 
 void ofApp::draw() {
+    if (startupTiming_.firstFrameMicros == 0) {
+        startupTiming_.firstFrameMicros = microsSinceLaunch();
+    }
     ofBackground(10);
-    const double nowSeconds = ofGetElapsedTimef();
+    const double nowSeconds = sceneClockSeconds();
     const SceneState current = sceneController_.currentState();
     const float blend = sceneController_.transitionBlend();
     const float baseAlpha = sceneController_.isTransitioning() ? blend : 1.0f;
@@ -393,10 +632,17 @@ void ofApp::draw() {
     if (shouldDrawControlPanel() || shouldDrawStatusPanel()) {
         drawCalibrationStatus();
         drawBeatDebug();
+        if (!startupAssetsAttached_ || graphicsStage_ != GraphicsStage::Ready) {
+            ofDrawBitmapString("loading assets...", 20.0f, static_cast<float>(ofGetHeight()) - 20.0f);
+        }
     }
 }
 
 void ofApp::exit() {
+    if (startupLoader_.joinable()) {
+        startupLoader_.join();
+    }
+    configWatcher_.stop();
     startButton_.removeListener(this, &ofApp::onStartButtonPressed);
     endButton_.removeListener(this, &ofApp::onEndButtonPressed);
     resetButton_.removeListener(this, &ofApp::onResetButtonPressed);
@@ -408,7 +654,11 @@ void ofApp::exit() {
     nextOutputDeviceButton_.removeListener(this, &ofApp::onNextOutputDevice);
     applyAudioDevicesButton_.removeListener(this, &ofApp::onApplyAudioDevices);
 
+    telemetryStreamer_.stop();
+    audioDeviceMonitor_.stop();
     shutdownSoundStream();
+    audioPipeline_.setInputRecorder(nullptr);
+    sessionRecorder_.stop();
 
     if (sessionLogger_) {
         sessionLogger_->writeSummary();
@@ -446,14 +696,16 @@ void ofApp::keyPressed(int key) {
         case 'c':
         case 'C':
             ofLogNotice("ofApp") << "Manual calibration triggered.";
-            audioPipeline_.startCalibration();
-            calibrationSaved_ = false;
-            calibrationSaveAttempted_ = false;
+            startFullCalibration();
             break;
         case 's':
         case 'S':
             calibrationSaveAttempted_ = false;
             break;
+        case 'l':
+        case 'L':
+            startLatencySweep();
+            break;
         default:
             break;
     }
@@ -484,54 +736,24 @@ void ofApp::dragEvent(ofDragInfo) {}
 void ofApp::gotMessage(ofMessage) {}
 
 void ofApp::audioIn(ofSoundBuffer& input) {
+    knot::audio::rt::ScopedAudioThread realtimeScope;
+    if (sessionReplayer_.active() || syntheticInputActive_.load(std::memory_order_acquire)) {
+        return;
+    }
     audioPipeline_.audioIn(input);
 }
 
 void ofApp::audioOut(ofSoundBuffer& output) {
-    const std::size_t numFrames = output.getNumFrames();
-    const std::size_t numChannels = output.getNumChannels();
-    if (numFrames == 0 || numChannels == 0) {
-        return;
-    }
-
-    if (stereoScratch_.getNumFrames() != numFrames || stereoScratch_.getNumChannels() != 2) {
-        stereoScratch_.allocate(numFrames, 2);
-    }
-    stereoScratch_.setSampleRate(output.getSampleRate());
-
-    audioPipeline_.audioOut(stereoScratch_);
-
-    const auto metricsP1 = audioPipeline_.channelMetrics(knot::audio::ParticipantId::Participant1);
-    const auto metricsP2 = audioPipeline_.channelMetrics(knot::audio::ParticipantId::Participant2);
-    envelopeFrame_[0] = std::clamp(metricsP1.envelope, 0.0f, 1.0f);
-    envelopeFrame_[1] = std::clamp(metricsP2.envelope, 0.0f, 1.0f);
-
-    const float* stereoData = stereoScratch_.getBuffer().data();
-    float* outputData = output.getBuffer().data();
-
-    for (std::size_t frame = 0; frame < numFrames; ++frame) {
-        headphoneFrame_[0] = stereoData[frame * 2];
-        headphoneFrame_[1] = stereoData[frame * 2 + 1];
-
-        audioRouter_.route(headphoneFrame_, envelopeFrame_, routedFrame_);
-
-        if (numChannels >= 4) {
-            outputData[frame * numChannels + 0] = routedFrame_[0];
-            outputData[frame * numChannels + 1] = routedFrame_[1];
-            outputData[frame * numChannels + 2] = routedFrame_[2];
-            outputData[frame * numChannels + 3] = routedFrame_[3];
-        } else if (numChannels >= 2) {
-            outputData[frame * numChannels + 0] = routedFrame_[0];
-            outputData[frame * numChannels + 1] = routedFrame_[1];
-        }
+    knot::audio::rt::ScopedAudioThread realtimeScope;
+    if (firstAudioMicros_.load(std::memory_order_relaxed) == 0) {
+        firstAudioMicros_.store(microsSinceLaunch(), std::memory_order_relaxed);
     }
-
-    if (audioFadeGain_ < 0.99f) {
-        const std::size_t totalSamples = numFrames * numChannels;
-        for (std::size_t i = 0; i < totalSamples; ++i) {
-            outputData[i] *= audioFadeGain_;
-        }
+    if (sessionReplayer_.active()) {
+        feedReplayInput(output.getNumFrames());
+    } else if (syntheticInputActive_.load(std::memory_order_acquire)) {
+        feedSyntheticInput(output.getNumFrames());
     }
+    audioPipeline_.audioOut(output);
 }
 
 void ofApp::onStartButtonPressed() {
@@ -539,7 +761,7 @@ void ofApp::onStartButtonPressed() {
         ofLogNotice("ofApp") << "Start request ignored (locked state).";
         return;
     }
-    const double nowSeconds = ofGetElapsedTimef();
+    const double nowSeconds = sceneClockSeconds();
     if (!sceneController_.requestState(SceneState::Start, nowSeconds, true, "button_press")) {
         ofLogNotice("ofApp") << "Start request ignored.";
     }
@@ -550,7 +772,7 @@ void ofApp::onEndButtonPressed() {
         ofLogNotice("ofApp") << "End request ignored (locked state).";
         return;
     }
-    const double nowSeconds = ofGetElapsedTimef();
+    const double nowSeconds = sceneClockSeconds();
     if (!sceneController_.requestState(SceneState::End, nowSeconds, true, "button_press")) {
         ofLogNotice("ofApp") << "End request ignored.";
     }
@@ -561,7 +783,7 @@ void ofApp::onResetButtonPressed() {
         ofLogNotice("ofApp") << "Reset request ignored (locked state).";
         return;
     }
-    const double nowSeconds = ofGetElapsedTimef();
+    const double nowSeconds = sceneClockSeconds();
     if (!sceneController_.requestState(SceneState::Idle, nowSeconds, true, "button_press")) {
         ofLogNotice("ofApp") << "Reset request ignored.";
     }
@@ -614,12 +836,13 @@ void ofApp::updateSceneGui(double nowSeconds) {
     envelopeP2Param_.set(participantEnvelopes_[1]);
     hapticCountParam_.set(static_cast<std::uint32_t>(hapticLog_.entries().size()));
 
-    const double horizon = std::clamp(sceneController_.timeInState(nowSeconds) * 1.2, 10.0, 45.0);
+    const double sceneSeconds = sceneClockSeconds();
+    const double horizon = std::clamp(sceneController_.timeInState(sceneSeconds) * 1.2, 10.0, 45.0);
     envelopeHistory_.setHorizon(horizon);
     envelopeHistory_.prune(nowSeconds);
 
     sceneOverviewParam_.set(sceneLabel);
-    const double timeInStateSec = sceneController_.timeInState(nowSeconds);
+    const double timeInStateSec = sceneController_.timeInState(sceneSeconds);
     timeInStateParam_.set(ofToString(timeInStateSec, 1) + "s");
     transitionProgressParam_.set(transitioning ? sceneController_.transitionBlend() : 0.0f);
     envelopeMonitorParam_.set(std::clamp(latestMetrics_.envelope, 0.0f, 1.0f));
@@ -641,8 +864,48 @@ void ofApp::updateEnvelopeHistories(double nowSeconds) {
     lastEnvelopeSampledAt_ = nowSeconds;
     for (std::size_t idx = 0; idx < participantEnvelopeHistory_.size(); ++idx) {
         participantEnvelopeHistory_[idx].addSample(nowSeconds, participantEnvelopes_[idx], participantBpms_[idx]);
+        participantEnvelopeLines_[idx].sync(participantEnvelopeHistory_[idx]);
     }
     envelopeHistory_.addSample(nowSeconds, displayEnvelope_, latestMetrics_.bpm);
+    envelopeLine_.sync(envelopeHistory_);
+}
+
+void ofApp::updateEnvelopeScope() {
+    constexpr std::array<knot::audio::ParticipantId, 2> participants{
+        knot::audio::ParticipantId::Participant1, knot::audio::ParticipantId::Participant2};
+    float peak = 0.0f;
+    for (std::size_t idx = 0; idx < participants.size(); ++idx) {
+        auto& envelopeMesh = scopeEnvelopeMeshes_[idx];
+        auto& thresholdMesh = scopeThresholdMeshes_[idx];
+        envelopeMesh.clear();
+        thresholdMesh.clear();
+        envelopeMesh.setMode(OF_PRIMITIVE_LINES);
+        thresholdMesh.setMode(OF_PRIMITIVE_LINE_STRIP);
+
+        const auto* scope = audioPipeline_.envelopeScope(participants[idx]);
+        if (scope == nullptr || scope->bucketDurationSec() <= 0.0) {
+            continue;
+        }
+        const auto windowBuckets = static_cast<std::size_t>(kEnvelopeScopeWindowSec / scope->bucketDurationSec());
+        if (scopeScratch_.size() < windowBuckets) {
+            scopeScratch_.resize(windowBuckets);
+        }
+        const std::size_t count = scope->readLatest(scopeScratch_.data(), windowBuckets);
+        const std::size_t offset = windowBuckets - count;  // newest bucket stays on the right edge
+        const float invWindow = 1.0f / static_cast<float>(std::max<std::size_t>(windowBuckets, 1));
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& bucket = scopeScratch_[i];
+            const float x = static_cast<float>(offset + i) * invWindow;
+            envelopeMesh.addVertex(glm::vec3(x, bucket.envelopeMin, 0.0f));
+            envelopeMesh.addVertex(glm::vec3(x, bucket.envelopeMax, 0.0f));
+            thresholdMesh.addVertex(glm::vec3(x, bucket.threshold, 0.0f));
+            peak = std::max({peak, bucket.envelopeMax, bucket.threshold});
+        }
+    }
+
+    // Snap up to new peaks, relax slowly so the scope does not pump between beats.
+    const float targetScale = std::max(peak * 1.1f, 1e-3f);
+    scopeScale_ = targetScale > scopeScale_ ? targetScale : ofLerp(scopeScale_, targetScale, 0.02f);
 }
 
 void ofApp::updateFakeSignal(double nowSeconds) {
@@ -685,6 +948,12 @@ void ofApp::updateFakeSignal(double nowSeconds) {
     signalHealth_.fallbackActive = false;
     signalHealth_.fallbackBlend = 0.0f;
     signalHealth_.fallbackEnvelope = latestMetrics_.envelope;
+    signalHealth_.crosstalkLeakageDb = knot::audio::AudioPipeline::SignalHealth{}.crosstalkLeakageDb;
+    signalHealth_.crosstalkResidualDb = knot::audio::AudioPipeline::SignalHealth{}.crosstalkResidualDb;
+    signalHealth_.crosstalkConverged = false;
+    signalHealth_.beatTrackerLocked = {};
+    signalHealth_.trackedBpm = {};
+    signalHealth_.beatFallbackActive = {};
 }
 
 void ofApp::applyBeatMetrics(knot::audio::ParticipantId participant,
@@ -700,22 +969,19 @@ void ofApp::applyBeatMetrics(knot::audio::ParticipantId participant,
     participantBpms_[*idx] = std::max(0.0f, metrics.bpm);
 }
 
-void ofApp::handleBeatEvents(knot::audio::ParticipantId participant,
-                             const std::vector<knot::audio::BeatEvent>& events, double nowSeconds) {
-    const auto idx = participantIndex(participant);
+void ofApp::handleBeatEvent(const knot::audio::BeatEvent& evt, double nowSeconds) {
+    const auto idx = participantIndex(evt.participantId);
     if (!idx) {
         return;
     }
-    for (const auto& evt : events) {
-        if (evt.bpm > 1.0f) {
-            participantBpms_[*idx] = evt.bpm;
-            participantMetrics_[*idx].bpm = evt.bpm;
-        }
-        const float intensity = ofClamp(evt.envelope, 0.2f, 1.0f);
-        const std::string labelPrefix = (participant == knot::audio::ParticipantId::Participant1) ? "P1" : "P2";
-        const std::string label = signalHealth_.fallbackActive ? labelPrefix + "_fallback" : labelPrefix + "_detected";
-        appendHapticEvent(nowSeconds, intensity, label);
+    if (evt.bpm > 1.0f) {
+        participantBpms_[*idx] = evt.bpm;
+        participantMetrics_[*idx].bpm = evt.bpm;
     }
+    const float intensity = ofClamp(evt.envelope, 0.2f, 1.0f);
+    const std::string labelPrefix = (evt.participantId == knot::audio::ParticipantId::Participant1) ? "P1" : "P2";
+    const std::string label = signalHealth_.fallbackActive ? labelPrefix + "_fallback" : labelPrefix + "_detected";
+    appendHapticEvent(nowSeconds, intensity, label);
 }
 
 void ofApp::appendHapticEvent(double nowSeconds, float intensity, const std::string& label) {
@@ -736,21 +1002,22 @@ void ofApp::appendHapticEvent(double nowSeconds, float intensity, const std::str
 }
 
 void ofApp::updateEnvelopeCalibrationUi(double /*nowSeconds*/) {
-    const bool active = audioPipeline_.isEnvelopeCalibrationActive();
+    const bool active = pipelineSnapshot_.envelopeCalibrationActive;
     envelopeCalibrationRunning_ = active;
     if (active) {
-        envelopeCalibrationProgressParam_.set(audioPipeline_.envelopeCalibrationProgress());
+        envelopeCalibrationProgressParam_.set(pipelineSnapshot_.envelopeCalibrationProgress);
     } else {
         envelopeCalibrationProgressParam_.set(0.0f);
     }
 
-    knot::audio::EnvelopeCalibrationStats stats;
+    // The status panel shows P1's baseline; both are logged and drawn in the calibration status.
+    EnvelopeCalibrationPair stats;
     if (audioPipeline_.pollEnvelopeCalibrationStats(stats)) {
         lastEnvelopeCalibrationStats_ = stats;
-        baselineEnvelopeParam_.set(std::clamp(stats.mean, 0.0f, 2.0f));
+        baselineEnvelopeParam_.set(std::clamp(stats[0].mean, 0.0f, 2.0f));
         logEnvelopeCalibrationResult(stats);
     } else if (lastEnvelopeCalibrationStats_) {
-        baselineEnvelopeParam_.set(std::clamp(lastEnvelopeCalibrationStats_->mean, 0.0f, 2.0f));
+        baselineEnvelopeParam_.set(std::clamp((*lastEnvelopeCalibrationStats_)[0].mean, 0.0f, 2.0f));
     } else if (!active) {
         baselineEnvelopeParam_.set(0.0f);
     }
@@ -819,7 +1086,8 @@ bool ofApp::ensureParentDirectory(const std::filesystem::path& path) {
 }
 
 void ofApp::loadShaders() {
-    const auto loadShaderFn = [&](ofShader& shader, bool& loaded, const std::string& vert, const std::string& frag) {
+    const auto cachePath = std::filesystem::path(ofToDataPath(kShaderCachePath, true));
+    const auto loadShaderFn = [&](ShaderProgram& shader, bool& loaded, const std::string& vert, const std::string& frag) {
         loaded = false;
         const std::string vertPath = ofToDataPath(vert, true);
         const std::string fragPath = ofToDataPath(frag, true);
@@ -827,14 +1095,12 @@ void ofApp::loadShaders() {
             ofLogWarning("ofApp") << "Shader files not found: " << vert << " / " << frag;
             return;
         }
-        try {
-            loaded = shader.load(vert, frag);
-        } catch (const std::exception& ex) {
-            loaded = false;
-            ofLogWarning("ofApp") << "Failed to load shader (" << vert << ", " << frag << "): " << ex.what();
-        }
+        ++startupTiming_.shaderCount;
+        loaded = shader.load(vertPath, fragPath, cachePath);
         if (!loaded) {
             ofLogWarning("ofApp") << "Shader compile failed for " << vert << " / " << frag;
+        } else if (shader.loadedFromCache()) {
+            ++startupTiming_.shaderCacheHits;
         }
     };
 
@@ -878,32 +1144,45 @@ void ofApp::drawRippleLayer(float alpha, double nowSeconds, float envelopeP1, fl
 }
 
 void ofApp::refreshAudioDeviceList() {
-    const int currentInputId =
-        (selectedInputDevice_ >= 0 && selectedInputDevice_ < static_cast<int>(inputDevices_.size()))
-            ? inputDevices_[selectedInputDevice_].deviceID
-            : -1;
-    const int currentOutputId =
-        (selectedOutputDevice_ >= 0 && selectedOutputDevice_ < static_cast<int>(outputDevices_.size()))
-            ? outputDevices_[selectedOutputDevice_].deviceID
-            : -1;
+    applyAudioDeviceList(ofSoundStreamListDevices());
+}
+
+void ofApp::applyAudioDeviceList(const std::vector<ofSoundDevice>& devices) {
+    // Keep the selection by name first: IDs are renumbered when an interface is re-plugged.
+    const bool hasInput = selectedInputDevice_ >= 0 && selectedInputDevice_ < static_cast<int>(inputDevices_.size());
+    const bool hasOutput =
+        selectedOutputDevice_ >= 0 && selectedOutputDevice_ < static_cast<int>(outputDevices_.size());
+    const int currentInputId = hasInput ? inputDevices_[selectedInputDevice_].deviceID : -1;
+    const int currentOutputId = hasOutput ? outputDevices_[selectedOutputDevice_].deviceID : -1;
+    const std::string currentInputName = hasInput ? inputDevices_[selectedInputDevice_].name : std::string();
+    const std::string currentOutputName = hasOutput ? outputDevices_[selectedOutputDevice_].name : std::string();
 
     inputDevices_.clear();
     outputDevices_.clear();
 
-    const auto devices = ofSoundStreamListDevices();
+    // The devices the stream holds open stay selectable even if the driver lists them busy,
+    // with no channels; otherwise the selection would jump to another device.
     for (const auto& device : devices) {
-        if (device.inputChannels > 0) {
+        if (device.inputChannels > 0 || (soundStreamActive_ && device.name == activeInputDeviceName_)) {
             inputDevices_.push_back(device);
         }
-        if (device.outputChannels > 0) {
+        if (device.outputChannels > 0 || (soundStreamActive_ && device.name == activeOutputDeviceName_)) {
             outputDevices_.push_back(device);
         }
     }
 
-    auto resolveSelection = [](const std::vector<ofSoundDevice>& devices, int desiredId, bool preferInput) {
+    auto resolveSelection = [](const std::vector<ofSoundDevice>& devices, const std::string& desiredName,
+                               int desiredId, bool preferInput) {
         if (devices.empty()) {
             return -1;
         }
+        if (!desiredName.empty()) {
+            for (std::size_t i = 0; i < devices.size(); ++i) {
+                if (devices[i].name == desiredName) {
+                    return static_cast<int>(i);
+                }
+            }
+        }
         if (desiredId != -1) {
             for (std::size_t i = 0; i < devices.size(); ++i) {
                 if (devices[i].deviceID == desiredId) {
@@ -922,8 +1201,8 @@ void ofApp::refreshAudioDeviceList() {
         return 0;
     };
 
-    selectedInputDevice_ = resolveSelection(inputDevices_, currentInputId, true);
-    selectedOutputDevice_ = resolveSelection(outputDevices_, currentOutputId, false);
+    selectedInputDevice_ = resolveSelection(inputDevices_, currentInputName, currentInputId, true);
+    selectedOutputDevice_ = resolveSelection(outputDevices_, currentOutputName, currentOutputId, false);
 
     updateAudioDeviceLabels();
 }
@@ -1040,7 +1319,7 @@ bool ofApp::setupSoundStreamWithSelection() {
     ofSoundStreamSettings settings;
     settings.sampleRate = static_cast<unsigned int>(sampleRate_);
     settings.bufferSize = bufferSize_;
-    settings.numBuffers = 4;
+    settings.numBuffers = numBuffers_;
     settings.setInListener(this);
     settings.setOutListener(this);
 
@@ -1072,6 +1351,10 @@ bool ofApp::setupSoundStreamWithSelection() {
         soundStream_.start();
         soundStreamActive_ = true;
         configuredOutputChannels_ = static_cast<int>(settings.numOutputChannels);
+        activeOutputDeviceName_ = outDevice.name;
+        activeInputDeviceName_ = settings.numInputChannels > 0 ? inputDevices_[selectedInputDevice_].name : std::string();
+        lastAudioBlockIndex_ = pipelineSnapshot_.blockIndex;
+        lastAudioBlockMicros_ = ofGetElapsedTimeMicros();
         if (settings.numOutputChannels < 4) {
             ofLogWarning("ofApp") << "出力デバイス '" << outDevice.name << "' は "
                                   << settings.numOutputChannels
@@ -1081,6 +1364,7 @@ bool ofApp::setupSoundStreamWithSelection() {
                                  << settings.numOutputChannels << "ch で初期化しました。";
         }
         updateAudioDeviceLabels();
+        selectCalibrationProfile();
         return true;
     } catch (const std::exception& ex) {
         ofLogError("ofApp") << "オーディオデバイス初期化に失敗しました: " << ex.what();
@@ -1090,6 +1374,1023 @@ bool ofApp::setupSoundStreamWithSelection() {
     }
 }
 
+void ofApp::selectCalibrationProfile() {
+    if (!startupAssetsAttached_) {
+        // attachStartupAssets() calls back once the routing is complete.
+        return;
+    }
+    if (latencySweep_.active || sessionReplayer_.active()) {
+        // The sweep reopens the stream with trial settings; a replay keeps the recorded venue's values.
+        return;
+    }
+    knot::audio::CalibrationProfileKey key;
+    key.inputDevice = activeInputDeviceName_;
+    key.outputDevice = activeOutputDeviceName_;
+    key.sampleRate = sampleRate_;
+    key.bufferSize = bufferSize_;
+    if (calibrationProfileKey_ && *calibrationProfileKey_ == key) {
+        // Same stream reopened (hot-plug recovery, sweep restore): the values still apply.
+        return;
+    }
+    calibrationProfileKey_ = key;
+    if (audioPipeline_.isCalibrationActive()) {
+        // A running calibration carries on with the new devices and is stored under their key.
+        return;
+    }
+    if (key.inputDevice.empty()) {
+        ofLogWarning("ofApp") << "No input device; calibration for '" << key.outputDevice << "' cannot be checked.";
+        return;
+    }
+    if (auto stored = calibrationStore_.find(key)) {
+        audioPipeline_.setCalibration(*stored);
+        // Already on disk and reported when it was measured.
+        calibrationSaved_ = true;
+        calibrationSaveAttempted_ = true;
+        calibrationReportAppended_ = true;
+        ofLogNotice("ofApp") << "Calibration profile for '" << key.inputDevice << "' / '" << key.outputDevice
+                             << "' (" << key.bufferSize << " frames) loaded; verifying.";
+    } else if (audioPipeline_.calibrationReady()) {
+        ofLogNotice("ofApp") << "No calibration profile for '" << key.inputDevice << "' / '" << key.outputDevice
+                             << "' (" << key.bufferSize << " frames); verifying the current values.";
+    } else {
+        ofLogNotice("ofApp") << "No calibration for '" << key.inputDevice << "' / '" << key.outputDevice
+                             << "'. Starting calibration.";
+        startFullCalibration();
+        return;
+    }
+    if (!audioPipeline_.startCalibrationCheck()) {
+        ofLogWarning("ofApp") << "Calibration check could not start (latency test running).";
+    }
+}
+
+void ofApp::handleCalibrationCheck(const knot::audio::CalibrationCheck& check) {
+    std::ostringstream errors;
+    errors << "CH1 " << ofToString(check.gainErrorDb[0], 2) << " dB, CH2 " << ofToString(check.gainErrorDb[1], 2)
+           << " dB";
+    if (!check.passed) {
+        ofLogWarning("ofApp") << "Calibration is stale (" << errors.str() << "). Starting calibration.";
+        startFullCalibration();
+        return;
+    }
+    ofLogNotice("ofApp") << "Calibration verified (" << errors.str() << ").";
+    if (calibrationProfileKey_ && !calibrationStore_.contains(*calibrationProfileKey_)) {
+        // Values carried over from another profile or the legacy file hold here too: keep them.
+        if (calibrationStore_.store(*calibrationProfileKey_, audioPipeline_.calibrationResult())) {
+            ofLogNotice("ofApp") << "Calibration profile stored for '" << calibrationProfileKey_->inputDevice
+                                 << "' / '" << calibrationProfileKey_->outputDevice << "'.";
+        }
+    }
+}
+
+void ofApp::startFullCalibration() {
+    ensureParentDirectory(calibrationFilePath_);
+    audioPipeline_.startCalibration();
+    calibrationSaved_ = false;
+    calibrationSaveAttempted_ = false;
+}
+
+void ofApp::superviseAudioDevices(std::uint64_t nowMicros) {
+    if (latencySweep_.active) {
+        // The sweep reopens the stream itself and times out candidates that never start.
+        return;
+    }
+    const auto devices = audioDeviceMonitor_.devices();
+    const std::uint64_t generation = audioDeviceMonitor_.generation();
+    const bool listChanged = devices && generation != audioDeviceGeneration_;
+    audioDeviceGeneration_ = generation;
+
+    if (audioDeviceLost_ && soundStreamActive_) {
+        // The operator picked other devices and applied them by hand.
+        ofLogNotice("ofApp") << "Audio stream reopened manually; automatic recovery cancelled.";
+        audioDeviceLost_ = false;
+    }
+    if (audioDeviceLost_) {
+        if (devices && nowMicros >= nextAudioReopenMicros_) {
+            reopenLostAudioDevices(nowMicros, *devices);
+        }
+        return;
+    }
+    if (!soundStreamActive_) {
+        return;
+    }
+    if (pipelineSnapshot_.blockIndex != lastAudioBlockIndex_) {
+        lastAudioBlockIndex_ = pipelineSnapshot_.blockIndex;
+        lastAudioBlockMicros_ = nowMicros;
+    }
+
+    // The open devices are matched by name only: a driver may list a device it has open with no
+    // channels, and treating that as a removal would close and reopen the stream in a loop. A
+    // device that stays listed but stops delivering is caught by the stall check instead.
+    std::string reason;
+    if (listChanged && !infra::AudioDeviceMonitor::listed(*devices, activeOutputDeviceName_)) {
+        reason = "output_removed";
+    } else if (listChanged && !activeInputDeviceName_.empty() &&
+               !infra::AudioDeviceMonitor::listed(*devices, activeInputDeviceName_)) {
+        reason = "input_removed";
+    } else if (nowMicros - lastAudioBlockMicros_ > kAudioStallMicros) {
+        reason = "stream_stalled";
+    }
+    if (reason.empty()) {
+        if (listChanged) {
+            applyAudioDeviceList(*devices);
+        }
+        return;
+    }
+
+    // Only the device stream goes down: the pipeline keeps its calibration, beat baselines and
+    // fallback state, and update() drives the visuals synthetically until the stream is back.
+    ofLogWarning("ofApp") << "Audio device lost (" << reason << "): output '" << activeOutputDeviceName_
+                          << "', input '" << activeInputDeviceName_ << "'. Waiting for it to return.";
+    audioDeviceLost_ = true;
+    audioDeviceLostMicros_ = nowMicros;
+    audioDeviceLossReason_ = reason;
+    nextAudioReopenMicros_ = nowMicros;
+    shutdownSoundStream();
+}
+
+void ofApp::reopenLostAudioDevices(std::uint64_t nowMicros, const infra::AudioDeviceMonitor::DeviceList& devices) {
+    const bool outputBack = infra::AudioDeviceMonitor::contains(devices, activeOutputDeviceName_, false);
+    const bool inputBack = activeInputDeviceName_.empty() ||
+                           infra::AudioDeviceMonitor::contains(devices, activeInputDeviceName_, true);
+    if (!outputBack || !inputBack) {
+        return;
+    }
+    nextAudioReopenMicros_ = nowMicros + kAudioReopenRetryMicros;
+
+    applyAudioDeviceList(devices);
+    audioPipeline_.prepareStreamRestart();
+    const std::uint64_t reopenStart = ofGetElapsedTimeMicros();
+    if (!setupSoundStreamWithSelection()) {
+        ofLogWarning("ofApp") << "Audio device listed again but the stream did not open; retrying.";
+        return;
+    }
+    const std::uint64_t recoveredMicros = ofGetElapsedTimeMicros();
+
+    infra::DeviceOutageFrame outage;
+    outage.lostAtMicros = audioDeviceLostMicros_;
+    outage.recoveredAtMicros = recoveredMicros;
+    outage.reopenMicros = recoveredMicros - reopenStart;
+    outage.reason = audioDeviceLossReason_;
+    outage.device = activeOutputDeviceName_;
+    ofLogNotice("ofApp") << "Audio device recovered: time-to-recover "
+                         << ofToString(static_cast<double>(recoveredMicros - audioDeviceLostMicros_) * 1e-6, 2)
+                         << " s (" << outage.reason << ", reopen "
+                         << ofToString(static_cast<double>(outage.reopenMicros) * 1e-3, 1) << " ms)";
+    if (sessionLogger_) {
+        sessionLogger_->recordDeviceOutage(outage);
+    }
+    audioDeviceLost_ = false;
+}
+
+void ofApp::reportRealtimeViolations(double nowSeconds) {
+    if constexpr (!knot::audio::rt::kChecksEnabled) {
+        return;
+    }
+    constexpr double kReportIntervalSec = 1.0;
+    const auto current = knot::audio::rt::violations();
+    if (current.total() == reportedRealtimeViolations_.total() ||
+        nowSeconds - lastRealtimeReportAt_ < kReportIntervalSec) {
+        return;
+    }
+    lastRealtimeReportAt_ = nowSeconds;
+    ofLogWarning("ofApp") << "Audio thread realtime violations: allocations=" << current.allocations
+                          << " frees=" << current.deallocations << " blockingWaits=" << current.blockingWaits;
+    reportedRealtimeViolations_ = current;
+}
+
+void ofApp::scheduleBellCue(double atSeconds) {
+    if (!bellCueId_) {
+        return;
+    }
+    audioPipeline_.scheduleCue(*bellCueId_, sceneTimelineSample(atSeconds), kBellCueGain);
+}
+
+double ofApp::sceneClockSeconds() const {
+    // Callback timing jitter can make the extrapolated clock step back slightly; scene time
+    // must never run backwards.
+    const double clock = audioPipeline_.clockSecondsAtMicros(ofGetElapsedTimeMicros());
+    lastSceneClockSeconds_ = std::max(lastSceneClockSeconds_, clock);
+    return lastSceneClockSeconds_;
+}
+
+std::uint64_t ofApp::sceneTimelineSample(double sceneSeconds) const {
+    return audioPipeline_.secondsToSample(std::max(sceneSeconds, sceneClockSeconds() + kCueScheduleLeadSec));
+}
+
+void ofApp::cancelScheduledSceneAudio() {
+    audioPipeline_.cancelPendingCues();
+    audioPipeline_.cancelScheduledFades();
+    audioRouter_.cancelScheduledRules();
+}
+
+void ofApp::scheduleSceneAudio(SceneState scene, double enteredAt) {
+    if (!sceneTimingConfig_) {
+        return;
+    }
+    if (const auto* bellStage = sceneTimingConfig_->findStage(scene, "bellSound")) {
+        if (enteredAt + bellStage->startAt >= sceneClockSeconds() - kStaleCueSec) {
+            scheduleBellCue(enteredAt + bellStage->startAt);
+        }
+    }
+    if (const auto planned = sceneController_.plannedAutoTransition()) {
+        scheduleTransitionAudio(scene, planned->to, planned->startTime, sceneController_.fadeDuration());
+        scheduledAutoTransition_ = planned->to;
+    }
+}
+
+void ofApp::scheduleTransitionAudio(SceneState from, SceneState to, double startAt, double blendDuration) {
+    // ベル音(Start→FirstPhase, FirstPhase→Exchange等の主要遷移)
+    const bool playBell = (to == SceneState::FirstPhase) || (to == SceneState::Exchange) ||
+                          (to == SceneState::Mixed) || (to == SceneState::End);
+    if (playBell) {
+        scheduleBellCue(startAt);
+    }
+
+    // ルーティングは映像のブレンドと同じ区間でクロスフェードする
+    const double sampleRate = audioPipeline_.sampleRate();
+    audioRouter_.scheduleScenePreset(to, sceneTimelineSample(startAt),
+                                     static_cast<std::size_t>(blendDuration * sampleRate));
+
+    // 心音交換シーンへの遷移: 開始時にフェードアウト、ブレンド完了時にフェードイン
+    if (to == SceneState::Exchange || to == SceneState::Mixed) {
+        const auto fadeSamples = static_cast<std::size_t>(audioFadeDuration_ * sampleRate);
+        audioPipeline_.scheduleOutputFade(0.1f, sceneTimelineSample(startAt), fadeSamples);
+        audioPipeline_.scheduleOutputFade(1.0f, sceneTimelineSample(startAt + blendDuration), fadeSamples);
+    }
+    ofLogNotice("ofApp") << "Scene audio scheduled: " << sceneStateToString(from) << " → "
+                         << sceneStateToString(to) << " at " << ofToString(startAt, 3) << " s";
+}
+
+void ofApp::rescheduleCurrentSceneAudio() {
+    // An in-flight transition keeps what it scheduled; its completion plans the next scene anyway.
+    if (sceneController_.isTransitioning()) {
+        return;
+    }
+    const double now = sceneClockSeconds();
+    cancelScheduledSceneAudio();
+    scheduledAutoTransition_.reset();
+    scheduleSceneAudio(sceneController_.currentState(), now - sceneController_.timeInState(now));
+}
+
+void ofApp::applyGuiConfig() {
+    operationMode_ = ofToLower(appConfig_.operationMode);
+    showControlPanel_ = appConfig_.gui.showControlPanel;
+    showStatusPanel_ = appConfig_.gui.showStatusPanel;
+    allowKeyboardToggle_ = appConfig_.gui.allowKeyboardToggle;
+    allowCornerUnlock_ = appConfig_.gui.allowCornerUnlock;
+    guiToggleHoldTimeSec_ = std::max(0.0, appConfig_.gui.keyboardToggleHoldTime);
+    if (!appConfig_.gui.keyboardToggleKey.empty()) {
+        guiToggleKey_ = static_cast<int>(appConfig_.gui.keyboardToggleKey.front());
+    }
+
+    if (operationMode_ == "exhibition") {
+        showControlPanel_ = false;
+        showStatusPanel_ = false;
+        allowKeyboardToggle_ = false;
+    } else if (operationMode_ == "operator") {
+        showControlPanel_ = false;
+        showStatusPanel_ = true;
+    }
+}
+
+void ofApp::startConfigWatcher() {
+    const auto timingRelative = appConfig_.sceneTimingConfigPath;
+    configWatcher_.watch(ofToDataPath(timingRelative.string(), true), [this, timingRelative](const auto&) {
+        std::string error;
+        if (auto config = SceneTimingConfig::tryLoad(timingRelative, error)) {
+            std::shared_ptr<const SceneTimingConfig> next = std::make_shared<SceneTimingConfig>(std::move(*config));
+            std::atomic_store(&pendingSceneTiming_, std::move(next));
+        } else {
+            ofLogWarning("ofApp") << "Scene timing reload rejected, keeping current config: " << error;
+        }
+    });
+
+    configWatcher_.watch(ofToDataPath(kAppConfigPath, true), [this](const auto&) {
+        std::string error;
+        infra::AppConfigLoader loader;
+        if (auto config = loader.tryLoad(kAppConfigPath, error)) {
+            std::shared_ptr<const infra::AppConfig> next = std::make_shared<infra::AppConfig>(std::move(*config));
+            std::atomic_store(&pendingAppConfig_, std::move(next));
+        } else {
+            ofLogWarning("ofApp") << "App config reload rejected, keeping current config: " << error;
+        }
+    });
+
+    const auto presetPath = std::filesystem::path(ofToDataPath(appConfig_.routingPresetsPath.string(), true));
+    configWatcher_.watch(presetPath, [this](const std::filesystem::path& path) {
+        std::string error;
+        if (auto presets = knot::audio::AudioRouter::loadScenePresets(path, error)) {
+            std::atomic_store(&pendingRoutingPresets_, std::move(presets));
+        } else {
+            ofLogWarning("ofApp") << "Routing preset reload rejected, keeping current presets: " << error;
+        }
+    });
+
+    configWatcher_.start();
+}
+
+void ofApp::applyPendingConfigReloads() {
+    if (auto timing = std::atomic_exchange(&pendingSceneTiming_, std::shared_ptr<const SceneTimingConfig>{})) {
+        // SceneController keeps its state and entry time; only durations/stages change.
+        sceneTimingConfig_ = std::move(timing);
+        sceneController_.setTimingConfig(sceneTimingConfig_);
+        rescheduleCurrentSceneAudio();
+        ofLogNotice("ofApp") << "Scene timing reloaded";
+    }
+
+    using PresetTable = knot::audio::AudioRouter::ScenePresetTable;
+    if (auto presets = std::atomic_exchange(&pendingRoutingPresets_, std::shared_ptr<const PresetTable>{})) {
+        audioRouter_.setScenePresets(std::move(presets));
+        if (!sceneController_.isTransitioning()) {
+            // Reschedule first: it cancels pending rule changes, which would include the one below.
+            rescheduleCurrentSceneAudio();
+            // Crossfades on the audio thread like any other rule change; no buffer is dropped.
+            audioRouter_.applyScenePreset(sceneController_.currentState());
+        }
+        ofLogNotice("ofApp") << "Routing presets reloaded";
+    }
+
+    if (auto config = std::atomic_exchange(&pendingAppConfig_, std::shared_ptr<const infra::AppConfig>{})) {
+        applyAppConfigReload(*config);
+    }
+}
+
+void ofApp::applyAppConfigReload(const infra::AppConfig& next) {
+    if (next.inputGainDb != appConfig_.inputGainDb) {
+        audioPipeline_.setInputGainDb(next.inputGainDb);
+        ofLogNotice("ofApp") << "Input gain reloaded: " << next.inputGainDb << " dB";
+    }
+    appConfig_.inputGainDb = next.inputGainDb;
+    if (next.audio.inputAgc != appConfig_.audio.inputAgc) {
+        audioPipeline_.setInputAgc(next.audio.inputAgc);
+        ofLogNotice("ofApp") << "Input AGC reloaded: " << (next.audio.inputAgc ? "on" : "off");
+    }
+    appConfig_.audio.inputAgc = next.audio.inputAgc;
+    if (next.audio.crosstalkCancellation != appConfig_.audio.crosstalkCancellation) {
+        audioPipeline_.setCrosstalkCancellation(next.audio.crosstalkCancellation);
+        ofLogNotice("ofApp") << "Crosstalk cancellation reloaded: "
+                             << (next.audio.crosstalkCancellation ? "on" : "off");
+    }
+    appConfig_.audio.crosstalkCancellation = next.audio.crosstalkCancellation;
+    if (next.audio.baselineTracking != appConfig_.audio.baselineTracking) {
+        audioPipeline_.setBaselineTracking(next.audio.baselineTracking);
+        ofLogNotice("ofApp") << "Baseline tracking reloaded: " << (next.audio.baselineTracking ? "on" : "off");
+    }
+    appConfig_.audio.baselineTracking = next.audio.baselineTracking;
+    if (next.audio.noiseColor != appConfig_.audio.noiseColor) {
+        audioPipeline_.setNoiseColor(
+            knot::audio::noiseColorFromString(next.audio.noiseColor).value_or(knot::audio::NoiseColor::White));
+        ofLogNotice("ofApp") << "Noise color reloaded: " << next.audio.noiseColor;
+    }
+    appConfig_.audio.noiseColor = next.audio.noiseColor;
+    if (next.audio.resynthesisMix != appConfig_.audio.resynthesisMix) {
+        audioPipeline_.setResynthesisMix(next.audio.resynthesisMix);
+        ofLogNotice("ofApp") << "Heartbeat resynthesis mix reloaded: " << next.audio.resynthesisMix;
+    }
+    appConfig_.audio.resynthesisMix = next.audio.resynthesisMix;
+    if (next.audio.predictiveHaptics != appConfig_.audio.predictiveHaptics ||
+        next.audio.hapticLeadMs != appConfig_.audio.hapticLeadMs) {
+        appConfig_.audio.predictiveHaptics = next.audio.predictiveHaptics;
+        appConfig_.audio.hapticLeadMs = next.audio.hapticLeadMs;
+        applyPredictiveHaptics();
+        ofLogNotice("ofApp") << "Predictive haptics reloaded: " << (next.audio.predictiveHaptics ? "on" : "off")
+                             << ", lead " << next.audio.hapticLeadMs << " ms";
+    }
+    appConfig_.operationMode = next.operationMode;
+    appConfig_.gui = next.gui;
+    applyGuiConfig();
+
+    // Paths and file-backed loggers are opened once; changing them needs a restart.
+    const bool restartNeeded = next.calibrationPath != appConfig_.calibrationPath ||
+                               next.calibrationReportCsvPath != appConfig_.calibrationReportCsvPath ||
+                               next.sessionSeedPath != appConfig_.sessionSeedPath ||
+                               next.sceneTimingConfigPath != appConfig_.sceneTimingConfigPath ||
+                               next.routingPresetsPath != appConfig_.routingPresetsPath ||
+                               next.sceneTransitionCsvPath != appConfig_.sceneTransitionCsvPath ||
+                               next.audio.bufferSize != appConfig_.audio.bufferSize ||
+                               next.audio.numBuffers != appConfig_.audio.numBuffers ||
+                               next.recording.enabled != appConfig_.recording.enabled ||
+                               next.recording.directory != appConfig_.recording.directory ||
+                               next.streaming.enabled != appConfig_.streaming.enabled ||
+                               next.streaming.destinations != appConfig_.streaming.destinations ||
+                               next.streaming.envelopeRateHz != appConfig_.streaming.envelopeRateHz ||
+                               next.streaming.envelopesPerPacket != appConfig_.streaming.envelopesPerPacket ||
+                               next.streaming.statusRateHz != appConfig_.streaming.statusRateHz ||
+                               next.simulation.bpm != appConfig_.simulation.bpm ||
+                               next.simulation.levelDb != appConfig_.simulation.levelDb ||
+                               next.simulation.hrvMs != appConfig_.simulation.hrvMs ||
+                               next.simulation.breathsPerMin != appConfig_.simulation.breathsPerMin ||
+                               next.simulation.noiseDb != appConfig_.simulation.noiseDb ||
+                               next.simulation.crosstalkDb != appConfig_.simulation.crosstalkDb ||
+                               next.simulation.dropoutsPerMin != appConfig_.simulation.dropoutsPerMin ||
+                               next.telemetry.sessionCsvPath != appConfig_.telemetry.sessionCsvPath ||
+                               next.telemetry.summaryJsonPath != appConfig_.telemetry.summaryJsonPath ||
+                               next.telemetry.hapticCsvPath != appConfig_.telemetry.hapticCsvPath;
+    if (restartNeeded) {
+        ofLogWarning("ofApp") << "App config reloaded; path, stream and simulation changes take effect after restart";
+    } else {
+        ofLogNotice("ofApp") << "App config reloaded (mode=" << operationMode_ << ")";
+    }
+}
+
+void ofApp::setReplayFile(const std::filesystem::path& wavPath) {
+    replayPath_ = wavPath;
+}
+
+void ofApp::startSessionRecording() {
+    const auto path = appConfig_.recording.directory / ("session-" + ofGetTimestampString("%Y%m%d-%H%M%S") + ".wav");
+    if (!sessionRecorder_.start(path, sampleRate_)) {
+        return;
+    }
+    audioPipeline_.setInputRecorder(&sessionRecorder_);
+    sessionRecorder_.mark(kSceneMarkerPrefix + sceneStateToString(sceneController_.currentState()));
+}
+
+void ofApp::startTelemetryStreaming() {
+    if (!telemetryStreamer_.configure(appConfig_.streaming)) {
+        ofLogWarning("ofApp") << "Telemetry streaming disabled: no usable destination";
+        return;
+    }
+    telemetryStreamer_.setBeatSource(audioPipeline_.subscribeBeatEvents());
+    telemetryStreamer_.setEnvelopeSources(audioPipeline_.envelopeScope(knot::audio::ParticipantId::Participant1),
+                                          audioPipeline_.envelopeScope(knot::audio::ParticipantId::Participant2));
+    telemetryStreamer_.start();
+}
+
+void ofApp::publishStreamStatus() {
+    if (!telemetryStreamer_.running()) {
+        return;
+    }
+    infra::StreamStatus status;
+    status.sequence = ++streamStatusSequence_;
+    status.bpm = participantBpms_;
+    status.envelope = participantEnvelopes_;
+    status.envelopeShort = signalHealth_.envelopeShort;
+    status.envelopeMid = signalHealth_.envelopeMid;
+    status.envelopeLong = signalHealth_.envelopeLong;
+    status.bpmAverage = signalHealth_.bpmAverage;
+    status.dropoutSeconds = signalHealth_.dropoutSeconds;
+    status.fallbackActive = signalHealth_.fallbackActive;
+    status.fallbackBlend = signalHealth_.fallbackBlend;
+    status.limiterReductionDb = pipelineSnapshot_.limiterReductionDb;
+    status.inputGainDb = {pipelineSnapshot_.channels[0].inputGainDb, pipelineSnapshot_.channels[1].inputGainDb};
+    const std::string scene = sceneStateToString(sceneController_.currentState());
+    std::strncpy(status.scene, scene.c_str(), sizeof(status.scene) - 1);
+    telemetryStreamer_.publishStatus(status);
+}
+
+void ofApp::startLatencySweep() {
+    if (latencySweep_.active) {
+        ofLogNotice("ofApp") << "Latency sweep already running.";
+        return;
+    }
+    if (audioPipeline_.isCalibrationActive() || audioPipeline_.isCalibrationCheckActive() ||
+        sessionReplayer_.active() || !soundStreamActive_ || activeInputDeviceName_.empty()) {
+        ofLogWarning("ofApp") << "Latency sweep needs a live input and output stream and no calibration or replay.";
+        return;
+    }
+    latencySweep_.results.clear();
+    bool configuredListed = false;
+    for (const auto& [bufferSize, numBuffers] : kLatencySweepCandidates) {
+        LatencySweepResult result;
+        result.bufferSize = bufferSize;
+        result.numBuffers = numBuffers;
+        latencySweep_.results.push_back(result);
+        configuredListed = configuredListed || (bufferSize == bufferSize_ && numBuffers == numBuffers_);
+    }
+    if (!configuredListed) {
+        LatencySweepResult result;
+        result.bufferSize = bufferSize_;
+        result.numBuffers = numBuffers_;
+        latencySweep_.results.push_back(result);
+    }
+    latencySweep_.configuredBufferSize = bufferSize_;
+    latencySweep_.configuredNumBuffers = numBuffers_;
+    latencySweep_.step = 0;
+    latencySweep_.active = true;
+    ofLogNotice("ofApp") << "Latency sweep: loop output CH1 -> input 1 and output CH3 -> input 2. Testing "
+                         << latencySweep_.results.size() << " stream settings.";
+    beginLatencySweepStep(ofGetElapsedTimeMicros());
+}
+
+void ofApp::beginLatencySweepStep(std::uint64_t nowMicros) {
+    while (latencySweep_.step < latencySweep_.results.size()) {
+        auto& result = latencySweep_.results[latencySweep_.step];
+        shutdownSoundStream();
+        bufferSize_ = result.bufferSize;
+        numBuffers_ = result.numBuffers;
+        audioPipeline_.prepareStreamRestart();
+        if (setupSoundStreamWithSelection() && audioPipeline_.startLatencyTest(kLatencyTestPulses)) {
+            result.opened = true;
+            latencySweep_.deadlineMicros = nowMicros + kLatencyStepTimeoutMicros;
+            return;
+        }
+        ofLogWarning("ofApp") << "Latency sweep: bufferSize " << result.bufferSize << " x " << result.numBuffers
+                              << " could not be opened.";
+        ++latencySweep_.step;
+    }
+    finishLatencySweep();
+}
+
+void ofApp::updateLatencySweep(std::uint64_t nowMicros) {
+    if (!latencySweep_.active) {
+        return;
+    }
+    auto& result = latencySweep_.results[latencySweep_.step];
+    knot::audio::LatencyReport report;
+    if (audioPipeline_.pollLatencyReport(report)) {
+        result.completed = true;
+        result.report = report;
+        ofLogNotice("ofApp") << "Latency " << result.bufferSize << " x " << result.numBuffers << ": "
+                             << describeLatencyReport(report);
+    } else if (nowMicros >= latencySweep_.deadlineMicros) {
+        audioPipeline_.cancelLatencyTest();
+        ofLogWarning("ofApp") << "Latency " << result.bufferSize << " x " << result.numBuffers
+                              << ": timed out (stream did not run)";
+    } else {
+        return;
+    }
+    ++latencySweep_.step;
+    beginLatencySweepStep(nowMicros);
+}
+
+void ofApp::finishLatencySweep() {
+    latencySweep_.active = false;
+    shutdownSoundStream();
+    bufferSize_ = latencySweep_.configuredBufferSize;
+    numBuffers_ = latencySweep_.configuredNumBuffers;
+    audioPipeline_.prepareStreamRestart();
+    if (!setupSoundStreamWithSelection()) {
+        ofLogError("ofApp") << "Latency sweep: could not reopen the configured stream settings.";
+    }
+
+    const LatencySweepResult* suggested = nullptr;
+    ofJson candidates = ofJson::array();
+    for (const auto& result : latencySweep_.results) {
+        const auto& report = result.report;
+        if (result.completed && report.stable && result.bufferSize == bufferSize_ &&
+            result.numBuffers == numBuffers_) {
+            measuredHapticLeadMs_ = report.roundTrip.medianMs + report.detection.medianMs;
+            ofLogNotice("ofApp") << "Predictive haptic lead set to " << ofToString(measuredHapticLeadMs_, 2)
+                                 << " ms from the sweep at the configured buffer settings.";
+        }
+        ofJson entry = {
+            {"bufferSize", result.bufferSize},
+            {"numBuffers", result.numBuffers},
+            {"opened", result.opened},
+            {"completed", result.completed},
+            {"stable", result.completed && report.stable},
+            {"pulsesSent", report.pulsesSent},
+            {"pulsesMeasured", report.pulsesMeasured},
+            {"hapticOutputAvailable", report.hapticOutputAvailable},
+            {"filterDelayMs", report.filterDelayMs},
+            {"roundTrip", latencyStageJson(report.roundTrip)},
+            {"detection", latencyStageJson(report.detection)},
+            {"hapticRender", latencyStageJson(report.hapticRender)},
+            {"hapticReturn", latencyStageJson(report.hapticReturn)},
+            {"inputToHaptic", latencyStageJson(report.inputToHaptic)},
+        };
+        candidates.push_back(entry);
+        if (result.completed && report.stable &&
+            (suggested == nullptr || report.inputToHaptic.medianMs < suggested->report.inputToHaptic.medianMs)) {
+            suggested = &result;
+        }
+    }
+
+    ofJson json = {
+        {"createdUtc", ofGetTimestampString("%FT%TZ")},
+        {"sampleRateHz", sampleRate_},
+        {"configured", {{"bufferSize", bufferSize_}, {"numBuffers", numBuffers_}}},
+        {"candidates", candidates},
+    };
+    if (suggested) {
+        json["suggested"] = {{"bufferSize", suggested->bufferSize},
+                             {"numBuffers", suggested->numBuffers},
+                             {"inputToHapticMs", suggested->report.inputToHaptic.medianMs}};
+        ofLogNotice("ofApp") << "Latency sweep: lowest stable setting is bufferSize " << suggested->bufferSize
+                             << " x " << suggested->numBuffers << " (input->haptic "
+                             << ofToString(suggested->report.inputToHaptic.medianMs, 2)
+                             << " ms). Set audio.bufferSize / audio.numBuffers in " << kAppConfigPath
+                             << " to use it.";
+    } else {
+        json["suggested"] = nullptr;
+        ofLogWarning("ofApp") << "Latency sweep: no setting was stable. Check the loopback cables and levels.";
+    }
+
+    applyPredictiveHaptics();
+
+    const auto reportPath = calibrationReportPath_.parent_path() / "latency_report.json";
+    if (ensureParentDirectory(reportPath)) {
+        try {
+            ofSavePrettyJson(reportPath.string(), json);
+            ofLogNotice("ofApp") << "Latency report written to " << reportPath;
+        } catch (const std::exception& ex) {
+            ofLogWarning("ofApp") << "Failed to write latency report: " << reportPath << " reason: " << ex.what();
+        }
+    }
+}
+
+void ofApp::applyPredictiveHaptics() {
+    const double leadMs = appConfig_.audio.hapticLeadMs > 0.0 ? appConfig_.audio.hapticLeadMs : measuredHapticLeadMs_;
+    audioPipeline_.setPredictiveHaptics(appConfig_.audio.predictiveHaptics, leadMs / 1000.0);
+}
+
+void ofApp::startReplay() {
+    auto recording = std::make_shared<knot::audio::SessionRecordingData>();
+    if (!knot::audio::SessionRecordingData::load(replayPath_, sampleRate_, *recording)) {
+        ofLogError("ofApp") << "Replay file could not be loaded: " << replayPath_;
+        replayPath_.clear();
+        return;
+    }
+    // Sized once; feedReplayInput() only shrinks it, so the audio thread never allocates.
+    replayInput_.allocate(audioPipeline_.monitorCapacityFrames(), 2);
+    replayMarkerIndex_ = 0;
+    replayEndLogged_ = false;
+    ofLogNotice("ofApp") << "Replaying " << replayPath_ << " ("
+                         << ofToString(static_cast<double>(recording->length()) / sampleRate_, 1) << " s, "
+                         << recording->markers.size() << " markers); the input device is ignored.";
+    sessionReplayer_.prepare(std::move(recording));
+}
+
+void ofApp::feedReplayInput(std::size_t numFrames) {
+    // The whole device block in one call, as the input device would deliver it, so the monitor
+    // lines up with the output block; only a block beyond the monitor's capacity takes several.
+    const std::size_t capacity = audioPipeline_.monitorCapacityFrames();
+    for (std::size_t offset = 0; offset < numFrames && capacity > 0; offset += capacity) {
+        const std::size_t frames = std::min(capacity, numFrames - offset);
+        replayInput_.resize(frames * 2);
+        sessionReplayer_.read(replayInput_.getBuffer().data(), frames);
+        audioPipeline_.audioIn(replayInput_);
+    }
+}
+
+void ofApp::feedSyntheticInput(std::size_t numFrames) {
+    // Same as feedReplayInput(): whole blocks up to the monitor's capacity.
+    const std::size_t capacity = audioPipeline_.monitorCapacityFrames();
+    for (std::size_t offset = 0; offset < numFrames && capacity > 0; offset += capacity) {
+        const std::size_t frames = std::min(capacity, numFrames - offset);
+        syntheticInput_.resize(frames * 2);
+        syntheticSource_.read(syntheticInput_.getBuffer().data(), frames);
+        audioPipeline_.audioIn(syntheticInput_);
+    }
+}
+
+void ofApp::pumpSyntheticPipeline(std::uint64_t nowMicros) {
+    // Only while no callback runs: the stream is opened and closed on this thread.
+    if (soundStreamActive_ || !syntheticInputActive_.load(std::memory_order_acquire)) {
+        lastSyntheticPumpMicros_ = 0;
+        return;
+    }
+    if (lastSyntheticPumpMicros_ == 0) {
+        lastSyntheticPumpMicros_ = nowMicros;
+        return;
+    }
+    // A stalled frame is not made up beyond this, so it does not turn into a burst of blocks.
+    constexpr std::uint64_t kMaxCatchUpMicros = 250'000;
+    const std::uint64_t elapsed = nowMicros - lastSyntheticPumpMicros_;
+    std::size_t frames = 0;
+    if (elapsed > kMaxCatchUpMicros) {
+        frames = static_cast<std::size_t>(static_cast<double>(kMaxCatchUpMicros) * 1e-6 * sampleRate_);
+        lastSyntheticPumpMicros_ = nowMicros;
+    } else {
+        frames = static_cast<std::size_t>(static_cast<double>(elapsed) * 1e-6 * sampleRate_);
+        lastSyntheticPumpMicros_ += static_cast<std::uint64_t>(static_cast<double>(frames) * 1e6 / sampleRate_);
+    }
+    knot::audio::rt::ScopedAudioThread realtimeScope;
+    while (frames > 0) {
+        const std::size_t block = std::min({frames, bufferSize_, audioPipeline_.monitorCapacityFrames()});
+        feedSyntheticInput(block);
+        syntheticOutput_.resize(block * knot::audio::AudioRouter::kOutputChannels);
+        audioPipeline_.audioOut(syntheticOutput_);
+        frames -= block;
+    }
+}
+
+void ofApp::applyReplayMarkers() {
+    const auto* recording = sessionReplayer_.recording();
+    if (!recording) {
+        return;
+    }
+    const std::uint64_t position = sessionReplayer_.position();
+    while (replayMarkerIndex_ < recording->markers.size() && recording->markers[replayMarkerIndex_].frame <= position) {
+        const auto& marker = recording->markers[replayMarkerIndex_++];
+        ofLogNotice("ofApp") << "Replay marker at " << ofToString(static_cast<double>(marker.frame) / sampleRate_, 2)
+                             << " s: " << marker.label;
+        const auto scene = sceneFromMarker(marker.label);
+        if (scene && *scene != sceneController_.targetState()) {
+            sceneController_.requestState(*scene, sceneClockSeconds(), true, "replay_marker");
+        }
+    }
+    if (!replayEndLogged_ && sessionReplayer_.finished()) {
+        ofLogNotice("ofApp") << "Replay finished; output continues with silence on the inputs.";
+        replayEndLogged_ = true;
+    }
+}
+
+int ofApp::runHeadlessReplay(const std::filesystem::path& wavPath) {
+    using namespace knot::audio;
+    constexpr double kSampleRate = 48000.0;
+    constexpr std::size_t kBlockFrames = 512;
+
+    infra::AppConfigLoader loader;
+    const infra::AppConfig config = loader.load(kAppConfigPath);
+    auto recording = std::make_shared<SessionRecordingData>();
+    if (!SessionRecordingData::load(wavPath, kSampleRate, *recording)) {
+        ofLogError("ofApp") << "Replay file could not be loaded: " << wavPath;
+        return 1;
+    }
+
+    auto pipeline = std::make_unique<AudioPipeline>();
+    pipeline->setup(kSampleRate, kBlockFrames);
+    configureOfflinePipeline(*pipeline, config);
+    AudioRouter router;
+    router.setup(static_cast<float>(kSampleRate));
+    auto hrirDatabase = std::make_shared<HrirDatabase>();
+    if (hrirDatabase->loadSofa(ofToDataPath(kHrirSofaPath, true), kSampleRate)) {
+        router.setHrirDatabase(hrirDatabase);
+    }
+    std::string error;
+    if (auto presets = AudioRouter::loadScenePresets(ofToDataPath(config.routingPresetsPath.string(), true), error)) {
+        router.setScenePresets(std::move(presets));
+    }
+    router.applyScenePreset(SceneState::Idle);
+    pipeline->setOutputRouter(&router);
+    auto beats = pipeline->subscribeBeatEvents();
+
+    SessionReplayer replayer;
+    replayer.prepare(recording);
+    ofSoundBuffer input;
+    input.allocate(kBlockFrames, 2);
+    ofSoundBuffer output;
+    output.allocate(kBlockFrames, AudioRouter::kOutputChannels);
+
+    auto csvPath = wavPath;
+    csvPath.replace_extension(".replay_beats.csv");
+    std::ofstream csv(csvPath, std::ios::trunc);
+    csv << "timestampSec,participant,bpm,envelope,sequenceId\n";
+
+    std::array<std::uint64_t, 2> beatCounts{};
+    std::array<float, AudioRouter::kOutputChannels> outputPeaks{};
+    float deepestReductionDb = 0.0f;
+    std::size_t nextMarker = 0;
+    const auto wallStart = std::chrono::steady_clock::now();
+    while (!replayer.finished()) {
+        // Markers are applied at block granularity; routing then crossfades as it does live.
+        const std::uint64_t blockEnd = replayer.position() + kBlockFrames;
+        while (nextMarker < recording->markers.size() && recording->markers[nextMarker].frame < blockEnd) {
+            const auto& marker = recording->markers[nextMarker++];
+            ofLogNotice("ofApp") << "Replay marker at " << ofToString(static_cast<double>(marker.frame) / kSampleRate, 2)
+                                 << " s: " << marker.label;
+            if (const auto scene = sceneFromMarker(marker.label)) {
+                router.applyScenePreset(*scene);
+            }
+        }
+
+        replayer.read(input.getBuffer().data(), kBlockFrames);
+        pipeline->audioIn(input);
+        pipeline->audioOut(output);
+
+        const auto& samples = output.getBuffer();
+        for (std::size_t n = 0; n < samples.size(); ++n) {
+            auto& peak = outputPeaks[n % outputPeaks.size()];
+            peak = std::max(peak, std::fabs(samples[n]));
+        }
+        deepestReductionDb = std::min(deepestReductionDb, pipeline->snapshot().limiterReductionDb);
+        beats.poll([&](const BeatEvent& event) {
+            if (const auto index = participantIndex(event.participantId)) {
+                ++beatCounts[*index];
+            }
+            csv << ofToString(event.timestampSec, 4) << ',' << participantIdToString(event.participantId) << ','
+                << event.bpm << ',' << event.envelope << ',' << event.sequenceId << '\n';
+        });
+    }
+
+    const double wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double audioSeconds = static_cast<double>(recording->length()) / kSampleRate;
+    ofLogNotice("ofApp") << "Headless replay: " << ofToString(audioSeconds, 1) << " s of audio in "
+                         << ofToString(wallSeconds, 2) << " s (" << ofToString(audioSeconds / std::max(wallSeconds, 1e-6), 1)
+                         << "x). Beats P1=" << beatCounts[0] << " P2=" << beatCounts[1]
+                         << ", output peaks CH1-4 = " << outputPeaks[0] << ' ' << outputPeaks[1] << ' ' << outputPeaks[2]
+                         << ' ' << outputPeaks[3] << ", deepest limiter reduction " << deepestReductionDb
+                         << " dB. Beats written to " << csvPath;
+    return 0;
+}
+
+int ofApp::runSyntheticBenchmark(std::size_t participants, double simulatedSeconds) {
+    using namespace knot::audio;
+    constexpr double kSampleRate = 48000.0;
+    // Beats before this are not scored while the detectors and the AGC settle.
+    constexpr double kWarmupSec = 10.0;
+    // A detection counts for a true S1 onset from kMatchEarlySec before to kMatchLateSec after it.
+    constexpr double kMatchEarlySec = 0.02;
+    constexpr double kMatchLateSec = 0.12;
+    constexpr double kProgressIntervalSec = 60.0;
+
+    struct Pair {
+        AudioPipeline pipeline;
+        AudioRouter router;
+        SyntheticHeartSource source;
+        BeatEventBus truth;
+        BeatEventBus::Subscriber truthEvents;
+        BeatEventBus::Subscriber beats;
+        std::array<std::vector<double>, 2> truthTimes;
+        std::array<std::vector<double>, 2> detectedTimes;
+    };
+
+    infra::AppConfigLoader loader;
+    const infra::AppConfig config = loader.load(kAppConfigPath);
+    const std::size_t blockFrames =
+        std::clamp<std::size_t>(config.audio.bufferSize, 32, AudioPipeline::kMaxBlockFrames);
+    const std::size_t pairCount = std::max<std::size_t>(1, (participants + 1) / 2);
+    if (pairCount * 2 != participants) {
+        ofLogNotice("ofApp") << "Simulating " << pairCount * 2 << " participants (one pipeline per pair).";
+    }
+    auto hrirDatabase = std::make_shared<HrirDatabase>();
+    if (!hrirDatabase->loadSofa(ofToDataPath(kHrirSofaPath, true), kSampleRate)) {
+        hrirDatabase.reset();
+    }
+    std::string error;
+    const auto presets =
+        AudioRouter::loadScenePresets(ofToDataPath(config.routingPresetsPath.string(), true), error);
+
+    // Participants spread around the configured pair: +-10 bpm and up to 8 dB quieter.
+    std::vector<std::unique_ptr<Pair>> pairs;
+    for (std::size_t p = 0; p < pairCount; ++p) {
+        auto pair = std::make_unique<Pair>();
+        auto params = syntheticHeartParams(config.simulation);
+        for (std::size_t c = 0; c < params.size(); ++c) {
+            const std::size_t k = p * 2 + c;
+            params[c].bpm += static_cast<float>(static_cast<int>((k * 37) % 21) - 10);
+            params[c].levelDb -= static_cast<float>((k * 11) % 9);
+        }
+        pair->pipeline.setup(kSampleRate, blockFrames);
+        configureOfflinePipeline(pair->pipeline, config);
+        pair->router.setup(static_cast<float>(kSampleRate));
+        if (hrirDatabase) {
+            pair->router.setHrirDatabase(hrirDatabase);
+        }
+        if (presets) {
+            pair->router.setScenePresets(presets);
+        }
+        pair->router.applyScenePreset(SceneState::FirstPhase);
+        pair->pipeline.setOutputRouter(&pair->router);
+        pair->source.setup(kSampleRate, params, 0x5EEDull + p);
+        pair->source.setTruthBus(&pair->truth);
+        pair->truthEvents = pair->truth.subscribe();
+        pair->beats = pair->pipeline.subscribeBeatEvents();
+        pairs.push_back(std::move(pair));
+    }
+
+    ofSoundBuffer input;
+    input.allocate(blockFrames, 2);
+    ofSoundBuffer output;
+    output.allocate(blockFrames, AudioRouter::kOutputChannels);
+    const double blockSec = static_cast<double>(blockFrames) / kSampleRate;
+    const auto totalBlocks = static_cast<std::size_t>(std::max(0.0, simulatedSeconds) / blockSec);
+    const auto progressBlocks = static_cast<std::size_t>(kProgressIntervalSec / blockSec);
+    std::vector<double> blockMicros;
+    blockMicros.reserve(totalBlocks);
+    const auto collect = [](BeatEventBus::Subscriber& events, std::array<std::vector<double>, 2>& times) {
+        events.poll([&](const BeatEvent& event) {
+            if (const auto index = participantIndex(event.participantId)) {
+                times[*index].push_back(event.timestampSec);
+            }
+        });
+    };
+
+    rt::resetViolations();
+    const auto wallStart = std::chrono::steady_clock::now();
+    for (std::size_t block = 0; block < totalBlocks; ++block) {
+        const auto blockStart = std::chrono::steady_clock::now();
+        {
+            rt::ScopedAudioThread realtimeScope;
+            for (auto& pair : pairs) {
+                pair->source.read(input.getBuffer().data(), blockFrames);
+                pair->pipeline.audioIn(input);
+                pair->pipeline.audioOut(output);
+            }
+        }
+        blockMicros.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - blockStart).count());
+        for (auto& pair : pairs) {
+            collect(pair->truthEvents, pair->truthTimes);
+            collect(pair->beats, pair->detectedTimes);
+        }
+        if (progressBlocks > 0 && (block + 1) % progressBlocks == 0) {
+            const double wallSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+            const double audioSeconds = static_cast<double>(block + 1) * blockSec;
+            ofLogNotice("ofApp") << "Synthetic run: " << ofToString(audioSeconds / 60.0, 0) << " min simulated ("
+                                 << ofToString(audioSeconds / std::max(wallSeconds, 1e-6), 1)
+                                 << "x realtime), realtime violations " << rt::violations().total();
+        }
+    }
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    const double audioSeconds = static_cast<double>(totalBlocks) * blockSec;
+
+    std::size_t truthTotal = 0;
+    std::size_t hitTotal = 0;
+    std::size_t falseTotal = 0;
+    std::uint64_t overflow = 0;
+    std::vector<double> lagsMs;
+    for (std::size_t p = 0; p < pairs.size(); ++p) {
+        const auto& pair = *pairs[p];
+        overflow += pair.beats.overflowCount() + pair.truthEvents.overflowCount();
+        for (std::size_t c = 0; c < 2; ++c) {
+            const auto& truth = pair.truthTimes[c];
+            const auto& detected = pair.detectedTimes[c];
+            // Both lists are in time order: match each true onset to the first free detection in its window.
+            std::size_t next = 0;
+            std::size_t scored = 0;
+            std::size_t hits = 0;
+            std::size_t used = 0;
+            for (const double t : truth) {
+                while (next < detected.size() && detected[next] < t - kMatchEarlySec) {
+                    ++next;
+                }
+                if (t < kWarmupSec) {
+                    continue;
+                }
+                ++scored;
+                if (next < detected.size() && detected[next] <= t + kMatchLateSec) {
+                    lagsMs.push_back((detected[next] - t) * 1000.0);
+                    ++hits;
+                    ++next;
+                }
+            }
+            for (const double d : detected) {
+                used += d >= kWarmupSec ? 1 : 0;
+            }
+            const std::size_t falseBeats = used - std::min(used, hits);
+            truthTotal += scored;
+            hitTotal += hits;
+            falseTotal += falseBeats;
+            const auto& params = pair.source.params(c);
+            ofLogNotice("ofApp") << "  participant " << p * 2 + c + 1 << ": " << params.bpm << " bpm, "
+                                 << params.levelDb << " dBFS, hit " << hits << '/' << scored << " ("
+                                 << ofToString(100.0 * static_cast<double>(hits) / std::max<std::size_t>(1, scored), 1)
+                                 << "%), false " << falseBeats;
+        }
+    }
+
+    std::sort(blockMicros.begin(), blockMicros.end());
+    const auto percentile = [&blockMicros](double q) {
+        return blockMicros.empty() ? 0.0 : blockMicros[static_cast<std::size_t>(q * (blockMicros.size() - 1))];
+    };
+    double lagMedianMs = 0.0;
+    if (!lagsMs.empty()) {
+        std::nth_element(lagsMs.begin(), lagsMs.begin() + lagsMs.size() / 2, lagsMs.end());
+        lagMedianMs = lagsMs[lagsMs.size() / 2];
+    }
+    const auto violations = rt::violations();
+    const double scoredMinutes = std::max(1e-6, (audioSeconds - kWarmupSec) / 60.0);
+    ofLogNotice("ofApp") << "Synthetic benchmark: " << pairCount * 2 << " participants, " << ofToString(audioSeconds, 1)
+                         << " s simulated in " << ofToString(wallSeconds, 2) << " s ("
+                         << ofToString(audioSeconds / std::max(wallSeconds, 1e-6), 1) << "x realtime). Block of "
+                         << blockFrames << " frames (budget " << ofToString(blockSec * 1e6, 0) << " us): p50 "
+                         << ofToString(percentile(0.5), 1) << " us, p99 " << ofToString(percentile(0.99), 1)
+                         << " us, max " << ofToString(percentile(1.0), 1) << " us. Beats: hit " << hitTotal << '/'
+                         << truthTotal << " ("
+                         << ofToString(100.0 * static_cast<double>(hitTotal) / std::max<std::size_t>(1, truthTotal), 1)
+                         << "%), false " << ofToString(static_cast<double>(falseTotal) / scoredMinutes / (pairCount * 2), 2)
+                         << "/min per participant, median lag " << ofToString(lagMedianMs, 1)
+                         << " ms. Event overflow " << overflow << ", realtime violations: allocations="
+                         << violations.allocations << " frees=" << violations.deallocations
+                         << " blockingWaits=" << violations.blockingWaits;
+    return violations.total() > 0 ? 1 : 0;
+}
+
+int ofApp::runStreamingCheck() {
+    infra::AppConfigLoader loader;
+    const infra::AppConfig config = loader.load(kAppConfigPath);
+    return infra::TelemetryStreamer::runLoopbackCheck(config.streaming) ? 0 : 1;
+}
+
+void ofApp::pollCueReports() {
+    const double msPerSample = 1000.0 / audioPipeline_.sampleRate();
+    cueReportSubscriber_.poll([&](const knot::audio::CueReport& report) {
+        if (report.dropped) {
+            ++cueTimingStats_.dropped;
+            ofLogWarning("ofApp") << "Cue " << report.cueId << " dropped (no free voice / queue full)";
+            return;
+        }
+        ++cueTimingStats_.started;
+        const double lateMs = static_cast<double>(report.startSample - report.requestedSample) * msPerSample;
+        if (report.startSample > report.requestedSample) {
+            ++cueTimingStats_.late;
+        }
+        cueTimingStats_.sumLateMs += lateMs;
+        cueTimingStats_.maxLateMs = std::max(cueTimingStats_.maxLateMs, lateMs);
+        ofLogNotice("ofApp") << "Cue " << report.cueId << " started at sample " << report.startSample
+                             << " (late " << ofToString(lateMs, 2) << " ms; total " << cueTimingStats_.started
+                             << ", late " << cueTimingStats_.late << ", max "
+                             << ofToString(cueTimingStats_.maxLateMs, 2) << " ms, mean "
+                             << ofToString(cueTimingStats_.sumLateMs / cueTimingStats_.started, 2)
+                             << " ms, dropped " << cueTimingStats_.dropped << ")";
+    });
+}
+
 float ofApp::blendedEnvelope() const {
     const float base = std::clamp(0.6f * signalHealth_.envelopeShort +
                                       0.3f * signalHealth_.envelopeMid +
@@ -1105,7 +2406,7 @@ float ofApp::blendedEnvelope() const {
 
 void ofApp::appendCalibrationReport(
     const std::array<knot::audio::ChannelCalibrationValue, 2>& values,
-    const std::optional<knot::audio::EnvelopeCalibrationStats>& envelopeStats) {
+    const std::optional<EnvelopeCalibrationPair>& envelopeStats) {
     if (calibrationReportPath_.empty()) {
         return;
     }
@@ -1147,7 +2448,8 @@ void ofApp::appendCalibrationReport(
         stream << "timestampUtc,sessionSeed,sampleRateHz,"
                << "gainCh1,gainDbCh1,gainSpecCh1,delaySamplesCh1,delaySpecCh1,phaseDegCh1,"
                << "gainCh2,gainDbCh2,gainSpecCh2,delaySamplesCh2,delaySpecCh2,phaseDegCh2,"
-               << "envelopeMean,envelopePeak,envelopeRatio,envelopeSpec\n";
+               << "envelopeMean,envelopePeak,envelopeRatio,envelopeSpec,"
+               << "envelopeMeanCh2,envelopePeakCh2,envelopeRatioCh2,envelopeSpecCh2\n";
     }
 
     stream << std::fixed << std::setprecision(6);
@@ -1157,21 +2459,24 @@ void ofApp::appendCalibrationReport(
            << values[0].gain << ',' << gainDbCh1 << ',' << okText(gainOkCh1) << ','
            << values[0].delaySamples << ',' << okText(delayOkCh1) << ',' << values[0].phaseDeg << ','
            << values[1].gain << ',' << gainDbCh2 << ',' << okText(gainOkCh2) << ','
-           << values[1].delaySamples << ',' << okText(delayOkCh2) << ',' << values[1].phaseDeg << ',';
-
-    if (envelopeStats) {
-        const float mean = envelopeStats->mean;
-        const float peak = envelopeStats->peak;
-        const float ratio = (mean > 1e-6f) ? (peak / mean) : 0.0f;
-        const bool envOk = envelopeStats->valid && ratio >= 1.15f;
-        stream << mean << ',' << peak << ',' << ratio << ',' << okText(envOk) << '\n';
-        if (!envOk) {
-            ofLogWarning("ofApp") << "Envelope calibration below target ratio: " << ratio
-                                   << " (mean=" << mean << ", peak=" << peak << ")";
+           << values[1].delaySamples << ',' << okText(delayOkCh2) << ',' << values[1].phaseDeg;
+
+    // P1's envelope columns keep their original names; P2's follow with a Ch2 suffix.
+    for (std::size_t channel = 0; channel < 2; ++channel) {
+        if (envelopeStats) {
+            const auto& stats = (*envelopeStats)[channel];
+            const float ratio = envelopeRatio(stats);
+            const bool envOk = stats.valid && ratio >= 1.15f;
+            stream << ',' << stats.mean << ',' << stats.peak << ',' << ratio << ',' << okText(envOk);
+            if (!envOk) {
+                ofLogWarning("ofApp") << "Envelope calibration below target ratio on P" << channel + 1 << ": "
+                                       << ratio << " (mean=" << stats.mean << ", peak=" << stats.peak << ")";
+            }
+        } else {
+            stream << ",NA,NA,NA,NA";
         }
-    } else {
-        stream << "NA,NA,NA,NA\n";
     }
+    stream << '\n';
 
     if (!(gainOkCh1 && gainOkCh2 && delayOkCh1 && delayOkCh2)) {
         ofLogWarning("ofApp") << "Calibration quality degraded (proceeding anyway)."
@@ -1182,18 +2487,19 @@ void ofApp::appendCalibrationReport(
     }
 }
 
-void ofApp::logEnvelopeCalibrationResult(const knot::audio::EnvelopeCalibrationStats& stats) {
-    const float mean = stats.mean;
-    const float peak = stats.peak;
-    const float ratio = (mean > 1e-6f) ? (peak / mean) : 0.0f;
-    ofLogNotice("ofApp") << "Envelope calibration completed."
-                           << " mean=" << mean
-                           << " peak=" << peak
-                           << " ratio=" << ratio
-                           << " valid=" << (stats.valid ? "true" : "false");
+void ofApp::logEnvelopeCalibrationResult(const EnvelopeCalibrationPair& stats) {
+    for (std::size_t channel = 0; channel < stats.size(); ++channel) {
+        const float ratio = envelopeRatio(stats[channel]);
+        ofLogNotice("ofApp") << "Envelope calibration completed for P" << channel + 1 << "."
+                               << " mean=" << stats[channel].mean
+                               << " peak=" << stats[channel].peak
+                               << " ratio=" << ratio
+                               << " valid=" << (stats[channel].valid ? "true" : "false");
 
-    if (stats.valid && ratio < 1.15f) {
-        ofLogWarning("ofApp") << "Envelope ratio below recommended threshold. Consider再測定 or gain調整.";
+        if (stats[channel].valid && ratio < 1.15f) {
+            ofLogWarning("ofApp") << "Envelope ratio below recommended threshold on P" << channel + 1
+                                   << ". Consider再測定 or gain調整.";
+        }
     }
 
     appendCalibrationReport(audioPipeline_.calibrationResult(), stats);
@@ -1218,40 +2524,19 @@ void ofApp::handleTransitionEvent(const SceneController::TransitionEvent& event)
 
     // シーン遷移開始時の処理
     if (!event.completed) {
-        // ベル音を鳴らす(Start→FirstPhase, FirstPhase→Exchange等の主要遷移)
-        if (bellSoundLoaded_) {
-            const bool playBell = (event.to == SceneState::FirstPhase) ||
-                                  (event.to == SceneState::Exchange) ||
-                                  (event.to == SceneState::Mixed) ||
-                                  (event.to == SceneState::End);
-            if (playBell) {
-                bellSound_.play();
-                ofLogNotice("ofApp") << "Bell sound played for transition: "
-                                      << sceneStateToString(event.from) << " → "
-                                      << sceneStateToString(event.to);
-            }
-        }
-
-        // オーディオフェードアウト開始(心音交換シーンへの遷移時)
-        if (event.to == SceneState::Exchange || event.to == SceneState::Mixed) {
-            audioFadeStartTime_ = event.timestamp;
-            targetAudioFadeGain_ = 0.1f;  // 10%まで減衰
-            audioFading_ = true;
-            ofLogNotice("ofApp") << "Audio fade-out started for scene transition";
+        sessionRecorder_.mark(kSceneMarkerPrefix + sceneStateToString(event.to));
+        // タイムアウト遷移はシーン開始時に予約済み。それ以外(手動・予約外)は予約を取り直す
+        const bool alreadyScheduled = !event.manual && scheduledAutoTransition_ == event.to;
+        scheduledAutoTransition_.reset();
+        if (!alreadyScheduled) {
+            cancelScheduledSceneAudio();
+            scheduleTransitionAudio(event.from, event.to, event.timestamp, event.blendDuration);
         }
     }
 
-    // シーン遷移完了時の処理
+    // シーン遷移完了時の処理: シーン内ステージと次のタイムアウト遷移を出力クロック上に予約する
     if (event.completed) {
-        // オーディオフェードイン(Exchange/Mixed完了後)
-        if (event.to == SceneState::Exchange || event.to == SceneState::Mixed) {
-            audioFadeStartTime_ = event.timestamp;
-            targetAudioFadeGain_ = 1.0f;  // 100%に復帰
-            audioFading_ = true;
-            ofLogNotice("ofApp") << "Audio fade-in started after scene transition";
-        }
-        audioRouter_.applyScenePreset(event.to);
-        ofLogNotice("ofApp") << "Audio routing preset reapplied for scene: " << sceneStateToString(event.to);
+        scheduleSceneAudio(event.to, event.timestamp);
     }
 
     if (!event.manual && sceneTimingConfig_) {
@@ -1324,6 +2609,8 @@ std::string ofApp::makeCalibrationStatusText() const {
     std::ostringstream oss;
     if (audioPipeline_.isCalibrationActive()) {
         oss << "running";
+    } else if (audioPipeline_.isCalibrationCheckActive()) {
+        oss << "verifying";
     } else if (audioPipeline_.calibrationReady()) {
         oss << "ready";
         if (!calibrationSaved_) {
@@ -1336,14 +2623,15 @@ std::string ofApp::makeCalibrationStatusText() const {
     if (!calibrationReportPath_.empty()) {
         oss << " → " << calibrationReportPath_;
     }
+    if (latencySweep_.active) {
+        oss << " | latency " << latencySweep_.step + 1 << '/' << latencySweep_.results.size();
+    }
     if (envelopeCalibrationRunning_) {
         oss << " | env=calibrating";
     } else if (lastEnvelopeCalibrationStats_) {
-        const float ratio = (lastEnvelopeCalibrationStats_->mean > 1e-6f)
-                                ? (lastEnvelopeCalibrationStats_->peak / lastEnvelopeCalibrationStats_->mean)
-                                : 0.0f;
-        oss << " | env=" << std::fixed << std::setprecision(3) << lastEnvelopeCalibrationStats_->mean
-            << " (ratio=" << ratio << ')';
+        const auto& stats = *lastEnvelopeCalibrationStats_;
+        oss << " | env=" << std::fixed << std::setprecision(3) << stats[0].mean << '/' << stats[1].mean
+            << " (ratio=" << envelopeRatio(stats[0]) << '/' << envelopeRatio(stats[1]) << ')';
         oss << std::defaultfloat;
     }
     return oss.str();
@@ -1645,9 +2933,13 @@ void ofApp::drawFirstPhaseScene(float alpha, double nowSeconds) {
     const ofRectangle graphArea(panelRight + margin, margin, availableWidth, graphHeight);
     drawEnvelopeGraph(graphArea);
 
+    const ofRectangle scopeArea(panelRight + margin, graphArea.getBottom() + margin, availableWidth,
+                                graphHeight * 0.6f);
+    drawEnvelopeScope(scopeArea);
+
     const float logHeight =
-        std::max(160.0f, static_cast<float>(ofGetHeight()) - graphArea.getBottom() - margin * 2.0f);
-    const ofRectangle logArea(panelRight + margin, graphArea.getBottom() + margin, availableWidth, logHeight);
+        std::max(160.0f, static_cast<float>(ofGetHeight()) - scopeArea.getBottom() - margin * 2.0f);
+    const ofRectangle logArea(panelRight + margin, scopeArea.getBottom() + margin, availableWidth, logHeight);
     drawHapticLog(logArea, nowSeconds);
 
     ofPopStyle();
@@ -1794,37 +3086,56 @@ void ofApp::drawEnvelopeGraph(const ofRectangle& area) const {
     ofSetColor(255, 255, 255, 160);
     ofDrawRectangle(area);
 
-    const auto& aggregateSamples = envelopeHistory_.samples();
-    if (aggregateSamples.size() < 2) {
+    if (envelopeHistory_.size() < 2) {
         ofPopStyle();
         return;
     }
 
-    const double start = aggregateSamples.front().timestampSec;
-    const double end = aggregateSamples.back().timestampSec;
+    const double start = envelopeHistory_.frontTimestamp();
+    const double end = envelopeHistory_.backTimestamp();
     const double span = std::max(end - start, 1.0);
 
-    auto drawSeries = [&](const std::deque<BeatVisualMetrics>& samples, const ofColor& color) {
-        if (samples.size() < 2) {
-            return;
-        }
-        ofPolyline line;
-        for (const auto& sample : samples) {
-            const double norm = (sample.timestampSec - start) / span;
-            const float x = static_cast<float>(area.x + std::clamp(norm, 0.0, 1.0) * area.width);
-            const float y = static_cast<float>(area.getBottom() - sample.envelope * area.height);
-            line.addVertex(x, y);
-        }
-        ofSetColor(color);
-        line.draw();
-    };
+    ofSetColor(ofColor(90, 200, 255, 200));
+    participantEnvelopeLines_[0].draw(participantEnvelopeHistory_[0], area, start, span);
+    ofSetColor(ofColor(255, 150, 200, 200));
+    participantEnvelopeLines_[1].draw(participantEnvelopeHistory_[1], area, start, span);
+    ofSetColor(ofColor(200, 255, 180, 160));
+    envelopeLine_.draw(envelopeHistory_, area, start, span);
 
-    drawSeries(participantEnvelopeHistory_[0].samples(), ofColor(90, 200, 255, 200));
-    drawSeries(participantEnvelopeHistory_[1].samples(), ofColor(255, 150, 200, 200));
-    drawSeries(aggregateSamples, ofColor(200, 255, 180, 160));
+    const auto stats = envelopeHistory_.envelopeStats();
+    ofSetColor(255, 200);
+    ofDrawBitmapString("Envelope P1/P2 (" + ofToString(span, 1) + "s) peak=" + ofToString(stats.max, 2) +
+                           " mean=" + ofToString(stats.mean, 2),
+                       area.x + 4.0f, area.y + 16.0f);
+    ofPopStyle();
+}
+
+void ofApp::drawEnvelopeScope(const ofRectangle& area) const {
+    ofPushStyle();
+    ofFill();
+    ofSetColor(8, 12, 20, 200);
+    ofDrawRectangle(area);
+    ofNoFill();
+    ofSetColor(255, 255, 255, 140);
+    ofDrawRectangle(area);
+
+    ofPushMatrix();
+    ofTranslate(area.x, area.getBottom());
+    ofScale(area.width, -area.height / std::max(scopeScale_, 1e-3f));
+    ofSetLineWidth(1.0f);
+    ofSetColor(90, 200, 255, 200);
+    scopeEnvelopeMeshes_[0].draw();
+    ofSetColor(255, 150, 200, 200);
+    scopeEnvelopeMeshes_[1].draw();
+    ofSetColor(120, 220, 255, 120);
+    scopeThresholdMeshes_[0].draw();
+    ofSetColor(255, 180, 220, 120);
+    scopeThresholdMeshes_[1].draw();
+    ofPopMatrix();
 
     ofSetColor(255, 200);
-    ofDrawBitmapString("Envelope P1/P2 (" + ofToString(span, 1) + "s)", area.x + 4.0f, area.y + 16.0f);
+    ofDrawBitmapString("Envelope scope 1ms (" + ofToString(kEnvelopeScopeWindowSec, 1) + "s) + threshold",
+                       area.x + 4.0f, area.y + 16.0f);
     ofPopStyle();
 }
 
@@ -1931,7 +3242,7 @@ bool ofApp::isInteractionLocked() const {
         return true;
     }
 
-    const double nowSeconds = ofGetElapsedTimef();
+    const double nowSeconds = sceneClockSeconds();
     const SceneState current = sceneController_.currentState();
     const double timeInStateSec = sceneController_.timeInState(nowSeconds);
 
@@ -1992,16 +3303,16 @@ std::string ofApp::buildGuidanceMessage(double /*nowSeconds*/) const {
     if (envelopeCalibrationRunning_) {
         return "包絡キャリブレーションを実行中です。周囲を静かにして 3 秒ほどお待ちください。";
     }
-    if (lastEnvelopeCalibrationStats_ && !lastEnvelopeCalibrationStats_->valid) {
-        return "包絡ベースラインが取得できていません。再測定し、入力レベルを確認してください。";
-    }
-    if (lastEnvelopeCalibrationStats_ && lastEnvelopeCalibrationStats_->valid) {
-        const float mean = lastEnvelopeCalibrationStats_->mean;
-        const float ratio = (mean > 1e-6f)
-                                ? (lastEnvelopeCalibrationStats_->peak / mean)
-                                : 0.0f;
-        if (ratio < 1.15f) {
-            return "包絡比が低下しています。マイクゲインか胸ピースの固定を見直してください。";
+    if (lastEnvelopeCalibrationStats_) {
+        for (const auto& stats : *lastEnvelopeCalibrationStats_) {
+            if (!stats.valid) {
+                return "包絡ベースラインが取得できていません。再測定し、入力レベルを確認してください。";
+            }
+        }
+        for (const auto& stats : *lastEnvelopeCalibrationStats_) {
+            if (envelopeRatio(stats) < 1.15f) {
+                return "包絡比が低下しています。マイクゲインか胸ピースの固定を見直してください。";
+            }
         }
     }
     if (weakSignalWarning_) {
@@ -2010,6 +3321,12 @@ std::string ofApp::buildGuidanceMessage(double /*nowSeconds*/) const {
     if (signalHealth_.fallbackActive) {
         return "実入力が不安定なため推定波形を表示中です。マイク接続とゲインを点検してください。";
     }
+    for (std::size_t channel = 0; channel < signalHealth_.crosstalkLeakageDb.size(); ++channel) {
+        if (signalHealth_.crosstalkConverged && signalHealth_.crosstalkLeakageDb[channel] > -10.0f &&
+            signalHealth_.crosstalkResidualDb[channel] > -6.0f) {
+            return "聴診器間のクロストークが除去しきれていません。2 台の距離を離すか、胸ピースの固定を見直してください。";
+        }
+    }
     if (simulateTelemetry_) {
         return "シミュレーション信号を再生中です。実入力を確認するには Synthetic Signal を OFF にしてください。";
     }
@@ -2055,14 +3372,16 @@ void ofApp::drawCalibrationStatus() const {
         oss << std::defaultfloat;
         lines.push_back({oss.str(), ofColor(255, 210, 150)});
     } else if (lastEnvelopeCalibrationStats_) {
-        const auto& stats = *lastEnvelopeCalibrationStats_;
-        const float ratio = (stats.mean > 1e-6f) ? (stats.peak / stats.mean) : 0.0f;
-        std::ostringstream oss;
-        oss << "包絡ベースライン: mean=" << std::fixed << std::setprecision(3) << stats.mean
-            << " peak=" << stats.peak << " ratio=" << ratio;
-        oss << std::defaultfloat;
-        lines.push_back({oss.str(), stats.valid && ratio >= 1.15f ? ofColor(160, 240, 160)
-                                                                  : ofColor(255, 200, 140)});
+        for (std::size_t channel = 0; channel < lastEnvelopeCalibrationStats_->size(); ++channel) {
+            const auto& stats = (*lastEnvelopeCalibrationStats_)[channel];
+            const float ratio = envelopeRatio(stats);
+            std::ostringstream oss;
+            oss << "包絡ベースライン P" << channel + 1 << ": mean=" << std::fixed << std::setprecision(3)
+                << stats.mean << " peak=" << stats.peak << " ratio=" << ratio;
+            oss << std::defaultfloat;
+            lines.push_back({oss.str(), stats.valid && ratio >= 1.15f ? ofColor(160, 240, 160)
+                                                                      : ofColor(255, 200, 140)});
+        }
     } else {
         lines.push_back({"包絡ベースライン: 未測定 — Envelope Baseline 計測 を実行してください", ofColor(255, 200, 150)});
     }
@@ -2078,6 +3397,41 @@ void ofApp::drawCalibrationStatus() const {
         oss << std::defaultfloat;
         lines.push_back({oss.str(), ofColor(255, 220, 140)});
     }
+    if (signalHealth_.beatTrackerLocked[0] || signalHealth_.beatTrackerLocked[1]) {
+        std::ostringstream oss;
+        oss << "拍予測:";
+        for (std::size_t channel = 0; channel < signalHealth_.beatTrackerLocked.size(); ++channel) {
+            oss << " P" << channel + 1 << " ";
+            if (signalHealth_.beatTrackerLocked[channel]) {
+                oss << std::fixed << std::setprecision(0) << signalHealth_.trackedBpm[channel] << "BPM"
+                    << (signalHealth_.beatFallbackActive[channel] ? "(推定継続)" : "");
+            } else {
+                oss << "-";
+            }
+        }
+        oss << std::defaultfloat;
+        lines.push_back({oss.str(), ofColor(200, 220, 255)});
+    }
+    if (signalHealth_.baselineFloor[0] > 0.0f || signalHealth_.baselineFloor[1] > 0.0f) {
+        std::ostringstream oss;
+        oss << "背景追従:" << std::fixed << std::setprecision(4);
+        for (std::size_t channel = 0; channel < signalHealth_.baselineFloor.size(); ++channel) {
+            oss << " P" << channel + 1 << " med=" << signalHealth_.baselineMedian[channel]
+                << " MAD=" << signalHealth_.baselineMad[channel] << " floor=" << signalHealth_.baselineFloor[channel];
+        }
+        oss << std::defaultfloat;
+        lines.push_back({oss.str(), ofColor(200, 220, 255)});
+    }
+    const auto& leakage = signalHealth_.crosstalkLeakageDb;
+    if (std::max(leakage[0], leakage[1]) > -30.0f) {
+        const auto& residual = signalHealth_.crosstalkResidualDb;
+        std::ostringstream oss;
+        oss << "クロストーク: P1<-P2 " << std::fixed << std::setprecision(1) << leakage[0] << "dB (除去 "
+            << residual[0] << "dB) / P2<-P1 " << leakage[1] << "dB (除去 " << residual[1] << "dB) "
+            << (signalHealth_.crosstalkConverged ? "収束" : "適応中");
+        oss << std::defaultfloat;
+        lines.push_back({oss.str(), signalHealth_.crosstalkConverged ? ofColor(200, 220, 255) : ofColor(255, 220, 140)});
+    }
 
     if (simulateTelemetry_) {
         lines.push_back({"情報: シミュレーション信号が有効です。Synthetic Signal を OFF にすると実入力をモニタできます。",
@@ -2105,7 +3459,9 @@ void ofApp::drawBeatDebug() const {
     oss << "Limiter減衰: " << std::fixed << std::setprecision(1) << limiterReductionDbSmooth_ << " dB"
         << " / BPM: " << std::setprecision(1) << latestMetrics_.bpm
         << " / Envelope: " << std::setprecision(2) << latestMetrics_.envelope
-        << " / Haptic/min: " << std::setprecision(1) << hapticRateParam_.get();
+        << " / Haptic/min: " << std::setprecision(1) << hapticRateParam_.get()
+        << " / 入力ゲイン" << (appConfig_.audio.inputAgc ? "(AGC)" : "") << ": P1 "
+        << pipelineSnapshot_.channels[0].inputGainDb << " dB P2 " << pipelineSnapshot_.channels[1].inputGainDb << " dB";
     ofSetColor(210, 210, 220);
     ofDrawBitmapString(oss.str(), margin, ofGetHeight() - margin);
     ofPopStyle();
@@ -7,16 +7,24 @@
 #include "HapticLog.h"
 #include "SceneController.h"
 #include "SceneTimingConfig.h"
+#include "ShaderProgram.h"
 #include "audio/AudioPipeline.h"
 #include "audio/AudioRouter.h"
+#include "audio/RealtimeSafety.h"
+#include "audio/SyntheticHeartSource.h"
+#include "infra/AudioDeviceMonitor.h"
+#include "infra/ConfigWatcher.h"
 #include "infra/SceneTransitionLogger.h"
 #include "infra/TelemetryLogging.h"
+#include "infra/TelemetryStreamer.h"
 
 #include <array>
+#include <atomic>
 #include <filesystem>
 #include <optional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 class ofApp : public ofBaseApp {
@@ -41,7 +49,26 @@ public:
     void audioIn(ofSoundBuffer& input) override;
     void audioOut(ofSoundBuffer& output) override;
 
+    /// Replays a raw-input recording in place of the input device. Call before ofRunApp(); the
+    /// output device still clocks playback, so it runs at 1x.
+    void setReplayFile(const std::filesystem::path& wavPath);
+    /// Runs a recording through a fresh pipeline as fast as possible without a window or audio
+    /// devices, writing detected beats next to the recording. Returns a process exit code.
+    static int runHeadlessReplay(const std::filesystem::path& wavPath);
+    /// Soak test / CPU benchmark: runs the given number of simulated participants (in pairs, one
+    /// pipeline per pair) through fresh pipelines for simulatedSeconds as fast as possible, and
+    /// logs per-block CPU time, beat detection against the generator's ground truth and realtime
+    /// violations. Returns a process exit code.
+    static int runSyntheticBenchmark(std::size_t participants, double simulatedSeconds);
+    /// Integration test for the telemetry streamer: streams synthetic beats and envelopes with
+    /// the configured rates to a receiver on 127.0.0.1 (see TelemetryStreamer::runLoopbackCheck()).
+    /// Returns a process exit code, non-zero when a beat was lost.
+    static int runStreamingCheck();
+
 private:
+    /// Envelope baseline per participant (index 0 = P1), as measured together.
+    using EnvelopeCalibrationPair = std::array<knot::audio::EnvelopeCalibrationStats, 2>;
+
     // GUI callbacks
     void onStartButtonPressed();
     void onEndButtonPressed();
@@ -51,11 +78,11 @@ private:
     // Update helpers
     void updateSceneGui(double nowSeconds);
     void updateEnvelopeHistories(double nowSeconds);
+    void updateEnvelopeScope();
     void updateFakeSignal(double nowSeconds);
     void applyBeatMetrics(knot::audio::ParticipantId participant,
                           const knot::audio::AudioPipeline::ChannelMetrics& metrics, double nowSeconds);
-    void handleBeatEvents(knot::audio::ParticipantId participant,
-                          const std::vector<knot::audio::BeatEvent>& events, double nowSeconds);
+    void handleBeatEvent(const knot::audio::BeatEvent& evt, double nowSeconds);
     void appendHapticEvent(double nowSeconds, float intensity, const std::string& label);
     void updateEnvelopeCalibrationUi(double nowSeconds);
     void initializeSessionSeed();
@@ -70,27 +97,35 @@ private:
     void drawMixedScene(float alpha, double nowSeconds);
     void drawEndScene(float alpha);
     void drawEnvelopeGraph(const ofRectangle& area) const;
+    void drawEnvelopeScope(const ofRectangle& area) const;
     void drawHapticLog(const ofRectangle& area, double nowSeconds) const;
     void drawHapticChart(const ofRectangle& area, double nowSeconds) const;
     void drawCalibrationStatus() const;
     void drawBeatDebug() const;
     void appendCalibrationReport(const std::array<knot::audio::ChannelCalibrationValue, 2>& values,
-                                 const std::optional<knot::audio::EnvelopeCalibrationStats>& envelopeStats);
+                                 const std::optional<EnvelopeCalibrationPair>& envelopeStats);
     std::string makeCalibrationStatusText() const;
     bool isInteractionLocked() const;
     std::string buildGuidanceMessage(double nowSeconds) const;
     float computeHapticRatePerMinute(double nowSeconds) const;
-    void logEnvelopeCalibrationResult(const knot::audio::EnvelopeCalibrationStats& stats);
+    void logEnvelopeCalibrationResult(const EnvelopeCalibrationPair& stats);
     void processSceneTransitionEvents();
     void handleTransitionEvent(const SceneController::TransitionEvent& event);
     bool shouldDrawControlPanel() const;
     bool shouldDrawStatusPanel() const;
     void updateCornerUnlock(double nowSeconds, int x, int y);
+    void startStartupLoader();
+    void advanceStartup();
+    void attachStartupAssets();
+    void advanceStartupGraphics();
     void loadShaders();
     void drawStarfieldLayer(float alpha, double nowSeconds, float envelopeP1, float envelopeP2);
     void drawRippleLayer(float alpha, double nowSeconds, float envelopeP1, float envelopeP2);
     float blendedEnvelope() const;
     void refreshAudioDeviceList();
+    void applyAudioDeviceList(const std::vector<ofSoundDevice>& devices);
+    void superviseAudioDevices(std::uint64_t nowMicros);
+    void reopenLostAudioDevices(std::uint64_t nowMicros, const infra::AudioDeviceMonitor::DeviceList& devices);
     void updateAudioDeviceLabels();
     void selectNextInputDevice(int delta);
     void selectNextOutputDevice(int delta);
@@ -102,6 +137,35 @@ private:
     void onApplyAudioDevices();
     void shutdownSoundStream();
     bool setupSoundStreamWithSelection();
+    void selectCalibrationProfile();
+    void handleCalibrationCheck(const knot::audio::CalibrationCheck& check);
+    void startFullCalibration();
+    void reportRealtimeViolations(double nowSeconds);
+    void scheduleBellCue(double atSeconds);
+    void pollCueReports();
+    double sceneClockSeconds() const;
+    std::uint64_t sceneTimelineSample(double sceneSeconds) const;
+    void cancelScheduledSceneAudio();
+    void scheduleSceneAudio(SceneState scene, double enteredAt);
+    void scheduleTransitionAudio(SceneState from, SceneState to, double startAt, double blendDuration);
+    void rescheduleCurrentSceneAudio();
+    void applyGuiConfig();
+    void startConfigWatcher();
+    void applyPendingConfigReloads();
+    void applyAppConfigReload(const infra::AppConfig& next);
+    void startSessionRecording();
+    void startReplay();
+    void feedReplayInput(std::size_t numFrames);
+    void applyReplayMarkers();
+    void feedSyntheticInput(std::size_t numFrames);
+    void pumpSyntheticPipeline(std::uint64_t nowMicros);
+    void startTelemetryStreaming();
+    void publishStreamStatus();
+    void startLatencySweep();
+    void updateLatencySweep(std::uint64_t nowMicros);
+    void beginLatencySweepStep(std::uint64_t nowMicros);
+    void finishLatencySweep();
+    void applyPredictiveHaptics();
 
     // UI + state
     SceneController sceneController_;
@@ -112,10 +176,16 @@ private:
     std::array<float, 2> participantEnvelopes_{0.0f, 0.0f};
     std::array<float, 2> participantBpms_{0.0f, 0.0f};
     std::array<BeatEnvelopeHistory, 2> participantEnvelopeHistory_;
+    EnvelopeLineStream envelopeLine_;
+    std::array<EnvelopeLineStream, 2> participantEnvelopeLines_;
+    std::vector<knot::audio::ScopeBucket> scopeScratch_;
+    std::array<ofMesh, 2> scopeEnvelopeMeshes_;
+    std::array<ofMesh, 2> scopeThresholdMeshes_;
+    float scopeScale_ = 0.05f;
     knot::audio::AudioPipeline::SignalHealth signalHealth_{};
     bool lastFallbackActive_ = false;
     float displayEnvelope_ = 0.0f;
-    std::shared_ptr<SceneTimingConfig> sceneTimingConfig_;
+    std::shared_ptr<const SceneTimingConfig> sceneTimingConfig_;
     infra::SceneTransitionLogger sceneTransitionLogger_;
 
     ofxPanel controlPanel_;
@@ -161,6 +231,48 @@ private:
     infra::AppConfig appConfig_;
     std::unique_ptr<infra::SessionLogger> sessionLogger_;
     std::unique_ptr<infra::HapticEventLogger> hapticLogger_;
+    // Hot reload: the watcher thread parses and validates, then atomic_store()s the result here;
+    // update() takes it with atomic_exchange() and applies it on the UI thread.
+    infra::ConfigWatcher configWatcher_;
+    std::shared_ptr<const SceneTimingConfig> pendingSceneTiming_;
+    std::shared_ptr<const infra::AppConfig> pendingAppConfig_;
+    std::shared_ptr<const knot::audio::AudioRouter::ScenePresetTable> pendingRoutingPresets_;
+    // Raw input recording (recording.enabled) and its replay (--replay).
+    knot::audio::SessionRecorder sessionRecorder_;
+    knot::audio::SessionReplayer sessionReplayer_;
+    std::filesystem::path replayPath_;
+    ofSoundBuffer replayInput_;
+    std::size_t replayMarkerIndex_ = 0;
+    bool replayEndLogged_ = false;
+    // "Synthetic Signal": generated stethoscope input in place of the input device. With no device
+    // open, update() pumps the pipeline itself at wall-clock rate.
+    knot::audio::SyntheticHeartSource syntheticSource_;
+    ofSoundBuffer syntheticInput_;
+    ofSoundBuffer syntheticOutput_;
+    std::atomic<bool> syntheticInputActive_{false};
+    std::uint64_t lastSyntheticPumpMicros_ = 0;
+    // Staged startup: setup() opens the stream with the router in direct mode and returns. The
+    // loader thread reads the HRIR set, routing presets and bell cue and atomic_store()s them
+    // here for update() to attach; shaders and fonts load on the GL thread, one stage per frame
+    // once the first frame is up.
+    struct StartupAssets {
+        std::shared_ptr<const knot::audio::HrirDatabase> hrirDatabase;
+        std::shared_ptr<const knot::audio::AudioRouter::ScenePresetTable> routingPresets;
+        std::string routingPresetError;
+        std::optional<std::uint32_t> bellCueId;
+        std::uint64_t hrirLoadMicros = 0;
+    };
+    enum class GraphicsStage { Shaders, DisplayFont, GuideFont, Ready };
+    std::thread startupLoader_;
+    std::shared_ptr<StartupAssets> pendingStartupAssets_;
+    bool startupAssetsAttached_ = false;
+    GraphicsStage graphicsStage_ = GraphicsStage::Shaders;
+    std::atomic<std::uint64_t> firstAudioMicros_{0};  // since launch, set by the first audioOut()
+    infra::StartupTimingFrame startupTiming_;
+    bool startupTimingLogged_ = false;
+    // OSC/UDP telemetry for external visualisers (streaming.enabled).
+    infra::TelemetryStreamer telemetryStreamer_;
+    std::uint64_t streamStatusSequence_ = 0;
     std::uint64_t lastTelemetryMicros_ = 0;
     std::uint64_t sessionStartMicros_ = 0;
     std::uint64_t beatCounter_ = 0;
@@ -170,16 +282,27 @@ private:
     ofSoundStream soundStream_;
     bool soundStreamActive_ = false;
     knot::audio::AudioPipeline audioPipeline_;
+    knot::audio::AudioPipeline::PipelineSnapshot pipelineSnapshot_{};
+    knot::audio::BeatEventBus::Subscriber beatEventSubscriber_;
+    std::uint64_t reportedBeatEventOverflow_ = 0;
     std::filesystem::path calibrationFilePath_;
     std::filesystem::path calibrationReportPath_;
     std::filesystem::path sessionSeedPath_;
     double sampleRate_ = 48000.0;
     std::size_t bufferSize_ = 512;
+    std::size_t numBuffers_ = 4;
+    // Round trip + detection from the last latency sweep at the configured buffer settings
+    // (0 = not measured); the haptic lead when audio.hapticLeadMs is 0.
+    double measuredHapticLeadMs_ = 0.0;
     bool calibrationSaved_ = false;
     bool calibrationSaveAttempted_ = false;
     bool calibrationReportAppended_ = false;
+    // Per-device calibration: profiles keyed by the open stream, chosen whenever it changes and
+    // verified with a short burst before use (see selectCalibrationProfile()).
+    knot::audio::CalibrationStore calibrationStore_;
+    std::optional<knot::audio::CalibrationProfileKey> calibrationProfileKey_;
     bool envelopeCalibrationRunning_ = false;
-    std::optional<knot::audio::EnvelopeCalibrationStats> lastEnvelopeCalibrationStats_;
+    std::optional<EnvelopeCalibrationPair> lastEnvelopeCalibrationStats_;
     float limiterReductionDbSmooth_ = 0.0f;
     double lastStrongSignalAt_ = 0.0;
     bool weakSignalWarning_ = false;
@@ -194,27 +317,60 @@ private:
     bool allowCornerUnlock_ = false;
     std::vector<std::pair<double, glm::vec2>> cornerTouches_;
     double cornerUnlockWindowSec_ = 5.0;
-    ofShader starfieldShader_;
-    ofShader torusShader_;
-    ofShader rippleShader_;
+    ShaderProgram starfieldShader_;
+    ShaderProgram torusShader_;
+    ShaderProgram rippleShader_;
     bool starfieldShaderLoaded_ = false;
     bool torusShaderLoaded_ = false;
     bool rippleShaderLoaded_ = false;
-    ofSoundPlayer bellSound_;
-    bool bellSoundLoaded_ = false;
-    float audioFadeGain_ = 1.0f;
-    float targetAudioFadeGain_ = 1.0f;
-    double audioFadeStartTime_ = 0.0;
+    std::optional<std::uint32_t> bellCueId_;
+    knot::audio::CueReportBus::Subscriber cueReportSubscriber_;
+    struct CueTimingStats {
+        std::uint64_t started = 0;
+        std::uint64_t late = 0;
+        std::uint64_t dropped = 0;
+        double sumLateMs = 0.0;
+        double maxLateMs = 0.0;
+    } cueTimingStats_;
     double audioFadeDuration_ = 10.0;
-    bool audioFading_ = false;
+    mutable double lastSceneClockSeconds_ = 0.0;
+    std::optional<SceneState> scheduledAutoTransition_;
     knot::audio::AudioRouter audioRouter_;
-    ofSoundBuffer stereoScratch_;
-    std::array<float, 2> envelopeFrame_{0.0f, 0.0f};
-    std::array<float, 2> headphoneFrame_{0.0f, 0.0f};
-    std::array<float, 4> routedFrame_{0.0f, 0.0f, 0.0f, 0.0f};
+    std::shared_ptr<const knot::audio::HrirDatabase> hrirDatabase_;
+    knot::audio::rt::ViolationCounts reportedRealtimeViolations_{};
+    double lastRealtimeReportAt_ = 0.0;
     std::vector<ofSoundDevice> inputDevices_;
     std::vector<ofSoundDevice> outputDevices_;
     int selectedInputDevice_ = -1;
     int selectedOutputDevice_ = -1;
     int configuredOutputChannels_ = 4;
+    // Hot-plug: the monitor re-enumerates in the background; superviseAudioDevices() notices a
+    // vanished device or a stalled callback and reopens the stream once the devices are back.
+    infra::AudioDeviceMonitor audioDeviceMonitor_;
+    std::uint64_t audioDeviceGeneration_ = 0;
+    std::string activeInputDeviceName_;
+    std::string activeOutputDeviceName_;
+    std::uint64_t lastAudioBlockIndex_ = 0;
+    std::uint64_t lastAudioBlockMicros_ = 0;
+    bool audioDeviceLost_ = false;
+    std::uint64_t audioDeviceLostMicros_ = 0;
+    std::uint64_t nextAudioReopenMicros_ = 0;
+    std::string audioDeviceLossReason_;
+    // Loopback latency sweep ('l'): every bufferSize/numBuffers candidate gets a reopened stream
+    // and one LatencyProbe run; the configured settings are restored afterwards.
+    struct LatencySweepResult {
+        std::size_t bufferSize = 0;
+        std::size_t numBuffers = 0;
+        bool opened = false;
+        bool completed = false;
+        knot::audio::LatencyReport report;
+    };
+    struct LatencySweep {
+        bool active = false;
+        std::vector<LatencySweepResult> results;
+        std::size_t step = 0;
+        std::uint64_t deadlineMicros = 0;
+        std::size_t configuredBufferSize = 0;
+        std::size_t configuredNumBuffers = 0;
+    } latencySweep_;
 };
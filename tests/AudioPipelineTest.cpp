@@ -0,0 +1,86 @@
+#include "AudioPipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr double kSampleRate = 48000.0;
+/// Monitor gain of the direct input in processOutput() (kSelfGainDb).
+const float kSelfGain = std::pow(10.0f, -15.0f / 20.0f);
+
+void setupQuiet(AudioPipeline& pipeline, std::size_t bufferSize) {
+    pipeline.setup(kSampleRate, bufferSize);
+    pipeline.setNoiseSeed(5);
+    pipeline.setInputAgc(false);
+    pipeline.setInputGainDb(0.0f);
+    pipeline.setCrosstalkCancellation(false);
+}
+
+float testSignal(std::size_t frame, std::size_t channel) {
+    // Small enough that the limiter never engages, distinct for every frame of the block.
+    return 0.01f * std::sin(0.0123f * static_cast<float>(frame) + static_cast<float>(channel));
+}
+
+/// The monitor path must line up every output frame with the input frame of the same index,
+/// including device blocks larger than the slice size the input is processed in; frames past
+/// the monitor capacity are silent. A pipeline fed with silence and the same noise seed gives
+/// the reference to subtract.
+void expectMonitorFollowsInput(std::size_t bufferSize, std::size_t blockFrames) {
+    AudioPipeline live;
+    AudioPipeline silent;
+    setupQuiet(live, bufferSize);
+    setupQuiet(silent, bufferSize);
+
+    std::vector<float> input(blockFrames * 2);
+    for (std::size_t frame = 0; frame < blockFrames; ++frame) {
+        input[frame * 2] = testSignal(frame, 0);
+        input[frame * 2 + 1] = testSignal(frame, 1);
+    }
+    const std::vector<float> zeros(blockFrames * 2, 0.0f);
+    std::vector<float> liveOut(blockFrames * 2);
+    std::vector<float> silentOut(blockFrames * 2);
+
+    const std::size_t capacity =
+        std::max(bufferSize, AudioPipeline::kMaxBlockFrames) * AudioPipeline::kMonitorSlices;
+    live.processInput(input.data(), blockFrames);
+    live.processOutput(liveOut.data(), blockFrames, 2, 0);
+    silent.processInput(zeros.data(), blockFrames);
+    silent.processOutput(silentOut.data(), blockFrames, 2, 0);
+
+    for (std::size_t frame = 0; frame < blockFrames; ++frame) {
+        for (std::size_t channel = 0; channel < 2; ++channel) {
+            const float monitored = liveOut[frame * 2 + channel] - silentOut[frame * 2 + channel];
+            const float expected = frame < capacity ? kSelfGain * testSignal(frame, channel) : 0.0f;
+            ASSERT_NEAR(monitored, expected, 1e-6f)
+                << "block " << blockFrames << " frame " << frame << " channel " << channel;
+        }
+    }
+}
+
+TEST(AudioPipeline, MonitorFollowsInputWithinOneSlice) {
+    expectMonitorFollowsInput(512, 512);
+}
+
+TEST(AudioPipeline, MonitorFollowsInputAcrossSlices) {
+    expectMonitorFollowsInput(512, 6000);
+}
+
+TEST(AudioPipeline, MonitorFollowsInputAtFullCapacity) {
+    expectMonitorFollowsInput(512, AudioPipeline::kMaxBlockFrames * AudioPipeline::kMonitorSlices);
+}
+
+TEST(AudioPipeline, MonitorIsSilentPastCapacity) {
+    expectMonitorFollowsInput(512, AudioPipeline::kMaxBlockFrames * AudioPipeline::kMonitorSlices + 1000);
+}
+
+TEST(AudioPipeline, MonitorCapacityFollowsLargeBufferSizes) {
+    expectMonitorFollowsInput(6000, 6000 * 3 + 17);
+}
+
+} // namespace
@@ -0,0 +1,139 @@
+#include "AudioRouter.h"
+#include "HrirDatabase.h"
+#include "RealtimeSafety.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr float kSampleRate = 48000.0f;
+constexpr std::size_t kBlockFrames = 256;
+
+/// Unit impulse on both ears for every direction: the binaural path is the input delayed by
+/// the convolver latency.
+std::shared_ptr<const HrirDatabase> impulseHrirSet() {
+    constexpr std::size_t kIrLength = 128;
+    const std::vector<float> azimuth = {-90.0f, 0.0f, 90.0f, 180.0f};
+    const std::vector<float> elevation(azimuth.size(), 0.0f);
+    std::vector<float> impulses(azimuth.size() * kIrLength, 0.0f);
+    for (std::size_t m = 0; m < azimuth.size(); ++m) {
+        impulses[m * kIrLength] = 1.0f;
+    }
+    auto database = std::make_shared<HrirDatabase>();
+    database->setImpulseResponses(azimuth, elevation, impulses, impulses, kIrLength);
+    return database;
+}
+
+/// CH1 plays participant 1 at 0 dB, binaural when an HRIR set is present; everything else is silent.
+void setBinauralSelfRule(AudioRouter& router) {
+    RoutingRule rule;
+    rule.source = ParticipantId::Participant1;
+    rule.mixMode = MixMode::Self;
+    rule.gainDb = 0.0f;
+    rule.binaural = true;
+    router.setRoutingRule(OutputChannel::CH1_HeadphoneLeft, rule);
+}
+
+/// Renders one block of constant input on participant 1 and writes CH1 to left.
+void renderBlock(AudioRouter& router, std::uint64_t& clock, float* left) {
+    const float input[2] = {1.0f, 0.0f};
+    const float envelopes[2] = {0.0f, 0.0f};
+    router.prepareBlock(clock, kBlockFrames);
+    for (std::size_t frame = 0; frame < kBlockFrames; ++frame) {
+        float out[AudioRouter::kOutputChannels] = {};
+        router.routeFrame(input, envelopes, 1.0f, nullptr, out, AudioRouter::kOutputChannels);
+        if (left) {
+            left[frame] = out[0];
+        }
+    }
+    clock += kBlockFrames;
+}
+
+TEST(AudioRouter, HrirSetArrivingMidStreamCrossfadesWithoutAllocating) {
+    AudioRouter router;
+    router.setup(kSampleRate);
+    setBinauralSelfRule(router);
+    std::uint64_t clock = 0;
+    constexpr std::size_t kSettleBlocks = 20;
+    constexpr std::size_t kSwitchBlocks = 40;
+    std::vector<float> rendered((kSettleBlocks + kSwitchBlocks) * kBlockFrames);
+    // Let the rule change settle on the direct path.
+    for (std::size_t block = 0; block < kSettleBlocks; ++block) {
+        renderBlock(router, clock, &rendered[block * kBlockFrames]);
+    }
+    const std::size_t switchFrame = kSettleBlocks * kBlockFrames;
+    ASSERT_NEAR(rendered[switchFrame - 1], 1.0f, 1e-6f);
+
+    router.setHrirDatabase(impulseHrirSet());
+    rt::resetViolations();
+    {
+        rt::ScopedAudioThread realtimeScope;
+        for (std::size_t block = kSettleBlocks; block < kSettleBlocks + kSwitchBlocks; ++block) {
+            renderBlock(router, clock, &rendered[block * kBlockFrames]);
+        }
+    }
+    EXPECT_EQ(rt::violations().total(), 0u);
+
+    // Direct path fades out while the binaural path (1.0 after the convolver latency) fades in:
+    // the output dips by at most the latency's share of the crossfade and never jumps.
+    float largestStep = 0.0f;
+    float lowest = 1.0f;
+    for (std::size_t frame = switchFrame; frame < rendered.size(); ++frame) {
+        largestStep = std::max(largestStep, std::fabs(rendered[frame] - rendered[frame - 1]));
+        lowest = std::min(lowest, rendered[frame]);
+    }
+    EXPECT_LT(largestStep, 0.01f);
+    EXPECT_GT(lowest, 0.9f);
+    EXPECT_NEAR(rendered.back(), 1.0f, 1e-4f);
+}
+
+TEST(AudioRouter, HrirSetInstalledBeforeSetupStartsBinaural) {
+    AudioRouter router;
+    router.setHrirDatabase(impulseHrirSet());
+    router.setup(kSampleRate);
+    setBinauralSelfRule(router);
+    std::uint64_t clock = 0;
+    std::vector<float> rendered(20 * kBlockFrames);
+    for (std::size_t block = 0; block < 20; ++block) {
+        renderBlock(router, clock, &rendered[block * kBlockFrames]);
+    }
+    // The binaural path carries the convolver latency, so the first frame is silent.
+    EXPECT_EQ(rendered.front(), 0.0f);
+    EXPECT_NEAR(rendered.back(), 1.0f, 1e-4f);
+}
+
+TEST(AudioRouter, HrirSetsSwappedFromAnotherThreadNeverBlockTheAudioThread) {
+    AudioRouter router;
+    router.setup(kSampleRate);
+    setBinauralSelfRule(router);
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> violations{0};
+    std::thread audio([&] {
+        std::uint64_t clock = 0;
+        rt::ScopedAudioThread realtimeScope;
+        const auto before = rt::violations().total();
+        while (!done.load(std::memory_order_acquire)) {
+            renderBlock(router, clock, nullptr);
+        }
+        violations.store(rt::violations().total() - before, std::memory_order_release);
+    });
+    for (int swap = 0; swap < 50; ++swap) {
+        router.setHrirDatabase(swap % 5 == 4 ? nullptr : impulseHrirSet());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    done.store(true, std::memory_order_release);
+    audio.join();
+    EXPECT_EQ(violations.load(std::memory_order_acquire), 0u);
+}
+
+} // namespace
@@ -0,0 +1,264 @@
+#include "BeatPredictor.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+// Trigger timing jitter of the detector, on top of a steady rhythm.
+constexpr double kJitterSec = 0.01;
+// Predictions from a tracked beat are held to a few jitters; a prediction a beat off would miss by
+// hundreds of ms. While coasting, the bound is three of the predictor's own reported sigmas.
+constexpr double kToleranceSec = 0.08;
+constexpr double kCoastSigmas = 3.0;
+
+/// Trigger times of a steady rhythm from firstSec to endSec with Gaussian jitter.
+std::vector<double> jitteredBeats(double periodSec, double firstSec, double endSec, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> jitter(0.0, kJitterSec);
+    std::vector<double> beats;
+    for (double beat = firstSec; beat < endSec; beat += periodSec) {
+        beats.push_back(beat + jitter(rng));
+    }
+    return beats;
+}
+
+/// Feeds the triggers in order, advancing the predictor every 10 ms in between as the pipeline
+/// does once per block. Records how far each prediction of the next beat, made just after a
+/// trigger, missed the trigger that followed. Returns the largest miss over beats from fromSec.
+double worstPredictionMissSec(BeatPredictor& predictor, const std::vector<double>& beats, double fromSec) {
+    double worst = 0.0;
+    double now = 0.0;
+    for (std::size_t i = 0; i < beats.size(); ++i) {
+        for (; now < beats[i]; now += 0.01) {
+            predictor.advance(now);
+        }
+        if (i > 0 && beats[i] >= fromSec) {
+            // The previous trigger's prediction is still the current one until this trigger lands.
+            EXPECT_TRUE(predictor.prediction().valid) << "beat " << i;
+            const double predicted = predictor.nextBeatAfter(beats[i - 1] + 0.01);
+            worst = std::max(worst, std::fabs(predicted - beats[i]));
+        }
+        predictor.observe(beats[i]);
+    }
+    return worst;
+}
+
+/// Locks on within three beats of a jittered 75 BPM rhythm and then predicts every next beat to
+/// within a few jitters.
+TEST(BeatPredictor, PredictsJitteredBeatsWithinTolerance) {
+    constexpr double kPeriod = 0.8;
+    BeatPredictor predictor;
+    const auto beats = jitteredBeats(kPeriod, 0.5, 40.0, 1);
+    EXPECT_FALSE(predictor.observe(beats[0]));
+    EXPECT_FALSE(predictor.observe(beats[1]));
+    EXPECT_TRUE(predictor.observe(beats[2]));
+    EXPECT_TRUE(predictor.prediction().valid);
+
+    predictor.reset();
+    EXPECT_LT(worstPredictionMissSec(predictor, beats, beats[3]), kToleranceSec);
+    const auto& prediction = predictor.prediction();
+    EXPECT_NEAR(prediction.periodSec, kPeriod, 0.02);
+    EXPECT_FALSE(prediction.coasting);
+    EXPECT_FLOAT_EQ(prediction.confidence, 1.0f);
+    EXPECT_LT(prediction.uncertaintySec, kToleranceSec);
+}
+
+/// Both participants lose their signal at the same time for 2.5 s (three of one's beats, two of
+/// the other's). Each predictor coasts on its own period, keeps predicting where the hidden beats
+/// fall, and takes the first beat after the dropout as a continuation instead of starting over.
+TEST(BeatPredictor, CoastsThroughDropoutForBothParticipants) {
+    constexpr double kDropoutStartSec = 20.0;
+    constexpr double kDropoutEndSec = 22.5;
+    constexpr std::array<double, 2> kPeriods{0.8, 1.1};
+    std::array<BeatPredictor, 2> predictors{};
+    std::array<std::vector<double>, 2> heard{};
+    std::array<std::vector<double>, 2> hidden{};
+    for (std::size_t participant = 0; participant < predictors.size(); ++participant) {
+        for (double beat : jitteredBeats(kPeriods[participant], 0.3 + 0.2 * participant, 40.0, 2 + participant)) {
+            (beat >= kDropoutStartSec && beat < kDropoutEndSec ? hidden : heard)[participant].push_back(beat);
+        }
+        ASSERT_GE(hidden[participant].size(), 2u);
+    }
+
+    std::array<std::size_t, 2> next{};
+    std::array<bool, 2> coasted{};
+    for (double now = 0.0; now < 40.0; now += 0.01) {
+        for (std::size_t participant = 0; participant < predictors.size(); ++participant) {
+            auto& predictor = predictors[participant];
+            const auto& beats = heard[participant];
+            for (; next[participant] < beats.size() && beats[next[participant]] <= now; ++next[participant]) {
+                const double beat = beats[next[participant]];
+                if (beat >= kDropoutEndSec && next[participant] > 0 &&
+                    beats[next[participant] - 1] < kDropoutStartSec) {
+                    // First beat after the dropout: predicted from before it and accepted.
+                    EXPECT_NEAR(predictor.nextBeatAfter(beat - 0.3 * kPeriods[participant]), beat,
+                                kCoastSigmas * predictor.prediction().uncertaintySec)
+                        << "participant " << participant;
+                    EXPECT_TRUE(predictor.observe(beat)) << "participant " << participant;
+                    EXPECT_FALSE(predictor.prediction().coasting);
+                    EXPECT_FLOAT_EQ(predictor.prediction().confidence, 1.0f);
+                    continue;
+                }
+                predictor.observe(beat);
+            }
+            predictor.advance(now);
+
+            const auto& prediction = predictor.prediction();
+            if (now >= kDropoutStartSec && now < kDropoutEndSec) {
+                EXPECT_TRUE(prediction.valid);
+                EXPECT_GE(prediction.confidence, 0.3f);
+                coasted[participant] = coasted[participant] || prediction.coasting;
+            }
+        }
+    }
+
+    for (std::size_t participant = 0; participant < predictors.size(); ++participant) {
+        EXPECT_TRUE(coasted[participant]) << "participant " << participant;
+        EXPECT_NEAR(predictors[participant].prediction().periodSec, kPeriods[participant], 0.02);
+    }
+}
+
+/// Coasting predictions fall on the hidden beats within their reported uncertainty, which grows
+/// with each missed beat but stays below half a period.
+TEST(BeatPredictor, CoastingPredictionsTrackHiddenBeats) {
+    constexpr double kPeriod = 0.8;
+    BeatPredictor predictor;
+    const auto beats = jitteredBeats(kPeriod, 0.5, 23.0, 4);
+    std::size_t lastHeard = 0;
+    for (std::size_t i = 0; i < beats.size() && beats[i] < 20.0; ++i) {
+        predictor.observe(beats[i]);
+        lastHeard = i;
+    }
+    double previousUncertainty = 0.0;
+    for (std::size_t i = lastHeard + 1; i < beats.size(); ++i) {
+        predictor.advance(beats[i] - 0.2 * kPeriod);
+        const auto& prediction = predictor.prediction();
+        ASSERT_TRUE(prediction.valid);
+        EXPECT_NEAR(predictor.nextBeatAfter(beats[i] - 0.2 * kPeriod), beats[i],
+                    kCoastSigmas * prediction.uncertaintySec);
+        EXPECT_GT(prediction.uncertaintySec, previousUncertainty);
+        EXPECT_LT(prediction.uncertaintySec, 0.5 * kPeriod);
+        previousUncertainty = prediction.uncertaintySec;
+    }
+    EXPECT_TRUE(predictor.prediction().coasting);
+}
+
+/// A jump from 75 to 100 BPM is beyond what the gate follows: the off-grid triggers are rejected,
+/// the filter restarts and locks on the new tempo within a few beats, then predicts it as well as
+/// the old one.
+TEST(BeatPredictor, RelocksAfterTempoChange) {
+    constexpr double kChangeSec = 20.0;
+    constexpr double kNewPeriod = 0.6;
+    auto beats = jitteredBeats(0.8, 0.5, kChangeSec, 5);
+    const auto faster = jitteredBeats(kNewPeriod, beats.back() + kNewPeriod, 40.0, 6);
+    const std::size_t firstFaster = beats.size();
+    beats.insert(beats.end(), faster.begin(), faster.end());
+
+    BeatPredictor predictor;
+    std::size_t relockedAt = 0;
+    for (std::size_t i = 0; i < beats.size(); ++i) {
+        predictor.advance(beats[i]);
+        const bool accepted = predictor.observe(beats[i]);
+        if (i >= firstFaster && relockedAt == 0 && accepted &&
+            std::fabs(predictor.prediction().periodSec - kNewPeriod) < 0.05) {
+            relockedAt = i;
+        }
+    }
+    ASSERT_GT(relockedAt, 0u);
+    EXPECT_LE(relockedAt - firstFaster, 6u);
+    EXPECT_NEAR(predictor.prediction().periodSec, kNewPeriod, 0.02);
+
+    // From a few beats after the relock on, predictions are as good as before the change.
+    BeatPredictor replay;
+    EXPECT_LT(worstPredictionMissSec(replay, beats, beats[relockedAt + 3]), kToleranceSec);
+}
+
+/// Every other beat missed while locking on leaves the filter on twice the period. Once the beats
+/// between come through, they split each predicted interval evenly; after two periods of that
+/// the filter halves its period instead of rejecting them for good.
+TEST(BeatPredictor, HalvesALockOnTwiceThePeriod) {
+    constexpr double kPeriod = 0.75;
+    const auto beats = jitteredBeats(kPeriod, 0.5, 40.0, 7);
+    BeatPredictor predictor;
+    std::size_t i = 0;
+    for (; i < 12; i += 2) {
+        predictor.advance(beats[i]);
+        predictor.observe(beats[i]);
+    }
+    ASSERT_TRUE(predictor.prediction().valid);
+    ASSERT_NEAR(predictor.prediction().periodSec, 2.0 * kPeriod, 0.05);
+
+    const std::size_t firstFull = i;
+    std::size_t foldedAt = 0;
+    for (; i < beats.size(); ++i) {
+        predictor.advance(beats[i]);
+        predictor.observe(beats[i]);
+        if (foldedAt == 0 && std::fabs(predictor.prediction().periodSec - kPeriod) < 0.05) {
+            foldedAt = i;
+        }
+    }
+    ASSERT_GT(foldedAt, 0u);
+    // Two periods of the double lock, two beats each.
+    EXPECT_LE(foldedAt - firstFull, 4u);
+    EXPECT_NEAR(predictor.prediction().periodSec, kPeriod, 0.02);
+}
+
+/// A detector that misses a quarter of the beats at random leaves gaps of one, two or more
+/// periods. They are missed beats, not a lock on half the period. A run of misses while the filter
+/// restarts can lock it on twice the period, which the beats between its predictions halve again
+/// within a few seconds: the filter stays on the true period most of the time.
+TEST(BeatPredictor, RandomlyMissedBeatsDoNotChangeThePeriod) {
+    constexpr double kPeriod = 0.88;
+    const auto beats = jitteredBeats(kPeriod, 0.5, 300.0, 9);
+    std::mt19937 rng(10);
+    std::bernoulli_distribution missed(0.25);
+    BeatPredictor predictor;
+    std::size_t checks = 0;
+    std::size_t onPeriod = 0;
+    for (double now = 0.0, next = 0.0; now < beats.back(); now += 0.01) {
+        for (auto i = static_cast<std::size_t>(next); i < beats.size() && beats[i] <= now; ++i) {
+            next = static_cast<double>(i + 1);
+            if (!missed(rng)) {
+                predictor.observe(beats[i]);
+            }
+        }
+        predictor.advance(now);
+        if (now >= 10.0) {
+            ++checks;
+            const auto& prediction = predictor.prediction();
+            onPeriod += prediction.valid && std::fabs(prediction.periodSec - kPeriod) < 0.05 * kPeriod ? 1 : 0;
+        }
+    }
+    EXPECT_GT(static_cast<double>(onPeriod) / static_cast<double>(checks), 0.85);
+}
+
+/// Once locked, a second trigger on S2 a systole after every beat does not split the interval
+/// evenly and must not fold the period.
+TEST(BeatPredictor, KeepsPeriodWithATriggerOnEveryS2) {
+    constexpr double kPeriod = 0.75;
+    constexpr double kSystoleSec = 0.3;
+    constexpr std::size_t kLockBeats = 6;
+    const auto beats = jitteredBeats(kPeriod, 0.5, 40.0, 8);
+    BeatPredictor predictor;
+    for (std::size_t i = 0; i < beats.size(); ++i) {
+        predictor.advance(beats[i]);
+        predictor.observe(beats[i]);
+        if (i < kLockBeats) {
+            continue;
+        }
+        ASSERT_NEAR(predictor.prediction().periodSec, kPeriod, 0.02) << "beat " << i;
+        predictor.advance(beats[i] + kSystoleSec);
+        predictor.observe(beats[i] + kSystoleSec);
+    }
+}
+
+} // namespace
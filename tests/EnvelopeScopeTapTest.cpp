@@ -0,0 +1,72 @@
+#include "EnvelopeScopeTap.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+using namespace knot::audio;
+
+TEST(EnvelopeScopeTap, BucketsHoldMinMaxAndLastThreshold) {
+    EnvelopeScopeTap tap;
+    tap.setup(48000.0, 0.1); // 5-sample buckets
+    const float envelope[10] = {0.3f, 0.1f, 0.5f, 0.2f, 0.4f, 0.9f, 0.6f, 0.7f, 0.8f, 0.65f};
+    for (int i = 0; i < 10; ++i) {
+        tap.write(envelope[i], static_cast<float>(i));
+    }
+    std::array<ScopeBucket, 4> out{};
+    std::uint64_t last = 0;
+    ASSERT_EQ(tap.readLatest(out.data(), out.size(), &last), 2u);
+    EXPECT_EQ(last, 1u);
+    EXPECT_FLOAT_EQ(out[0].envelopeMin, 0.1f);
+    EXPECT_FLOAT_EQ(out[0].envelopeMax, 0.5f);
+    EXPECT_FLOAT_EQ(out[0].threshold, 4.0f);
+    EXPECT_FLOAT_EQ(out[1].envelopeMin, 0.6f);
+    EXPECT_FLOAT_EQ(out[1].envelopeMax, 0.9f);
+    EXPECT_FLOAT_EQ(out[1].threshold, 9.0f);
+}
+
+TEST(EnvelopeScopeTap, ConcurrentReadsNeverReturnLappedBuckets) {
+    // One-sample buckets in a small ring, so the writer laps the reader constantly. Bucket k
+    // carries k in every field; a returned bucket that does not sit at its sequence was
+    // overwritten while it was copied and should have been dropped.
+    constexpr std::uint64_t kBuckets = 2'000'000;
+    constexpr std::size_t kCapacity = 16;
+    EnvelopeScopeTap tap;
+    tap.setup(1000.0, 1.0, kCapacity);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::uint64_t k = 0; k < kBuckets; ++k) {
+            tap.write(static_cast<float>(k), static_cast<float>(k));
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::array<ScopeBucket, kCapacity> out{};
+    std::uint64_t reads = 0;
+    std::uint64_t stale = 0;
+    bool finished = false;
+    while (!finished) {
+        finished = done.load(std::memory_order_acquire);
+        std::uint64_t last = 0;
+        const std::size_t count = tap.readLatest(out.data(), out.size(), &last);
+        ++reads;
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto expected = static_cast<float>(last - (count - 1) + i);
+            if (out[i].envelopeMin != expected || out[i].envelopeMax != expected || out[i].threshold != expected) {
+                ++stale;
+                break;
+            }
+        }
+    }
+    writer.join();
+
+    EXPECT_EQ(stale, 0u) << "of " << reads << " reads";
+    EXPECT_EQ(tap.publishedCount(), kBuckets);
+}
+
+} // namespace
@@ -0,0 +1,157 @@
+#include "EventBus.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+using namespace knot::audio;
+
+/// Published as the n-th event with sequence n (from 1). Every field derives from sequence, so an
+/// event assembled from two publishes is detectable.
+struct Event {
+    std::uint64_t sequence = 0;
+    std::array<std::uint64_t, 7> payload{};
+
+    static Event make(std::uint64_t sequence) {
+        Event event;
+        event.sequence = sequence;
+        for (std::size_t i = 0; i < event.payload.size(); ++i) {
+            event.payload[i] = sequence * (i + 1);
+        }
+        return event;
+    }
+
+    bool consistent() const {
+        for (std::size_t i = 0; i < payload.size(); ++i) {
+            if (payload[i] != sequence * (i + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+using SmallBus = EventBus<Event, 8>;
+
+TEST(EventBus, SubscriberSeesOnlyEventsPublishedAfterSubscribing) {
+    SmallBus bus;
+    bus.publish(Event::make(1));
+    auto subscriber = bus.subscribe();
+    Event event;
+    EXPECT_FALSE(subscriber.tryConsume(event));
+    bus.publish(Event::make(2));
+    ASSERT_TRUE(subscriber.tryConsume(event));
+    EXPECT_EQ(event.sequence, 2u);
+    EXPECT_FALSE(subscriber.tryConsume(event));
+    EXPECT_EQ(bus.publishedCount(), 2u);
+}
+
+TEST(EventBus, SubscribersAtDifferentSpeedsDoNotAffectEachOther) {
+    constexpr std::uint64_t kEvents = 20;
+    SmallBus bus;
+    auto fast = bus.subscribe();
+    auto slow = bus.subscribe();
+
+    Event event;
+    std::uint64_t fastExpected = 1;
+    for (std::uint64_t sequence = 1; sequence <= kEvents; ++sequence) {
+        bus.publish(Event::make(sequence));
+        while (fast.tryConsume(event)) {
+            EXPECT_EQ(event.sequence, fastExpected++);
+        }
+    }
+    EXPECT_EQ(fast.consumedCount(), kEvents);
+    EXPECT_EQ(fast.overflowCount(), 0u);
+
+    // The slow subscriber was lapped: only the last Capacity events are still in the ring, and
+    // exactly the ones before them count as lost.
+    EXPECT_EQ(slow.pendingCount(), kEvents);
+    std::uint64_t slowExpected = kEvents - SmallBus::capacity() + 1;
+    while (slow.tryConsume(event)) {
+        EXPECT_TRUE(event.consistent());
+        EXPECT_EQ(event.sequence, slowExpected++);
+    }
+    EXPECT_EQ(slowExpected, kEvents + 1);
+    EXPECT_EQ(slow.consumedCount(), SmallBus::capacity());
+    EXPECT_EQ(slow.overflowCount(), kEvents - SmallBus::capacity());
+
+    // Caught up again, it loses nothing more.
+    for (std::uint64_t sequence = kEvents + 1; sequence <= kEvents + 5; ++sequence) {
+        bus.publish(Event::make(sequence));
+    }
+    EXPECT_EQ(slow.poll([&](const Event& consumed) { EXPECT_EQ(consumed.sequence, slowExpected++); }), 5u);
+    EXPECT_EQ(slow.overflowCount(), kEvents - SmallBus::capacity());
+    EXPECT_EQ(fast.overflowCount(), 0u);
+}
+
+TEST(EventBus, SkipToLatestIsNotOverflow) {
+    SmallBus bus;
+    auto subscriber = bus.subscribe();
+    for (std::uint64_t sequence = 1; sequence <= 3 * SmallBus::capacity(); ++sequence) {
+        bus.publish(Event::make(sequence));
+    }
+    subscriber.skipToLatest();
+    EXPECT_EQ(subscriber.pendingCount(), 0u);
+    EXPECT_EQ(subscriber.overflowCount(), 0u);
+    Event event;
+    EXPECT_FALSE(subscriber.tryConsume(event));
+}
+
+TEST(EventBus, ConcurrentConsumerSeesWholeEventsInOrderAndCountsEveryLoss) {
+    constexpr std::uint64_t kEvents = 500'000;
+    EventBus<Event, 64> bus;
+    auto subscriber = bus.subscribe();
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        for (std::uint64_t sequence = 1; sequence <= kEvents; ++sequence) {
+            bus.publish(Event::make(sequence));
+            // Bursts of a few rings' worth with pauses in between, so the consumer both catches
+            // up and gets lapped, even on a single core.
+            if (sequence % 256 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::uint64_t last = 0;
+    std::uint64_t torn = 0;
+    std::uint64_t outOfOrder = 0;
+    std::uint64_t uncountedGaps = 0;
+    bool finished = false;
+    Event event;
+    while (!finished) {
+        // Drain once more after the producer stopped so the last publish is seen.
+        finished = done.load(std::memory_order_acquire);
+        std::uint64_t overflowBefore = subscriber.overflowCount();
+        while (subscriber.tryConsume(event)) {
+            if (!event.consistent()) {
+                ++torn;
+            }
+            if (event.sequence <= last) {
+                ++outOfOrder;
+            } else if (event.sequence - last - 1 != subscriber.overflowCount() - overflowBefore) {
+                // Every event skipped since the previous one must show up in overflowCount().
+                ++uncountedGaps;
+            }
+            last = event.sequence;
+            overflowBefore = subscriber.overflowCount();
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(outOfOrder, 0u);
+    EXPECT_EQ(uncountedGaps, 0u);
+    EXPECT_EQ(last, kEvents);
+    EXPECT_EQ(subscriber.consumedCount() + subscriber.overflowCount(), kEvents);
+}
+
+} // namespace
@@ -0,0 +1,105 @@
+#include "HeartbeatSynth.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr double kSampleRate = 48000.0;
+constexpr std::size_t kBlockFrames = 512;
+// One second: a whole beat (S1 and S2) at 60 BPM.
+constexpr std::size_t kFrames = 48000;
+// The output clock does not start at zero in the app.
+constexpr std::uint64_t kClockStart = 1'000'000;
+
+struct Output {
+    std::array<std::vector<float>, 2> channels;
+};
+
+/// Renders kFrames from kClockStart in blocks of blockFrames after the given triggers, as
+/// (participant, sample offset from kClockStart) pairs at amplitude 1 and 60 BPM.
+Output render(HeartbeatSynth& synth, const std::vector<std::pair<std::size_t, std::size_t>>& triggers,
+              std::size_t blockFrames) {
+    for (const auto& [participant, offset] : triggers) {
+        synth.trigger(participant, kClockStart + offset, 1.0f, 60.0f);
+    }
+    Output output;
+    for (auto& channel : output.channels) {
+        channel.assign(kFrames, 0.0f);
+    }
+    for (std::size_t offset = 0; offset < kFrames; offset += blockFrames) {
+        const std::size_t block = std::min(blockFrames, kFrames - offset);
+        synth.render(kClockStart + offset, block,
+                     {output.channels[0].data() + offset, output.channels[1].data() + offset});
+    }
+    return output;
+}
+
+/// A beat triggered at a sample offset inside a block starts on exactly that sample: the output is
+/// silent before it and then the beat rendered from the start of the clock, shifted by the offset.
+/// Offsets land at the start, in the middle and at the end of a block and in a later block.
+TEST(HeartbeatSynth, TriggerAtSampleOffsetStartsOnThatSample) {
+    HeartbeatSynth synth;
+    synth.setup(kSampleRate);
+    const auto reference = render(synth, {{0, 0}}, kFrames).channels[0];
+    ASSERT_GT(*std::max_element(reference.begin(), reference.begin() + 200), 0.0f);
+
+    for (std::size_t offset : {std::size_t{0}, std::size_t{1}, std::size_t{137}, kBlockFrames - 1, kBlockFrames,
+                               std::size_t{3 * kBlockFrames + 300}}) {
+        SCOPED_TRACE(offset);
+        synth.reset();
+        const auto output = render(synth, {{1, offset}}, kBlockFrames);
+        for (std::size_t i = 0; i < kFrames; ++i) {
+            const float expected = i < offset ? 0.0f : reference[i - offset];
+            ASSERT_EQ(output.channels[1][i], expected) << "frame " << i;
+            // The other participant's channel stays silent.
+            ASSERT_EQ(output.channels[0][i], 0.0f) << "frame " << i;
+        }
+    }
+}
+
+/// Piling up more triggers than the pool holds steals the oldest voices; the mix never exceeds
+/// the pool's worth of loudest voices and falls silent once the last beat has played out.
+TEST(HeartbeatSynth, OverlappingTriggersStayBounded) {
+    HeartbeatSynth synth;
+    synth.setup(kSampleRate);
+    const auto reference = render(synth, {{0, 0}}, kFrames).channels[0];
+    float voicePeak = 0.0f;
+    for (float sample : reference) {
+        voicePeak = std::max(voicePeak, std::fabs(sample));
+    }
+    EXPECT_EQ(synth.activeVoiceCount(), 0u);
+
+    // Forty beats 1 ms apart: two voices each, five times the pool.
+    std::vector<std::pair<std::size_t, std::size_t>> triggers;
+    for (std::size_t beat = 0; beat < 40; ++beat) {
+        triggers.emplace_back(0, 100 + 48 * beat);
+    }
+    const auto output = render(synth, triggers, kBlockFrames);
+    EXPECT_LE(synth.activeVoiceCount(), HeartbeatSynth::kMaxVoices);
+
+    float peak = 0.0f;
+    for (float sample : output.channels[0]) {
+        ASSERT_TRUE(std::isfinite(sample));
+        peak = std::max(peak, std::fabs(sample));
+    }
+    EXPECT_GT(peak, voicePeak);
+    EXPECT_LE(peak, static_cast<float>(HeartbeatSynth::kMaxVoices) * voicePeak);
+
+    // Every voice has played out by the end of the second; the next block is silent.
+    EXPECT_EQ(synth.activeVoiceCount(), 0u);
+    std::array<float, kBlockFrames> left{};
+    std::array<float, kBlockFrames> right{};
+    synth.render(kClockStart + kFrames, kBlockFrames, {left.data(), right.data()});
+    EXPECT_TRUE(std::all_of(left.begin(), left.end(), [](float sample) { return sample == 0.0f; }));
+}
+
+} // namespace
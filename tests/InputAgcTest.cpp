@@ -0,0 +1,157 @@
+#include "InputAgc.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr double kSampleRate = 48000.0;
+constexpr std::size_t kBlockFrames = 512;
+// The operator's static input gain from app_config.json.
+constexpr float kInitialGainDb = 25.0f;
+// Clip protection lands on the ceiling through a dB round trip; allow float rounding on top.
+constexpr float kCeilingLimit = InputAgc::kCeiling * 1.0001f;
+
+float toDb(float linear) {
+    return 20.0f * std::log10(linear);
+}
+
+/// One second of input: a 50 Hz beat of the given peak in its first 150 ms, then near silence.
+std::vector<float> beatSecond(float peak) {
+    std::vector<float> second(static_cast<std::size_t>(kSampleRate), 0.0f);
+    const auto beatFrames = static_cast<std::size_t>(0.15 * kSampleRate);
+    for (std::size_t i = 0; i < beatFrames; ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        const double envelope = std::sin(M_PI * t / 0.15);
+        second[i] = static_cast<float>(peak * envelope * std::sin(2.0 * M_PI * 50.0 * t));
+    }
+    return second;
+}
+
+/// Runs seconds of 60 BPM beats of the given input peak through the AGC in blocks, reporting each
+/// beat after its second as the detector would. No output sample may pass the ceiling. Returns the
+/// output peak over the last second.
+float runBeats(InputAgc& agc, float inputPeak, int seconds) {
+    const auto input = beatSecond(inputPeak);
+    std::vector<float> block(kBlockFrames);
+    float outputPeak = 0.0f;
+    for (int second = 0; second < seconds; ++second) {
+        outputPeak = 0.0f;
+        for (std::size_t offset = 0; offset < input.size(); offset += kBlockFrames) {
+            const std::size_t count = std::min(kBlockFrames, input.size() - offset);
+            std::copy_n(input.begin() + static_cast<std::ptrdiff_t>(offset), count, block.begin());
+            agc.process(block.data(), count);
+            for (std::size_t i = 0; i < count; ++i) {
+                outputPeak = std::max(outputPeak, std::fabs(block[i]));
+            }
+            EXPECT_LE(agc.gainDb(), InputAgc::kMaxGainDb);
+        }
+        EXPECT_LE(outputPeak, kCeilingLimit) << "second " << second;
+        agc.onBeat();
+    }
+    return outputPeak;
+}
+
+/// A quiet and a loud stethoscope both end up with their beats at the target level, whichever way
+/// the gain has to move from the operator's setting, and without ever clipping.
+TEST(InputAgc, ConvergesToTargetForQuietAndLoudInput) {
+    // -46 dBFS needs 34 dB; -20 dBFS needs 8 dB (and clips at the initial 25 dB).
+    for (float inputPeak : {0.005f, 0.1f}) {
+        SCOPED_TRACE(inputPeak);
+        InputAgc agc;
+        agc.setup(kSampleRate, kInitialGainDb);
+        const float outputPeak = runBeats(agc, inputPeak, 60);
+        const float desiredDb = InputAgc::kDefaultTargetPeakDb - toDb(inputPeak);
+        EXPECT_NEAR(agc.gainDb(), desiredDb, 0.5f);
+        EXPECT_NEAR(toDb(outputPeak), InputAgc::kDefaultTargetPeakDb, 1.0f);
+    }
+}
+
+/// Adaptation is bounded: each beat moves the gain by at most kMaxStepDb.
+TEST(InputAgc, AdaptsByBoundedStepsPerBeat) {
+    InputAgc agc;
+    agc.setup(kSampleRate, kInitialGainDb);
+    float previousDb = agc.gainDb();
+    for (int beat = 0; beat < 10; ++beat) {
+        runBeats(agc, 0.005f, 1);
+        EXPECT_LE(std::fabs(agc.gainDb() - previousDb), InputAgc::kMaxStepDb + 1e-4f);
+        previousDb = agc.gainDb();
+    }
+    EXPECT_GT(previousDb, kInitialGainDb + 5.0f);
+}
+
+/// An input too faint to reach the target, or a channel with no beat at all, takes the gain up to
+/// the 40 dB ceiling and no further.
+TEST(InputAgc, GainStopsAtCeiling) {
+    InputAgc agc;
+    agc.setup(kSampleRate, kInitialGainDb);
+    // -80 dBFS would need 68 dB.
+    runBeats(agc, 1e-4f, 60);
+    EXPECT_FLOAT_EQ(agc.gainDb(), InputAgc::kMaxGainDb);
+
+    // Starved: silence and no beats creep the gain up after kStarveSec, to the ceiling.
+    InputAgc starved;
+    starved.setup(kSampleRate, kInitialGainDb);
+    std::vector<float> silence(kBlockFrames, 0.0f);
+    const auto blocks = static_cast<std::size_t>(60.0 * kSampleRate / kBlockFrames);
+    for (std::size_t block = 0; block < blocks; ++block) {
+        starved.process(silence.data(), silence.size());
+        ASSERT_LE(starved.gainDb(), InputAgc::kMaxGainDb);
+    }
+    EXPECT_FLOAT_EQ(starved.gainDb(), InputAgc::kMaxGainDb);
+
+    // An explicit reset above the ceiling is clamped as well.
+    starved.reset(60.0f);
+    EXPECT_FLOAT_EQ(starved.gainDb(), InputAgc::kMaxGainDb);
+}
+
+/// A knock on a channel settled at 40 dB: the block that carries it is scaled at the safe gain from
+/// its first sample, so not one sample passes the ceiling. The reduction then releases slowly.
+TEST(InputAgc, DropsGainAboveSafeLevelAtOnce) {
+    InputAgc agc;
+    agc.setup(kSampleRate, InputAgc::kMaxGainDb);
+    // process() scales in place; every block gets a fresh copy of the input.
+    const std::vector<float> quiet(kBlockFrames, 1e-4f);
+    std::vector<float> block;
+    for (int count = 0; count < 10; ++count) {
+        block = quiet;
+        agc.process(block.data(), block.size());
+    }
+    ASSERT_FLOAT_EQ(agc.gainDb(), InputAgc::kMaxGainDb);
+
+    constexpr float kKnock = 0.5f;
+    std::vector<float> input(kBlockFrames);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = kKnock * static_cast<float>(std::sin(2.0 * M_PI * 80.0 * static_cast<double>(i) / kSampleRate));
+    }
+    std::vector<float> knock = input;
+    agc.process(knock.data(), knock.size());
+
+    const float safeDb = toDb(InputAgc::kCeiling / kKnock);
+    EXPECT_NEAR(agc.gainDb(), safeDb, 0.01f);
+    EXPECT_LT(agc.protectionDb(), 0.0f);
+    const float safeLinear = std::pow(10.0f, safeDb / 20.0f);
+    for (std::size_t i = 0; i < knock.size(); ++i) {
+        ASSERT_LE(std::fabs(knock[i]), kCeilingLimit) << "frame " << i;
+        // Not a ramp down from 40 dB: every sample already has the safe gain.
+        if (std::fabs(input[i]) > 1e-3f) {
+            ASSERT_NEAR(knock[i] / input[i], safeLinear, 1e-3f * safeLinear) << "frame " << i;
+        }
+    }
+
+    // Back to quiet input, the gain recovers at kReleaseDbPerSec rather than jumping back.
+    const auto blocksPerSecond = static_cast<std::size_t>(kSampleRate / kBlockFrames);
+    for (std::size_t count = 0; count < blocksPerSecond; ++count) {
+        block = quiet;
+        agc.process(block.data(), block.size());
+    }
+    EXPECT_NEAR(agc.gainDb(), safeDb + InputAgc::kReleaseDbPerSec, 0.1f);
+}
+
+} // namespace
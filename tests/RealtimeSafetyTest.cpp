@@ -0,0 +1,198 @@
+#include "AudioPipeline.h"
+#include "AudioRouter.h"
+#include "HrirDatabase.h"
+#include "RealtimeSafety.h"
+#include "SceneController.h"
+#include "SyntheticHeartSource.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr double kSampleRate = 48000.0;
+constexpr double kSecondsPerBlockSize = 2.0;
+
+/// Small random HRIR set so the router renders CH1/CH2 binaurally.
+std::shared_ptr<const HrirDatabase> testHrirSet() {
+    constexpr std::size_t kIrLength = 256;
+    std::vector<float> azimuth;
+    std::vector<float> elevation;
+    for (float az = -180.0f; az < 180.0f; az += 30.0f) {
+        azimuth.push_back(az);
+        elevation.push_back(0.0f);
+    }
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-0.05f, 0.05f);
+    std::vector<float> left(azimuth.size() * kIrLength);
+    std::vector<float> right(left.size());
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        left[i] = dist(rng);
+        right[i] = dist(rng);
+    }
+    auto database = std::make_shared<HrirDatabase>();
+    database->setImpulseResponses(azimuth, elevation, left, right, kIrLength);
+    return database;
+}
+
+/// What the UI does to the pipeline while audio runs, as fast as it can: every setter, the run
+/// requests with their polls, and the per-frame reads.
+void hammerUiCalls(AudioPipeline& pipeline, const std::atomic<bool>& done) {
+    std::array<ChannelCalibrationValue, 2> stored{};
+    stored[0] = {"CH1", 1.0f, 0.0f, 0};
+    stored[1] = {"CH2", 1.0f, 0.0f, 0};
+    CalibrationCheck check;
+    LatencyReport report;
+    std::array<EnvelopeCalibrationStats, 2> envelopeStats{};
+    for (std::uint32_t round = 0; !done.load(std::memory_order_acquire); ++round) {
+        const bool odd = (round & 1u) != 0;
+        pipeline.setInputGainDb(odd ? 3.0f : 0.0f);
+        pipeline.setInputAgc(true);
+        pipeline.setCrosstalkCancellation(true);
+        pipeline.setBaselineTracking(true);
+        pipeline.setResynthesisMix(odd ? 0.6f : 0.5f);
+        pipeline.setPredictiveHaptics(true, 0.0);
+        pipeline.setNoiseColor(odd ? NoiseColor::Pink : NoiseColor::Brown);
+        pipeline.setNoiseSeed(round);
+        if (round % 64 == 0) {
+            pipeline.setCalibration(stored);
+            pipeline.startCalibrationCheck();
+            pipeline.startEnvelopeCalibration(0.5);
+        } else if (round % 64 == 32) {
+            pipeline.startLatencyTest(2);
+        } else if (round % 64 == 40) {
+            pipeline.cancelLatencyTest();
+        }
+        pipeline.isCalibrationActive();
+        pipeline.calibrationReady();
+        pipeline.calibrationResult();
+        pipeline.isCalibrationCheckActive();
+        pipeline.pollCalibrationCheck(check);
+        pipeline.isLatencyTestActive();
+        pipeline.pollLatencyReport(report);
+        pipeline.isEnvelopeCalibrationActive();
+        pipeline.pollEnvelopeCalibrationStats(envelopeStats);
+        pipeline.snapshot();
+        pipeline.sampleIndexAtMicros(1'000'000);
+        // Roughly a few hundred UI calls per audio block; the command bus must keep up with a
+        // UI frame, not with a thread that never sleeps.
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+/// Drives the pipeline and router through the device block sizes seen in the field, plus blocks
+/// larger than the reserved scratch and the monitor capacity, with every audio-thread feature
+/// on: AGC, crosstalk cancellation, baseline tracking, resynthesis, predictive haptics and
+/// binaural routing. Meanwhile a second thread plays the UI and calls the setters, run requests
+/// and getters. Each callback runs under ScopedAudioThread; none may allocate, free or take a
+/// lock.
+TEST(RealtimeSafety, AudioCallbacksNeitherAllocateNorBlock) {
+    if constexpr (!rt::kChecksEnabled) {
+        GTEST_SKIP() << "Built with KNOT_RT_SAFETY_CHECKS=0";
+    }
+    constexpr std::array<std::size_t, 10> kBlockSizes = {64, 128, 256, 441, 512, 1024, 4096, 6000, 16384, 20000};
+    const auto hrir = testHrirSet();
+    ASSERT_FALSE(hrir->empty());
+
+    AudioRouter router;
+    router.setup(static_cast<float>(kSampleRate));
+    router.setHrirDatabase(hrir);
+    const auto rules = AudioRouter::builtInScenePreset(SceneState::FirstPhase);
+    for (std::size_t ch = 0; ch < rules.size(); ++ch) {
+        router.setRoutingRule(static_cast<OutputChannel>(ch), rules[ch]);
+    }
+
+    auto pipeline = std::make_unique<AudioPipeline>();
+    pipeline->setup(kSampleRate, 512);
+    pipeline->setInputAgc(true);
+    pipeline->setCrosstalkCancellation(true);
+    pipeline->setBaselineTracking(true);
+    pipeline->setResynthesisMix(0.5f);
+    pipeline->setPredictiveHaptics(true, 0.0);
+    pipeline->setOutputRouter(&router);
+
+    SyntheticHeartSource source;
+    SyntheticHeartParams second;
+    second.bpm = 80.0f;
+    source.setup(kSampleRate, {SyntheticHeartParams{}, second}, 9);
+
+    std::atomic<bool> done{false};
+    std::thread ui([&] { hammerUiCalls(*pipeline, done); });
+
+    std::uint64_t nowMicros = 1'000'000;
+    for (const std::size_t blockFrames : kBlockSizes) {
+        const std::size_t blocks =
+            std::max<std::size_t>(2, static_cast<std::size_t>(kSampleRate * kSecondsPerBlockSize) / blockFrames);
+        std::vector<float> input(blockFrames * 2);
+        std::vector<float> output(blockFrames * AudioRouter::kOutputChannels);
+        rt::resetViolations();
+        for (std::size_t block = 0; block < blocks; ++block) {
+            source.read(input.data(), blockFrames);
+            {
+                rt::ScopedAudioThread realtimeScope;
+                pipeline->processInput(input.data(), blockFrames);
+                pipeline->processOutput(output.data(), blockFrames, AudioRouter::kOutputChannels, nowMicros);
+            }
+            nowMicros += static_cast<std::uint64_t>(static_cast<double>(blockFrames) * 1e6 / kSampleRate);
+        }
+        const auto found = rt::violations();
+        EXPECT_EQ(found.allocations, 0u) << "block size " << blockFrames;
+        EXPECT_EQ(found.deallocations, 0u) << "block size " << blockFrames;
+        EXPECT_EQ(found.blockingWaits, 0u) << "block size " << blockFrames;
+    }
+    done.store(true, std::memory_order_release);
+    ui.join();
+    // The input actually went through detection.
+    EXPECT_GT(pipeline->snapshot().health.bpmAverage, 0.0f);
+}
+
+/// Any lock on the audio thread counts, contended or not, so the zero above cannot depend on
+/// how the two threads happened to interleave.
+TEST(RealtimeSafety, CheckedLockOnAudioThreadCountsAsBlockingWait) {
+    if constexpr (!rt::kChecksEnabled) {
+        GTEST_SKIP() << "Built with KNOT_RT_SAFETY_CHECKS=0";
+    }
+    std::mutex mutex;
+    rt::resetViolations();
+    {
+        rt::CheckedLock lock(mutex);
+    }
+    EXPECT_EQ(rt::violations().blockingWaits, 0u);
+    {
+        rt::ScopedAudioThread realtimeScope;
+        rt::CheckedLock lock(mutex);
+    }
+    EXPECT_EQ(rt::violations().blockingWaits, 1u);
+    rt::resetViolations();
+}
+
+/// The allocation hooks are live, so the zero counts above mean something.
+TEST(RealtimeSafety, ScopedAudioThreadCountsAllocations) {
+    if constexpr (!rt::kChecksEnabled) {
+        GTEST_SKIP() << "Built with KNOT_RT_SAFETY_CHECKS=0";
+    }
+    rt::resetViolations();
+    {
+        rt::ScopedAudioThread realtimeScope;
+        // Called directly: the compiler may drop a paired new/delete expression altogether.
+        void* volatile block = ::operator new(16);
+        ::operator delete(block);
+    }
+    const auto found = rt::violations();
+    EXPECT_EQ(found.allocations, 1u);
+    EXPECT_EQ(found.deallocations, 1u);
+    rt::resetViolations();
+}
+
+} // namespace
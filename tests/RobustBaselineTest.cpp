@@ -0,0 +1,100 @@
+#include "RobustBaseline.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+float medianOf(std::vector<float> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    return values.size() % 2 == 1 ? values[mid] : 0.5f * (values[mid - 1] + values[mid]);
+}
+
+/// Feeds the same envelope to RobustBaseline and to a brute-force window of hop peaks, and
+/// compares median and MAD after every hop, through filling, wrap-around and level shifts.
+void expectMatchesBruteForce(double windowSec, double hopSec, unsigned seed) {
+    constexpr double kSampleRate = 1000.0;
+    RobustBaseline baseline;
+    baseline.setup(kSampleRate, windowSec, hopSec);
+    const auto hopSamples = static_cast<std::size_t>(std::round(hopSec * kSampleRate));
+    const auto capacity = static_cast<std::size_t>(std::round(windowSec / hopSec));
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+    // Quantised values produce plenty of ties, which the sorted window has to keep in order.
+    std::uniform_int_distribution<int> coarse(0, 8);
+    std::deque<float> window;
+    float hopPeak = 0.0f;
+    std::size_t hopFill = 0;
+    const std::size_t total = hopSamples * capacity * 5;
+    for (std::size_t i = 0; i < total; ++i) {
+        const std::size_t phase = i / (hopSamples * capacity);
+        float envelope = noise(rng) * (1.0f + static_cast<float>(phase));
+        if (phase == 2) {
+            envelope = static_cast<float>(coarse(rng)) * 0.125f;
+        }
+        hopPeak = std::max(hopPeak, envelope);
+        const bool hopDone = ++hopFill == hopSamples;
+        ASSERT_EQ(baseline.process(envelope), hopDone);
+        if (!hopDone) {
+            continue;
+        }
+        window.push_back(hopPeak);
+        if (window.size() > capacity) {
+            window.pop_front();
+        }
+        hopFill = 0;
+        hopPeak = 0.0f;
+
+        const std::vector<float> values(window.begin(), window.end());
+        const float median = medianOf(values);
+        std::vector<float> deviations;
+        deviations.reserve(values.size());
+        for (const float value : values) {
+            deviations.push_back(std::fabs(value - median));
+        }
+        ASSERT_EQ(baseline.count(), values.size());
+        ASSERT_FLOAT_EQ(baseline.median(), median) << "sample " << i;
+        ASSERT_NEAR(baseline.mad(), medianOf(deviations), 1e-6f) << "sample " << i;
+    }
+}
+
+TEST(RobustBaseline, OddWindowMatchesBruteForce) {
+    expectMatchesBruteForce(0.99, 0.01, 1);
+}
+
+TEST(RobustBaseline, EvenWindowMatchesBruteForce) {
+    expectMatchesBruteForce(1.0, 0.01, 2);
+}
+
+TEST(RobustBaseline, DefaultWindowMatchesBruteForce) {
+    expectMatchesBruteForce(RobustBaseline::kDefaultWindowSec, RobustBaseline::kDefaultHopSec, 3);
+}
+
+TEST(RobustBaseline, ReadyOnceAQuarterFull) {
+    RobustBaseline baseline;
+    baseline.setup(1000.0, 1.0, 0.01);
+    for (int hop = 0; hop < 24; ++hop) {
+        for (int i = 0; i < 10; ++i) {
+            baseline.process(0.5f);
+        }
+        EXPECT_FALSE(baseline.ready());
+    }
+    for (int i = 0; i < 10; ++i) {
+        baseline.process(0.5f);
+    }
+    EXPECT_TRUE(baseline.ready());
+    baseline.reset();
+    EXPECT_FALSE(baseline.ready());
+    EXPECT_EQ(baseline.count(), 0u);
+}
+
+} // namespace
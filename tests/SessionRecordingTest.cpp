@@ -0,0 +1,125 @@
+#include "SessionRecording.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+class SessionRecordingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+                     ("knot_session_recording_" +
+                      std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        std::filesystem::create_directories(directory_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(directory_, ec);
+    }
+
+    std::filesystem::path directory_;
+};
+
+float leftSample(std::size_t frame) {
+    return static_cast<float>(frame % 1000) / 1000.0f - 0.5f;
+}
+
+float rightSample(std::size_t frame) {
+    return -0.25f * leftSample(frame * 7);
+}
+
+TEST_F(SessionRecordingTest, RoundTripKeepsSamplesAndMarkers) {
+    constexpr double kSampleRate = 48000.0;
+    constexpr std::size_t kBlockFrames = 480;
+    constexpr std::size_t kBlocks = 100;
+    const auto wavPath = directory_ / "session.wav";
+
+    SessionRecorder recorder;
+    ASSERT_TRUE(recorder.start(wavPath, kSampleRate));
+    std::vector<float> block(kBlockFrames * 2);
+    std::size_t frame = 0;
+    for (std::size_t b = 0; b < kBlocks; ++b) {
+        if (b == 10) {
+            recorder.mark("FirstPhase");
+        }
+        if (b == 60) {
+            recorder.mark("Exchange");
+        }
+        for (std::size_t i = 0; i < kBlockFrames; ++i, ++frame) {
+            block[i * 2] = leftSample(frame);
+            block[i * 2 + 1] = rightSample(frame);
+        }
+        recorder.capture(block.data(), kBlockFrames);
+    }
+    recorder.stop();
+    EXPECT_FALSE(recorder.recording());
+    EXPECT_EQ(recorder.capturedFrames(), kBlocks * kBlockFrames);
+    EXPECT_EQ(recorder.droppedFrames(), 0u);
+
+    SessionRecordingData data;
+    ASSERT_TRUE(SessionRecordingData::load(wavPath, kSampleRate, data));
+    ASSERT_EQ(data.length(), kBlocks * kBlockFrames);
+    ASSERT_EQ(data.right.size(), data.left.size());
+    for (std::size_t i = 0; i < data.length(); ++i) {
+        ASSERT_EQ(data.left[i], leftSample(i)) << "frame " << i;
+        ASSERT_EQ(data.right[i], rightSample(i)) << "frame " << i;
+    }
+    ASSERT_EQ(data.markers.size(), 2u);
+    EXPECT_EQ(data.markers[0].frame, 10 * kBlockFrames);
+    EXPECT_EQ(data.markers[0].label, "FirstPhase");
+    EXPECT_EQ(data.markers[1].frame, 60 * kBlockFrames);
+    EXPECT_EQ(data.markers[1].label, "Exchange");
+}
+
+TEST_F(SessionRecordingTest, ReplayerPlaysTheRecordingThenSilence) {
+    auto recording = std::make_shared<SessionRecordingData>();
+    for (std::size_t i = 0; i < 1000; ++i) {
+        recording->left.push_back(leftSample(i));
+        recording->right.push_back(rightSample(i));
+    }
+    SessionReplayer replayer;
+    replayer.prepare(recording);
+    ASSERT_TRUE(replayer.active());
+
+    std::vector<float> block(256 * 2);
+    std::size_t frame = 0;
+    while (!replayer.finished()) {
+        replayer.read(block.data(), 256);
+        for (std::size_t i = 0; i < 256; ++i, ++frame) {
+            const bool inRecording = frame < recording->length();
+            ASSERT_EQ(block[i * 2], inRecording ? leftSample(frame) : 0.0f) << "frame " << frame;
+            ASSERT_EQ(block[i * 2 + 1], inRecording ? rightSample(frame) : 0.0f) << "frame " << frame;
+        }
+    }
+    EXPECT_EQ(frame, 1024u);
+}
+
+TEST_F(SessionRecordingTest, LoadResamplesMarkersToThePipelineRate) {
+    const auto wavPath = directory_ / "resampled.wav";
+    SessionRecorder recorder;
+    ASSERT_TRUE(recorder.start(wavPath, 44100.0));
+    std::vector<float> block(441 * 2, 0.1f);
+    for (int b = 0; b < 20; ++b) {
+        if (b == 10) {
+            recorder.mark("Mixed");
+        }
+        recorder.capture(block.data(), 441);
+    }
+    recorder.stop();
+
+    SessionRecordingData data;
+    ASSERT_TRUE(SessionRecordingData::load(wavPath, 48000.0, data));
+    EXPECT_NEAR(static_cast<double>(data.length()), 9600.0, 1.0);
+    ASSERT_EQ(data.markers.size(), 1u);
+    EXPECT_EQ(data.markers[0].frame, 4800u);
+}
+
+} // namespace
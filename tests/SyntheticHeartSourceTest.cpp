@@ -0,0 +1,198 @@
+#include "AudioPipeline.h"
+#include "SyntheticHeartSource.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace {
+
+using namespace knot::audio;
+
+constexpr double kSampleRate = 48000.0;
+constexpr std::size_t kBlockFrames = 512;
+constexpr double kSeconds = 180.0;
+// Nothing before this is scored while the detectors, the AGC and the canceller settle.
+constexpr double kWarmupSec = 10.0;
+// A published beat counts for a true S1 onset from kMatchEarlySec before to kMatchLateSec after it
+// (the synthetic benchmark's window).
+constexpr double kMatchEarlySec = 0.02;
+constexpr double kMatchLateSec = 0.12;
+// The source adds 30 ms of RR jitter and breathing on top of the tempo.
+constexpr float kBpmTolerance = 2.5f;
+constexpr float kTrackedTolerance = 0.05f;
+// Floors below the worst of 30 source seeds: the detector misses beats on inspiration, and the
+// tracker loses the tempo for a while after a run of them.
+constexpr double kMinHitRate = 0.6;
+constexpr double kMinTrackedFraction = 0.5;
+
+struct Scored {
+    /// 60 / median interval between consecutive published beats.
+    float detectedBpm = 0.0f;
+    /// Median of the bpm the published beats carry.
+    float reportedBpm = 0.0f;
+    /// Fraction of the run the health snapshot's tracked bpm is within kTrackedTolerance.
+    double trackedFraction = 0.0;
+    /// Fraction of true onsets with a published beat in the match window.
+    double hitRate = 0.0;
+    std::size_t truthCount = 0;
+    std::size_t dropouts = 0;
+};
+
+/// Participant 1 or 2 as 0 or 1; nothing for other ids.
+std::optional<std::size_t> indexOf(ParticipantId id) {
+    switch (id) {
+        case ParticipantId::Participant1:
+            return 0;
+        case ParticipantId::Participant2:
+            return 1;
+        default:
+            return std::nullopt;
+    }
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+/// Feeds kSeconds of synthetic input through a pipeline set up as the app runs it (25 dB input
+/// gain, AGC, crosstalk cancellation, predictive haptics) and scores each participant's published
+/// beats and tracked tempo against the source's ground truth.
+std::array<Scored, 2> runSynthetic(const std::array<SyntheticHeartParams, 2>& params) {
+    AudioPipeline pipeline;
+    pipeline.setup(kSampleRate, kBlockFrames);
+    pipeline.setNoiseSeed(11);
+    pipeline.setInputGainDb(25.0f);
+    pipeline.setInputAgc(true);
+    pipeline.setCrosstalkCancellation(true);
+    pipeline.setPredictiveHaptics(true, 0.0);
+
+    SyntheticHeartSource source;
+    source.setup(kSampleRate, params, 0x5EED);
+    BeatEventBus truth;
+    source.setTruthBus(&truth);
+    auto truthEvents = truth.subscribe();
+    auto beatEvents = pipeline.subscribeBeatEvents();
+
+    std::array<Scored, 2> scored{};
+    std::array<std::vector<double>, 2> truthTimes;
+    std::array<std::vector<BeatEvent>, 2> published;
+    std::array<std::size_t, 2> trackedBlocks{};
+    std::array<std::size_t, 2> scoredBlocks{};
+    std::array<bool, 2> inDropout{};
+
+    std::vector<float> input(kBlockFrames * 2);
+    std::vector<float> output(kBlockFrames * AudioRouter::kOutputChannels);
+    const auto blocks = static_cast<std::size_t>(kSeconds * kSampleRate / kBlockFrames);
+    for (std::size_t block = 0; block < blocks; ++block) {
+        source.read(input.data(), kBlockFrames);
+        pipeline.processInput(input.data(), kBlockFrames);
+        pipeline.processOutput(output.data(), kBlockFrames, AudioRouter::kOutputChannels, 0);
+        const double nowSec = static_cast<double>(source.position()) / kSampleRate;
+        const auto snapshot = pipeline.snapshot();
+        for (std::size_t p = 0; p < 2; ++p) {
+            const bool dropped = source.inDropout(p);
+            scored[p].dropouts += dropped && !inDropout[p] ? 1 : 0;
+            inDropout[p] = dropped;
+            if (nowSec >= kWarmupSec) {
+                ++scoredBlocks[p];
+                const float trackedError = std::fabs(snapshot.health.trackedBpm[p] - params[p].bpm);
+                trackedBlocks[p] += trackedError < kTrackedTolerance * params[p].bpm ? 1 : 0;
+            }
+        }
+        truthEvents.poll([&](const BeatEvent& event) {
+            if (const auto index = indexOf(event.participantId)) {
+                truthTimes[*index].push_back(event.timestampSec);
+            }
+        });
+        beatEvents.poll([&](const BeatEvent& event) {
+            if (const auto index = indexOf(event.participantId)) {
+                published[*index].push_back(event);
+            }
+        });
+    }
+
+    for (std::size_t p = 0; p < 2; ++p) {
+        std::vector<double> intervals;
+        std::vector<double> reported;
+        for (std::size_t i = 1; i < published[p].size(); ++i) {
+            if (published[p][i].timestampSec >= kWarmupSec) {
+                intervals.push_back(published[p][i].timestampSec - published[p][i - 1].timestampSec);
+                reported.push_back(published[p][i].bpm);
+            }
+        }
+        scored[p].detectedBpm = intervals.empty() ? 0.0f : static_cast<float>(60.0 / median(intervals));
+        scored[p].reportedBpm = static_cast<float>(median(reported));
+        scored[p].trackedFraction = static_cast<double>(trackedBlocks[p]) / static_cast<double>(scoredBlocks[p]);
+
+        std::size_t hits = 0;
+        for (double onset : truthTimes[p]) {
+            if (onset < kWarmupSec) {
+                continue;
+            }
+            ++scored[p].truthCount;
+            const bool hit = std::any_of(published[p].begin(), published[p].end(), [&](const BeatEvent& beat) {
+                return beat.timestampSec >= onset - kMatchEarlySec && beat.timestampSec <= onset + kMatchLateSec;
+            });
+            hits += hit ? 1 : 0;
+        }
+        scored[p].hitRate =
+            scored[p].truthCount > 0 ? static_cast<double>(hits) / static_cast<double>(scored[p].truthCount) : 0.0;
+    }
+    return scored;
+}
+
+/// Two participants at distinct tempi, the second one quieter.
+std::array<SyntheticHeartParams, 2> twoParticipants(float crosstalkDb, float dropoutsPerMin) {
+    std::array<SyntheticHeartParams, 2> params{};
+    params[0].bpm = 68.0f;
+    params[1].bpm = 81.0f;
+    params[1].levelDb = -38.0f;
+    for (auto& participant : params) {
+        participant.crosstalkDb = crosstalkDb;
+        participant.dropoutsPerMin = dropoutsPerMin;
+    }
+    return params;
+}
+
+void expectTempo(const std::array<SyntheticHeartParams, 2>& params, const std::array<Scored, 2>& scored) {
+    for (std::size_t p = 0; p < 2; ++p) {
+        SCOPED_TRACE(p);
+        ASSERT_GT(scored[p].truthCount, 100u);
+        EXPECT_NEAR(scored[p].detectedBpm, params[p].bpm, kBpmTolerance);
+        EXPECT_NEAR(scored[p].reportedBpm, params[p].bpm, kBpmTolerance);
+        EXPECT_GT(scored[p].hitRate, kMinHitRate);
+        EXPECT_GT(scored[p].trackedFraction, kMinTrackedFraction);
+    }
+}
+
+/// Synthetic input at a known tempo through the whole pipeline: the published beats, the bpm they
+/// carry and the tracked tempo in the health snapshot all match it for both participants.
+TEST(SyntheticHeartSource, PipelineDetectsTheSourceTempo) {
+    const auto params = twoParticipants(-30.0f, 0.0f);
+    expectTempo(params, runSynthetic(params));
+}
+
+/// The same with each heart leaking into the other stethoscope at -24 dB and stethoscopes lifted
+/// off the chest twice a minute: the tempo comes back after every dropout and does not follow the
+/// other participant's heart.
+TEST(SyntheticHeartSource, PipelineKeepsTheTempoThroughCrosstalkAndDropouts) {
+    const auto params = twoParticipants(-24.0f, 2.0f);
+    const auto scored = runSynthetic(params);
+    for (const auto& participant : scored) {
+        EXPECT_GT(participant.dropouts, 0u);
+    }
+    expectTempo(params, scored);
+}
+
+} // namespace
@@ -0,0 +1,19 @@
+#include "infra/TelemetryStreamer.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TEST(TelemetryStreamer, LoopbackDeliversEveryBeatEnvelopesAndStatus) {
+    const infra::StreamingConfig config;
+    const auto report = infra::TelemetryStreamer::measureLoopback(config);
+    ASSERT_TRUE(report.receiverBound) << "cannot bind a receiver on 127.0.0.1";
+    EXPECT_GT(report.beatsSent, 0u);
+    EXPECT_EQ(report.lostBeats(), 0u) << report.beatsReceived << "/" << report.beatsSent << " beats arrived";
+    EXPECT_GT(report.envelopeBundles, 0u);
+    EXPECT_GT(report.statusMessages, 0u);
+    EXPECT_EQ(report.stats.sendErrors, 0u);
+    EXPECT_TRUE(report.passed());
+}
+
+} // namespace
@@ -0,0 +1,93 @@
+#include "TripleBuffer.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+using namespace knot::audio;
+
+/// Every field derives from sequence, so a value assembled from two publishes is detectable. The
+/// default value (sequence 0) is consistent too.
+struct Frame {
+    std::uint64_t sequence = 0;
+    std::array<std::uint64_t, 15> payload{};
+
+    static Frame make(std::uint64_t sequence) {
+        Frame frame;
+        frame.sequence = sequence;
+        for (std::size_t i = 0; i < frame.payload.size(); ++i) {
+            frame.payload[i] = sequence * (i + 1);
+        }
+        return frame;
+    }
+
+    bool consistent() const {
+        for (std::size_t i = 0; i < payload.size(); ++i) {
+            if (payload[i] != sequence * (i + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+TEST(TripleBuffer, ReadBeforePublishReturnsDefault) {
+    TripleBuffer<Frame> buffer;
+    EXPECT_EQ(buffer.read().sequence, 0u);
+}
+
+TEST(TripleBuffer, ReadReturnsLatestPublish) {
+    TripleBuffer<Frame> buffer;
+    buffer.publish(Frame::make(1));
+    buffer.publish(Frame::make(2));
+    buffer.publish(Frame::make(3));
+    EXPECT_EQ(buffer.read().sequence, 3u);
+    // Nothing new: the same value again.
+    EXPECT_EQ(buffer.read().sequence, 3u);
+    buffer.publish(Frame::make(4));
+    EXPECT_EQ(buffer.read().sequence, 4u);
+}
+
+TEST(TripleBuffer, ConcurrentReadsAreWholeAndInOrder) {
+    constexpr std::uint64_t kPublishes = 2'000'000;
+    TripleBuffer<Frame> buffer;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        for (std::uint64_t sequence = 1; sequence <= kPublishes; ++sequence) {
+            buffer.publish(Frame::make(sequence));
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::uint64_t last = 0;
+    std::uint64_t reads = 0;
+    std::uint64_t torn = 0;
+    std::uint64_t backwards = 0;
+    bool finished = false;
+    while (!finished) {
+        // Read once more after the producer stopped so the last publish is seen.
+        finished = done.load(std::memory_order_acquire);
+        const Frame& frame = buffer.read();
+        ++reads;
+        if (!frame.consistent()) {
+            ++torn;
+        }
+        if (frame.sequence < last) {
+            ++backwards;
+        }
+        last = frame.sequence;
+    }
+    producer.join();
+
+    EXPECT_EQ(torn, 0u) << "of " << reads << " reads";
+    EXPECT_EQ(backwards, 0u);
+    EXPECT_EQ(last, kPublishes);
+}
+
+} // namespace